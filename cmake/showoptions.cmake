@@ -62,6 +62,22 @@ else()
 	message("* Use coreside debug     : No  (default)")
 endif()
 
+# Log calls below this level are compiled out, defaults to 'info' in release builds.
+set(LOG_LEVELS trace debug info warning error fatal)
+if (NOT LOG_MIN_LEVEL)
+	if (CMAKE_BUILD_TYPE STREQUAL "Release" OR CMAKE_BUILD_TYPE STREQUAL "MinSizeRel")
+		set(LOG_MIN_LEVEL info)
+	else()
+		set(LOG_MIN_LEVEL trace)
+	endif()
+endif()
+list(FIND LOG_LEVELS ${LOG_MIN_LEVEL} LOG_MIN_LEVEL_INDEX)
+if (LOG_MIN_LEVEL_INDEX EQUAL -1)
+	message(FATAL_ERROR "LOG_MIN_LEVEL must be one of: ${LOG_LEVELS}.")
+endif()
+message("* Minimum log level      : ${LOG_MIN_LEVEL}")
+add_definitions(-DHORIZON_LOG_MIN_LEVEL=${LOG_MIN_LEVEL_INDEX})
+
 if (NOT WITH_SOURCE_TREE STREQUAL "no")
 	message("* Show source tree       : Yes (${WITH_SOURCE_TREE})")
 else()
@@ -1059,3 +1059,12 @@ map_list = {
 	"gl_cas01_",
 	"1@gl_prq"
 }
+
+---------------------------------------------------------------------------
+--- Map Load Weights.
+--- Optional hints used by the zone server to distribute maps between its
+--- map containers. Maps without a hint are weighed by their monster spawns.
+---------------------------------------------------------------------------
+map_weights = {
+	-- prontera = 200,
+}
@@ -31,17 +31,119 @@
 #include <iostream>
 #include <boost/log/utility/setup/file.hpp>
 #include <boost/log/expressions.hpp>
+#include <boost/log/attributes/attribute_value_impl.hpp>
 #include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/date_time/c_local_time_adjustor.hpp>
 #include <boost/log/support/date_time.hpp>
 #include <boost/log/utility/setup/console.hpp>
 
+/**
+ * @brief Stream buffer writing into the inline text of a record, moving the message
+ * to a heap string once it no longer fits.
+ */
+class LogLine::record_streambuf : public std::streambuf
+{
+public:
+	void attach(log_record &record)
+	{
+		_record = &record;
+		_spilled = false;
+		setp(record.text, record.text + LOG_RECORD_TEXT_SIZE);
+	}
+
+	void detach()
+	{
+		if (_spilled) {
+			_spill.append(pbase(), pptr() - pbase());
+			_record->overflow = std::make_unique<std::string>(std::move(_spill));
+			_spill.clear();
+		} else {
+			_record->length = (uint16_t) (pptr() - pbase());
+		}
+
+		_record = nullptr;
+		setp(nullptr, nullptr);
+	}
+
+protected:
+	int_type overflow(int_type ch) override
+	{
+		if (_record == nullptr)
+			return traits_type::eof();
+
+		_spill.append(pbase(), pptr() - pbase());
+		_spilled = true;
+
+		if (!traits_type::eq_int_type(ch, traits_type::eof()))
+			_spill.push_back(traits_type::to_char_type(ch));
+
+		// Keep using the inline text as a staging area for the spilled message.
+		setp(_record->text, _record->text + LOG_RECORD_TEXT_SIZE);
+
+		return traits_type::not_eof(ch);
+	}
+
+private:
+	log_record *_record{nullptr};
+	std::string _spill;
+	bool _spilled{false};
+};
+
+struct LogLine::thread_stream
+{
+	thread_stream() : os(&buf) { }
+
+	record_streambuf buf;
+	std::ostream os;
+	bool in_use{false};
+};
+
+LogLine::LogLine(log_subsystem subsystem, boost::log::trivial::severity_level severity)
+{
+	static thread_local thread_stream stream;
+
+	_record.time = std::chrono::system_clock::now();
+	_record.severity = severity;
+	_record.subsystem = subsystem;
+
+	if (stream.in_use) {
+		_nested_stream = std::make_unique<thread_stream>();
+		_thread_stream = _nested_stream.get();
+	} else {
+		_thread_stream = &stream;
+	}
+
+	_thread_stream->in_use = true;
+	_thread_stream->buf.attach(_record);
+
+	// Undo manipulators left behind by the previous message.
+	std::ostream &os = _thread_stream->os;
+	os.clear();
+	os.flags(std::ios_base::dec | std::ios_base::skipws);
+	os.fill(' ');
+	os.precision(6);
+	os.width(0);
+
+	_stream = &os;
+}
+
+LogLine::~LogLine()
+{
+	_thread_stream->buf.detach();
+	_thread_stream->in_use = false;
+
+	Logger::getInstance()->submit(std::move(_record));
+}
+
 Logger::Logger()
 {
+	for (auto &level : _levels)
+		level.store(boost::log::trivial::trace);
 }
 
 Logger::~Logger()
 {
-	//
+	finalize();
 }
 
 std::string Logger::color(uint16_t color) { return "\033[" + std::to_string(color) + "m"; }
@@ -81,15 +183,13 @@ void Logger::colored_formatter(boost::log::record_view const& rec, boost::log::f
 void Logger::initialize()
 {
     /* init boost log 
-     * 1. Add common attributes
-     * 2. set log filter to trace
+     * 1. Keep the core alive for as long as the logger is.
+     * 2. Let everything through, levels are checked before a record is made (@see is_enabled()).
+     *    The time stamp is attached to each record by the log thread from the time it was logged.
      */
-    boost::log::add_common_attributes();
-    
-    boost::log::core::get()->add_global_attribute("Scope",
-        boost::log::attributes::named_scope());
-    
-    boost::log::core::get()->set_filter(
+    _core = boost::log::core::get();
+
+    _core->set_filter(
         boost::log::trivial::severity >= boost::log::trivial::trace
     );
 
@@ -102,32 +202,198 @@ void Logger::initialize()
     auto fmtSeverity = boost::log::expressions::
         attr<boost::log::trivial::severity_level>("Severity");
     
-    auto fmtScope = boost::log::expressions::format_named_scope("Scope",
-        boost::log::keywords::format = "%n(%f:%l)",
-        boost::log::keywords::iteration = boost::log::expressions::reverse,
-        boost::log::keywords::depth = 2);
-    
     boost::log::formatter logFmt =
         boost::log::expressions::format("[%1%] (%2%) %3%")
         % fmtTimeStamp % fmtSeverity
         % boost::log::expressions::smessage;
 
     /* console sink */
-    auto consoleSink = boost::log::add_console_log(std::clog);
+    _console_sink = boost::log::add_console_log(std::clog);
     
-    consoleSink->set_formatter(std::bind(&Logger::colored_formatter, this, std::placeholders::_1, std::placeholders::_2));
+    _console_sink->set_formatter(std::bind(&Logger::colored_formatter, this, std::placeholders::_1, std::placeholders::_2));
+    _console_sink->set_filter([this] (boost::log::attribute_value_set const &) { return _console_output.load(std::memory_order_relaxed); });
 
     /* fs sink */
-    auto fsSink = boost::log::add_file_log(
+    _file_sink = boost::log::add_file_log(
         boost::log::keywords::target = "logs",
         boost::log::keywords::file_name = "logs/log_%Y-%m-%d_%H-%M-%S.%N.log",
         boost::log::keywords::rotation_size = 10 * 1024 * 1024,
         boost::log::keywords::min_free_space = 30 * 1024 * 1024,
         boost::log::keywords::open_mode = std::ios_base::app);
     
-    fsSink->set_formatter(logFmt);
-    
-    fsSink->locked_backend()->auto_flush(true);
+    _file_sink->set_formatter(logFmt);
+
+    /* Sinks are flushed by the log thread after each batch (@see drain()). */
+    _file_sink->locked_backend()->auto_flush(false);
+
+    _running.store(true);
+    _thread = std::thread(&Logger::run, this);
+}
+
+void Logger::finalize()
+{
+    if (!_running.exchange(false))
+        return;
+
+    if (_thread.joinable())
+        _thread.join();
+
+    // Pick up anything queued while the log thread was stopping.
+    std::lock_guard<std::mutex> lock(_write_mtx);
+    drain();
+}
+
+char const *Logger::subsystem_name(log_subsystem subsystem)
+{
+    static char const *names[LOG_SUBSYSTEM_MAX] = { "core", "network", "game", "database", "script" };
+
+    return subsystem < LOG_SUBSYSTEM_MAX ? names[subsystem] : "unknown";
+}
+
+bool Logger::parse_subsystem(std::string const &name, log_subsystem &subsystem)
+{
+    for (int i = 0; i < LOG_SUBSYSTEM_MAX; i++) {
+        if (name == subsystem_name((log_subsystem) i)) {
+            subsystem = (log_subsystem) i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void Logger::submit(log_record &&record)
+{
+    if (record.overflow)
+        _overflows.fetch_add(1, std::memory_order_relaxed);
+
+    if (!_running.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(_write_mtx);
+        write(record);
+        if (_console_sink)
+            _console_sink->flush();
+        if (_file_sink)
+            _file_sink->flush();
+        return;
+    }
+
+    static thread_local std::shared_ptr<log_ring> ring;
+
+    if (ring == nullptr) {
+        ring = std::make_shared<log_ring>(_ring_capacity.load(std::memory_order_relaxed));
+        std::lock_guard<std::mutex> lock(_rings_mtx);
+        _rings.push_back(ring);
+    }
+
+    if (ring->records.try_push(std::move(record)))
+        return;
+
+    _stalls.fetch_add(1, std::memory_order_relaxed);
+
+    do {
+        if (!_running.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(_write_mtx);
+            write(record);
+            return;
+        }
+
+        std::this_thread::yield();
+    } while (!ring->records.try_push(std::move(record)));
+}
+
+logger_statistics Logger::get_statistics()
+{
+    logger_statistics stats;
+
+    stats.records = _records.load(std::memory_order_relaxed);
+    stats.overflows = _overflows.load(std::memory_order_relaxed);
+    stats.stalls = _stalls.load(std::memory_order_relaxed);
+
+    return stats;
+}
+
+/**
+ * @brief Log thread loop, formats and flushes queued records until finalize() is called.
+ * @thread Log thread.
+ */
+void Logger::run()
+{
+    while (_running.load(std::memory_order_acquire)) {
+        if (drain() == 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    drain();
+}
+
+/**
+ * @brief Writes up to LOG_FLUSH_BATCH_SIZE records of every ring and flushes the sinks.
+ * Rings of threads that have exited are dropped once they are empty.
+ * @thread Log thread, or the thread calling finalize() once the log thread has stopped.
+ * @return number of records written.
+ */
+std::size_t Logger::drain()
+{
+    std::size_t written = 0;
+    std::lock_guard<std::mutex> lock(_rings_mtx);
+
+    for (auto it = _rings.begin(); it != _rings.end();) {
+        SPSCQueue<log_record> &records = (*it)->records;
+        log_record *record = nullptr;
+        std::size_t count = 0;
+
+        while (count < LOG_FLUSH_BATCH_SIZE && (record = records.front()) != nullptr) {
+            write(*record);
+            records.pop();
+            count++;
+        }
+
+        written += count;
+
+        // The thread owning the ring holds the other reference until it exits.
+        if (it->use_count() == 1 && records.empty())
+            it = _rings.erase(it);
+        else
+            it++;
+    }
+
+    if (written) {
+        _console_sink->flush();
+        _file_sink->flush();
+    }
+
+    return written;
+}
+
+void Logger::write(log_record const &record)
+{
+    boost::log::record rec = _core_log.open_record(boost::log::keywords::severity = record.severity);
+
+    if (!rec)
+        return;
+
+    std::chrono::system_clock::duration since_epoch = record.time.time_since_epoch();
+    std::chrono::seconds seconds = std::chrono::duration_cast<std::chrono::seconds>(since_epoch);
+    std::chrono::microseconds microseconds = std::chrono::duration_cast<std::chrono::microseconds>(since_epoch - seconds);
+
+    boost::posix_time::ptime time = boost::date_time::c_local_adjustor<boost::posix_time::ptime>::utc_to_local(
+        boost::posix_time::from_time_t(seconds.count()) + boost::posix_time::microseconds(microseconds.count()));
+
+    rec.attribute_values().insert("TimeStamp", boost::log::attributes::make_attribute_value(time));
+
+    char const *text = record.overflow ? record.overflow->data() : record.text;
+    std::size_t length = record.overflow ? record.overflow->size() : record.length;
+
+    // Messages ended with std::endl would otherwise be followed by an empty line.
+    while (length > 0 && (text[length - 1] == '\n' || text[length - 1] == '\r'))
+        length--;
+
+    {
+        boost::log::record_ostream strm(rec);
+        strm.write(text, length);
+        strm.flush();
+    }
 
-    _initialized.store(true);
+    _core_log.push_record(boost::move(rec));
+    _records.fetch_add(1, std::memory_order_relaxed);
 }
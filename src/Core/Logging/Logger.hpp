@@ -31,8 +31,15 @@
 #define HORIZON_LOGGER_H
 
 #include <cstring>
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <memory>
 #include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
 
 #define BOOST_LOG_DYN_LINK 1
 
@@ -40,14 +47,72 @@
 #include <boost/log/trivial.hpp>
 #include <boost/log/sources/severity_logger.hpp>
 #include <boost/log/expressions.hpp>
+#include <boost/log/sinks/sync_frontend.hpp>
 #include <boost/log/sinks/text_file_backend.hpp>
+#include <boost/log/sinks/text_ostream_backend.hpp>
 #include <boost/log/utility/setup/file.hpp>
-#include <boost/log/utility/setup/common_attributes.hpp>
+
+#include "Core/Multithreading/SPSCQueue.hpp"
+
+/**
+ * Minimum severity compiled into the binary, set by the build (LOG_MIN_LEVEL).
+ * HLog() calls below it are constant-false branches and are removed entirely.
+ * 0 - trace, 1 - debug, 2 - info, 3 - warning, 4 - error, 5 - fatal.
+ */
+#ifndef HORIZON_LOG_MIN_LEVEL
+#define HORIZON_LOG_MIN_LEVEL 0
+#endif
+
+// Characters of a message stored inline in a log record, longer messages spill onto the heap.
+#define LOG_RECORD_TEXT_SIZE 200
+// Default number of records each producing thread can have queued before it has to wait for the log thread.
+// Every thread that logs holds a ring of this many records (about 232 bytes each), @see Logger::set_ring_capacity().
+#define LOG_RING_CAPACITY 256
+// Maximum records formatted by the log thread before it flushes the sinks.
+#define LOG_FLUSH_BATCH_SIZE 1024
+
+enum log_subsystem : uint8_t
+{
+	LOG_CORE = 0,
+	LOG_NETWORK,
+	LOG_GAME,
+	LOG_DATABASE,
+	LOG_SCRIPT,
+	LOG_SUBSYSTEM_MAX
+};
+
+/**
+ * @brief Fixed-size log record, filled in by the producing thread and formatted by the log thread.
+ */
+struct log_record
+{
+	std::chrono::system_clock::time_point time;
+	boost::log::trivial::severity_level severity{boost::log::trivial::info};
+	log_subsystem subsystem{LOG_CORE};
+	uint16_t length{0};
+	std::unique_ptr<std::string> overflow;  ///< Whole message, only set when it didn't fit in text.
+	char text[LOG_RECORD_TEXT_SIZE];
+};
+
+struct logger_statistics
+{
+	uint64_t records{0};       ///< Records written to the sinks.
+	uint64_t overflows{0};     ///< Records whose message was too long to be stored inline.
+	uint64_t stalls{0};        ///< Times a producer found its ring full and had to wait.
+};
 
 class Logger
 {
 private:
     typedef boost::log::sources::severity_logger<boost::log::trivial::severity_level> logtype;
+    typedef boost::log::sinks::synchronous_sink<boost::log::sinks::text_ostream_backend> console_sink_type;
+    typedef boost::log::sinks::synchronous_sink<boost::log::sinks::text_file_backend> file_sink_type;
+
+    struct log_ring
+    {
+        explicit log_ring(std::size_t capacity) : records(capacity) { }
+        SPSCQueue<log_record> records;
+    };
 
 public:
 	Logger();
@@ -56,26 +121,110 @@ public:
 	static Logger *getInstance()
 	{
 		static Logger instance;
+		static std::once_flag initialized;
+
+		std::call_once(initialized, &Logger::initialize, &instance);
 
-        if (!instance._initialized)
-            instance.initialize();
-        
 		return &instance;
 	}
 
+    /**
+     * @brief Sets up the sinks and starts the log thread, called once by getInstance().
+     */
     void initialize();
+    /**
+     * @brief Stops the log thread after writing every queued record, later records are written synchronously.
+     */
+    void finalize();
     
     logtype &get_core_log() { return _core_log; }
     
     void colored_formatter(boost::log::record_view const& rec, boost::log::formatting_ostream& strm);
     std::string color(uint16_t color);
 
+    bool is_enabled(log_subsystem subsystem, boost::log::trivial::severity_level severity) const
+    {
+        return severity >= _levels[subsystem].load(std::memory_order_relaxed);
+    }
+
+    void set_level(log_subsystem subsystem, boost::log::trivial::severity_level severity) { _levels[subsystem].store(severity, std::memory_order_relaxed); }
+    boost::log::trivial::severity_level get_level(log_subsystem subsystem) const { return _levels[subsystem].load(std::memory_order_relaxed); }
+
+    void set_console_output(bool enabled) { _console_output.store(enabled); }
+
+    /**
+     * @brief Sets the capacity of the rings of threads that log for the first time after this call,
+     * rounded up to a power of two. Rings that already exist keep their capacity.
+     */
+    void set_ring_capacity(std::size_t capacity) { _ring_capacity.store(std::max<std::size_t>(capacity, 1), std::memory_order_relaxed); }
+    std::size_t get_ring_capacity() const { return _ring_capacity.load(std::memory_order_relaxed); }
+
+    static char const *subsystem_name(log_subsystem subsystem);
+    static bool parse_subsystem(std::string const &name, log_subsystem &subsystem);
+
+    /**
+     * @brief Queues a record on the calling thread's ring.
+     * @thread Any, lock-free unless the ring is full.
+     */
+    void submit(log_record &&record);
+
+    logger_statistics get_statistics();
+
 protected:
+    void run();
+    std::size_t drain();
+    void write(log_record const &record);
+
     logtype _core_log;
-    std::atomic<bool> _initialized;
+    boost::shared_ptr<boost::log::core> _core;
+    boost::shared_ptr<console_sink_type> _console_sink;
+    boost::shared_ptr<file_sink_type> _file_sink;
+    std::atomic<bool> _console_output{true};
+    std::atomic<std::size_t> _ring_capacity{LOG_RING_CAPACITY};
+    std::atomic<boost::log::trivial::severity_level> _levels[LOG_SUBSYSTEM_MAX];
+
+    std::thread _thread;
+    std::atomic<bool> _running{false};
+    std::mutex _rings_mtx;                              ///< Guards _rings against registrations.
+    std::vector<std::shared_ptr<log_ring>> _rings;
+    std::mutex _write_mtx;                              ///< Serializes synchronous writes before/after the log thread runs.
+
+    std::atomic<uint64_t> _records{0}, _overflows{0}, _stalls{0};
+};
 
+/**
+ * @brief Temporary created by HLog(), streams the message into a record and submits it when destroyed.
+ * The stream is a per-thread object that writes straight into the record, so a log call neither
+ * allocates nor locks unless its message is longer than LOG_RECORD_TEXT_SIZE.
+ */
+class LogLine
+{
+public:
+	LogLine(log_subsystem subsystem, boost::log::trivial::severity_level severity);
+	~LogLine();
+
+	LogLine(LogLine const &) = delete;
+	LogLine &operator=(LogLine const &) = delete;
+
+	std::ostream &stream() { return *_stream; }
+
+private:
+	class record_streambuf;
+	struct thread_stream;
+
+	log_record _record;
+	thread_stream *_thread_stream;
+	std::unique_ptr<thread_stream> _nested_stream;  ///< Used when a message is logged while building another one.
+	std::ostream *_stream;
 };
 
-#define HLog(type) BOOST_LOG_SEV(Logger().getInstance()->get_core_log(), boost::log::trivial::type)
+#define HLogSys(subsystem, type) \
+	if ((int) boost::log::trivial::type < HORIZON_LOG_MIN_LEVEL \
+		|| !Logger::getInstance()->is_enabled(subsystem, boost::log::trivial::type)) \
+		; \
+	else \
+		LogLine(subsystem, boost::log::trivial::type).stream()
+
+#define HLog(type) HLogSys(LOG_CORE, type)
 
 #endif //HORIZON_LOGGER_H
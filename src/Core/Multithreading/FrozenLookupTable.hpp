@@ -0,0 +1,299 @@
+/***************************************************
+ *       _   _            _                        *
+ *      | | | |          (_)                       *
+ *      | |_| | ___  _ __ _ _______  _ __          *
+ *      |  _  |/ _ \| '__| |_  / _ \| '_  \        *
+ *      | | | | (_) | |  | |/ / (_) | | | |        *
+ *      \_| |_/\___/|_|  |_/___\___/|_| |_|        *
+ ***************************************************
+ * This file is part of Horizon (c).
+ *
+ * Copyright (c) 2019 Sagun K. (sagunxp@gmail.com).
+ * Copyright (c) 2019 Horizon Dev Team.
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ **************************************************/
+
+#ifndef HORIZON_CORE_MULTITHREADING_FROZENLOOKUPTABLE_HPP
+#define HORIZON_CORE_MULTITHREADING_FROZENLOOKUPTABLE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Lookup table for data that is written once at load time and read everywhere afterwards.
+ * Loaders fill a staging map and call freeze(), which compacts it into an immutable snapshot.
+ * Integral keys that are dense enough get an index array (key - base). All other keys get an
+ * open addressing hash table with a load factor of at most one half.
+ * Lookups never lock or touch a reference count. They load the published snapshot pointer and
+ * return a raw pointer into it. Freezing again (hot reload) builds a new snapshot and swaps it in.
+ * Replaced snapshots are retired but kept until the table is destroyed, so pointers handed out
+ * earlier stay valid for the lifetime of the table.
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class FrozenLookupTable
+{
+	static constexpr bool is_index_key = std::is_integral<Key>::value || std::is_enum<Key>::value;
+
+	//! @brief Keys spanning at most this many slots per entry (plus the slack) are indexed directly.
+	static constexpr int64_t DENSE_SLOTS_PER_ENTRY = 4;
+	static constexpr int64_t DENSE_SLACK = 64;
+
+	struct snapshot
+	{
+		std::vector<Key> keys;
+		std::vector<Value> values;
+		//! @brief Position of the value for a key index or hash slot, -1 if empty.
+		std::vector<int32_t> slots;
+		bool dense{false};
+		int64_t base{0};
+		uint32_t shift{63};
+		std::size_t max_probe{0};
+	};
+
+public:
+	typedef Key key_type;
+	typedef Value mapped_type;
+	typedef Hash hash_type;
+
+	FrozenLookupTable(const Hash &hasher = Hash())
+	: _hasher(hasher)
+	{
+		freeze();
+	}
+
+	FrozenLookupTable(const FrozenLookupTable &other) = delete;
+	FrozenLookupTable &operator=(const FrozenLookupTable &other) = delete;
+
+	/**
+	 * @brief Returns the frozen value of the key, or nullptr if it has none.
+	 * The pointer stays valid for the lifetime of the table, even across hot reloads.
+	 * @thread any
+	 */
+	Value const *find(Key const &key) const
+	{
+		snapshot const *s = _snapshot.load(std::memory_order_acquire);
+
+		if (s->dense)
+			return find_dense(*s, key);
+
+		for (std::size_t i = slot_of(*s, key);; i = (i + 1) & (s->slots.size() - 1)) {
+			int32_t const index = s->slots[i];
+
+			if (index < 0)
+				return nullptr;
+
+			if (s->keys[index] == key)
+				return &s->values[index];
+		}
+	}
+
+	/**
+	 * @brief Returns a copy of the frozen value of the key, or default_value if it has none.
+	 * @thread any
+	 */
+	Value at(Key const &key, Value const &default_value = Value()) const
+	{
+		Value const *value = find(key);
+		return value != nullptr ? *value : default_value;
+	}
+
+	/**
+	 * @brief Amount of entries in the frozen snapshot.
+	 * @thread any
+	 */
+	std::size_t size() const { return _snapshot.load(std::memory_order_acquire)->values.size(); }
+
+	/**
+	 * @brief Longest probe sequence of the frozen hash table, 0 for index arrays.
+	 * @thread any
+	 */
+	std::size_t max_probe() const { return _snapshot.load(std::memory_order_acquire)->max_probe; }
+
+	/**
+	 * @brief Calls fn(key, value) for every entry of the frozen snapshot, in no particular order.
+	 * @thread any
+	 */
+	template <typename Fn>
+	void for_each(Fn &&fn) const
+	{
+		snapshot const *s = _snapshot.load(std::memory_order_acquire);
+
+		for (std::size_t i = 0; i < s->values.size(); ++i)
+			fn(s->keys[i], s->values[i]);
+	}
+
+	/**
+	 * @brief Adds or replaces a staged entry, it becomes visible to lookups with the next freeze().
+	 * @thread loader
+	 */
+	void insert(Key const &key, Value const &value)
+	{
+		std::lock_guard<std::mutex> lock(_staging_mtx);
+		_staging[key] = value;
+	}
+
+	/**
+	 * @thread loader
+	 */
+	void erase(Key const &key)
+	{
+		std::lock_guard<std::mutex> lock(_staging_mtx);
+		_staging.erase(key);
+	}
+
+	/**
+	 * @brief Drops all staged entries, used before reloading a table from scratch.
+	 * @thread loader
+	 */
+	void clear()
+	{
+		std::lock_guard<std::mutex> lock(_staging_mtx);
+		_staging.clear();
+	}
+
+	/**
+	 * @brief Returns a copy of a staged entry, for loaders that refer to entries they read earlier.
+	 * @thread loader
+	 */
+	Value staged(Key const &key, Value const &default_value = Value()) const
+	{
+		std::lock_guard<std::mutex> lock(_staging_mtx);
+		auto it = _staging.find(key);
+		return it != _staging.end() ? it->second : default_value;
+	}
+
+	/**
+	 * @thread loader
+	 */
+	std::size_t staged_size() const
+	{
+		std::lock_guard<std::mutex> lock(_staging_mtx);
+		return _staging.size();
+	}
+
+	/**
+	 * @brief Compacts the staged entries into a new snapshot and publishes it.
+	 * Readers move to the new snapshot on their next lookup, the previous one is retired.
+	 * @thread loader
+	 */
+	void freeze()
+	{
+		std::lock_guard<std::mutex> lock(_staging_mtx);
+		std::unique_ptr<snapshot> next(new snapshot());
+
+		build(*next);
+
+		_snapshot.store(next.get(), std::memory_order_release);
+		_snapshots.push_back(std::move(next));
+	}
+
+private:
+	void build(snapshot &s) const
+	{
+		std::vector<std::pair<Key, Value>> entries(_staging.begin(), _staging.end());
+
+		build_index(s, entries);
+
+		if (s.dense)
+			return;
+
+		// Fibonacci hashing spreads clustered hashes (e.g. identity hashed ids) over the slots.
+		std::size_t capacity = 2;
+		s.shift = 63;
+
+		while (capacity < entries.size() * 2) {
+			capacity <<= 1;
+			--s.shift;
+		}
+
+		s.slots.assign(capacity, -1);
+		s.keys.reserve(entries.size());
+		s.values.reserve(entries.size());
+
+		for (auto &entry : entries) {
+			std::size_t probe = 0, i = slot_of(s, entry.first);
+
+			for (; s.slots[i] >= 0; i = (i + 1) & (capacity - 1))
+				++probe;
+
+			s.slots[i] = (int32_t) s.values.size();
+			s.keys.push_back(entry.first);
+			s.values.push_back(entry.second);
+			s.max_probe = std::max(s.max_probe, probe);
+		}
+	}
+
+	void build_index(snapshot &s, std::vector<std::pair<Key, Value>> &entries) const
+	{
+		if constexpr (is_index_key) {
+			if (entries.empty())
+				return;
+
+			// Keep values in key order, neighbouring ids end up next to each other in memory.
+			std::sort(entries.begin(), entries.end(),
+				[] (std::pair<Key, Value> const &a, std::pair<Key, Value> const &b) { return a.first < b.first; });
+
+			int64_t const first = (int64_t) entries.front().first, last = (int64_t) entries.back().first;
+
+			if (last - first + 1 > (int64_t) entries.size() * DENSE_SLOTS_PER_ENTRY + DENSE_SLACK)
+				return;
+
+			s.dense = true;
+			s.base = first;
+			s.slots.assign(last - first + 1, -1);
+			s.keys.reserve(entries.size());
+			s.values.reserve(entries.size());
+
+			for (auto &entry : entries) {
+				s.slots[(int64_t) entry.first - first] = (int32_t) s.values.size();
+				s.keys.push_back(entry.first);
+				s.values.push_back(entry.second);
+			}
+		}
+	}
+
+	static Value const *find_dense(snapshot const &s, Key const &key)
+	{
+		if constexpr (is_index_key) {
+			uint64_t const offset = (uint64_t) ((int64_t) key - s.base);
+
+			if (offset >= s.slots.size() || s.slots[offset] < 0)
+				return nullptr;
+
+			return &s.values[s.slots[offset]];
+		}
+
+		return nullptr;
+	}
+
+	std::size_t slot_of(snapshot const &s, Key const &key) const
+	{
+		return (std::size_t) (((uint64_t) _hasher(key) * UINT64_C(11400714819323198485)) >> s.shift);
+	}
+
+	Hash _hasher;
+	std::unordered_map<Key, Value, Hash> _staging;
+	mutable std::mutex _staging_mtx;
+	std::atomic<snapshot const *> _snapshot{nullptr};
+	std::vector<std::unique_ptr<snapshot>> _snapshots;
+};
+
+#endif /* HORIZON_CORE_MULTITHREADING_FROZENLOOKUPTABLE_HPP */
@@ -0,0 +1,110 @@
+/***************************************************
+ *       _   _            _                        *
+ *      | | | |          (_)                       *
+ *      | |_| | ___  _ __ _ _______  _ __          *
+ *      |  _  |/ _ \| '__| |_  / _ \| '_  \        *
+ *      | | | | (_) | |  | |/ / (_) | | | |        *
+ *      \_| |_/\___/|_|  |_/___\___/|_| |_|        *
+ ***************************************************
+ * This file is part of Horizon (c).
+ *
+ * Copyright (c) 2019 Sagun K. (sagunxp@gmail.com).
+ * Copyright (c) 2019 Horizon Dev Team.
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ **************************************************/
+
+#ifndef HORIZON_CORE_MULTITHREADING_RCUSNAPSHOT_HPP
+#define HORIZON_CORE_MULTITHREADING_RCUSNAPSHOT_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+/**
+ * @brief Read-mostly value published as immutable snapshots (read-copy-update).
+ * Writers copy the current snapshot, modify the copy and swap it in under a writer lock.
+ * Readers never take a lock. Each thread caches the last snapshot it read with its version.
+ * A read only compares that version with the published one and copies a shared_ptr.
+ * The shared snapshot is fetched again only after a writer has swapped in a new one.
+ * A snapshot is freed once neither the publisher nor any thread cache or reader holds it.
+ */
+template <typename T>
+class RCUSnapshot
+{
+	struct thread_cache
+	{
+		uint64_t version{0};
+		std::shared_ptr<T const> snapshot;
+	};
+
+public:
+	RCUSnapshot()
+	: _current(std::make_shared<T const>()), _version(next_version())
+	{
+	}
+
+	RCUSnapshot(const RCUSnapshot &other) = delete;
+	RCUSnapshot &operator=(const RCUSnapshot &other) = delete;
+
+	/**
+	 * @brief Returns the current snapshot. It stays valid and unchanged for as long as it is held.
+	 * @thread any
+	 */
+	std::shared_ptr<T const> read() const
+	{
+		// Versions are unique across all snapshots of T, so the cache of one instance is never taken for another's.
+		thread_local thread_cache cache;
+		uint64_t const version = _version.load(std::memory_order_acquire);
+
+		if (cache.version != version) {
+			cache.snapshot = std::atomic_load_explicit(&_current, std::memory_order_acquire);
+			cache.version = version;
+		}
+
+		return cache.snapshot;
+	}
+
+	/**
+	 * @brief Publishes a copy of the current snapshot modified by mutate(T &).
+	 * Writers are serialized, readers keep seeing the previous snapshot until the swap.
+	 * @thread any
+	 */
+	template <typename Mutator>
+	void update(Mutator &&mutate)
+	{
+		std::lock_guard<std::mutex> lock(_writer_mtx);
+		std::shared_ptr<T> next = std::make_shared<T>(*std::atomic_load_explicit(&_current, std::memory_order_acquire));
+
+		mutate(*next);
+
+		std::atomic_store_explicit(&_current, std::shared_ptr<T const>(std::move(next)), std::memory_order_release);
+		_version.store(next_version(), std::memory_order_release);
+	}
+
+private:
+	static uint64_t next_version()
+	{
+		static std::atomic<uint64_t> versions{0};
+		return ++versions;
+	}
+
+	std::shared_ptr<T const> _current;
+	std::atomic<uint64_t> _version;
+	std::mutex _writer_mtx;
+};
+
+#endif /* HORIZON_CORE_MULTITHREADING_RCUSNAPSHOT_HPP */
@@ -0,0 +1,196 @@
+/***************************************************
+ *       _   _            _                        *
+ *      | | | |          (_)                       *
+ *      | |_| | ___  _ __ _ _______  _ __          *
+ *      |  _  |/ _ \| '__| |_  / _ \| '_  \        *
+ *      | | | | (_) | |  | |/ / (_) | | | |        *
+ *      \_| |_/\___/|_|  |_/___\___/|_| |_|        *
+ ***************************************************
+ * This file is part of Horizon (c).
+ *
+ * Copyright (c) 2019 Sagun K. (sagunxp@gmail.com).
+ * Copyright (c) 2019 Horizon Dev Team.
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ **************************************************/
+
+#ifndef HORIZON_CORE_MULTITHREADING_SPSCQUEUE_HPP
+#define HORIZON_CORE_MULTITHREADING_SPSCQUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#ifndef CACHE_LINE_SIZE
+#define CACHE_LINE_SIZE 64
+#endif
+
+/**
+ * @brief Bounded lock-free queue for exactly one producer thread and one consumer thread.
+ * Elements are moved into pre-allocated slots of a ring, so neither side allocates or locks.
+ * The producer and consumer indices live on separate cache lines to avoid false sharing,
+ * and each side caches the other's index to only touch the shared line when it must.
+ */
+template <typename T>
+class SPSCQueue
+{
+	typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type slot_type;
+
+public:
+	/**
+	 * @param[in] capacity maximum number of queued elements, rounded up to a power of two.
+	 */
+	explicit SPSCQueue(std::size_t capacity)
+	: _capacity(round_up_to_power_of_two(capacity)), _mask(_capacity - 1), _slots(new slot_type[_capacity])
+	{
+	}
+
+	~SPSCQueue()
+	{
+		while (front() != nullptr)
+			pop();
+	}
+
+	SPSCQueue(const SPSCQueue &other) = delete;
+	SPSCQueue &operator=(const SPSCQueue &other) = delete;
+
+	/**
+	 * @brief Moves an element to the back of the queue.
+	 * @thread producer.
+	 * @return false if the queue is full, in which case value is left untouched.
+	 */
+	bool try_push(T &&value)
+	{
+		std::size_t const tail = _tail.load(std::memory_order_relaxed);
+
+		if (tail - _cached_head == _capacity) {
+			_cached_head = _head.load(std::memory_order_acquire);
+
+			if (tail - _cached_head == _capacity) {
+				_rejected_pushes.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+		}
+
+		new (&_slots[tail & _mask]) T(std::move(value));
+		_tail.store(tail + 1, std::memory_order_release);
+
+		std::size_t const depth = tail + 1 - _cached_head;
+
+		if (depth > _high_water_mark.load(std::memory_order_relaxed))
+			_high_water_mark.store(depth, std::memory_order_relaxed);
+
+		return true;
+	}
+
+	/**
+	 * @brief Retrieves the element at the front of the queue without removing or copying it.
+	 * @thread consumer.
+	 * @return pointer to the element or nullptr if the queue is empty.
+	 */
+	T *front() { return peek(0); }
+
+	/**
+	 * @brief Retrieves the element at a position from the front of the queue without removing it.
+	 * @thread consumer.
+	 * @param[in] index 0 for the front element, 1 for the one behind it and so on.
+	 * @return pointer to the element or nullptr if fewer than index + 1 elements are queued.
+	 */
+	T *peek(std::size_t index)
+	{
+		std::size_t const head = _head.load(std::memory_order_relaxed);
+
+		if (_cached_tail - head <= index) {
+			_cached_tail = _tail.load(std::memory_order_acquire);
+
+			if (_cached_tail - head <= index)
+				return nullptr;
+		}
+
+		return std::launder(reinterpret_cast<T *>(&_slots[(head + index) & _mask]));
+	}
+
+	/**
+	 * @brief Destroys the element at the front of the queue.
+	 * Must only be called after front() has returned a non-null element.
+	 * @thread consumer.
+	 */
+	void pop()
+	{
+		std::size_t const head = _head.load(std::memory_order_relaxed);
+
+		std::launder(reinterpret_cast<T *>(&_slots[head & _mask]))->~T();
+		_head.store(head + 1, std::memory_order_release);
+	}
+
+	/**
+	 * @brief Moves the element at the front of the queue into value and removes it.
+	 * @thread consumer.
+	 * @return false if the queue was empty.
+	 */
+	bool try_pop(T &value)
+	{
+		T *element = front();
+
+		if (element == nullptr)
+			return false;
+
+		value = std::move(*element);
+		pop();
+		return true;
+	}
+
+	bool empty() const { return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire); }
+
+	std::size_t size() const
+	{
+		std::size_t const head = _head.load(std::memory_order_acquire);
+		return _tail.load(std::memory_order_acquire) - head;
+	}
+
+	std::size_t capacity() const { return _capacity; }
+
+	/* Statistics */
+	std::size_t high_water_mark() const { return _high_water_mark.load(std::memory_order_relaxed); }
+	uint64_t rejected_pushes() const { return _rejected_pushes.load(std::memory_order_relaxed); }
+
+private:
+	static std::size_t round_up_to_power_of_two(std::size_t n)
+	{
+		std::size_t p = 2;
+
+		while (p < n)
+			p <<= 1;
+
+		return p;
+	}
+
+	std::size_t const _capacity;
+	std::size_t const _mask;
+	std::unique_ptr<slot_type[]> _slots;
+
+	alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> _head{0};   ///< Written by the consumer.
+	std::size_t _cached_tail{0};                                   ///< Consumer's copy of _tail.
+
+	alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> _tail{0};   ///< Written by the producer.
+	std::size_t _cached_head{0};                                   ///< Producer's copy of _head.
+	std::atomic<std::size_t> _high_water_mark{0};                  ///< Deepest the queue has been, as seen by the producer.
+	std::atomic<uint64_t> _rejected_pushes{0};                     ///< Pushes that failed because the queue was full.
+};
+
+#endif /* HORIZON_CORE_MULTITHREADING_SPSCQUEUE_HPP */
@@ -0,0 +1,192 @@
+/***************************************************
+ *       _   _            _                        *
+ *      | | | |          (_)                       *
+ *      | |_| | ___  _ __ _ _______  _ __          *
+ *      |  _  |/ _ \| '__| |_  / _ \| '_  \        *
+ *      | | | | (_) | |  | |/ / (_) | | | |        *
+ *      \_| |_/\___/|_|  |_/___\___/|_| |_|        *
+ ***************************************************
+ * This file is part of Horizon (c).
+ *
+ * Copyright (c) 2019 Sagun K. (sagunxp@gmail.com).
+ * Copyright (c) 2019 Horizon Dev Team.
+ *
+ * Base Author - Sagun K. (sagunxp@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ **************************************************/
+
+#ifndef HORIZON_CORE_MULTITHREADING_WORKSTEALINGDEQUE_HPP
+#define HORIZON_CORE_MULTITHREADING_WORKSTEALINGDEQUE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#ifndef CACHE_LINE_SIZE
+#define CACHE_LINE_SIZE 64
+#endif
+
+/**
+ * @brief Chase-Lev work-stealing deque.
+ * The owning thread pushes and pops at the bottom without locking, any other thread may steal
+ * from the top. The ring grows when full; rings that were replaced are kept until the deque is
+ * destroyed since a thief may still be reading from them.
+ * @see "Correct and Efficient Work-Stealing for Weak Memory Models", Lê et al., PPoPP 2013.
+ */
+template <typename T>
+class WorkStealingDeque
+{
+	static_assert(std::is_trivially_copyable<T>::value, "WorkStealingDeque only holds trivially copyable values (e.g. pointers).");
+
+	class ring
+	{
+	public:
+		explicit ring(int64_t capacity)
+		: _capacity(capacity), _mask(capacity - 1), _slots(new std::atomic<T>[capacity])
+		{
+		}
+
+		int64_t capacity() const { return _capacity; }
+
+		T get(int64_t index) const { return _slots[index & _mask].load(std::memory_order_relaxed); }
+		void put(int64_t index, T value) { _slots[index & _mask].store(value, std::memory_order_relaxed); }
+
+		ring *grow(int64_t bottom, int64_t top) const
+		{
+			ring *r = new ring(_capacity * 2);
+
+			for (int64_t i = top; i != bottom; i++)
+				r->put(i, get(i));
+
+			return r;
+		}
+
+	private:
+		int64_t const _capacity;
+		int64_t const _mask;
+		std::unique_ptr<std::atomic<T>[]> _slots;
+	};
+
+public:
+	/**
+	 * @param[in] capacity initial capacity, must be a power of two.
+	 */
+	explicit WorkStealingDeque(int64_t capacity = 256)
+	{
+		ring *r = new ring(capacity);
+
+		_rings.emplace_back(r);
+		_ring.store(r, std::memory_order_relaxed);
+	}
+
+	WorkStealingDeque(WorkStealingDeque const &) = delete;
+	WorkStealingDeque &operator=(WorkStealingDeque const &) = delete;
+
+	/**
+	 * @brief Pushes a value at the bottom.
+	 * @thread owner.
+	 */
+	void push(T value)
+	{
+		int64_t const b = _bottom.load(std::memory_order_relaxed);
+		int64_t const t = _top.load(std::memory_order_acquire);
+		ring *r = _ring.load(std::memory_order_relaxed);
+
+		if (b - t > r->capacity() - 1) {
+			r = r->grow(b, t);
+			_rings.emplace_back(r);
+			_ring.store(r, std::memory_order_release);
+		}
+
+		r->put(b, value);
+		std::atomic_thread_fence(std::memory_order_release);
+		_bottom.store(b + 1, std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Pops the most recently pushed value.
+	 * @thread owner.
+	 * @return false if the deque was empty or a thief took the last value.
+	 */
+	bool pop(T &value)
+	{
+		int64_t const b = _bottom.load(std::memory_order_relaxed) - 1;
+		ring *r = _ring.load(std::memory_order_relaxed);
+
+		_bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		int64_t t = _top.load(std::memory_order_relaxed);
+
+		if (t > b) {
+			_bottom.store(b + 1, std::memory_order_relaxed);
+			return false;
+		}
+
+		value = r->get(b);
+
+		if (t == b) {
+			// Last element, race against thieves for it.
+			bool const won = _top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+			_bottom.store(b + 1, std::memory_order_relaxed);
+			return won;
+		}
+
+		return true;
+	}
+
+	/**
+	 * @brief Takes the oldest value.
+	 * @thread any.
+	 * @return false if the deque was empty or another thread took the value first.
+	 */
+	bool steal(T &value)
+	{
+		int64_t t = _top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t const b = _bottom.load(std::memory_order_acquire);
+
+		if (t >= b)
+			return false;
+
+		ring *r = _ring.load(std::memory_order_acquire);
+		value = r->get(t);
+
+		return _top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Approximate number of queued values.
+	 * @thread any.
+	 */
+	int64_t size() const
+	{
+		int64_t const b = _bottom.load(std::memory_order_relaxed);
+		int64_t const t = _top.load(std::memory_order_relaxed);
+		return b > t ? b - t : 0;
+	}
+
+	bool empty() const { return size() == 0; }
+
+private:
+	alignas(CACHE_LINE_SIZE) std::atomic<int64_t> _top{0};      ///< Advanced by thieves and the owner's last pop.
+	alignas(CACHE_LINE_SIZE) std::atomic<int64_t> _bottom{0};   ///< Written by the owner only.
+	std::atomic<ring *> _ring{nullptr};
+	std::vector<std::unique_ptr<ring>> _rings;     ///< Every ring ever used, owned by the deque. @thread owner.
+};
+
+#endif /* HORIZON_CORE_MULTITHREADING_WORKSTEALINGDEQUE_HPP */
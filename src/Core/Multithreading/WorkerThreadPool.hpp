@@ -30,12 +30,20 @@
 #ifndef HORIZON_CORE_MULTITHREADING_WORKERTHREADPOOL_HPP
 #define HORIZON_CORE_MULTITHREADING_WORKERTHREADPOOL_HPP
 
-#include "ThreadSafeQueue.hpp"
+#include "WorkStealingDeque.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
 #include <thread>
 #include <vector>
 #include <future>
 #include <type_traits>
 
+// Times an idle worker looks for work, yielding in between, before it parks.
+#define WORKER_THREAD_SPIN_ROUNDS 64
+
 class FunctionWrapper
 {
 	struct impl_base
@@ -76,57 +84,384 @@ private:
 	std::unique_ptr<impl_base> impl;
 };
 
+struct worker_thread_pool_statistics
+{
+	uint64_t submitted{0};   ///< Tasks handed to the pool.
+	uint64_t executed{0};    ///< Tasks run by workers or by threads helping in parallel_for().
+	uint64_t steals{0};      ///< Tasks taken from another worker's deque.
+	uint64_t parks{0};       ///< Times a worker went to sleep for lack of work.
+	uint64_t queue_depth{0}; ///< Tasks waiting to be run.
+};
+
+/**
+ * @brief Work-stealing thread pool for background jobs.
+ * Each worker owns a Chase-Lev deque. Tasks submitted from a worker go to its own deque, tasks
+ * submitted from any other thread are spread over the workers' inboxes. A worker runs its own
+ * tasks newest first, then its inbox, then steals the oldest tasks of the others and parks on a
+ * condition variable once it has found nothing for WORKER_THREAD_SPIN_ROUNDS attempts.
+ * Tasks still queued when the pool is destroyed are run before its threads exit.
+ */
 class WorkerThreadPool
 {
+	struct alignas(CACHE_LINE_SIZE) worker
+	{
+		WorkStealingDeque<FunctionWrapper *> tasks;
+		std::mutex inbox_mtx;
+		std::vector<FunctionWrapper *> inbox;            ///< Tasks submitted from outside the pool.
+		std::atomic<bool> has_inbox{false};
+		std::atomic<uint64_t> executed{0}, steals{0}, parks{0};
+	};
+
+	struct thread_context
+	{
+		WorkerThreadPool *pool{nullptr};
+		unsigned index{0};
+	};
+
+	static thread_context &current()
+	{
+		static thread_local thread_context context;
+		return context;
+	}
+
 public:
 	WorkerThreadPool(unsigned const thread_count = std::thread::hardware_concurrency())
 	:  _done(false)
 	{
+		unsigned const count = std::max(thread_count, 1u);
+
+		for (unsigned i = 0; i < count; ++i)
+			_workers.push_back(std::make_unique<worker>());
+
 		try {
-			for (unsigned i = 0; i < thread_count; ++i)
-				_threads.push_back(std::thread(&WorkerThreadPool::worker_thread, this));
+			for (unsigned i = 0; i < count; ++i)
+				_threads.push_back(std::thread(&WorkerThreadPool::worker_thread, this, i));
 		} catch (...) {
-			_done = true;
+			shutdown();
 			throw;
 		}
 	}
 
 	~WorkerThreadPool()
 	{
-		_done = true;
+		shutdown();
 
-		for (unsigned long i = 0; i < _threads.size(); i++)
-			if (_threads.at(i).joinable())
-				_threads.at(i).join();
+		for (auto &w : _workers) {
+			FunctionWrapper *task = nullptr;
+
+			while (w->tasks.pop(task))
+				delete task;
+
+			for (FunctionWrapper *t : w->inbox)
+				delete t;
+		}
 	}
 
 	template<typename FunctionType>
-	std::future<typename std::invoke_result<FunctionType()>::type>
+	std::future<typename std::invoke_result<FunctionType>::type>
 	submit(FunctionType f)
 	{
-		typedef typename std::invoke_result<FunctionType()>::type result_type;
+		typedef typename std::invoke_result<FunctionType>::type result_type;
 
 		std::packaged_task<result_type()> task(std::move(f));
 		std::future<result_type> res(task.get_future());
-		_work_queue.push(std::move(task));
+		enqueue(new FunctionWrapper(std::move(task)));
 		return res;
 	}
 
+	/**
+	 * @brief Calls f(i) for every i in [begin, end), split in chunks of grain indices.
+	 * The calling thread works on chunks too and returns once every index has been processed.
+	 * If f throws, the remaining chunks are skipped and the first exception is rethrown here.
+	 * @param[in] grain indices per chunk, 0 to split the range into about four chunks per worker.
+	 */
+	template<typename IndexType, typename FunctionType>
+	void parallel_for(IndexType begin, IndexType end, FunctionType const &f, IndexType grain = 0)
+	{
+		static_assert(std::is_integral<IndexType>::value, "parallel_for requires an integral index type.");
+
+		if (begin >= end)
+			return;
+
+		struct range_state
+		{
+			std::atomic<IndexType> next;
+			IndexType end;
+			IndexType grain;
+			std::atomic<unsigned> running{0};
+			std::atomic<bool> failed{false};
+			std::exception_ptr error;
+			std::mutex mtx;
+			std::condition_variable cv;
+		};
+
+		if (grain <= 0)
+			grain = std::max<IndexType>((end - begin) / (IndexType) (_workers.size() * 4), 1);
+
+		std::shared_ptr<range_state> state = std::make_shared<range_state>();
+		state->next.store(begin);
+		state->end = end;
+		state->grain = grain;
+
+		auto work = [state, &f] () {
+			IndexType first;
+
+			while (!state->failed.load(std::memory_order_relaxed)
+				&& (first = state->next.fetch_add(state->grain, std::memory_order_relaxed)) < state->end) {
+				IndexType const last = std::min<IndexType>(first + state->grain, state->end);
+
+				try {
+					for (IndexType i = first; i < last; i++)
+						f(i);
+				} catch (...) {
+					std::lock_guard<std::mutex> lock(state->mtx);
+
+					if (!state->error)
+						state->error = std::current_exception();
+
+					state->failed.store(true);
+				}
+			}
+		};
+
+		std::size_t const chunks = (std::size_t) ((end - begin + grain - 1) / grain);
+		unsigned const helpers = (unsigned) std::min<std::size_t>(_workers.size(), chunks - 1);
+
+		state->running.store(helpers);
+
+		for (unsigned i = 0; i < helpers; i++) {
+			enqueue(new FunctionWrapper([state, work] () {
+				work();
+
+				if (state->running.fetch_sub(1) == 1) {
+					std::lock_guard<std::mutex> lock(state->mtx);
+					state->cv.notify_all();
+				}
+			}));
+		}
+
+		work();
+
+		if (current().pool == this) {
+			// A worker must not block here, it helps with whatever is queued instead.
+			while (state->running.load() > 0) {
+				if (!run_pending_task())
+					std::this_thread::yield();
+			}
+		} else {
+			std::unique_lock<std::mutex> lock(state->mtx);
+			state->cv.wait(lock, [&state] () { return state->running.load() == 0; });
+		}
+
+		if (state->error)
+			std::rethrow_exception(state->error);
+	}
+
+	unsigned size() const { return (unsigned) _workers.size(); }
+
+	worker_thread_pool_statistics get_statistics() const
+	{
+		worker_thread_pool_statistics stats;
+
+		stats.submitted = _submitted.load(std::memory_order_relaxed);
+
+		for (auto &w : _workers) {
+			stats.executed += w->executed.load(std::memory_order_relaxed);
+			stats.steals += w->steals.load(std::memory_order_relaxed);
+			stats.parks += w->parks.load(std::memory_order_relaxed);
+		}
+
+		stats.executed += _executed_by_others.load(std::memory_order_relaxed);
+		stats.queue_depth = (uint64_t) std::max<int64_t>(_queued.load(std::memory_order_relaxed), 0);
+
+		return stats;
+	}
+
 private:
-	void worker_thread()
+	void shutdown()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_park_mtx);
+			_done = true;
+		}
+
+		_park_cv.notify_all();
+
+		for (unsigned long i = 0; i < _threads.size(); i++)
+			if (_threads.at(i).joinable())
+				_threads.at(i).join();
+	}
+
+	void enqueue(FunctionWrapper *task)
+	{
+		thread_context &context = current();
+
+		_submitted.fetch_add(1, std::memory_order_relaxed);
+
+		if (context.pool == this) {
+			_workers[context.index]->tasks.push(task);
+		} else {
+			worker &w = *_workers[_next_inbox.fetch_add(1, std::memory_order_relaxed) % _workers.size()];
+			std::lock_guard<std::mutex> lock(w.inbox_mtx);
+			w.inbox.push_back(task);
+			w.has_inbox.store(true, std::memory_order_release);
+		}
+
+		// Paired with park(): either the parking worker sees the task or we see the worker.
+		_queued.fetch_add(1);
+
+		if (_sleeping.load() > 0) {
+			std::lock_guard<std::mutex> lock(_park_mtx);
+			_park_cv.notify_one();
+		}
+	}
+
+	/**
+	 * @brief Moves the tasks of a worker's inbox onto the deque of the calling worker.
+	 * @thread Worker index.
+	 */
+	FunctionWrapper *take_inbox(worker &from, unsigned index, bool wait)
+	{
+		if (!from.has_inbox.load(std::memory_order_acquire))
+			return nullptr;
+
+		std::vector<FunctionWrapper *> tasks;
+
+		{
+			std::unique_lock<std::mutex> lock(from.inbox_mtx, std::defer_lock);
+
+			if (wait)
+				lock.lock();
+			else if (!lock.try_lock())
+				return nullptr;
+
+			tasks.swap(from.inbox);
+			from.has_inbox.store(false, std::memory_order_relaxed);
+		}
+
+		if (tasks.empty())
+			return nullptr;
+
+		for (std::size_t i = 1; i < tasks.size(); i++)
+			_workers[index]->tasks.push(tasks[i]);
+
+		return tasks.front();
+	}
+
+	/**
+	 * @thread Worker index.
+	 */
+	FunctionWrapper *find_task(unsigned index)
+	{
+		worker &w = *_workers[index];
+		FunctionWrapper *task = nullptr;
+
+		if (w.tasks.pop(task))
+			return task;
+
+		if ((task = take_inbox(w, index, true)))
+			return task;
+
+		std::size_t const count = _workers.size();
+
+		for (std::size_t i = 1; i < count; i++) {
+			worker &victim = *_workers[(index + i) % count];
+
+			if (victim.tasks.steal(task)) {
+				w.steals.fetch_add(1, std::memory_order_relaxed);
+				return task;
+			}
+
+			if ((task = take_inbox(victim, index, false)))
+				return task;
+		}
+
+		return nullptr;
+	}
+
+	/**
+	 * @brief Runs one queued task on the calling worker.
+	 * @thread Worker of this pool.
+	 * @return false if no task was found.
+	 */
+	bool run_pending_task()
+	{
+		thread_context &context = current();
+		FunctionWrapper *task = find_task(context.index);
+
+		if (task == nullptr)
+			return false;
+
+		_queued.fetch_sub(1);
+		run(task);
+		_executed_by_others.fetch_add(1, std::memory_order_relaxed);
+
+		return true;
+	}
+
+	void run(FunctionWrapper *task)
+	{
+		std::unique_ptr<FunctionWrapper> owned(task);
+		owned->call();
+	}
+
+	void park(worker &w)
 	{
-		while (!_done) {
-			std::shared_ptr<FunctionWrapper> task;
-			if ((task = _work_queue.try_pop()))
-				task->call();
-			else
+		std::unique_lock<std::mutex> lock(_park_mtx);
+
+		_sleeping.fetch_add(1);
+
+		if (_queued.load() <= 0 && !_done) {
+			w.parks.fetch_add(1, std::memory_order_relaxed);
+			_park_cv.wait(lock, [this] () { return _queued.load() > 0 || _done; });
+		}
+
+		_sleeping.fetch_sub(1);
+	}
+
+	void worker_thread(unsigned index)
+	{
+		worker &w = *_workers[index];
+		int idle_rounds = 0;
+
+		current().pool = this;
+		current().index = index;
+
+		while (true) {
+			FunctionWrapper *task = find_task(index);
+
+			if (task != nullptr) {
+				_queued.fetch_sub(1);
+				run(task);
+				w.executed.fetch_add(1, std::memory_order_relaxed);
+				idle_rounds = 0;
+				continue;
+			}
+
+			if (_done && _queued.load() <= 0)
+				break;
+
+			if (++idle_rounds < WORKER_THREAD_SPIN_ROUNDS) {
 				std::this_thread::yield();
+				continue;
+			}
+
+			idle_rounds = 0;
+			park(w);
 		}
+
+		current().pool = nullptr;
 	}
 
+	std::vector<std::unique_ptr<worker>> _workers;
 	std::vector<std::thread> _threads;
 	std::atomic_bool _done;
-	ThreadSafeQueue<FunctionWrapper> _work_queue;
+	std::atomic<int64_t> _queued{0};                    ///< Tasks pushed and not yet taken, may briefly go negative.
+	std::atomic<unsigned> _next_inbox{0};
+	std::atomic<uint64_t> _submitted{0}, _executed_by_others{0};
+	std::mutex _park_mtx;
+	std::condition_variable _park_cv;
+	std::atomic<int> _sleeping{0};
 };
 
 #endif /* HORIZON_CORE_MULTITHREADING_WORKERTHREADPOOL_HPP */
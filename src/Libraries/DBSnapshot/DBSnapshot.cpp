@@ -0,0 +1,301 @@
+/***************************************************
+ *       _   _            _                        *
+ *      | | | |          (_)                       *
+ *      | |_| | ___  _ __ _ _______  _ __          *
+ *      |  _  |/ _ \| '__| |_  / _ \| '_  \        *
+ *      | | | | (_) | |  | |/ / (_) | | | |        *
+ *      \_| |_/\___/|_|  |_/___\___/|_| |_|        *
+ ***************************************************
+ * This file is part of Horizon (c).
+ *
+ * Copyright (c) 2019 Sagun K. (sagunxp@gmail.com).
+ * Copyright (c) 2019 Horizon Dev Team.
+ *
+ * Base Author - Sagun K. (sagunxp@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ **************************************************/
+
+#include "DBSnapshot.hpp"
+
+#include <boost/crc.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <fstream>
+
+using namespace Horizon::Libraries;
+
+bool Horizon::Libraries::DBSnapshotFileChecksum(boost::filesystem::path const &path, uint64_t &size, uint32_t &checksum)
+{
+	std::ifstream ifs(path.string(), std::ios::in | std::ios::binary);
+	boost::crc_32_type crc_32;
+	char buf[8192];
+
+	if (!ifs.good())
+		return false;
+
+	size = 0;
+
+	while (ifs.read(buf, sizeof(buf)) || ifs.gcount() > 0) {
+		crc_32.process_bytes(buf, ifs.gcount());
+		size += ifs.gcount();
+	}
+
+	if (ifs.bad())
+		return false;
+
+	checksum = crc_32.checksum();
+	return true;
+}
+
+bool DBSnapshotWriter::AddSource(boost::filesystem::path const &path)
+{
+	dbsnapshot_source source;
+	boost::system::error_code ec;
+	std::string p = path.string();
+
+	if (p.size() >= DBSNAPSHOT_MAX_PATH_LENGTH)
+		return false;
+
+	std::strncpy(source.path, p.c_str(), DBSNAPSHOT_MAX_PATH_LENGTH - 1);
+
+	source.mtime = boost::filesystem::last_write_time(path, ec);
+
+	if (ec || !DBSnapshotFileChecksum(path, source.size, source.checksum))
+		return false;
+
+	_sources.push_back(source);
+	return true;
+}
+
+dbsnapshot_error_type DBSnapshotWriter::Write(boost::filesystem::path const &path) const
+{
+	dbsnapshot_header header;
+	std::vector<dbsnapshot_section> sections(_sections.size());
+	uint64_t offset = sizeof(dbsnapshot_header)
+		+ _sources.size() * sizeof(dbsnapshot_source)
+		+ _sections.size() * sizeof(dbsnapshot_section);
+
+	for (std::size_t i = 0; i < _sections.size(); ++i) {
+		if (_sections[i].name.size() >= DBSNAPSHOT_MAX_SECTION_NAME_LENGTH)
+			return DBSNAPSHOT_INVALID_FORMAT;
+
+		offset = (offset + DBSNAPSHOT_SECTION_ALIGNMENT - 1) & ~uint64_t(DBSNAPSHOT_SECTION_ALIGNMENT - 1);
+
+		std::strncpy(sections[i].name, _sections[i].name.c_str(), DBSNAPSHOT_MAX_SECTION_NAME_LENGTH - 1);
+		sections[i].layout = _sections[i].layout;
+		sections[i].record_size = _sections[i].record_size;
+		sections[i].record_count = _sections[i].record_count;
+		sections[i].offset = offset;
+		sections[i].length = _sections[i].data.size();
+
+		offset += sections[i].length;
+	}
+
+	// Everything after the header is assembled first so that it can be checksummed.
+	std::vector<uint8_t> body(offset - sizeof(dbsnapshot_header), 0);
+	uint8_t *out = body.data();
+
+	if (!_sources.empty())
+		std::memcpy(out, _sources.data(), _sources.size() * sizeof(dbsnapshot_source));
+	out += _sources.size() * sizeof(dbsnapshot_source);
+
+	if (!sections.empty())
+		std::memcpy(out, sections.data(), sections.size() * sizeof(dbsnapshot_section));
+
+	for (std::size_t i = 0; i < _sections.size(); ++i) {
+		if (!_sections[i].data.empty())
+			std::memcpy(body.data() + sections[i].offset - sizeof(dbsnapshot_header), _sections[i].data.data(), _sections[i].data.size());
+	}
+
+	boost::crc_32_type crc_32;
+	crc_32.process_bytes(body.data(), body.size());
+
+	std::memcpy(header.magic, DBSNAPSHOT_MAGIC, sizeof(header.magic));
+	header.version = DBSNAPSHOT_VERSION;
+	header.byte_order = DBSNAPSHOT_BYTE_ORDER;
+	header.file_size = offset;
+	header.checksum = crc_32.checksum();
+	header.source_count = _sources.size();
+	header.section_count = _sections.size();
+
+	boost::filesystem::path tmp_path = path;
+	tmp_path += ".tmp";
+
+	{
+		std::ofstream ofs(tmp_path.string(), std::ios::out | std::ios::binary | std::ios::trunc);
+
+		if (!ofs.good())
+			return DBSNAPSHOT_WRITE_ERROR;
+
+		ofs.write((const char *) &header, sizeof(dbsnapshot_header));
+		ofs.write((const char *) body.data(), body.size());
+
+		if (!ofs.good())
+			return DBSNAPSHOT_WRITE_ERROR;
+	}
+
+	boost::system::error_code ec;
+	boost::filesystem::rename(tmp_path, path, ec);
+
+	if (ec) {
+		boost::filesystem::remove(tmp_path, ec);
+		return DBSNAPSHOT_WRITE_ERROR;
+	}
+
+	return DBSNAPSHOT_OK;
+}
+
+DBSnapshot::DBSnapshot()
+{
+}
+
+DBSnapshot::~DBSnapshot()
+{
+}
+
+dbsnapshot_error_type DBSnapshot::Open(boost::filesystem::path const &path)
+{
+	using namespace boost::interprocess;
+
+	std::shared_ptr<mapped_region> region;
+	boost::system::error_code ec;
+
+	_region.reset();
+	_base = nullptr;
+	_header = nullptr;
+	_sources = nullptr;
+	_sections = nullptr;
+
+	if (!boost::filesystem::exists(path, ec))
+		return DBSNAPSHOT_NONEXISTENT_FILE;
+
+	try {
+		file_mapping file(path.string().c_str(), read_only);
+		region = std::make_shared<mapped_region>(file, read_only);
+	} catch (std::exception const &) {
+		return DBSNAPSHOT_READ_ERROR;
+	}
+
+	uint8_t const *base = static_cast<uint8_t const *>(region->get_address());
+	uint64_t size = region->get_size();
+
+	if (size < sizeof(dbsnapshot_header))
+		return DBSNAPSHOT_INVALID_FORMAT;
+
+	dbsnapshot_header const *header = reinterpret_cast<dbsnapshot_header const *>(base);
+
+	if (std::memcmp(header->magic, DBSNAPSHOT_MAGIC, sizeof(header->magic)) != 0 || header->file_size != size)
+		return DBSNAPSHOT_INVALID_FORMAT;
+
+	if (header->version != DBSNAPSHOT_VERSION || header->byte_order != DBSNAPSHOT_BYTE_ORDER)
+		return DBSNAPSHOT_INVALID_VERSION;
+
+	uint64_t tables_end = sizeof(dbsnapshot_header)
+		+ uint64_t(header->source_count) * sizeof(dbsnapshot_source)
+		+ uint64_t(header->section_count) * sizeof(dbsnapshot_section);
+
+	if (tables_end > size)
+		return DBSNAPSHOT_INVALID_FORMAT;
+
+	boost::crc_32_type crc_32;
+	crc_32.process_bytes(base + sizeof(dbsnapshot_header), size - sizeof(dbsnapshot_header));
+
+	if (crc_32.checksum() != header->checksum)
+		return DBSNAPSHOT_INVALID_CHECKSUM;
+
+	dbsnapshot_source const *sources = reinterpret_cast<dbsnapshot_source const *>(base + sizeof(dbsnapshot_header));
+	dbsnapshot_section const *sections = reinterpret_cast<dbsnapshot_section const *>(sources + header->source_count);
+
+	for (uint32_t i = 0; i < header->section_count; ++i) {
+		dbsnapshot_section const &s = sections[i];
+
+		if (s.offset < tables_end || s.offset % DBSNAPSHOT_SECTION_ALIGNMENT != 0
+			|| s.length > size - s.offset || s.length != uint64_t(s.record_size) * s.record_count
+			|| s.name[DBSNAPSHOT_MAX_SECTION_NAME_LENGTH - 1] != '\0')
+			return DBSNAPSHOT_INVALID_FORMAT;
+	}
+
+	for (uint32_t i = 0; i < header->source_count; ++i) {
+		if (sources[i].path[DBSNAPSHOT_MAX_PATH_LENGTH - 1] != '\0')
+			return DBSNAPSHOT_INVALID_FORMAT;
+	}
+
+	_region = region;
+	_base = base;
+	_header = header;
+	_sources = sources;
+	_sections = sections;
+
+	return DBSNAPSHOT_OK;
+}
+
+dbsnapshot_error_type DBSnapshot::CheckSources(std::string *stale_source) const
+{
+	if (!IsOpen())
+		return DBSNAPSHOT_READ_ERROR;
+
+	for (uint32_t i = 0; i < _header->source_count; ++i) {
+		dbsnapshot_source const &source = _sources[i];
+		boost::filesystem::path path(source.path);
+		boost::system::error_code ec;
+		uint64_t size = boost::filesystem::file_size(path, ec);
+		bool current = !ec && size == source.size;
+
+		if (current && boost::filesystem::last_write_time(path, ec) != source.mtime) {
+			uint32_t checksum = 0;
+			current = DBSnapshotFileChecksum(path, size, checksum) && size == source.size && checksum == source.checksum;
+		}
+
+		if (!current) {
+			if (stale_source != nullptr)
+				*stale_source = source.path;
+			return DBSNAPSHOT_STALE_SOURCE;
+		}
+	}
+
+	return DBSNAPSHOT_OK;
+}
+
+dbsnapshot_section const *DBSnapshot::FindSection(std::string const &name) const
+{
+	if (!IsOpen())
+		return nullptr;
+
+	for (uint32_t i = 0; i < _header->section_count; ++i) {
+		if (name.compare(_sections[i].name) == 0)
+			return &_sections[i];
+	}
+
+	return nullptr;
+}
+
+const char *DBSnapshot::ErrorString(dbsnapshot_error_type error)
+{
+	switch (error)
+	{
+	case DBSNAPSHOT_OK: return "ok";
+	case DBSNAPSHOT_NONEXISTENT_FILE: return "file does not exist";
+	case DBSNAPSHOT_READ_ERROR: return "file could not be read";
+	case DBSNAPSHOT_WRITE_ERROR: return "file could not be written";
+	case DBSNAPSHOT_INVALID_FORMAT: return "invalid or truncated snapshot";
+	case DBSNAPSHOT_INVALID_VERSION: return "snapshot was written by an incompatible version";
+	case DBSNAPSHOT_INVALID_CHECKSUM: return "invalid checksum";
+	case DBSNAPSHOT_STALE_SOURCE: return "a source file changed since the snapshot was compiled";
+	default: break;
+	}
+
+	return "unknown error";
+}
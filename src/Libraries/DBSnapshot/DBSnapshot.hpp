@@ -0,0 +1,239 @@
+/***************************************************
+ *       _   _            _                        *
+ *      | | | |          (_)                       *
+ *      | |_| | ___  _ __ _ _______  _ __          *
+ *      |  _  |/ _ \| '__| |_  / _ \| '_  \        *
+ *      | | | | (_) | |  | |/ / (_) | | | |        *
+ *      \_| |_/\___/|_|  |_/___\___/|_| |_|        *
+ ***************************************************
+ * This file is part of Horizon (c).
+ *
+ * Copyright (c) 2019 Sagun K. (sagunxp@gmail.com).
+ * Copyright (c) 2019 Horizon Dev Team.
+ *
+ * Base Author - Sagun K. (sagunxp@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ **************************************************/
+
+#ifndef HORIZON_LIBRARIES_DBSNAPSHOT_HPP
+#define HORIZON_LIBRARIES_DBSNAPSHOT_HPP
+
+#include <boost/filesystem.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace boost { namespace interprocess { class mapped_region; } }
+
+#define DBSNAPSHOT_MAGIC "HZDBSNAP"
+#define DBSNAPSHOT_VERSION 2
+//! @brief Marker written in host byte order, a snapshot from a machine of another endianness will not match.
+#define DBSNAPSHOT_BYTE_ORDER 0x01020304
+//! @brief Sections start on this boundary so that their records can be used in place from the mapping.
+#define DBSNAPSHOT_SECTION_ALIGNMENT 64
+#define DBSNAPSHOT_MAX_PATH_LENGTH 256
+#define DBSNAPSHOT_MAX_SECTION_NAME_LENGTH 32
+
+/**
+ * Snapshot file layout, all offsets are relative to the start of the file:
+ *   dbsnapshot_header
+ *   dbsnapshot_source[source_count]
+ *   dbsnapshot_section[section_count]
+ *   section data, each aligned to DBSNAPSHOT_SECTION_ALIGNMENT.
+ * The checksum covers everything after the header.
+ */
+struct dbsnapshot_header
+{
+	char magic[8]{0};
+	uint32_t version{0};
+	uint32_t byte_order{0};
+	uint64_t file_size{0};
+	uint32_t checksum{0};
+	uint32_t source_count{0};
+	uint32_t section_count{0};
+	uint32_t reserved{0};
+};
+
+//! @brief Fingerprint of a source file the snapshot was compiled from.
+struct dbsnapshot_source
+{
+	char path[DBSNAPSHOT_MAX_PATH_LENGTH]{0};
+	uint64_t size{0};
+	int64_t mtime{0};
+	uint32_t checksum{0};
+	uint32_t reserved{0};
+};
+
+struct dbsnapshot_section
+{
+	char name[DBSNAPSHOT_MAX_SECTION_NAME_LENGTH]{0};
+	uint32_t record_size{0};
+	uint32_t record_count{0};
+	uint32_t layout{0};       ///< Layout version of the record type, given by the code that wrote the section.
+	uint32_t reserved{0};
+	uint64_t offset{0};
+	uint64_t length{0};
+};
+
+enum dbsnapshot_error_type
+{
+	DBSNAPSHOT_OK                 = 0,
+	DBSNAPSHOT_NONEXISTENT_FILE   = 1,
+	DBSNAPSHOT_READ_ERROR         = 2,
+	DBSNAPSHOT_WRITE_ERROR        = 3,
+	DBSNAPSHOT_INVALID_FORMAT     = 4,
+	DBSNAPSHOT_INVALID_VERSION    = 5,
+	DBSNAPSHOT_INVALID_CHECKSUM   = 6,
+	DBSNAPSHOT_STALE_SOURCE       = 7,
+};
+
+namespace Horizon
+{
+namespace Libraries
+{
+/**
+ * @brief Builds a snapshot from fixed-size records and the fingerprints of the files they were read from.
+ * Records are written byte for byte, so only trivially copyable types can be stored.
+ */
+class DBSnapshotWriter
+{
+public:
+	/**
+	 * @brief Records the size, modification time and checksum of a source file.
+	 * @return false if the file could not be read.
+	 */
+	bool AddSource(boost::filesystem::path const &path);
+
+	/**
+	 * @param layout version of the record layout, to be changed whenever a field of T is added, removed,
+	 * reordered or retyped. Readers expecting another layout do not use the section (@see DBSnapshot::GetRecords).
+	 */
+	template <typename T>
+	void AddSection(std::string const &name, std::vector<T> const &records, uint32_t layout)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Snapshot records must be trivially copyable.");
+
+		section s;
+		s.name = name;
+		s.layout = layout;
+		s.record_size = sizeof(T);
+		s.record_count = records.size();
+		s.data.resize(records.size() * sizeof(T));
+
+		if (!records.empty())
+			std::memcpy(s.data.data(), records.data(), s.data.size());
+
+		_sections.push_back(std::move(s));
+	}
+
+	/**
+	 * @brief Writes the snapshot to a temporary file and renames it over the path,
+	 * so that a running reader never maps a partially written file.
+	 */
+	dbsnapshot_error_type Write(boost::filesystem::path const &path) const;
+
+private:
+	struct section
+	{
+		std::string name;
+		uint32_t layout{0};
+		uint32_t record_size{0};
+		uint32_t record_count{0};
+		std::vector<uint8_t> data;
+	};
+
+	std::vector<dbsnapshot_source> _sources;
+	std::vector<section> _sections;
+};
+
+/**
+ * @brief Read-only memory mapping of a snapshot.
+ * Records are used in place, nothing is parsed or copied when a snapshot is opened.
+ */
+class DBSnapshot
+{
+public:
+	DBSnapshot();
+	~DBSnapshot();
+
+	/**
+	 * @brief Maps the file and checks its header, layout and checksum.
+	 */
+	dbsnapshot_error_type Open(boost::filesystem::path const &path);
+
+	/**
+	 * @brief Compares the recorded source fingerprints with the files on disk.
+	 * A source whose modification time changed but whose content did not is still considered current.
+	 * @param[out] stale_source path of the first stale source, if any.
+	 */
+	dbsnapshot_error_type CheckSources(std::string *stale_source = nullptr) const;
+
+	bool IsOpen() const { return _region != nullptr; }
+
+	dbsnapshot_header const &getHeader() const { return *_header; }
+	dbsnapshot_source const *getSources() const { return _sources; }
+	dbsnapshot_section const *getSections() const { return _sections; }
+
+	dbsnapshot_section const *FindSection(std::string const &name) const;
+
+	/**
+	 * @brief Returns the records of a section, or nullptr if it is missing or was written for another record layout.
+	 * The layout is checked by both the layout version given when writing the section and the record size,
+	 * the latter alone would accept a record whose fields were reordered or retyped.
+	 */
+	template <typename T>
+	T const *GetRecords(std::string const &name, std::size_t &count, uint32_t layout) const
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Snapshot records must be trivially copyable.");
+
+		dbsnapshot_section const *s = FindSection(name);
+
+		count = 0;
+
+		if (s == nullptr || s->layout != layout || s->record_size != sizeof(T))
+			return nullptr;
+
+		count = s->record_count;
+		return reinterpret_cast<T const *>(_base + s->offset);
+	}
+
+	/**
+	 * @brief Shares ownership of the mapping with a record, the mapping stays alive while any record is referenced.
+	 */
+	template <typename T>
+	std::shared_ptr<const T> Share(T const *record) const { return std::shared_ptr<const T>(_region, record); }
+
+	static const char *ErrorString(dbsnapshot_error_type error);
+
+private:
+	std::shared_ptr<boost::interprocess::mapped_region> _region;
+	uint8_t const *_base{nullptr};
+	dbsnapshot_header const *_header{nullptr};
+	dbsnapshot_source const *_sources{nullptr};
+	dbsnapshot_section const *_sections{nullptr};
+};
+
+/**
+ * @brief Checksum of a file's content, as stored in the source fingerprints.
+ */
+bool DBSnapshotFileChecksum(boost::filesystem::path const &path, uint64_t &size, uint32_t &checksum);
+}
+}
+
+#endif /* HORIZON_LIBRARIES_DBSNAPSHOT_HPP */
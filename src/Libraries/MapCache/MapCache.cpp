@@ -189,6 +189,17 @@ mcache_config_error_type Horizon::Libraries::MapCache::ReadMapListConfig()
 		addToMapList(value.as<std::string>());
 	});
 
+	// Optional per-map load hints used to balance maps between map containers.
+	sol::optional<sol::table> weight_tbl = lua["map_weights"];
+
+	if (weight_tbl) {
+		weight_tbl->for_each([this](sol::object const &key, sol::object const &value) {
+			if (key.get_type() != sol::type::string || value.get_type() != sol::type::number)
+				return;
+			setMapWeight(key.as<std::string>(), value.as<uint32_t>());
+		});
+	}
+
 	return MCACHE_CONFIG_OK;
 }
 
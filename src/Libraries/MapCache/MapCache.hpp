@@ -213,6 +213,10 @@ public:
 	/* Map List */
 	void addToMapList(std::string const &map) { _map_list.push_back(map); }
 
+	/* Map Load Weight Hints (0 when none is configured) */
+	uint32_t getMapWeight(std::string const &map) const { auto it = _map_weights.find(map); return it != _map_weights.end() ? it->second : 0; }
+	void setMapWeight(std::string const &map, uint32_t weight) { _map_weights[map] = weight; }
+
 	/* GRF Path */
 	const boost::filesystem::path &getGRFPath(uint8_t id) { return _grfs[id].getGRFPath(); }
 	void setGRFPath(uint8_t id, std::string const &path) { _grfs[id].setGRFPath(path); }
@@ -238,6 +242,7 @@ private:
 	int _compression_level{6};
 	std::map<std::string, map_data> _map_cache_data;
 	std::vector<std::string> _map_list;
+	std::unordered_map<std::string, uint32_t> _map_weights;
 	std::shared_ptr<map_cache> m_cache;
 	bool _verbose{false};
 };
@@ -0,0 +1,100 @@
+/***************************************************
+ *       _   _            _                        *
+ *      | | | |          (_)                       *
+ *      | |_| | ___  _ __ _ _______  _ __          *
+ *      |  _  |/ _ \| '__| |_  / _ \| '_  \        *
+ *      | | | | (_) | |  | |/ / (_) | | | |        *
+ *      \_| |_/\___/|_|  |_/___\___/|_| |_|        *
+ ***************************************************
+ * This file is part of Horizon (c).
+ *
+ * Copyright (c) 2019 Sagun K. (sagunxp@gmail.com).
+ * Copyright (c) 2019 Horizon Dev Team.
+ *
+ * Base Author - Sagun K. (sagunxp@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ **************************************************/
+
+#ifndef HORIZON_NETWORKING_BROADCASTBUFFER_HPP
+#define HORIZON_NETWORKING_BROADCASTBUFFER_HPP
+
+#include "ByteBuffer.hpp"
+
+#include <cstring>
+#include <memory>
+
+/**
+ * @brief Immutable copy of a serialized packet that is sent to many sessions.
+ * The packet is copied once into a reference-counted block from ByteBufferPool and every
+ * recipient is handed a ByteBuffer viewing that block (@see view()), so queueing it for a
+ * recipient costs a reference count instead of a copy. Views must only be read and consumed;
+ * writing through one would be seen by every recipient.
+ * Packets small enough for a ByteBuffer's inline storage are copied into each view instead,
+ * which is cheaper than an allocation and a reference count shared between network threads.
+ * @thread any, views may be released on any thread.
+ */
+class BroadcastBuffer
+{
+public:
+	explicit BroadcastBuffer(ByteBuffer const &buf)
+	: _length(buf.active_length())
+	{
+		if (_length == 0)
+			return;
+
+		uint8_t const *packet = buf.contents() + buf.rpos();
+
+		if (_length <= BYTEBUFFER_INLINE_SIZE) {
+			_inline.append(packet, _length);
+			return;
+		}
+
+		std::size_t block_size = _length;
+		uint8_t *block = ByteBufferPool::allocate(block_size);
+
+		std::memcpy(block, packet, _length);
+
+		_block.reset(block, [block_size] (uint8_t *b) { ByteBufferPool::deallocate(b, block_size); });
+	}
+
+	uint8_t const *data() const
+	{
+		if (_length == 0)
+			return nullptr;
+
+		return _block != nullptr ? _block.get() : _inline.contents();
+	}
+
+	std::size_t length() const { return _length; }
+	bool is_shared() const { return _block != nullptr; }
+
+	/**
+	 * @brief Returns a buffer holding the packet for one recipient, ready to be queued on its socket.
+	 */
+	ByteBuffer view() const
+	{
+		if (_block != nullptr)
+			return ByteBuffer(_block, _block.get(), _length);
+
+		return _inline;
+	}
+
+private:
+	std::size_t _length;
+	std::shared_ptr<uint8_t> _block;
+	ByteBuffer _inline;
+};
+
+#endif /* HORIZON_NETWORKING_BROADCASTBUFFER_HPP */
@@ -31,6 +31,7 @@
 #define HORIZON_NETWORKING_BYTEBUFFER_HPP
 
 #include "ByteConverter.hpp"
+#include "ByteBufferPool.hpp"
 
 #include <type_traits>
 #include <stdlib.h>
@@ -38,6 +39,7 @@
 #include <cstring>
 #include <vector>
 #include <cmath>
+#include <algorithm>
 #include <assert.h>
 #include <list>
 #include <map>
@@ -77,13 +79,10 @@ public:
 class ByteBuffer
 {
 public:
-	const static size_t DEFAULT_SIZE = 0x1000; // Reserve 4096 bytes.
-
-	// constructor
+	// constructor, contents are stored inline until they outgrow BYTEBUFFER_INLINE_SIZE.
 	ByteBuffer()
     : _rpos(0), _wpos(0)
 	{
-		_storage.reserve(DEFAULT_SIZE);
 	}
 
 	ByteBuffer(size_t reserve)
@@ -92,6 +91,13 @@ public:
 		_storage.reserve(reserve);
 	}
 
+	// constructor, views length bytes of a shared block without copying them (@see SharedReadBuffer::slice).
+	ByteBuffer(std::shared_ptr<uint8_t> const &owner, uint8_t *data, size_t length)
+    : _rpos(0), _wpos(length)
+	{
+		_storage.share(owner, data, length);
+	}
+
 	ByteBuffer(ByteBuffer&& buf)
     : _rpos(buf._rpos), _wpos(buf._wpos), _storage(std::move(buf._storage))
     { }
@@ -112,6 +118,18 @@ public:
 		return *this;
 	}
 
+	ByteBuffer& operator=(ByteBuffer&& right)
+	{
+		if (this != &right)
+		{
+			_rpos = right._rpos;
+			_wpos = right._wpos;
+			_storage = std::move(right._storage);
+		}
+
+		return *this;
+	}
+
 	virtual ~ByteBuffer()
     { }
 
@@ -423,17 +441,8 @@ public:
 		assert(maximum_length() < 10000000);
 
 		size_t const newSize = _wpos + cnt;
-		if (_storage.capacity() < newSize) // custom memory allocation rules
-		{
-			if (newSize < 100)
-				_storage.reserve(300);
-			else if (newSize < 750)
-				_storage.reserve(2500);
-			else if (newSize < 6000)
-				_storage.reserve(10000);
-			else
-				_storage.reserve(400000);
-		}
+		if (_storage.capacity() < newSize) // grow geometrically, the pool rounds up to its size classes.
+			_storage.reserve(std::max(newSize, _storage.capacity() * 2));
 
 		if (_storage.size() < newSize)
 			_storage.resize(newSize);
@@ -467,15 +476,14 @@ public:
 	template<typename SizeT = uint16_t, typename std::enable_if<std::is_integral<SizeT>::value>::type* = nullptr>
 	void emplace_size(std::size_t pos = 2)
 	{
-		_storage.emplace(_storage.begin() + pos, 0);
-		_storage.emplace(_storage.begin() + pos + 1, 0);
+		_storage.insert(pos, 2);
 		_wpos += 2;
 		put(pos, (uint8_t *) &_wpos, sizeof(SizeT));
 	}
 
 protected:
 	size_t _rpos{0}, _wpos{0};
-	std::vector<uint8_t> _storage;
+	ByteBufferStorage _storage;
 };
 
 template<>
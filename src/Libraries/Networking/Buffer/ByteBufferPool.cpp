@@ -0,0 +1,224 @@
+/***************************************************
+ *       _   _            _                        *
+ *      | | | |          (_)                       *
+ *      | |_| | ___  _ __ _ _______  _ __          *
+ *      |  _  |/ _ \| '__| |_  / _ \| '_  \        *
+ *      | | | | (_) | |  | |/ / (_) | | | |        *
+ *      \_| |_/\___/|_|  |_/___\___/|_| |_|        *
+ ***************************************************
+ * This file is part of Horizon (c).
+ *
+ * Copyright (c) 2019 Sagun K. (sagunxp@gmail.com).
+ * Copyright (c) 2019 Horizon Dev Team.
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ **************************************************/
+
+#include "ByteBufferPool.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+
+#define BYTEBUFFER_POOL_SIZE_CLASSES 4
+
+namespace
+{
+struct free_block
+{
+	free_block *next;
+};
+
+struct size_class
+{
+	std::size_t block_size;     ///< Usable size of blocks in this class.
+	std::size_t thread_limit;   ///< Maximum blocks kept on a thread's free list.
+	std::size_t batch_size;     ///< Blocks moved between a thread's free list and the depot at once.
+	std::size_t depot_limit;    ///< Maximum blocks kept in the shared depot.
+};
+
+const size_class size_classes[BYTEBUFFER_POOL_SIZE_CLASSES] = {
+	{ 128,     1024, 64, 16384 },
+	{ 512,     512,  32, 4096 },
+	{ 0x1000,  64,   16, 1024 },
+	{ 0x10000, 8,    2,  64 }
+};
+
+/**
+ * Free lists shared between threads, filled by threads that release more
+ * blocks than they allocate and drained by those that allocate more.
+ */
+struct depot_list
+{
+	std::mutex mutex;
+	free_block *head{nullptr};
+	std::size_t count{0};
+};
+
+depot_list depot[BYTEBUFFER_POOL_SIZE_CLASSES];
+
+struct
+{
+	std::atomic<uint64_t> inline_buffers{0};
+	std::atomic<uint64_t> pool_hits{0};
+	std::atomic<uint64_t> depot_refills{0};
+	std::atomic<uint64_t> system_allocations{0};
+	std::atomic<uint64_t> system_frees{0};
+} statistics;
+
+void push_list(free_block *&head, std::size_t &count, free_block *block)
+{
+	block->next = head;
+	head = block;
+	count++;
+}
+
+free_block *pop_list(free_block *&head, std::size_t &count)
+{
+	free_block *block = head;
+	head = block->next;
+	count--;
+	return block;
+}
+
+void system_free(free_block *block)
+{
+	std::free(block);
+	statistics.system_frees.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * Moves up to n blocks from one list to another, freeing the ones that exceed the destination's limit.
+ */
+void transfer(free_block *&from, std::size_t &from_count, free_block *&to, std::size_t &to_count, std::size_t n, std::size_t to_limit)
+{
+	for (std::size_t i = 0; i < n && from != nullptr; i++) {
+		free_block *block = pop_list(from, from_count);
+
+		if (to_count < to_limit)
+			push_list(to, to_count, block);
+		else
+			system_free(block);
+	}
+}
+
+/**
+ * Per-thread free lists. Blocks left over when the thread exits are handed to the depot.
+ */
+thread_local bool thread_cache_destroyed = false;
+
+struct thread_cache
+{
+	free_block *head[BYTEBUFFER_POOL_SIZE_CLASSES] = { nullptr };
+	std::size_t count[BYTEBUFFER_POOL_SIZE_CLASSES] = { 0 };
+
+	~thread_cache()
+	{
+		for (int i = 0; i < BYTEBUFFER_POOL_SIZE_CLASSES; i++) {
+			std::lock_guard<std::mutex> lock(depot[i].mutex);
+			transfer(head[i], count[i], depot[i].head, depot[i].count, count[i], size_classes[i].depot_limit);
+		}
+
+		thread_cache_destroyed = true;
+	}
+};
+
+thread_local thread_cache cache;
+
+int find_size_class(std::size_t size)
+{
+	for (int i = 0; i < BYTEBUFFER_POOL_SIZE_CLASSES; i++)
+		if (size <= size_classes[i].block_size)
+			return i;
+
+	return -1;
+}
+}
+
+uint8_t *ByteBufferPool::allocate(std::size_t &size)
+{
+	int const cls = find_size_class(size);
+
+	if (cls == -1 || thread_cache_destroyed) {
+		void *block = std::malloc(size);
+
+		if (block == nullptr)
+			throw std::bad_alloc();
+
+		statistics.system_allocations.fetch_add(1, std::memory_order_relaxed);
+		return static_cast<uint8_t *>(block);
+	}
+
+	size = size_classes[cls].block_size;
+
+	if (cache.head[cls] == nullptr) {
+		std::lock_guard<std::mutex> lock(depot[cls].mutex);
+
+		if (depot[cls].head != nullptr) {
+			transfer(depot[cls].head, depot[cls].count, cache.head[cls], cache.count[cls], size_classes[cls].batch_size, size_classes[cls].thread_limit);
+			statistics.depot_refills.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	if (cache.head[cls] != nullptr) {
+		statistics.pool_hits.fetch_add(1, std::memory_order_relaxed);
+		return reinterpret_cast<uint8_t *>(pop_list(cache.head[cls], cache.count[cls]));
+	}
+
+	void *block = std::malloc(size);
+
+	if (block == nullptr)
+		throw std::bad_alloc();
+
+	statistics.system_allocations.fetch_add(1, std::memory_order_relaxed);
+	return static_cast<uint8_t *>(block);
+}
+
+void ByteBufferPool::deallocate(uint8_t *block, std::size_t size)
+{
+	free_block *fb = reinterpret_cast<free_block *>(block);
+	int const cls = find_size_class(size);
+
+	// Blocks outside of the size classes were allocated with their exact size.
+	if (cls == -1 || size_classes[cls].block_size != size || thread_cache_destroyed) {
+		system_free(fb);
+		return;
+	}
+
+	push_list(cache.head[cls], cache.count[cls], fb);
+
+	if (cache.count[cls] > size_classes[cls].thread_limit) {
+		std::lock_guard<std::mutex> lock(depot[cls].mutex);
+		transfer(cache.head[cls], cache.count[cls], depot[cls].head, depot[cls].count, size_classes[cls].batch_size, size_classes[cls].depot_limit);
+	}
+}
+
+void ByteBufferPool::count_inline_buffer()
+{
+	statistics.inline_buffers.fetch_add(1, std::memory_order_relaxed);
+}
+
+bytebuffer_pool_statistics ByteBufferPool::get_statistics()
+{
+	bytebuffer_pool_statistics stats;
+
+	stats.inline_buffers = statistics.inline_buffers.load(std::memory_order_relaxed);
+	stats.pool_hits = statistics.pool_hits.load(std::memory_order_relaxed);
+	stats.depot_refills = statistics.depot_refills.load(std::memory_order_relaxed);
+	stats.system_allocations = statistics.system_allocations.load(std::memory_order_relaxed);
+	stats.system_frees = statistics.system_frees.load(std::memory_order_relaxed);
+
+	return stats;
+}
@@ -0,0 +1,242 @@
+/***************************************************
+ *       _   _            _                        *
+ *      | | | |          (_)                       *
+ *      | |_| | ___  _ __ _ _______  _ __          *
+ *      |  _  |/ _ \| '__| |_  / _ \| '_  \        *
+ *      | | | | (_) | |  | |/ / (_) | | | |        *
+ *      \_| |_/\___/|_|  |_/___\___/|_| |_|        *
+ ***************************************************
+ * This file is part of Horizon (c).
+ *
+ * Copyright (c) 2019 Sagun K. (sagunxp@gmail.com).
+ * Copyright (c) 2019 Horizon Dev Team.
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ **************************************************/
+
+#ifndef HORIZON_NETWORKING_BYTEBUFFERPOOL_HPP
+#define HORIZON_NETWORKING_BYTEBUFFERPOOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+
+#define BYTEBUFFER_INLINE_SIZE 64 // Bytes stored within the buffer object itself, enough for most packets.
+
+/**
+ * @brief Allocation counters of the ByteBuffer pools, aggregated over all threads.
+ */
+struct bytebuffer_pool_statistics
+{
+	uint64_t inline_buffers{0};      ///< Buffers that never outgrew their inline storage.
+	uint64_t pool_hits{0};           ///< Blocks served from a thread's free list.
+	uint64_t depot_refills{0};       ///< Batches moved from the shared depot to a thread's free list.
+	uint64_t system_allocations{0};  ///< Blocks allocated from the system allocator.
+	uint64_t system_frees{0};        ///< Blocks returned to the system allocator.
+};
+
+/**
+ * @brief Size-classed free-list allocator for ByteBuffer storage.
+ * Each thread keeps a bounded free list per size class. Buffers are commonly built on one
+ * thread and released on another (e.g. built on a MapContainerThread, released by the
+ * NetworkThread once written), so lists that overflow spill a batch into a shared depot,
+ * and empty lists refill from it before falling back to the system allocator.
+ * Requests larger than the biggest size class are served by the system allocator directly.
+ */
+class ByteBufferPool
+{
+public:
+	/**
+	 * @brief Allocates a block of at least size bytes.
+	 * @param[in|out] size requested size, set to the usable size of the block.
+	 */
+	static uint8_t *allocate(std::size_t &size);
+
+	/**
+	 * @brief Returns a block to the pool of the calling thread.
+	 * @param[in] size usable size of the block as returned by allocate().
+	 */
+	static void deallocate(uint8_t *block, std::size_t size);
+
+	static void count_inline_buffer();
+
+	static bytebuffer_pool_statistics get_statistics();
+};
+
+/**
+ * @brief Contiguous byte storage for ByteBuffer.
+ * Up to BYTEBUFFER_INLINE_SIZE bytes are kept inline; larger contents are held
+ * in a block from ByteBufferPool. New bytes are zero-initialised on resize.
+ * Storage may also view a region of a shared block (@see share()), which is
+ * copied into owned storage only once it needs to grow.
+ */
+class ByteBufferStorage
+{
+public:
+	ByteBufferStorage() : _data(_inline) { }
+
+	ByteBufferStorage(ByteBufferStorage const &right)
+	: _data(_inline)
+	{
+		reserve(right._size);
+		if (right._size)
+			std::memcpy(_data, right._data, right._size);
+		_size = right._size;
+	}
+
+	ByteBufferStorage(ByteBufferStorage &&right) : _data(_inline) { steal(right); }
+
+	~ByteBufferStorage()
+	{
+		if (is_inline() && _size > 0)
+			ByteBufferPool::count_inline_buffer();
+
+		release();
+	}
+
+	ByteBufferStorage &operator=(ByteBufferStorage const &right)
+	{
+		if (this != &right) {
+			_size = 0;
+			reserve(right._size);
+			if (right._size)
+				std::memcpy(_data, right._data, right._size);
+			_size = right._size;
+		}
+
+		return *this;
+	}
+
+	ByteBufferStorage &operator=(ByteBufferStorage &&right)
+	{
+		if (this != &right) {
+			release();
+			steal(right);
+		}
+
+		return *this;
+	}
+
+	uint8_t *data() { return _data; }
+	uint8_t const *data() const { return _data; }
+
+	uint8_t &operator[](std::size_t pos) { return _data[pos]; }
+	uint8_t const &operator[](std::size_t pos) const { return _data[pos]; }
+
+	std::size_t size() const { return _size; }
+	std::size_t capacity() const { return _capacity; }
+	bool empty() const { return _size == 0; }
+
+	void clear() { _size = 0; }
+
+	/**
+	 * @brief Views size bytes at data, which must lie within the block kept alive by owner.
+	 * The viewed region must not be accessed through any other storage.
+	 */
+	void share(std::shared_ptr<uint8_t> const &owner, uint8_t *data, std::size_t size)
+	{
+		release();
+
+		_shared = owner;
+		_data = data;
+		_size = size;
+		_capacity = size;
+	}
+
+	bool is_shared() const { return _shared != nullptr; }
+
+	void reserve(std::size_t capacity)
+	{
+		if (capacity <= _capacity)
+			return;
+
+		std::size_t new_capacity = capacity;
+		uint8_t *block = ByteBufferPool::allocate(new_capacity);
+
+		if (_size)
+			std::memcpy(block, _data, _size);
+
+		release();
+
+		_data = block;
+		_capacity = new_capacity;
+	}
+
+	void resize(std::size_t size)
+	{
+		if (size > _capacity)
+			reserve(size);
+
+		if (size > _size)
+			std::memset(_data + _size, 0, size - _size);
+
+		_size = size;
+	}
+
+	/**
+	 * @brief Inserts count zeroed bytes at pos, shifting the following bytes back.
+	 */
+	void insert(std::size_t pos, std::size_t count)
+	{
+		std::size_t const old_size = _size;
+
+		resize(_size + count);
+		std::memmove(_data + pos + count, _data + pos, old_size - pos);
+		std::memset(_data + pos, 0, count);
+	}
+
+private:
+	bool is_inline() const { return _data == _inline; }
+
+	void release()
+	{
+		if (is_shared()) {
+			_shared.reset();
+			_data = _inline;
+		} else if (!is_inline()) {
+			ByteBufferPool::deallocate(_data, _capacity);
+			_data = _inline;
+		}
+
+		_capacity = BYTEBUFFER_INLINE_SIZE;
+	}
+
+	void steal(ByteBufferStorage &right)
+	{
+		if (right.is_inline()) {
+			std::memcpy(_inline, right._inline, right._size);
+			_data = _inline;
+			_capacity = BYTEBUFFER_INLINE_SIZE;
+		} else {
+			_data = right._data;
+			_capacity = right._capacity;
+			_shared = std::move(right._shared);
+			right._data = right._inline;
+			right._capacity = BYTEBUFFER_INLINE_SIZE;
+		}
+
+		_size = right._size;
+		right._size = 0;
+	}
+
+	uint8_t *_data;
+	std::size_t _size{0};
+	std::size_t _capacity{BYTEBUFFER_INLINE_SIZE};
+	std::shared_ptr<uint8_t> _shared;   ///< Owner of the viewed block while shared.
+	uint8_t _inline[BYTEBUFFER_INLINE_SIZE];
+};
+
+#endif /* HORIZON_NETWORKING_BYTEBUFFERPOOL_HPP */
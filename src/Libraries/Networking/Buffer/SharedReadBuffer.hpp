@@ -0,0 +1,136 @@
+/***************************************************
+ *       _   _            _                        *
+ *      | | | |          (_)                       *
+ *      | |_| | ___  _ __ _ _______  _ __          *
+ *      |  _  |/ _ \| '__| |_  / _ \| '_  \        *
+ *      | | | | (_) | |  | |/ / (_) | | | |        *
+ *      \_| |_/\___/|_|  |_/___\___/|_| |_|        *
+ ***************************************************
+ * This file is part of Horizon (c).
+ *
+ * Copyright (c) 2019 Sagun K. (sagunxp@gmail.com).
+ * Copyright (c) 2019 Horizon Dev Team.
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ **************************************************/
+
+#ifndef HORIZON_NETWORKING_SHAREDREADBUFFER_HPP
+#define HORIZON_NETWORKING_SHAREDREADBUFFER_HPP
+
+#include "ByteBuffer.hpp"
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+/**
+ * @brief Receive buffer of a socket, from which framed packets are sliced without copying.
+ * Data is read into a reference-counted chunk from ByteBufferPool and every framed packet
+ * is handed out as a ByteBuffer viewing its bytes within that chunk (@see slice()).
+ * While any slice is alive its chunk is never written behind the read position;
+ * if room is needed, the unconsumed tail is moved into a fresh chunk instead and the old one
+ * returns to the pool once the last slice is released by the thread that handled it.
+ * @thread NetworkThread, slices may be released on any thread.
+ */
+class SharedReadBuffer
+{
+public:
+	explicit SharedReadBuffer(std::size_t block_size)
+	: _block_size(block_size)
+	{
+		replace_chunk(block_size);
+	}
+
+	uint8_t *get_read_pointer() { return _chunk.get() + _rpos; }
+	uint8_t *get_write_pointer() { return _chunk.get() + _wpos; }
+
+	std::string to_string() { return std::string(get_read_pointer(), get_write_pointer()); }
+
+	size_t active_length() const { return _wpos - _rpos; }
+	size_t remaining_space() const { return _capacity - _wpos; }
+
+	void read_completed(size_t bytes) { _rpos += bytes; }
+	void write_completed(size_t bytes) { _wpos += bytes; }
+
+	/**
+	 * @brief Consumes length bytes from the read position and returns them as a ByteBuffer
+	 * that shares ownership of the current chunk.
+	 */
+	ByteBuffer slice(size_t length)
+	{
+		ByteBuffer buf(_chunk, get_read_pointer(), length);
+		_rpos += length;
+		return buf;
+	}
+
+	/**
+	 * @brief Discards consumed bytes and ensures there is room for the next read.
+	 * An exclusively held chunk is compacted in place. A chunk that is still viewed by
+	 * slices is left untouched, and the unconsumed bytes move to a new chunk once less
+	 * than half a block is left to read into.
+	 */
+	void ensure_free_space()
+	{
+		if (is_exclusive()) {
+			if (_rpos) {
+				if (_rpos != _wpos)
+					memmove(_chunk.get(), get_read_pointer(), active_length());
+				_wpos -= _rpos;
+				_rpos = 0;
+			}
+		} else if (remaining_space() < _block_size / 2) {
+			replace_chunk(_block_size);
+		}
+
+		// Grow if a single packet doesn't fit.
+		if (remaining_space() == 0)
+			replace_chunk(_capacity * 2);
+	}
+
+private:
+	bool is_exclusive() const
+	{
+		if (_chunk.use_count() != 1)
+			return false;
+
+		// Pairs with the release of the last slice on another thread before we write to the chunk.
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return true;
+	}
+
+	/**
+	 * @brief Moves the unconsumed bytes into a new chunk of at least capacity bytes.
+	 */
+	void replace_chunk(std::size_t capacity)
+	{
+		std::size_t block_size = capacity;
+		uint8_t *block = ByteBufferPool::allocate(block_size);
+		std::size_t const length = active_length();
+
+		if (length)
+			memcpy(block, get_read_pointer(), length);
+
+		_chunk.reset(block, [block_size] (uint8_t *b) { ByteBufferPool::deallocate(b, block_size); });
+		_capacity = block_size;
+		_rpos = 0;
+		_wpos = length;
+	}
+
+	std::shared_ptr<uint8_t> _chunk;
+	std::size_t _block_size;
+	std::size_t _capacity{0};
+	std::size_t _rpos{0}, _wpos{0};
+};
+
+#endif /* HORIZON_NETWORKING_SHAREDREADBUFFER_HPP */
@@ -55,7 +55,7 @@ public:
 	std::shared_ptr<SocketType> get_socket() { return _socket.lock(); }
 	void set_socket(std::weak_ptr<SocketType> socket) { _socket.swap(socket); }
 
-	virtual void update(uint32_t diff) = 0;
+	virtual void update(uint64_t diff) = 0;
 
 	virtual void initialize() = 0;
 
@@ -32,11 +32,13 @@
 
 #include "Core/Logging/Logger.hpp"
 #include "Buffer/ByteBuffer.hpp"
-#include "Core/Multithreading/ThreadSafeQueue.hpp"
+#include "Buffer/SharedReadBuffer.hpp"
+#include "Core/Multithreading/SPSCQueue.hpp"
 
 #include <atomic>
 #include <queue>
 #include <memory>
+#include <mutex>
 #include <functional>
 #include <future>
 #include <type_traits>
@@ -50,20 +52,38 @@
 using boost::asio::ip::tcp;
 
 #define READ_BLOCK_SIZE 0x1000
+#define SEND_QUEUE_CAPACITY 1024 // Maximum number of packets pending transmission per socket.
+#define RECV_QUEUE_CAPACITY 256 // Maximum number of received packets pending handling per socket.
+#define MAX_SEND_BATCH_BUFFERS 64 // Maximum number of queued buffers gathered into a single write (asio's iovec limit).
+#define DEFAULT_SEND_BATCH_BYTE_LIMIT 0x10000 // Default maximum number of bytes gathered into a single write.
 
 namespace Horizon
 {
 namespace Networking
 {
+/**
+ * @brief Transmission counters of a socket, updated by its NetworkThread.
+ * A flush is one pass over the send queue, which may take several write calls
+ * when the peer's receive window fills up.
+ */
+struct socket_send_statistics
+{
+	uint64_t bytes_sent{0};
+	uint64_t buffers_sent{0};
+	uint64_t write_calls{0};
+	uint64_t flushes{0};
+};
+
 template <class SocketType>
 class Socket : public std::enable_shared_from_this<SocketType>
 {
 public:
 	explicit Socket(std::shared_ptr<tcp::socket> socket)
 	: _socket_id(0), _socket(socket), _remote_ip_address(_socket->remote_endpoint().address().to_string()),
-	_remote_port(_socket->remote_endpoint().port()), _read_buffer(), _closed(false), _closing(false), _is_writing_async(false)
+	_remote_port(_socket->remote_endpoint().port()), _read_buffer(READ_BLOCK_SIZE), _write_queue(SEND_QUEUE_CAPACITY),
+	_closed(false), _closing(false), _is_writing_async(false), _buffer_recv_queue(RECV_QUEUE_CAPACITY)
 	{
-		_read_buffer.resize(READ_BLOCK_SIZE);
+		_send_buffer_sequence.reserve(MAX_SEND_BATCH_BUFFERS);
 	}
 
 	virtual ~Socket()
@@ -91,6 +111,8 @@ public:
 		if (_is_writing_async || (_write_queue.empty() && !_closing))
 			return true;
 
+		_send_stats.flushes.fetch_add(1, std::memory_order_relaxed);
+
 		while (handle_queue())
 			;
 
@@ -114,7 +136,6 @@ public:
 		if (!is_open())
 			return;
 
-		_read_buffer.flush();
 		_read_buffer.ensure_free_space();
 		
 		_socket->async_read_some(boost::asio::buffer(_read_buffer.get_write_pointer(), _read_buffer.remaining_space()),
@@ -130,14 +151,27 @@ public:
 		if (!is_open())
 			return;
 
-		_read_buffer.flush();
 		_read_buffer.ensure_free_space();
 
 		_socket->async_read_some(boost::asio::buffer(buf.get_write_pointer(), buf.remaining_space()),
 								 boost::bind(&Socket<SocketType>::read_handler_internal, this, boost::placeholders::_1, boost::placeholders::_2));
 	}
 
-	void queue_buffer(ByteBuffer &&buffer) { _write_queue.push(std::move(buffer)); }
+	/**
+	 * @brief Queues a buffer for transmission.
+	 * Sessions may transmit from their update thread as well as the network thread (on cleanup),
+	 * so producers are serialized among themselves; the network thread consumes without locking.
+	 * A peer that lets the queue fill up is disconnected instead of buffering without bound.
+	 */
+	void queue_buffer(ByteBuffer &&buffer)
+	{
+		std::lock_guard<std::mutex> lock(_write_queue_producer_mutex);
+
+		if (!_write_queue.try_push(std::move(buffer))) {
+			HLog(warning) << "Send queue for " << remote_ip_address() << " is full (" << _write_queue.capacity() << " packets), closing connection.";
+			delayed_close_socket();
+		}
+	}
 
 	bool is_open() { return !_closed && !_closing; }
 
@@ -152,6 +186,9 @@ public:
 		if (_closed.exchange(true))
 			return;
 
+		HLog(debug) << "Socket " << remote_ip_address() << " queue high-water marks - send: " << _write_queue.high_water_mark()
+			<< "/" << _write_queue.capacity() << ", recv: " << _buffer_recv_queue.high_water_mark() << "/" << _buffer_recv_queue.capacity() << ".";
+
 		// Finalise the child-class socket first.
 		on_close();
 
@@ -171,9 +208,47 @@ public:
 
 	void delayed_close_socket() { if (_closing.exchange(true)) return; }
 
-    ByteBuffer &get_read_buffer() { return _read_buffer; }
+    SharedReadBuffer &get_read_buffer() { return _read_buffer; }
 	
-	ThreadSafeQueue<ByteBuffer> &get_recv_queue() { return _buffer_recv_queue; }
+	SPSCQueue<ByteBuffer> &get_recv_queue() { return _buffer_recv_queue; }
+
+	/**
+	 * @brief Queues a framed packet for its session.
+	 * @thread NetworkThread
+	 * @return false if the session has fallen too far behind, in which case the socket is closed.
+	 */
+	bool push_recv_buffer(ByteBuffer &&buffer)
+	{
+		if (!_buffer_recv_queue.try_push(std::move(buffer))) {
+			HLog(warning) << "Receive queue for " << remote_ip_address() << " is full (" << _buffer_recv_queue.capacity() << " packets), closing connection.";
+			close_socket();
+			return false;
+		}
+
+		return true;
+	}
+
+	/* Queue Statistics */
+	std::size_t send_queue_high_water_mark() const { return _write_queue.high_water_mark(); }
+	std::size_t recv_queue_high_water_mark() const { return _buffer_recv_queue.high_water_mark(); }
+
+	/* Send Statistics */
+	socket_send_statistics get_send_statistics() const
+	{
+		socket_send_statistics stats;
+		stats.bytes_sent = _send_stats.bytes_sent.load(std::memory_order_relaxed);
+		stats.buffers_sent = _send_stats.buffers_sent.load(std::memory_order_relaxed);
+		stats.write_calls = _send_stats.write_calls.load(std::memory_order_relaxed);
+		stats.flushes = _send_stats.flushes.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	/**
+	 * @brief Sets the maximum number of bytes gathered into a single write.
+	 * A single buffer larger than the limit is still written on its own.
+	 */
+	void set_send_batch_byte_limit(std::size_t limit) { _send_batch_byte_limit = limit; }
+	std::size_t get_send_batch_byte_limit() const { return _send_batch_byte_limit; }
 
 protected:
 	virtual void on_close() = 0;
@@ -208,17 +283,37 @@ protected:
 	}
 
 	/**
-	 * Write a message to the buffer.
-	 * @param to_send
-	 * @param error
-	 * @return
+	 * Gather the buffers at the front of the write queue into a single
+	 * scatter-gather write, bounded by MAX_SEND_BATCH_BUFFERS and the send batch byte limit.
+	 * @param[out] buffer_count number of queued buffers included in the write.
+	 * @param[out] bytes_to_send number of bytes included in the write.
+	 * @param[out] error
+	 * @return number of bytes written to the socket.
 	 */
-	std::size_t write_buffer_and_send(ByteBuffer &to_send, boost::system::error_code &error)
+	std::size_t write_queue_and_send(std::size_t &buffer_count, std::size_t &bytes_to_send, boost::system::error_code &error)
 	{
-		int16_t packet_id;
-		std::size_t bytes_to_send = to_send.active_length();
-		memcpy(&packet_id, to_send.get_read_pointer(), sizeof(int16_t));
-		std::size_t bytes_sent = _socket->write_some(boost::asio::buffer(to_send.get_read_pointer(), bytes_to_send), error);
+		ByteBuffer *buf = nullptr;
+
+		_send_buffer_sequence.clear();
+		buffer_count = 0;
+		bytes_to_send = 0;
+
+		while (buffer_count < MAX_SEND_BATCH_BUFFERS && (buf = _write_queue.peek(buffer_count)) != nullptr) {
+			std::size_t length = buf->active_length();
+
+			if (buffer_count > 0 && bytes_to_send + length > _send_batch_byte_limit)
+				break;
+
+			_send_buffer_sequence.push_back(boost::asio::const_buffer(buf->get_read_pointer(), length));
+			bytes_to_send += length;
+			buffer_count++;
+		}
+
+		std::size_t bytes_sent = _socket->write_some(_send_buffer_sequence, error);
+
+		_send_stats.write_calls.fetch_add(1, std::memory_order_relaxed);
+		_send_stats.bytes_sent.fetch_add(bytes_sent, std::memory_order_relaxed);
+
 		return bytes_sent;
 	}
 private:
@@ -266,37 +361,65 @@ private:
 	void write_handler_wrapper(boost::system::error_code /*error*/, std::size_t /*transferedBytes*/)
 	{
 		_is_writing_async = false;
-		handle_queue();
+		_send_stats.flushes.fetch_add(1, std::memory_order_relaxed);
+
+		while (handle_queue())
+			;
 	}
 
 	/**
 	 * Handle the queue
-	 * @return true on success, false on failure.
+	 * @return true if more buffers can be written immediately, false otherwise.
 	 */
 	bool handle_queue()
 	{
 		boost::system::error_code error;
+		std::size_t buffer_count = 0, bytes_to_send = 0;
 
 		if (_write_queue.empty())
 			return false;
 
-		std::shared_ptr<ByteBuffer> to_send = _write_queue.front();
-
-		std::size_t bytes_sent = write_buffer_and_send(*to_send, error);
+		std::size_t bytes_sent = write_queue_and_send(buffer_count, bytes_to_send, error);
 
 		if (error == boost::asio::error::would_block || error == boost::asio::error::try_again)
 			return async_process_queue();
 
 		/**
-		 * Re-process queue if we have remaining bytes.
+		 * Any other error leaves the connection unusable, the rest of the batch can never be delivered.
+		 * Close it as the read handler does instead of dropping the batch and writing the next one.
 		 */
-		if (!error && bytes_sent < to_send->active_length()) {
-			to_send->read_completed(bytes_sent);
-			return async_process_queue();
+		if (error) {
+			HLog(debug) << "Socket::handle_queue: " << error.value() << " (Code: " << error.message() << "), closing connection to " << remote_ip_address() << ".";
+			on_error();
+			close_socket();
+			return false;
 		}
 
-		// Pop the front element.
-		_write_queue.try_pop();
+		/**
+		 * Release every fully written buffer and advance the read position of a
+		 * partially written one, which may end anywhere within the batch.
+		 */
+		std::size_t remaining = bytes_sent;
+
+		for (std::size_t i = 0; i < buffer_count; i++) {
+			ByteBuffer *to_send = _write_queue.front();
+			std::size_t length = to_send->active_length();
+
+			if (remaining < length) {
+				to_send->read_completed(remaining);
+				break;
+			}
+
+			remaining -= length;
+			_write_queue.pop();
+			_send_stats.buffers_sent.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		/**
+		 * Re-process queue if we have remaining bytes.
+		 */
+		if (bytes_sent < bytes_to_send)
+			return async_process_queue();
 
 		// Close if required.
 		if (_closing && _write_queue.empty())
@@ -310,14 +433,27 @@ private:
 	std::shared_ptr<tcp::socket> _socket;               ///< After accepting, the reference count of this pointer should be 1.
 	std::string _remote_ip_address;
 	uint16_t _remote_port;
-	ByteBuffer _read_buffer;
-	ThreadSafeQueue<ByteBuffer> _write_queue;
+	SharedReadBuffer _read_buffer;
+	SPSCQueue<ByteBuffer> _write_queue;
+	std::mutex _write_queue_producer_mutex;
+	std::vector<boost::asio::const_buffer> _send_buffer_sequence;   ///< Reused gather list for write_queue_and_send().
+	std::size_t _send_batch_byte_limit{DEFAULT_SEND_BATCH_BYTE_LIMIT};
+	struct {
+		std::atomic<uint64_t> bytes_sent{0};
+		std::atomic<uint64_t> buffers_sent{0};
+		std::atomic<uint64_t> write_calls{0};
+		std::atomic<uint64_t> flushes{0};
+	} _send_stats;                                                   ///< @see socket_send_statistics
 	std::atomic<bool> _closed;
 	std::atomic<bool> _closing;
 	bool _is_writing_async;
 
 public:
-	ThreadSafeQueue<ByteBuffer> _buffer_recv_queue;
+	/**
+	 * @brief Framed packets for the session. Produced by the network thread and consumed by one session
+	 * update thread at a time; a session moving to another thread stops consuming before it is handed over.
+	 */
+	SPSCQueue<ByteBuffer> _buffer_recv_queue;
 };
 }
 }
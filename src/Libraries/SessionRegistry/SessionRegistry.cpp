@@ -0,0 +1,335 @@
+/***************************************************
+ *       _   _            _                        *
+ *      | | | |          (_)                       *
+ *      | |_| | ___  _ __ _ _______  _ __          *
+ *      |  _  |/ _ \| '__| |_  / _ \| '_  \        *
+ *      | | | | (_) | |  | |/ / (_) | | | |        *
+ *      \_| |_/\___/|_|  |_/___\___/|_| |_|        *
+ ***************************************************
+ * This file is part of Horizon (c).
+ *
+ * Copyright (c) 2019 Sagun K. (sagunxp@gmail.com).
+ * Copyright (c) 2019 Horizon Dev Team.
+ *
+ * Base Author - Sagun K. (sagunxp@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ **************************************************/
+
+#include "SessionRegistry.hpp"
+
+#include <boost/interprocess/managed_shared_memory.hpp>
+#include <boost/interprocess/sync/interprocess_mutex.hpp>
+#include <boost/interprocess/sync/scoped_lock.hpp>
+
+#include <algorithm>
+
+using namespace Horizon::Libraries;
+
+namespace bip = boost::interprocess;
+
+struct SessionRegistry::registry_header
+{
+	uint32_t magic{SESSION_REGISTRY_MAGIC};
+	uint32_t version{SESSION_REGISTRY_VERSION};
+	uint32_t capacity{0};   ///< Sessions that fit, half the slots.
+	uint32_t slot_count{0}; ///< Power of two.
+	uint32_t shift{0};
+	uint32_t size{0};
+	uint64_t lookups{0}, hits{0}, writes{0}, expired{0};
+	bip::interprocess_mutex mtx;
+};
+
+struct SessionRegistry::registry_slot
+{
+	uint32_t used{0};
+	session_registry_entry entry;
+};
+
+typedef bip::scoped_lock<bip::interprocess_mutex> registry_lock;
+
+SessionRegistry::SessionRegistry()
+{
+}
+
+SessionRegistry::~SessionRegistry()
+{
+}
+
+bool SessionRegistry::open_shared(std::string const &name, uint32_t capacity, bool *created)
+{
+	uint32_t slot_count = 2;
+
+	while (slot_count < (uint64_t) std::max<uint32_t>(capacity, 1) * 2)
+		slot_count <<= 1;
+
+	try {
+		std::size_t segment_size = sizeof(registry_header) + (std::size_t) slot_count * sizeof(registry_slot) + 64 * 1024;
+
+		_segment.reset(new bip::managed_shared_memory(bip::open_or_create, name.c_str(), segment_size));
+
+		bool constructed = false;
+
+		// The creator constructs and sizes the table while holding the segment lock, others find it complete.
+		auto find_or_construct = [&] () {
+			_header = _segment->find<registry_header>("header").first;
+
+			if (_header != nullptr) {
+				_slots = _segment->find<registry_slot>("slots").first;
+				return;
+			}
+
+			_header = _segment->construct<registry_header>("header")();
+			_slots = _segment->construct<registry_slot>("slots")[slot_count]();
+			initialize(slot_count);
+			constructed = true;
+		};
+
+		_segment->atomic_func(find_or_construct);
+
+		if (_header == nullptr || _slots == nullptr
+			|| _header->magic != SESSION_REGISTRY_MAGIC || _header->version != SESSION_REGISTRY_VERSION) {
+			_segment.reset();
+			_header = nullptr;
+			_slots = nullptr;
+			return false;
+		}
+
+		if (created != nullptr)
+			*created = constructed;
+	} catch (bip::interprocess_exception &) {
+		_segment.reset();
+		_header = nullptr;
+		_slots = nullptr;
+		return false;
+	}
+
+	return true;
+}
+
+void SessionRegistry::open_local(uint32_t capacity)
+{
+	uint32_t slot_count = 2;
+
+	while (slot_count < (uint64_t) std::max<uint32_t>(capacity, 1) * 2)
+		slot_count <<= 1;
+
+	_segment.reset();
+	_local_header.reset(new registry_header());
+	_local_slots.reset(new registry_slot[slot_count]());
+	_header = _local_header.get();
+	_slots = _local_slots.get();
+
+	initialize(slot_count);
+}
+
+bool SessionRegistry::remove(std::string const &name)
+{
+	return bip::shared_memory_object::remove(name.c_str());
+}
+
+void SessionRegistry::initialize(uint32_t slot_count)
+{
+	_header->slot_count = slot_count;
+	_header->capacity = slot_count / 2;
+	_header->shift = 32;
+
+	for (uint32_t s = slot_count; s > 1; s >>= 1)
+		_header->shift--;
+}
+
+bool SessionRegistry::insert(session_registry_entry const &entry)
+{
+	registry_lock lock(_header->mtx);
+	return place(entry, false);
+}
+
+bool SessionRegistry::upsert(session_registry_entry const &entry)
+{
+	registry_lock lock(_header->mtx);
+	return place(entry, true);
+}
+
+bool SessionRegistry::find(uint32_t game_account_id, session_registry_entry &entry)
+{
+	registry_lock lock(_header->mtx);
+	int64_t index = locate(game_account_id);
+
+	_header->lookups++;
+
+	if (index < 0)
+		return false;
+
+	_header->hits++;
+	entry = _slots[index].entry;
+	return true;
+}
+
+bool SessionRegistry::erase(uint32_t game_account_id)
+{
+	registry_lock lock(_header->mtx);
+	int64_t index = locate(game_account_id);
+
+	if (index < 0)
+		return false;
+
+	remove_slot((uint32_t) index);
+	_header->writes++;
+	return true;
+}
+
+bool SessionRegistry::set_current_server(uint32_t game_account_id, char current_server)
+{
+	registry_lock lock(_header->mtx);
+	int64_t index = locate(game_account_id);
+
+	if (index < 0)
+		return false;
+
+	_slots[index].entry.current_server = current_server;
+	_header->writes++;
+	return true;
+}
+
+bool SessionRegistry::touch(uint32_t game_account_id, char current_server, int64_t now)
+{
+	registry_lock lock(_header->mtx);
+	int64_t index = locate(game_account_id);
+
+	if (index < 0 || _slots[index].entry.current_server != current_server)
+		return false;
+
+	_slots[index].entry.last_update = now;
+	_header->writes++;
+	return true;
+}
+
+std::vector<uint32_t> SessionRegistry::expire(char current_server, int64_t older_than)
+{
+	std::vector<uint32_t> expired;
+	registry_lock lock(_header->mtx);
+
+	for (uint32_t i = 0; i < _header->slot_count;) {
+		session_registry_entry const &entry = _slots[i].entry;
+
+		if (_slots[i].used && entry.current_server == current_server && entry.last_update < older_than) {
+			expired.push_back(entry.game_account_id);
+			// Another entry may be shifted into this slot, it is checked again.
+			remove_slot(i);
+			continue;
+		}
+
+		i++;
+	}
+
+	_header->expired += expired.size();
+
+	return expired;
+}
+
+uint32_t SessionRegistry::count(char current_server)
+{
+	uint32_t count = 0;
+	registry_lock lock(_header->mtx);
+
+	for (uint32_t i = 0; i < _header->slot_count; i++) {
+		if (_slots[i].used && _slots[i].entry.current_server == current_server)
+			count++;
+	}
+
+	return count;
+}
+
+session_registry_statistics SessionRegistry::get_statistics()
+{
+	session_registry_statistics stats;
+	registry_lock lock(_header->mtx);
+
+	stats.capacity = _header->capacity;
+	stats.size = _header->size;
+	stats.lookups = _header->lookups;
+	stats.hits = _header->hits;
+	stats.writes = _header->writes;
+	stats.expired = _header->expired;
+
+	return stats;
+}
+
+int64_t SessionRegistry::locate(uint32_t game_account_id) const
+{
+	uint32_t const mask = _header->slot_count - 1;
+
+	for (uint32_t i = home_of(game_account_id); _slots[i].used; i = (i + 1) & mask) {
+		if (_slots[i].entry.game_account_id == game_account_id)
+			return i;
+	}
+
+	return -1;
+}
+
+bool SessionRegistry::place(session_registry_entry const &entry, bool replace)
+{
+	uint32_t const mask = _header->slot_count - 1;
+	uint32_t i = home_of(entry.game_account_id);
+
+	for (; _slots[i].used; i = (i + 1) & mask) {
+		if (_slots[i].entry.game_account_id != entry.game_account_id)
+			continue;
+
+		if (!replace)
+			return false;
+
+		_slots[i].entry = entry;
+		_header->writes++;
+		return true;
+	}
+
+	if (_header->size >= _header->capacity)
+		return false;
+
+	_slots[i].used = 1;
+	_slots[i].entry = entry;
+	_header->size++;
+	_header->writes++;
+	return true;
+}
+
+/**
+ * @brief Empties a slot and shifts the rest of its probe sequence back, so that lookups
+ * never need tombstones.
+ */
+void SessionRegistry::remove_slot(uint32_t index)
+{
+	uint32_t const mask = _header->slot_count - 1;
+	uint32_t hole = index;
+
+	for (uint32_t i = (hole + 1) & mask; _slots[i].used; i = (i + 1) & mask) {
+		uint32_t home = home_of(_slots[i].entry.game_account_id);
+
+		// Entries whose home lies cyclically in (hole, i] must stay behind the hole.
+		if (((i - home) & mask) >= ((i - hole) & mask)) {
+			_slots[hole] = _slots[i];
+			hole = i;
+		}
+	}
+
+	_slots[hole].used = 0;
+	_slots[hole].entry = session_registry_entry();
+	_header->size--;
+}
+
+uint32_t SessionRegistry::home_of(uint32_t game_account_id) const
+{
+	return (uint32_t) ((game_account_id * UINT32_C(2654435769)) >> _header->shift);
+}
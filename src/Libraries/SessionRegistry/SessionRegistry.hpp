@@ -0,0 +1,167 @@
+/***************************************************
+ *       _   _            _                        *
+ *      | | | |          (_)                       *
+ *      | |_| | ___  _ __ _ _______  _ __          *
+ *      |  _  |/ _ \| '__| |_  / _ \| '_  \        *
+ *      | | | | (_) | |  | |/ / (_) | | | |        *
+ *      \_| |_/\___/|_|  |_/___\___/|_| |_|        *
+ ***************************************************
+ * This file is part of Horizon (c).
+ *
+ * Copyright (c) 2019 Sagun K. (sagunxp@gmail.com).
+ * Copyright (c) 2019 Horizon Dev Team.
+ *
+ * Base Author - Sagun K. (sagunxp@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ **************************************************/
+
+#ifndef HORIZON_LIBRARIES_SESSIONREGISTRY_HPP
+#define HORIZON_LIBRARIES_SESSIONREGISTRY_HPP
+
+#include <boost/interprocess/interprocess_fwd.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define SESSION_REGISTRY_MAGIC 0x48535247 // "HSRG"
+#define SESSION_REGISTRY_VERSION 1
+
+/**
+ * @brief A row of the `session_data` table.
+ * current_server holds the same 'A', 'C' or 'Z' as the table.
+ */
+struct session_registry_entry
+{
+	uint32_t game_account_id{0};
+	uint32_t auth_code{0};
+	uint32_t client_version{0};
+	uint32_t character_slots{0};
+	uint32_t group_id{0};
+	uint8_t client_type{0};
+	char current_server{'A'};
+	int64_t connect_time{0};
+	int64_t last_update{0};
+};
+
+struct session_registry_statistics
+{
+	uint32_t capacity{0};
+	uint32_t size{0};
+	uint64_t lookups{0};
+	uint64_t hits{0};
+	uint64_t writes{0};
+	uint64_t expired{0};
+};
+
+namespace Horizon
+{
+namespace Libraries
+{
+/**
+ * @brief Table of the sessions of every connected account, shared by the auth, char and zone servers.
+ * Sessions are keyed by game account id in a fixed-capacity open addressing table.
+ * Shared registries live in a named shared memory segment, so servers on the same host see
+ * each other's writes without going through the database. The first server to open the segment
+ * creates it, it outlives the servers until the host restarts or remove() is called.
+ * Local registries keep the same table on the heap, as a stand-in for tests or for a server
+ * running on its own host.
+ * Every operation holds the registry's process-shared lock for a single probe sequence. A process
+ * that dies while holding it leaves the segment locked, remove() it to recover.
+ * @thread any
+ */
+class SessionRegistry
+{
+public:
+	SessionRegistry();
+	~SessionRegistry();
+
+	SessionRegistry(const SessionRegistry &other) = delete;
+	SessionRegistry &operator=(const SessionRegistry &other) = delete;
+
+	/**
+	 * @brief Opens the shared registry called name, creating it with room for capacity sessions
+	 * if it does not exist. An existing registry keeps the capacity it was created with.
+	 * The table is sized to stay at most half full, so probe sequences stay short.
+	 * @param[out] created set to true if this call created the registry.
+	 * @return false if the segment could not be created or has an incompatible layout.
+	 */
+	bool open_shared(std::string const &name, uint32_t capacity, bool *created = nullptr);
+	/**
+	 * @brief Creates an empty registry on the heap, private to this process.
+	 */
+	void open_local(uint32_t capacity);
+	/**
+	 * @brief Removes the shared registry called name. Processes that have it open keep using
+	 * their mapping, processes opening it later get a new, empty one.
+	 */
+	static bool remove(std::string const &name);
+
+	bool is_open() const { return _header != nullptr; }
+	bool is_shared() const { return _segment != nullptr; }
+
+	/**
+	 * @return false if the account already has a session or the registry is full.
+	 */
+	bool insert(session_registry_entry const &entry);
+	/**
+	 * @brief Inserts or replaces the session of an account.
+	 * @return false if the registry is full.
+	 */
+	bool upsert(session_registry_entry const &entry);
+	bool find(uint32_t game_account_id, session_registry_entry &entry);
+	bool erase(uint32_t game_account_id);
+
+	/**
+	 * @brief Moves the session of an account to another server.
+	 * @return false if the account has no session.
+	 */
+	bool set_current_server(uint32_t game_account_id, char current_server);
+	/**
+	 * @brief Refreshes the last update time of a session that is on current_server.
+	 * @return false if the account has no session or it is on another server.
+	 */
+	bool touch(uint32_t game_account_id, char current_server, int64_t now);
+
+	/**
+	 * @brief Removes the sessions on current_server that were last updated before older_than.
+	 * @return the game account ids of the removed sessions.
+	 */
+	std::vector<uint32_t> expire(char current_server, int64_t older_than);
+	uint32_t count(char current_server);
+
+	session_registry_statistics get_statistics();
+
+private:
+	struct registry_header;
+	struct registry_slot;
+
+	void initialize(uint32_t slot_count);
+	int64_t locate(uint32_t game_account_id) const;
+	bool place(session_registry_entry const &entry, bool replace);
+	void remove_slot(uint32_t index);
+	uint32_t home_of(uint32_t game_account_id) const;
+
+	std::unique_ptr<boost::interprocess::managed_shared_memory> _segment;
+	std::unique_ptr<registry_header> _local_header;
+	std::unique_ptr<registry_slot[]> _local_slots;
+	registry_header *_header{nullptr};
+	registry_slot *_slots{nullptr};
+};
+}
+}
+
+#endif /* HORIZON_LIBRARIES_SESSIONREGISTRY_HPP */
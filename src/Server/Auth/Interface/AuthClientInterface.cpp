@@ -93,9 +93,17 @@ bool AuthClientInterface::process_login(std::string username, std::string passwo
 				uint32_t aid = last_insert_id;
 				acal.deliver(aid, aid, 0, gender);
 
-				sAuth->get_db_connection()->sql("REPLACE INTO `session_data` (`auth_code`, `game_account_id`, `client_version`, `client_type`, `character_slots`, `group_id`, `connect_time`, `current_server`) VALUES (?, ?, ?, ?, ?, ?, ?, ?);")
-					.bind(last_insert_id, aid, PACKET_VERSION, client_type, 3, 0, std::time(nullptr), "A")
-					.execute();
+				session_registry_entry session;
+				session.auth_code = last_insert_id;
+				session.game_account_id = aid;
+				session.client_version = PACKET_VERSION;
+				session.client_type = client_type;
+				session.character_slots = 3;
+				session.group_id = 0;
+				session.connect_time = std::time(nullptr);
+				session.current_server = 'A';
+
+				sAuth->session_store().replace(session);
 
 				HLog(info) << "Session (" << aid << ") has been initiated.";
 				HLog(info) << "Request for authorization of account '" << username << "' (" << aid << ")" << " has been granted.";
@@ -140,23 +148,23 @@ bool AuthClientInterface::process_login(std::string username, std::string passwo
 			return false;
 		}
 
-		mysqlx::RowResult rr2 = sAuth->get_db_connection()->sql("SELECT * FROM `session_data` WHERE `game_account_id` = ?")
-			.bind(aid)
-			.execute();
-
-		mysqlx::Row r3 = rr2.fetchOne();
-
-		if (!r3.isNull()) {
+		session_registry_entry session;
+		session.auth_code = aid;
+		session.game_account_id = aid;
+		session.client_version = PACKET_VERSION;
+		session.client_type = client_type;
+		session.character_slots = 3;
+		session.group_id = 0;
+		session.connect_time = std::time(nullptr);
+		session.current_server = 'A';
+
+		// Fails if the account already has a session on any server.
+		if (!sAuth->session_store().create(session)) {
 			acrl.deliver(login_error_codes::ERR_SESSION_CONNECTED, block_date, 0);
 			return false;
 		}
-		else {
-			sAuth->get_db_connection()->sql("INSERT INTO `session_data` (`auth_code`, `game_account_id`, `client_version`, `client_type`, `character_slots`, `group_id`, `connect_time`, `current_server`) VALUES (?, ?, ?, ?, ?, ?, ?, ?)")
-				.bind(aid, aid, PACKET_VERSION, client_type, 3, 0, std::time(nullptr), "A")
-				.execute();
 
-			HLog(info) << "Session (" << aid << ") has been initiated.";
-		}
+		HLog(info) << "Session (" << aid << ") has been initiated.";
 
 		acal.deliver(aid, aid, group_id, gender);
 
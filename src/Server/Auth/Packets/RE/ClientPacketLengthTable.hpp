@@ -40,11 +40,24 @@ namespace Auth
 class ClientPacketLengthTable : public PacketLengthTable
 {
 public:
-	ClientPacketLengthTable(std::shared_ptr<AuthSession> s)
-	: PacketLengthTable(s)
+	/**
+	 * @brief Retrieves the process-wide packet length table for the
+	 * compiled PACKET_VERSION, constructing it on first use.
+	 */
+	static ClientPacketLengthTable const &get_instance()
 	{
-#define ADD_HPKT(i, j, k) _hpacket_length_table.insert(i, std::make_pair(j, std::make_shared<k>(s)))
-#define ADD_TPKT(i, j, k) _tpacket_length_table.insert(i, std::make_pair(j, std::make_shared<k>(s)))
+		static ClientPacketLengthTable instance;
+		return instance;
+	}
+
+	~ClientPacketLengthTable() { }
+
+private:
+	ClientPacketLengthTable()
+	: PacketLengthTable()
+	{
+#define ADD_HPKT(i, j, k) add_hpacket(i, j, &create_hpacket_handler<k>)
+#define ADD_TPKT(i, j, k) add_tpacket(i, j)
 // Packet Version 20090701: 1 Packets
 #if PACKET_VERSION >= 20090701
 		ADD_TPKT(0x0276, -1, AC_ACCEPT_LOGIN2);
@@ -125,9 +138,6 @@ public:
 #undef ADD_TPKT
 #undef ADD_HPKT
 	}
-
-	~ClientPacketLengthTable() { }
-
 };
 }
 }
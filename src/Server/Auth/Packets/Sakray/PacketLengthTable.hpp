@@ -28,29 +28,42 @@
 #ifndef HORIZON_AUTH_SAKRAY_PACKET_LENGTH_TABLE
 #define HORIZON_AUTH_SAKRAY_PACKET_LENGTH_TABLE
 
-#include "Core/Multithreading/LockedLookupTable.hpp"
 #include "Server/Auth/Packets/HandledPackets.hpp"
 #include "Server/Auth/Packets/TransmittedPackets.hpp"
 
+#include <array>
+#include <memory>
+
 namespace Horizon
 {
 namespace Auth
 {
 	typedef std::shared_ptr<Base::NetworkPacketHandler<AuthSession>> HPacketStructPtrType;
-	typedef std::shared_ptr<Base::NetworkPacketTransmitter<AuthSession>> TPacketStructPtrType;
-	typedef std::pair<int16_t, HPacketStructPtrType> HPacketTablePairType;
-	typedef std::pair<int16_t, TPacketStructPtrType> TPacketTablePairType;
+	typedef HPacketStructPtrType (*HPacketFactoryType)(std::shared_ptr<AuthSession>);
+
+/**
+ * @brief Instantiates a handler of the given type for a session.
+ * Stored by address in the packet length table so that handlers are only
+ * constructed when a session first receives the corresponding packet.
+ */
+template <class HandlerType>
+HPacketStructPtrType create_hpacket_handler(std::shared_ptr<AuthSession> s) { return std::make_shared<HandlerType>(s); }
+
 /**
  * @brief Auto-generated with a python generator tool authored by Sephus (sagunxp@gmail.com).
+ * Packet lengths and handler factories are stored in flat arrays indexed by packet id.
+ * A single instance is shared by all sessions and is never modified after construction.
  */
 class PacketLengthTable
 {
 public:
-	PacketLengthTable(std::shared_ptr<AuthSession> s)
-	: _session(s)
+	PacketLengthTable()
 	{
-#define ADD_HPKT(i, j, k) _hpacket_length_table.insert(i, std::make_pair(j, std::make_shared<k>(s)))
-#define ADD_TPKT(i, j, k) _tpacket_length_table.insert(i, std::make_pair(j, std::make_shared<k>(s)))
+		_hpacket_length_table.fill(0);
+		_hpacket_factory_table.fill(nullptr);
+		_tpacket_length_table.fill(0);
+#define ADD_HPKT(i, j, k) add_hpacket(i, j, &create_hpacket_handler<k>)
+#define ADD_TPKT(i, j, k) add_tpacket(i, j)
 		ADD_TPKT(0x0069, -1, AC_ACCEPT_LOGIN);
 		ADD_TPKT(0x01dc, -1, AC_ACK_HASH);
 		ADD_TPKT(0x01be, 2, AC_ASK_PNGAMEROOM);
@@ -65,16 +78,31 @@ public:
 
 	~PacketLengthTable() { }
 
-	std::shared_ptr<AuthSession> get_session() { return _session.lock(); }
+	int16_t get_hpacket_length(uint16_t packet_id) const { return _hpacket_length_table[packet_id]; }
+	int16_t get_tpacket_length(uint16_t packet_id) const { return _tpacket_length_table[packet_id]; }
 
-	HPacketTablePairType get_hpacket_info(uint16_t packet_id) { return _hpacket_length_table.at(packet_id); }
-	TPacketTablePairType get_tpacket_info(uint16_t packet_id) { return _tpacket_length_table.at(packet_id); }
+	/**
+	 * @brief Creates a new handler instance for the packet id.
+	 * @return shared_ptr to the handler, or nullptr if the packet id is not handled.
+	 */
+	HPacketStructPtrType create_handler(uint16_t packet_id, std::shared_ptr<AuthSession> s) const
+	{
+		HPacketFactoryType factory = _hpacket_factory_table[packet_id];
+		return factory != nullptr ? factory(s) : nullptr;
+	}
 
 protected:
-	LockedLookupTable<uint16_t, HPacketTablePairType> _hpacket_length_table;
-	LockedLookupTable<uint16_t, TPacketTablePairType> _tpacket_length_table;
-	std::weak_ptr<AuthSession> _session;
+	void add_hpacket(uint16_t packet_id, int16_t length, HPacketFactoryType factory)
+	{
+		_hpacket_length_table[packet_id] = length;
+		_hpacket_factory_table[packet_id] = factory;
+	}
+
+	void add_tpacket(uint16_t packet_id, int16_t length) { _tpacket_length_table[packet_id] = length; }
 
+	std::array<int16_t, 0x10000> _hpacket_length_table;
+	std::array<HPacketFactoryType, 0x10000> _hpacket_factory_table;
+	std::array<int16_t, 0x10000> _tpacket_length_table;
 };
 }
 }
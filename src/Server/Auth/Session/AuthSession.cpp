@@ -47,7 +47,6 @@ AuthSession::~AuthSession()
 
 void AuthSession::initialize()
 {
-	_pkt_tbl = std::make_unique<ClientPacketLengthTable>(shared_from_this());
 	_clif = std::make_unique<AuthClientInterface>(shared_from_this());
 }
 
@@ -62,12 +61,12 @@ void AuthSession::transmit_buffer(ByteBuffer _buffer, std::size_t size)
 		
 		memcpy(&packet_id, _buffer.get_read_pointer(), sizeof(int16_t));
 
-		TPacketTablePairType p = _pkt_tbl->get_tpacket_info(packet_id);
+		int16_t table_len = ClientPacketLengthTable::get_instance().get_tpacket_length(packet_id);
 		
-		if (p.first == -1) {
+		if (table_len == -1) {
 			memcpy(&packet_len, _buffer.get_read_pointer() + 2, sizeof(int16_t));
 		} else {
-			packet_len = p.first;
+			packet_len = table_len;
 		}
 
 		if (packet_len != _buffer.active_length()) {
@@ -79,13 +78,38 @@ void AuthSession::transmit_buffer(ByteBuffer _buffer, std::size_t size)
 	}
 }
 
-void AuthSession::update(uint32_t /*diff*/)
+void AuthSession::update(uint64_t /*diff*/)
 {
-	std::shared_ptr<ByteBuffer> read_buf;
-	while ((read_buf = get_socket()->_buffer_recv_queue.try_pop())) {
+	ByteBuffer read_buf;
+	while (get_socket()->_buffer_recv_queue.try_pop(read_buf)) {
 		uint16_t packet_id = 0x0;
-		memcpy(&packet_id, read_buf->get_read_pointer(), sizeof(uint16_t));
-		HPacketTablePairType p = _pkt_tbl->get_hpacket_info(packet_id);
-		p.second->handle(std::move(*read_buf));
+		memcpy(&packet_id, read_buf.get_read_pointer(), sizeof(uint16_t));
+		HPacketStructPtrType handler = get_packet_handler(packet_id);
+
+		if (handler == nullptr) {
+			HLog(warning) << "Received packet 0x" << std::hex << packet_id << " without a handler, ignoring...";
+			continue;
+		}
+
+		handler->handle(std::move(read_buf));
 	}
 }
+
+/**
+ * @brief Retrieves the handler for a packet, instantiating it on first receipt.
+ * @thread called from main thread.
+ */
+HPacketStructPtrType AuthSession::get_packet_handler(uint16_t packet_id)
+{
+	auto it = _packet_handlers.find(packet_id);
+
+	if (it != _packet_handlers.end())
+		return it->second;
+
+	HPacketStructPtrType handler = ClientPacketLengthTable::get_instance().create_handler(packet_id, shared_from_this());
+
+	if (handler != nullptr)
+		_packet_handlers.emplace(packet_id, handler);
+
+	return handler;
+}
@@ -33,6 +33,7 @@
 #include "Libraries/Networking/Session.hpp"
 
 #include <memory>
+#include <unordered_map>
 
 #if CLIENT_TYPE == 'S'
 #include "Server/Auth/Packets/Sakray/ClientPacketLengthTable.hpp"
@@ -60,16 +61,17 @@ public:
 
 	/* */
 	void initialize();
-	void update(uint32_t diff);
+	void update(uint64_t diff);
+
+	HPacketStructPtrType get_packet_handler(uint16_t packet_id);
 	
 	std::unique_ptr<AuthClientInterface> &clif() { return _clif; }
-	std::unique_ptr<ClientPacketLengthTable> &pkt_tbl() { return _pkt_tbl; }
 	
 	void transmit_buffer(ByteBuffer _buffer, std::size_t size);
 	
 private:
 	std::unique_ptr<AuthClientInterface> _clif;
-	std::unique_ptr<ClientPacketLengthTable> _pkt_tbl;
+	std::unordered_map<uint16_t, HPacketStructPtrType> _packet_handlers; ///< Handlers instantiated on first receipt of their packet.
 };
 }
 }
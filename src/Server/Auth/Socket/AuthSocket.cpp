@@ -110,18 +110,23 @@ bool AuthSocket::update()
  */
 void AuthSocket::read_handler()
 {
-	while (get_read_buffer().active_length()) {
+	while (get_read_buffer().active_length() >= sizeof(uint16_t)) {
 		uint16_t packet_id = 0x0;
 		memcpy(&packet_id, get_read_buffer().get_read_pointer(), sizeof(uint16_t));
 		
-		HPacketTablePairType p = get_session()->pkt_tbl()->get_hpacket_info(packet_id);
-		
-		int16_t packet_length = p.first;
+		int16_t packet_length = ClientPacketLengthTable::get_instance().get_hpacket_length(packet_id);
 		
 		if (packet_length == -1) {
+			// Wait for the length field of variable-length packets.
+			if (get_read_buffer().active_length() < sizeof(uint16_t) + sizeof(int16_t))
+				break;
+
 			memcpy(&packet_length, get_read_buffer().get_read_pointer() + 2, sizeof(int16_t));
-			if (get_read_buffer().active_length() < packet_length) {
-				HLog(debug) << "Received packet 0x" << packet_id << " has expected length " << packet_length << " but buffer only supplied " << get_read_buffer().active_length() << " from client.";
+
+			if (packet_length < (int16_t) (sizeof(uint16_t) + sizeof(int16_t))) {
+				HLog(warning) << "Received packet 0x" << std::hex << packet_id << " with invalid length " << std::dec << packet_length << ", disconnecting session...";
+				get_read_buffer().read_completed(get_read_buffer().active_length());
+				close_socket();
 				break;
 			}
 		} else if (packet_length == 0) {
@@ -131,10 +136,14 @@ void AuthSocket::read_handler()
 			break;
 		}
 		
-		ByteBuffer b;
-		b.append(get_read_buffer().get_read_pointer(), packet_length);
-		get_recv_queue().push(std::move(b));
-		get_read_buffer().read_completed(packet_length);
+		if (get_read_buffer().active_length() < (size_t) packet_length) {
+			HLogSys(LOG_NETWORK, debug) << "Received packet 0x" << packet_id << " has expected length " << packet_length << " but buffer only supplied " << get_read_buffer().active_length() << " from client.";
+			break;
+		}
+
+		// The session receives a view of the packet within the read buffer, no copy is made.
+		if (!push_recv_buffer(get_read_buffer().slice(packet_length)))
+			break;
 	}
 }
 
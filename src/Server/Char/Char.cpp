@@ -195,31 +195,12 @@ void SignalHandler(const boost::system::error_code &error, int /*signal*/)
 
 void CharServer::verify_connected_sessions()
 {
-	try {
-		sChar->get_db_connection()->sql("DELETE FROM `session_data` WHERE `current_server` = ? AND `last_update` < ?")
-			.bind("C", std::time(nullptr) - config().session_max_timeout())
-			.execute();
-
-		mysqlx::RowResult rr = sChar->get_db_connection()->sql("SELECT COUNT(`game_account_id`) FROM `session_data` WHERE `current_server` = ?")
-			.bind("C")
-			.execute();
-
-		mysqlx::Row r = rr.fetchOne();
-		if (r.isNull()) {
-			HLog(info) << "There are no connected session(s).";
-			return;
-		}
+	uint32_t expired = session_store().expire('C', config().session_max_timeout());
 
-		int32_t count = r[0].get<int>();
+	if (expired > 0)
+		HLog(info) << expired << " session(s) timed out.";
 
-		HLog(info) << count << " connected session(s).";
-	}
-	catch (mysqlx::Error& error) {
-		HLog(error) << error.what();
-	}
-	catch (std::exception& error) {
-		HLog(error) << error.what();
-	}
+	HLog(info) << session_store().count('C') << " connected session(s).";
 }
 
 void CharServer::update(uint64_t time)
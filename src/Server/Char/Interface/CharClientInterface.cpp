@@ -52,15 +52,13 @@ bool CharClientInterface::authorize_new_connection(uint32_t account_id, uint32_t
 	HLog(warning) << "A new connection has been established from I.P. " << get_session()->get_socket()->remote_ip_address();
 	
 	try {
-		mysqlx::RowResult rr = sChar->get_db_connection()->sql("SELECT * FROM `session_data` WHERE `game_account_id` = ?")
-			.bind(account_id)
-			.execute();
-		mysqlx::Row r = rr.fetchOne();
+		session_registry_entry session;
+		bool has_session = sChar->session_store().find(account_id, session);
 
 		HC_ACCOUNT_ID hcad(get_session()); // first packet sent no matter what.
 		hcad.deliver(account_id);
 
-		if (r.isNull()) {
+		if (!has_session) {
 			HC_REFUSE_ENTER pkt(get_session());
 			HLog(warning) << "Invalid connection for account with ID " << account_id << ", session wasn't found.";
 			pkt.deliver(CHAR_ERR_REJECTED_FROM_SERVER);
@@ -115,9 +113,7 @@ bool CharClientInterface::authorize_new_connection(uint32_t account_id, uint32_t
 				hcspl.deliver(PINCODE_REQUEST_PIN);
 		}
 
-		sChar->get_db_connection()->sql("UPDATE `session_data` SET `current_server` = 'C' WHERE `game_account_id` = ?")
-			.bind(account_id)
-			.execute();
+		sChar->session_store().set_current_server(account_id, 'C');
 	}
 	catch (mysqlx::Error& err) {
 		HLog(error) << "CharClientInterface::authorize_new_connection:" << err.what();
@@ -575,37 +571,12 @@ bool CharClientInterface::update_session(int32_t account_id)
 {
 	HLog(debug) << "Updating session from I.P. address " << get_session()->get_socket()->remote_ip_address();
 	
-	try {
-		mysqlx::RowResult rr = sChar->get_db_connection()->sql("SELECT * FROM `session_data` WHERE `game_account_id` = ?")
-			.bind(account_id)
-			.execute();
-		mysqlx::Row r = rr.fetchOne();
-
-		if (r.isNull()) {
-			HC_REFUSE_ENTER pkt(get_session());
-			HLog(warning) << "Invalid connection for account with ID " << account_id << ", session wasn't found.";
-			pkt.deliver(CHAR_ERR_REJECTED_FROM_SERVER);
-			return false;
-		}
-
-		std::string current_server = r[7].get<std::string>();
-
-		if (current_server.compare("C") != 0) {
-			HC_REFUSE_ENTER pkt(get_session());
-			HLog(warning) << "Invalid connection for account with ID " << account_id << ", session wasn't found.";
-			pkt.deliver(CHAR_ERR_REJECTED_FROM_SERVER);
-			return false;
-		}
-
-		sChar->get_db_connection()->sql("UPDATE `session_data` SET `last_update` = ? WHERE `game_account_id` = ?")
-			.bind(std::time(nullptr), account_id)
-			.execute();
-	}
-	catch (mysqlx::Error& err) {
-		HLog(error) << "CharClientInterface::update_session:" << err.what();
-	}
-	catch (std::exception& err) {
-		HLog(error) << "CharClientInterface::update_session:" << err.what();
+	// Refreshes the session only if it exists and is on this server.
+	if (!sChar->session_store().touch(account_id, 'C', std::time(nullptr))) {
+		HC_REFUSE_ENTER pkt(get_session());
+		HLog(warning) << "Invalid connection for account with ID " << account_id << ", session wasn't found.";
+		pkt.deliver(CHAR_ERR_REJECTED_FROM_SERVER);
+		return false;
 	}
 
 	return true;
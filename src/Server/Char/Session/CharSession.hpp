@@ -33,6 +33,7 @@
 #include "Server/Char/Interface/CharClientInterface.hpp"
 
 #include <memory>
+#include <unordered_map>
 #include <chrono>
 #include <mutex>
 
@@ -70,12 +71,13 @@ public:
 	~CharSession();
 
 	void initialize();
-	void update(uint32_t diff);
+	void update(uint64_t diff);
+
+	HPacketStructPtrType get_packet_handler(uint16_t packet_id);
 
 	void perform_cleanup();
 	
 	std::unique_ptr<CharClientInterface> &clif() { return _clif; }
-	std::unique_ptr<ClientPacketLengthTable> &pkt_tbl() { return _pkt_tbl; }
 	
 	s_session_data &get_session_data() { std::lock_guard<std::mutex> lock(_sd_mutex); return _session_data; }
 	void set_session_data(s_session_data &data) { std::lock_guard<std::mutex> lock(_sd_mutex); _session_data = data; }
@@ -85,7 +87,7 @@ public:
 
 protected:
 	std::unique_ptr<CharClientInterface> _clif;
-	std::unique_ptr<ClientPacketLengthTable> _pkt_tbl;
+	std::unordered_map<uint16_t, HPacketStructPtrType> _packet_handlers; ///< Handlers instantiated on first receipt of their packet.
 	s_session_data _session_data;
 	std::mutex _sd_mutex;
 	bool _first_packet_sent{false};
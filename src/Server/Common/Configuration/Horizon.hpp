@@ -60,12 +60,60 @@
 // Time in Microseconds (µs)
 #define MAX_CORE_UPDATE_INTERVAL 5000
 
-// Map Thread Containers
-#define MAX_MAP_CONTAINER_THREADS 1
+// Zone network threads and map thread containers, 0 for one per hardware thread.
+// Overridden by 'network_threads' and 'map_container_threads' in the zone configuration.
+#define DEFAULT_ZONE_NETWORK_THREADS 0
+#define DEFAULT_MAP_CONTAINER_THREADS 0
+
+// Load weight of a map without a hint in map_list.lua, added to its monster spawn count
+// when distributing maps between map containers.
+#define MAP_CONTAINER_BASE_MAP_WEIGHT 10
+
+// Map container ticks per second, overridden by 'map_container_tick_rate' in the zone configuration.
+// Once MAP_CONTAINER_SHED_AFTER_OVERRUNS ticks in a row overrun their budget, sessions handle at most
+// MAP_CONTAINER_SHED_PACKET_BUDGET packets per tick until a tick completes in time again.
+// Overruns are reported at most every MAP_CONTAINER_OVERRUN_WARNING_INTERVAL seconds.
+#define DEFAULT_MAP_CONTAINER_TICK_RATE 200
+#define MAP_CONTAINER_SHED_AFTER_OVERRUNS 3
+#define MAP_CONTAINER_SHED_PACKET_BUDGET 8
+#define MAP_CONTAINER_OVERRUN_WARNING_INTERVAL 10
+
+// Seconds of map updates summed up into a map's tick cost sample, used to rebalance map containers.
+#define MAP_TICK_COST_SAMPLE_INTERVAL 1
+
+// Map containers are rebalanced when the average tick of the busiest one is above MAP_REBALANCE_MIN_TICK_US
+// and at least MAP_REBALANCE_IMBALANCE_PERCENT percent of the idlest one's. Maps moved by the rebalancer
+// are left in place for MAP_REBALANCE_COOLDOWN seconds.
+// The rebalancer runs every 'map_rebalance_interval' seconds of the zone configuration, 0 disables it.
+#define DEFAULT_MAP_REBALANCE_INTERVAL 60
+#define MAP_REBALANCE_MIN_TICK_US 2000
+#define MAP_REBALANCE_IMBALANCE_PERCENT 150
+#define MAP_REBALANCE_COOLDOWN 300
 
 // Mob searches active path when selecting target.
 #define ACTIVE_PATH_SEARCH 1
 
+// Default maximum number of cells expanded by a single path search, 0 for no limit.
+// Overridden by 'path_search_step_limit' in the zone configuration.
+#define DEFAULT_PATH_SEARCH_STEP_LIMIT 2048
+
+// Database workers writing player saves and the number of saves per transaction.
+// Overridden by 'persistence_threads' and 'persistence_batch_size' in the zone configuration.
+#define DEFAULT_PERSISTENCE_THREADS 2
+#define DEFAULT_PERSISTENCE_BATCH_SIZE 32
+
+// Database workers loading characters entering the zone and the logins loaded at once, 0 for no limit.
+// Overridden by 'login_threads' and 'max_concurrent_logins' in the zone configuration.
+#define DEFAULT_LOGIN_THREADS 2
+#define DEFAULT_MAX_CONCURRENT_LOGINS 32
+
+// Shared memory registry holding the sessions of every server on the host, the sessions it can hold,
+// and the milliseconds between two writes of its changes to `session_data`.
+// Overridden by the 'session_registry' table in each server's configuration.
+#define DEFAULT_SESSION_REGISTRY_NAME "horizon_sessions"
+#define DEFAULT_SESSION_REGISTRY_CAPACITY 16384
+#define DEFAULT_SESSION_WRITE_INTERVAL 100
+
 static_assert(MAX_LEVEL > 0,
               "MAX_LEVEL should be greater than 0.");
 static_assert(MAX_CHARACTER_SLOTS % 3 == 0,
@@ -83,8 +131,14 @@ static_assert(MAX_NETWORK_THREADS > 0,
 static_assert(MAX_CORE_UPDATE_INTERVAL >= 500,
             "MAX_CORE_UPDATE_INTERVAL should be greater than or equal to 500 microseconds (µs).");
 
-static_assert(MAX_MAP_CONTAINER_THREADS > 0,
-            "MAX_MAP_CONTAINER_THREADS cannot be less than or equal to 0.");
+static_assert(DEFAULT_ZONE_NETWORK_THREADS >= 0 && DEFAULT_MAP_CONTAINER_THREADS >= 0,
+            "DEFAULT_ZONE_NETWORK_THREADS and DEFAULT_MAP_CONTAINER_THREADS cannot be negative.");
+
+static_assert(DEFAULT_MAP_CONTAINER_TICK_RATE > 0 && DEFAULT_MAP_CONTAINER_TICK_RATE <= 1000,
+            "DEFAULT_MAP_CONTAINER_TICK_RATE must be between 1 and 1000 ticks per second.");
+
+static_assert(MAP_CONTAINER_BASE_MAP_WEIGHT > 0,
+            "MAP_CONTAINER_BASE_MAP_WEIGHT must be greater than 0.");
 
 #include "Client.hpp"
 
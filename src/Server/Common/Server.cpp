@@ -139,6 +139,25 @@ bool Server::parse_common_configs(sol::table &tbl)
 		return false;
 	}
 
+	sol::optional<sol::table> log_tbl = tbl.get<sol::optional<sol::table>>("log");
+
+	if (log_tbl)
+		Logger::getInstance()->set_ring_capacity(log_tbl->get_or<std::size_t>("ring_capacity", LOG_RING_CAPACITY));
+
+	sol::optional<sol::table> session_tbl = tbl.get<sol::optional<sol::table>>("session_registry");
+	std::string registry_name = DEFAULT_SESSION_REGISTRY_NAME;
+	uint32_t registry_capacity = DEFAULT_SESSION_REGISTRY_CAPACITY;
+	int write_interval = DEFAULT_SESSION_WRITE_INTERVAL;
+
+	if (session_tbl) {
+		registry_name = session_tbl->get_or<std::string>("name", DEFAULT_SESSION_REGISTRY_NAME);
+		registry_capacity = session_tbl->get_or("capacity", DEFAULT_SESSION_REGISTRY_CAPACITY);
+		write_interval = session_tbl->get_or("write_interval", DEFAULT_SESSION_WRITE_INTERVAL);
+	}
+
+	if (!_session_store.initialize(general_conf(), _mysql_connection, registry_name, registry_capacity, write_interval))
+		return false;
+
 	return true;
 }
 
@@ -162,9 +181,86 @@ bool Server::clicmd_shutdown(std::string /*cmd*/)
 	return true;
 }
 
+/**
+ * @brief Prints ByteBuffer allocation counters and their rates since the previous invocation.
+ */
+bool Server::clicmd_buffer_stats(std::string /*cmd*/)
+{
+	bytebuffer_pool_statistics stats = ByteBufferPool::get_statistics();
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	double seconds = std::chrono::duration<double>(now - _last_buffer_stats_time).count();
+
+	if (seconds <= 0)
+		seconds = 1;
+
+	HLog(info) << "ByteBuffer statistics over the last " << seconds << " seconds:";
+	HLog(info) << "  Inline buffers: " << stats.inline_buffers << " (" << (stats.inline_buffers - _last_buffer_stats.inline_buffers) / seconds << "/s)";
+	HLog(info) << "  Pool hits: " << stats.pool_hits << " (" << (stats.pool_hits - _last_buffer_stats.pool_hits) / seconds << "/s)";
+	HLog(info) << "  Depot refills: " << stats.depot_refills << " (" << (stats.depot_refills - _last_buffer_stats.depot_refills) / seconds << "/s)";
+	HLog(info) << "  System allocations: " << stats.system_allocations << " (" << (stats.system_allocations - _last_buffer_stats.system_allocations) / seconds << "/s)";
+	HLog(info) << "  System frees: " << stats.system_frees << " (" << (stats.system_frees - _last_buffer_stats.system_frees) / seconds << "/s)";
+
+	_last_buffer_stats = stats;
+	_last_buffer_stats_time = now;
+
+	return true;
+}
+
+/**
+ * @brief Shows the runtime log level of every subsystem, or sets one with 'log-level <subsystem> <level>'.
+ */
+bool Server::clicmd_log_level(std::string cmd)
+{
+	std::vector<std::string> args;
+	boost::algorithm::split(args, cmd, boost::algorithm::is_any_of(" "), boost::algorithm::token_compress_on);
+
+	if (args.size() < 3) {
+		for (int i = 0; i < LOG_SUBSYSTEM_MAX; i++)
+			HLog(info) << "Log level of '" << Logger::subsystem_name((log_subsystem) i) << "': " << Logger::getInstance()->get_level((log_subsystem) i) << ".";
+		return true;
+	}
+
+	log_subsystem subsystem;
+	boost::log::trivial::severity_level level;
+
+	if (!Logger::parse_subsystem(args[1], subsystem)) {
+		HLog(error) << "Unknown log subsystem '" << args[1] << "'.";
+		return false;
+	}
+
+	if (!boost::log::trivial::from_string(args[2].c_str(), args[2].size(), level)) {
+		HLog(error) << "Unknown log level '" << args[2] << "'.";
+		return false;
+	}
+
+	Logger::getInstance()->set_level(subsystem, level);
+
+	HLog(info) << "Log level of '" << args[1] << "' set to " << level << ".";
+
+	return true;
+}
+
+/**
+ * @brief Shows the size of the session registry and the progress of its writes to the database.
+ */
+bool Server::clicmd_session_stats(std::string /*cmd*/)
+{
+	session_store_statistics stats = _session_store.get_statistics();
+
+	HLog(info) << "Session registry" << (stats.registry.capacity > 0 ? "" : " (closed)") << " - sessions: " << stats.registry.size << "/" << stats.registry.capacity
+		<< ", lookups: " << stats.registry.lookups << " (" << stats.registry.hits << " hits), writes: " << stats.registry.writes
+		<< ", expired: " << stats.registry.expired << ".";
+	HLog(info) << "Session writer - pending: " << stats.pending << ", written: " << stats.written << ", failed flushes: " << stats.failed << ", lookups from the table: " << stats.fallbacks << ".";
+
+	return true;
+}
+
 void Server::initialize_cli_commands()
 {
 	add_cli_command_func("shutdown", std::bind(&Server::clicmd_shutdown, this, std::placeholders::_1));
+	add_cli_command_func("buffer-stats", std::bind(&Server::clicmd_buffer_stats, this, std::placeholders::_1));
+	add_cli_command_func("log-level", std::bind(&Server::clicmd_log_level, this, std::placeholders::_1));
+	add_cli_command_func("session-stats", std::bind(&Server::clicmd_session_stats, this, std::placeholders::_1));
 }
 
 void Server::process_cli_commands()
@@ -201,6 +297,12 @@ void Server::finalize_core()
 {
 	if (_cli_thread.joinable())
 		_cli_thread.join();
+
+	// Writes the session changes still pending to the database.
+	_session_store.finalize();
+
+	// Write out everything still queued for the log thread.
+	Logger::getInstance()->finalize();
 }
 
 boost::asio::io_service &Server::get_io_service()
@@ -31,6 +31,10 @@
 #define HORIZON_SERVER_HPP
 
 #include "CLI/CLICommand.hpp"
+#include "SessionStore/SessionStore.hpp"
+#include "Libraries/Networking/Buffer/ByteBufferPool.hpp"
+
+#include <chrono>
 
 using boost::asio::ip::tcp;
 
@@ -86,8 +90,14 @@ public:
 	 * CLI Commands
 	 */
 	bool clicmd_shutdown(std::string /*cmd*/);
+	bool clicmd_buffer_stats(std::string /*cmd*/);
+	bool clicmd_log_level(std::string cmd);
+	bool clicmd_session_stats(std::string cmd);
     
 	std::shared_ptr<mysqlx::Session> get_db_connection() { return _mysql_connection; }
+
+	/* Sessions shared with the other servers */
+	SessionStore &session_store() { return _session_store; }
     
 protected:
 	/* General Configuration */
@@ -99,6 +109,9 @@ protected:
 	std::atomic<int> _shutdown_signal;
 	std::unordered_map<std::string, std::function<bool(std::string)>> _cli_function_map;
 	std::shared_ptr<mysqlx::Session> _mysql_connection;
+	SessionStore _session_store;
+	bytebuffer_pool_statistics _last_buffer_stats;
+	std::chrono::steady_clock::time_point _last_buffer_stats_time{std::chrono::steady_clock::now()};
     
 	/**
 	 * Core IO Service
@@ -0,0 +1,381 @@
+/***************************************************
+ *       _   _            _                        *
+ *      | | | |          (_)                       *
+ *      | |_| | ___  _ __ _ _______  _ __          *
+ *      |  _  |/ _ \| '__| |_  / _ \| '_  \        *
+ *      | | | | (_) | |  | |/ / (_) | | | |        *
+ *      \_| |_/\___/|_|  |_/___\___/|_| |_|        *
+ ***************************************************
+ * This file is part of Horizon (c).
+ *
+ * Copyright (c) 2019 Sagun K. (sagunxp@gmail.com).
+ * Copyright (c) 2019 Horizon Dev Team.
+ *
+ * Base Author - Sagun K. (sagunxp@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ **************************************************/
+
+#include "SessionStore.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+
+using namespace Horizon::Libraries;
+
+SessionStore::SessionStore()
+{
+}
+
+SessionStore::~SessionStore()
+{
+}
+
+bool SessionStore::initialize(general_server_configuration const &conf, std::shared_ptr<mysqlx::Session> connection,
+	std::string const &registry_name, uint32_t capacity, int flush_interval)
+{
+	bool created = true;
+
+	_conf = conf;
+	_flush_interval = std::max(flush_interval, 1);
+
+	if (registry_name.empty()) {
+		_registry.open_local(capacity);
+		HLog(info) << "Sessions are kept in a registry private to this server.";
+	} else if (_registry.open_shared(registry_name, capacity, &created)) {
+		HLog(info) << (created ? "Created" : "Opened") << " the shared session registry '" << registry_name << "' for "
+			<< _registry.get_statistics().capacity << " sessions.";
+	} else {
+		_registry.open_local(capacity);
+		HLog(error) << "Could not open the shared session registry '" << registry_name << "', sessions are kept in a registry private to this server.";
+	}
+
+	// A new registry starts with the sessions a previous run left in the table.
+	if (created) {
+		try {
+			warm(*connection);
+		}
+		catch (std::exception &error) {
+			HLogSys(LOG_DATABASE, error) << "SessionStore::initialize: " << error.what();
+			return false;
+		}
+	}
+
+	try {
+		_connection = connect();
+	}
+	catch (std::exception &error) {
+		HLogSys(LOG_DATABASE, warning) << "SessionStore::initialize: " << error.what() << ", the session writer will keep trying to connect.";
+	}
+
+	_running.exchange(true);
+	_writer = std::thread([this] () { run(); });
+
+	return true;
+}
+
+void SessionStore::finalize()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mtx);
+		_running.exchange(false);
+	}
+	_cv.notify_all();
+
+	if (_writer.joinable())
+		_writer.join();
+
+	HLogSys(LOG_DATABASE, info) << "Session writer has shut down after writing " << _written.load() << " session(s).";
+}
+
+bool SessionStore::create(session_registry_entry const &entry)
+{
+	if (!_registry.insert(entry))
+		return false;
+
+	mark(entry.game_account_id);
+	return true;
+}
+
+bool SessionStore::replace(session_registry_entry const &entry)
+{
+	if (!_registry.upsert(entry))
+		return false;
+
+	mark(entry.game_account_id);
+	return true;
+}
+
+bool SessionStore::find(uint32_t game_account_id, session_registry_entry &entry)
+{
+	if (_registry.find(game_account_id, entry))
+		return true;
+
+	{
+		// The table is behind the registry for accounts changed here, its row may be one this server already removed.
+		std::lock_guard<std::mutex> lock(_mtx);
+
+		if (_pending.count(game_account_id) || _flushing.count(game_account_id))
+			return false;
+	}
+
+	if (!load(game_account_id, entry))
+		return false;
+
+	_fallbacks.fetch_add(1, std::memory_order_relaxed);
+
+	// Another thread may have filled the registry in between, its entry is kept.
+	if (!_registry.insert(entry))
+		return _registry.find(game_account_id, entry);
+
+	return true;
+}
+
+bool SessionStore::erase(uint32_t game_account_id)
+{
+	if (!_registry.erase(game_account_id))
+		return false;
+
+	mark(game_account_id);
+	return true;
+}
+
+bool SessionStore::set_current_server(uint32_t game_account_id, char current_server)
+{
+	if (!_registry.set_current_server(game_account_id, current_server))
+		return false;
+
+	mark(game_account_id);
+	return true;
+}
+
+bool SessionStore::touch(uint32_t game_account_id, char current_server, int64_t now)
+{
+	if (!_registry.touch(game_account_id, current_server, now))
+		return false;
+
+	mark(game_account_id);
+	return true;
+}
+
+uint32_t SessionStore::expire(char current_server, int64_t timeout)
+{
+	std::vector<uint32_t> expired = _registry.expire(current_server, std::time(nullptr) - timeout);
+
+	for (uint32_t game_account_id : expired)
+		mark(game_account_id);
+
+	return expired.size();
+}
+
+session_store_statistics SessionStore::get_statistics()
+{
+	session_store_statistics stats;
+
+	stats.registry = _registry.get_statistics();
+	stats.written = _written.load(std::memory_order_relaxed);
+	stats.failed = _failed.load(std::memory_order_relaxed);
+	stats.fallbacks = _fallbacks.load(std::memory_order_relaxed);
+
+	std::lock_guard<std::mutex> lock(_mtx);
+	stats.pending = _pending.size();
+
+	return stats;
+}
+
+std::shared_ptr<mysqlx::Session> SessionStore::connect()
+{
+	std::shared_ptr<mysqlx::Session> connection = std::make_shared<mysqlx::Session>(_conf.get_db_host(), _conf.get_db_port(),
+		_conf.get_db_user(), _conf.get_db_pass());
+
+	connection->sql(std::string("USE ").append(_conf.get_db_database())).execute();
+
+	return connection;
+}
+
+void SessionStore::warm(mysqlx::Session &connection)
+{
+	mysqlx::RowResult rr = connection.sql("SELECT `auth_code`, `game_account_id`, `client_version`, `client_type`, `character_slots`, `group_id`, "
+		"`connect_time`, `current_server`, `last_update` FROM `session_data`")
+		.execute();
+
+	uint32_t loaded = 0;
+
+	for (mysqlx::Row r : rr.fetchAll()) {
+		session_registry_entry entry;
+
+		entry.auth_code = r[0].get<int>();
+		entry.game_account_id = r[1].get<int>();
+		entry.client_version = r[2].get<int>();
+		entry.client_type = r[3].get<int>();
+		entry.character_slots = r[4].get<int>();
+		entry.group_id = r[5].get<int>();
+		entry.connect_time = r[6].isNull() ? 0 : r[6].get<int>();
+		entry.current_server = r[7].get<std::string>().c_str()[0];
+		entry.last_update = r[8].get<int>();
+
+		if (_registry.upsert(entry))
+			loaded++;
+	}
+
+	HLog(info) << "Loaded " << loaded << " session(s) from the database into the session registry.";
+}
+
+/**
+ * @brief Reads the session of an account from `session_data`.
+ * @thread any, misses are serialized on the lookup connection.
+ */
+bool SessionStore::load(uint32_t game_account_id, session_registry_entry &entry)
+{
+	std::lock_guard<std::mutex> lock(_lookup_mtx);
+
+	try {
+		if (_lookup_connection == nullptr)
+			_lookup_connection = connect();
+
+		mysqlx::RowResult rr = _lookup_connection->sql("SELECT `auth_code`, `game_account_id`, `client_version`, `client_type`, `character_slots`, `group_id`, "
+			"`connect_time`, `current_server`, `last_update` FROM `session_data` WHERE `game_account_id` = ?")
+			.bind(game_account_id)
+			.execute();
+
+		mysqlx::Row r = rr.fetchOne();
+
+		if (r.isNull())
+			return false;
+
+		entry.auth_code = r[0].get<int>();
+		entry.game_account_id = r[1].get<int>();
+		entry.client_version = r[2].get<int>();
+		entry.client_type = r[3].get<int>();
+		entry.character_slots = r[4].get<int>();
+		entry.group_id = r[5].get<int>();
+		entry.connect_time = r[6].isNull() ? 0 : r[6].get<int>();
+		entry.current_server = r[7].get<std::string>().c_str()[0];
+		entry.last_update = r[8].get<int>();
+
+		return true;
+	}
+	catch (std::exception &error) {
+		HLogSys(LOG_DATABASE, warning) << "SessionStore::load: " << error.what() << ", the session of game account " << game_account_id << " could not be read.";
+	}
+
+	// The connection may have been lost, the next miss opens a new one.
+	_lookup_connection = nullptr;
+
+	return false;
+}
+
+void SessionStore::mark(uint32_t game_account_id)
+{
+	std::lock_guard<std::mutex> lock(_mtx);
+	_pending.insert(game_account_id);
+}
+
+/**
+ * @brief Writer loop, flushes the marked accounts every flush interval until the store stops.
+ * @thread Session writer.
+ */
+void SessionStore::run()
+{
+	std::vector<uint32_t> accounts;
+
+	while (true) {
+		bool running;
+
+		{
+			std::unique_lock<std::mutex> lock(_mtx);
+
+			_cv.wait_for(lock, std::chrono::milliseconds(_flush_interval), [this] () { return !_running.load(); });
+
+			running = _running.load();
+			accounts.assign(_pending.begin(), _pending.end());
+			_flushing.insert(_pending.begin(), _pending.end());
+			_pending.clear();
+		}
+
+		bool flushed = accounts.empty() || flush(accounts);
+
+		{
+			std::lock_guard<std::mutex> lock(_mtx);
+
+			// Retried with the next flush, merged with whatever changed in between.
+			if (!flushed && running)
+				_pending.insert(accounts.begin(), accounts.end());
+
+			_flushing.clear();
+		}
+
+		if (!flushed && !running) {
+			HLogSys(LOG_DATABASE, error) << "SessionStore::run: " << accounts.size() << " session(s) could not be written before shutdown.";
+			break;
+		}
+
+		if (!running)
+			break;
+	}
+}
+
+/**
+ * @brief Copies the current registry state of the accounts to the table in one transaction,
+ * accounts without a session have their row deleted.
+ * @thread Session writer.
+ */
+bool SessionStore::flush(std::vector<uint32_t> const &accounts)
+{
+	try {
+		if (_connection == nullptr)
+			_connection = connect();
+
+		_connection->startTransaction();
+
+		for (uint32_t game_account_id : accounts) {
+			session_registry_entry entry;
+
+			_connection->sql("DELETE FROM `session_data` WHERE `game_account_id` = ?")
+				.bind(game_account_id)
+				.execute();
+
+			if (!_registry.find(game_account_id, entry))
+				continue;
+
+			_connection->sql("INSERT INTO `session_data` (`auth_code`, `game_account_id`, `client_version`, `client_type`, `character_slots`, `group_id`, "
+				"`connect_time`, `current_server`, `last_update`) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)")
+				.bind(entry.auth_code, entry.game_account_id, entry.client_version, (int) entry.client_type, entry.character_slots, entry.group_id,
+					entry.connect_time, std::string(1, entry.current_server), entry.last_update)
+				.execute();
+		}
+
+		_connection->commit();
+		_written.fetch_add(accounts.size(), std::memory_order_relaxed);
+
+		return true;
+	}
+	catch (std::exception &error) {
+		HLogSys(LOG_DATABASE, warning) << "SessionStore::flush: " << error.what() << ", " << accounts.size() << " session(s) will be retried.";
+		_failed.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	try {
+		if (_connection != nullptr)
+			_connection->rollback();
+	}
+	catch (std::exception &) {
+	}
+
+	// The connection may have been lost, the next flush opens a new one.
+	_connection = nullptr;
+
+	return false;
+}
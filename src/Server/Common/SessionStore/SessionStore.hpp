@@ -0,0 +1,132 @@
+/***************************************************
+ *       _   _            _                        *
+ *      | | | |          (_)                       *
+ *      | |_| | ___  _ __ _ _______  _ __          *
+ *      |  _  |/ _ \| '__| |_  / _ \| '_  \        *
+ *      | | | | (_) | |  | |/ / (_) | | | |        *
+ *      \_| |_/\___/|_|  |_/___\___/|_| |_|        *
+ ***************************************************
+ * This file is part of Horizon (c).
+ *
+ * Copyright (c) 2019 Sagun K. (sagunxp@gmail.com).
+ * Copyright (c) 2019 Horizon Dev Team.
+ *
+ * Base Author - Sagun K. (sagunxp@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ **************************************************/
+
+#ifndef HORIZON_SERVER_COMMON_SESSIONSTORE_HPP
+#define HORIZON_SERVER_COMMON_SESSIONSTORE_HPP
+
+#include "Libraries/SessionRegistry/SessionRegistry.hpp"
+#include "Server/Common/Configuration/ServerConfiguration.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+struct session_store_statistics
+{
+	session_registry_statistics registry;
+	uint64_t pending{0};  ///< Sessions waiting to be written to `session_data`.
+	uint64_t written{0};  ///< Rows written or deleted.
+	uint64_t failed{0};   ///< Flushes that failed and were retried.
+	uint64_t fallbacks{0}; ///< Registry misses answered from `session_data`.
+};
+
+/**
+ * @brief Sessions of connected accounts, kept in a SessionRegistry shared by the servers on this
+ * host and written through to the `session_data` table by a background writer.
+ * Servers read and change sessions in the registry only. Every change marks the account, and the
+ * writer periodically copies the registry's current state of the marked accounts to the table in
+ * one transaction, so that several changes in between cost a single write. The table is read
+ * when a server creates the shared registry, to bring back the sessions of a previous run, and
+ * when an account is missing from the registry, as its session may have been created by a server
+ * on another host.
+ * @thread any
+ */
+class SessionStore
+{
+public:
+	SessionStore();
+	~SessionStore();
+
+	/**
+	 * @brief Opens the registry and starts the writer.
+	 * @param registry_name shared registry to open, a registry private to this process if empty.
+	 * @param flush_interval milliseconds between two writes to the table.
+	 * @thread Main thread.
+	 */
+	bool initialize(general_server_configuration const &conf, std::shared_ptr<mysqlx::Session> connection,
+		std::string const &registry_name, uint32_t capacity, int flush_interval);
+	/**
+	 * @brief Writes every pending change and stops the writer.
+	 * @thread Main thread.
+	 */
+	void finalize();
+
+	/**
+	 * @return false if the account already has a session.
+	 */
+	bool create(session_registry_entry const &entry);
+	bool replace(session_registry_entry const &entry);
+	/**
+	 * @brief Finds the session of an account in the registry, or in `session_data` if the registry has none.
+	 * A session read from the table is added to the registry, so later lookups do not reach the database.
+	 */
+	bool find(uint32_t game_account_id, session_registry_entry &entry);
+	bool erase(uint32_t game_account_id);
+	bool set_current_server(uint32_t game_account_id, char current_server);
+	bool touch(uint32_t game_account_id, char current_server, int64_t now);
+	/**
+	 * @brief Removes the sessions on current_server that were not updated for timeout seconds.
+	 * @return the number of sessions removed.
+	 */
+	uint32_t expire(char current_server, int64_t timeout);
+	uint32_t count(char current_server) { return _registry.count(current_server); }
+
+	session_store_statistics get_statistics();
+
+private:
+	std::shared_ptr<mysqlx::Session> connect();
+	void warm(mysqlx::Session &connection);
+	bool load(uint32_t game_account_id, session_registry_entry &entry);
+	void mark(uint32_t game_account_id);
+	void run();
+	bool flush(std::vector<uint32_t> const &accounts);
+
+	Horizon::Libraries::SessionRegistry _registry;
+	general_server_configuration _conf;
+	std::shared_ptr<mysqlx::Session> _connection;
+	int _flush_interval{0};
+
+	std::thread _writer;
+	std::atomic<bool> _running{false};
+	std::mutex _mtx;
+	std::condition_variable _cv;
+	std::unordered_set<uint32_t> _pending;
+	std::unordered_set<uint32_t> _flushing;             ///< Taken from _pending by the writer and not yet written.
+
+	std::mutex _lookup_mtx;                             ///< Serializes registry misses on _lookup_connection.
+	std::shared_ptr<mysqlx::Session> _lookup_connection;
+
+	std::atomic<uint64_t> _written{0}, _failed{0}, _fallbacks{0};
+};
+
+#endif /* HORIZON_SERVER_COMMON_SESSIONSTORE_HPP */
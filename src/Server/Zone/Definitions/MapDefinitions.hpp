@@ -30,6 +30,8 @@
 #ifndef HORIZON_ZONE_GAME_MAP_DEFINITIONS_HPP
 #define HORIZON_ZONE_GAME_MAP_DEFINITIONS_HPP
 
+#include <cstdint>
+
 enum map_cell_types : int8_t
 {
     CELL_WALKABLE_SHOOTABLE_GROUND_0 = 0,
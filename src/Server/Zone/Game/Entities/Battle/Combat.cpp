@@ -130,7 +130,7 @@ int64_t Combat::deduce_weapon_element_attack(int64_t damage, element_type def_el
         if (loc != IT_EQPI_HAND_R || loc != IT_EQPI_HAND_L)
             return damage; // not a weapon.
 
-        std::shared_ptr<const item_config_data> weapond = ItemDB->get_item_by_id(weapon->item_id);
+        item_config_data const *weapond = ItemDB->find_item_by_id(weapon->item_id);
 
         if (weapond == nullptr) {
             HLog(warning) << "Combat::deduce_weapon_element_attack: could not find item config of right hand weapon ID: " << weapon->item_id << ". ignoring..." ;
@@ -159,7 +159,7 @@ int64_t Combat::deduce_damage_size_modifier(int64_t damage, item_equip_location_
         if (loc == IT_EQPI_HAND_R || loc == IT_EQPI_HAND_L) 
             return damage; // not a weapon.
 
-        std::shared_ptr<const item_config_data> weapond = ItemDB->get_item_by_id(weapon->item_id);
+        item_config_data const *weapond = ItemDB->find_item_by_id(weapon->item_id);
 
         if (weapond == nullptr) {
             HLog(warning) << "Combat::deduce_weapon_element_attack: could not find item config of right hand weapon ID: " << weapon->item_id << ". ignoring..." ;
@@ -84,6 +84,9 @@ void Monster::finalize()
 
 	if (has_valid_grid_reference())
 		remove_grid_reference();
+
+	if (map() != nullptr)
+		map()->remove_entity_from_index(guid(), this);
 }
 
 void Monster::behavior_passive()
@@ -93,7 +96,7 @@ void Monster::behavior_passive()
 		&& !is_walking()
 		&& was_spotted_once()) {
 	    try {
-	        sol::load_result fx = lua_manager()->lua_state()->load_file("scripts/monsters/functionalities/walking_passive.lua");
+	        sol::protected_function fx = lua_manager()->get_script(lua_manager()->lua_state(), "scripts/monsters/functionalities/walking_passive.lua");
 	        sol::protected_function_result result = fx(shared_from_this());
 	        if (!result.valid()) {
 	            sol::error err = result;
@@ -113,7 +116,7 @@ void Monster::behavior_active(std::shared_ptr<Player> pl)
 
 	if (_target != nullptr) {
 		// Check Validity of current target
-		HLog(debug) << "Monster (" << guid() << ") " << name() << " has begun aggressively engaging " << pl->name() << ".";
+		HLogSys(LOG_GAME, debug) << "Monster (" << guid() << ") " << name() << " has begun aggressively engaging " << pl->name() << ".";
 	}
 
 	if (monster_config()->mode & MONSTER_MODE_MASK_AGGRESSIVE) {
@@ -131,7 +134,8 @@ void Monster::behavior_active(std::shared_ptr<Player> pl)
 	// BL_ITEM
 
 	// Attempt to attack
-	if (_target != nullptr && distance_from(_target) < monster_config()->attack_range) {
+	// distance_from() counts moves, the attack range counts path cells including the starting one.
+	if (_target != nullptr && distance_from(_target) < monster_config()->attack_range - 1) {
 
 	}
 }
@@ -142,7 +146,7 @@ void Monster::stop_movement()
 
 void Monster::on_pathfinding_failure()
 {
-	HLog(debug) << "Monster " << name() << " has failed to find path from (" << map_coords().x() << "," << map_coords().y() << ") to (" << dest_coords().x() << ", " << dest_coords().y() << ").";
+	HLogSys(LOG_GAME, debug) << "Monster " << name() << " has failed to find path from (" << map_coords().x() << "," << map_coords().y() << ") to (" << dest_coords().x() << ", " << dest_coords().y() << ").";
 }
 
 void Monster::on_movement_begin()
@@ -201,7 +205,7 @@ bool Monster::on_killed(std::shared_ptr<Entity> killer, bool with_drops, bool wi
 		std::shared_ptr<Player> player = killer->downcast<Player>();
 
 		try {
-			sol::load_result fx = player->lua_state()->load_file("scripts/internal/on_monster_killed.lua");
+			sol::protected_function fx = player->lua_manager()->get_script(player->lua_state(), "scripts/internal/on_monster_killed.lua");
 			sol::protected_function_result result = fx(player, shared_from_this()->downcast<Monster>(), with_drops, with_exp);
 			if (!result.valid()) {
 				sol::error err = result;
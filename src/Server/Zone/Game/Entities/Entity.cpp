@@ -38,6 +38,7 @@
 #include "Server/Zone/Game/Entities/Traits/Status.hpp"
 #include "Server/Zone/Zone.hpp"
 
+#include <limits>
 
 using namespace Horizon::Zone;
 
@@ -76,6 +77,22 @@ std::shared_ptr<AStar::CoordinateList> Entity::path_to(std::shared_ptr<Entity> e
 	return std::move(wp);
 }
 
+int Entity::distance_from(std::shared_ptr<Entity> e)
+{
+	if (e->map() != map())
+		return std::numeric_limits<int>::max();
+
+	return map_coords().distance(e->map_coords());
+}
+
+bool Entity::can_reach(std::shared_ptr<Entity> e, uint32_t max_steps)
+{
+	if (e->map() != map())
+		return false;
+
+	return map()->can_reach(map_coords(), e->map_coords(), max_steps);
+}
+
 bool Entity::schedule_walk()
 {
 	MapCoords source_pos = { map_coords().x(), map_coords().y() };
@@ -147,10 +164,10 @@ void Entity::walk()
 
 			// set_direction((directions) my_coords.direction_to(step_coords));
 
-			notify_nearby_players_of_existence(EVP_NOTIFY_OUT_OF_SIGHT);
+			_previous_step_coords = map_coords();
 			set_map_coords(step_coords);
 			on_movement_step();
-			notify_nearby_players_of_existence(EVP_NOTIFY_IN_SIGHT);
+			notify_nearby_players_of_step();
 
 			_walk_path.erase(_walk_path.begin());
 
@@ -223,12 +240,14 @@ bool Entity::is_in_range_of(std::shared_ptr<Entity> e, uint8_t range)
 
 std::shared_ptr<Entity> Entity::get_nearby_entity(uint32_t guid)
 {
-	GridEntitySearcher searcher(guid);
-	GridReferenceContainerVisitor<GridEntitySearcher, GridReferenceContainer<AllEntityTypes>> search_visitor(searcher);
+	std::shared_ptr<Map> m = map();
+	std::shared_ptr<Entity> entity = m->find_entity(guid);
 
-	map()->visit_in_range(map_coords(), search_visitor);
+	// The index covers the whole map, the range check replaces the grids that were searched in view range.
+	if (entity == nullptr || entity->map() != m || !map_coords().is_within_range(entity->map_coords(), MAX_VIEW_RANGE))
+		return nullptr;
 
-	return searcher.get_result();
+	return entity;
 }
 
 void Entity::notify_nearby_players_of_existence(entity_viewport_notification_type notif_type)
@@ -239,6 +258,14 @@ void Entity::notify_nearby_players_of_existence(entity_viewport_notification_typ
 	map()->visit_in_range(map_coords(), entity_visitor);
 }
 
+void Entity::notify_nearby_players_of_step()
+{
+	GridViewPortStepNotifier step_notify(shared_from_this());
+	GridReferenceContainerVisitor<GridViewPortStepNotifier, GridReferenceContainer<AllEntityTypes>> entity_visitor(step_notify);
+
+	map()->visit_in_range(_previous_step_coords, map_coords(), entity_visitor);
+}
+
 void Entity::notify_nearby_players_of_spawn()
 {
 	GridEntitySpawnNotifier spawn_notify(shared_from_this());
@@ -363,7 +390,7 @@ bool Entity::attack(std::shared_ptr<Entity> target, bool continuous)
 				return;
 			}
 
-			if (path_to(target)->size() == 0) {
+			if (!can_reach(target, MAX_VIEW_RANGE)) {
 				return;
 			}
 
@@ -164,6 +164,11 @@ public:
 	MapCoords const &map_coords() const { return _map_coords; }
 	void set_map_coords(MapCoords const &coords) { _map_coords = coords; }
 
+	/**
+	 * @brief Coordinates the entity walked from in its last walk step.
+	 */
+	MapCoords const &previous_step_coords() const { return _previous_step_coords; }
+
 	GridCoords const &grid_coords() const { return _grid_coords; }
 	void set_grid_coords(GridCoords const &coords) { _grid_coords = coords; }
 
@@ -171,6 +176,11 @@ public:
 	void notify_nearby_players_of_existence(entity_viewport_notification_type notif_type);
 	void notify_nearby_players_of_spawn();
 	void notify_nearby_players_of_movement(bool new_entry = false);
+
+	/**
+	 * @brief Updates the viewports of the players around both ends of the last walk step.
+	 */
+	void notify_nearby_players_of_step();
 	std::shared_ptr<Entity> get_nearby_entity(uint32_t guid);
 
 	uint64_t get_scheduler_task_id(entity_task_schedule_group group) { return ((uint64_t) guid() << 32) + (int) group; }
@@ -188,7 +198,18 @@ public:
     virtual void on_status_effect_change(std::shared_ptr<status_change_entry> sce) = 0;
 
 	std::shared_ptr<AStar::CoordinateList> path_to(std::shared_ptr<Entity> e);
-	int distance_from(std::shared_ptr<Entity> e) { return path_to(e)->size(); }
+
+	/**
+	 * @brief Number of moves between this entity and e, disregarding obstacles (@see MapCoords::distance).
+	 * Entities on different maps are considered out of any range.
+	 */
+	int distance_from(std::shared_ptr<Entity> e);
+
+	/**
+	 * @brief Checks if e can be walked to in at most max_steps moves, without building the path.
+	 * Use path_to() only when the entity actually has to move.
+	 */
+	bool can_reach(std::shared_ptr<Entity> e, uint32_t max_steps);
 
 	virtual bool attack(std::shared_ptr<Entity> target, bool continuous = false);
 	virtual bool stop_attacking();
@@ -202,6 +223,7 @@ private:
 	entity_type _type{ENTITY_UNKNOWN};
 	std::weak_ptr<Map> _map;
 	MapCoords _map_coords{0, 0};
+	MapCoords _previous_step_coords{0, 0};
 	GridCoords _grid_coords{0, 0};
 
 	/* Simplified References */
@@ -40,6 +40,7 @@
 #include "Server/Zone/Interface/ZoneClientInterface.hpp"
 #include "Server/Zone/Session/ZoneSession.hpp"
 #include "Server/Zone/Zone.hpp"
+#include "Server/Zone/Persistence/PersistenceManager.hpp"
 
 using namespace Horizon::Zone::Entities::Traits;
 using namespace Horizon::Zone::Assets;
@@ -109,7 +110,7 @@ item_equip_result_type Inventory::equip_item(uint32_t inventory_index, uint16_t
 	std::shared_ptr<item_entry_data> inv_item = _inventory_items.at(inventory_index - 2);
 
 	if (inv_item == nullptr) {
-		HLog(debug) << "Inventory::equip_item: Could not wear item at inventory index " << inventory_index << " - Inventory data not found.";
+		HLogSys(LOG_GAME, debug) << "Inventory::equip_item: Could not wear item at inventory index " << inventory_index << " - Inventory data not found.";
 		return IT_EQUIP_FAIL;
 	}
 
@@ -145,7 +146,7 @@ item_equip_result_type Inventory::equip_item(uint32_t inventory_index, uint16_t
 		player()->get_session()->clif()->notify_equip_arrow(inv_item);
 		player()->get_session()->clif()->notify_action_failure(3);
 	} else {
-		HLog(debug) << "Inventory Item " << inv_item->inventory_index << " - " << inv_item->item_id << "worn.";
+		HLogSys(LOG_GAME, debug) << "Inventory Item " << inv_item->inventory_index << " - " << inv_item->item_id << "worn.";
 		
 		player()->get_session()->clif()->notify_equip_item(inv_item, IT_EQUIP_SUCCESS);
 		
@@ -243,17 +244,17 @@ uint32_t Inventory::calculate_current_equip_location_mask(std::shared_ptr<const
 
 void Inventory::print_inventory()
 {
-	HLog(debug) << " -- Inventory List --";
+	HLogSys(LOG_GAME, debug) << " -- Inventory List --";
 	for (auto i : _inventory_items)
-		HLog(debug) << "Idx: " << i->inventory_index << " ItemID: " << i->item_id << " Amount: " << i->amount;
+		HLogSys(LOG_GAME, debug) << "Idx: " << i->inventory_index << " ItemID: " << i->item_id << " Amount: " << i->amount;
 
 
-	HLog(debug) << " -- Equipments List --";
+	HLogSys(LOG_GAME, debug) << " -- Equipments List --";
 	for (int i = 0; i < IT_EQPI_MAX; i++) {
 		auto &equip = equipments()[i];
 		std::shared_ptr<const item_entry_data> id = equip.second.lock();
 		if (id != nullptr)
-			HLog(debug) << "Loc:" << std::hex << id->current_equip_location_mask << " Loc2: " << id->actual_equip_location_mask << " Idx: " << std::dec << id->inventory_index << " ItemID: " << id->item_id << " Amount: " << id->amount;
+			HLogSys(LOG_GAME, debug) << "Loc:" << std::hex << id->current_equip_location_mask << " Loc2: " << id->actual_equip_location_mask << " Idx: " << std::dec << id->inventory_index << " ItemID: " << id->item_id << " Amount: " << id->amount;
 	}
 }
 
@@ -293,7 +294,7 @@ inventory_addition_result_type Inventory::add_item(uint32_t item_id, uint16_t am
 {
 	item_entry_data data;
 	std::shared_ptr<const item_config_data> item = ItemDB->get_item_by_id(item_id);
-	std::shared_ptr<const job_config_data> job = JobDB->get_job_by_id(player()->job_id());
+	job_config_data const *job = JobDB->find_job_by_id(player()->job_id());
 	std::shared_ptr<Horizon::Zone::Traits::CurrentWeight> current_weight = player()->status()->current_weight();
 	std::shared_ptr<Horizon::Zone::Traits::MaxWeight> max_weight = player()->status()->max_weight();
 
@@ -408,7 +409,12 @@ void Inventory::notify_move_fail(uint16_t idx, bool silent)
 
 }
 
-int32_t Inventory::save()
+/**
+ * @brief Reconciles the saved item list with the current inventory and copies it into a save snapshot.
+ * @return Number of items that changed since the last snapshot.
+ * @see Player::save()
+ */
+int32_t Inventory::snapshot(std::vector<inventory_item_save_data> &items)
 {
 	int32_t changes = 0;
 
@@ -438,7 +444,7 @@ int32_t Inventory::save()
 	}
 
 	// Delete Non-existent items.
-	for (auto mit = _saved_inventory_items.begin(); mit != _saved_inventory_items.end(); mit++) {
+	for (auto mit = _saved_inventory_items.begin(); mit != _saved_inventory_items.end();) {
 		auto it = std::find_if(_inventory_items.begin(), _inventory_items.end(), [&mit] (std::shared_ptr<item_entry_data> it) {
 			return *it == *(*mit); // 'item_entry_data' and 'std::shared_ptr<item_entry_data>'
 		});
@@ -446,161 +452,102 @@ int32_t Inventory::save()
 		if (it == _inventory_items.end()) {
 			mit = _saved_inventory_items.erase(mit);
 			changes++;
+		} else {
+			mit++;
 		}
 	}
 
-	try {
-		sZone->get_db_connection()->sql("DELETE FROM `character_inventory` WHERE `char_id` = ?")
-			.bind(player()->character()._character_id)
-			.execute();
-
-		mysqlx::Schema schema = sZone->get_db_connection()->getSchema("horizon");
-		mysqlx::Table table = schema.getTable("character_inventory");
-		mysqlx::TableInsert ti = table.insert("char_id", "item_id", "amount", "equip_location_mask",
-			"is_identified", "refine_level", "element_type", "slot_item_id_0", "slot_item_id_1", "slot_item_id_2", "slot_item_id_3", "opt_idx0", "opt_val0",
-			"opt_idx1", "opt_val1", "opt_idx2", "opt_val2", "opt_idx3", "opt_val3", "opt_idx4", "opt_val4", "hire_expire_date", "is_favorite", "is_broken", "bind_type", "unique_id");
-
-		int count = 0;
-		for (auto mit_i = _saved_inventory_items.begin(); mit_i != _saved_inventory_items.end(); mit_i++) {
-			std::shared_ptr<const item_entry_data> mit = *mit_i;
-			ti.values(player()->character()._character_id,
-				(int)mit->item_id,
-				(int)mit->amount,
-				(int)mit->current_equip_location_mask,
-				(int)mit->info.is_identified,
-				(int)mit->refine_level,
-				(int)mit->ele_type,
-				(int)mit->slot_item_id[0],
-				(int)mit->slot_item_id[1],
-				(int)mit->slot_item_id[2],
-				(int)mit->slot_item_id[3],
-				(int)mit->option_data[0].get_index(),
-				(int)mit->option_data[0].get_value(),
-				(int)mit->option_data[1].get_index(),
-				(int)mit->option_data[1].get_value(),
-				(int)mit->option_data[2].get_index(),
-				(int)mit->option_data[2].get_value(),
-				(int)mit->option_data[3].get_index(),
-				(int)mit->option_data[3].get_value(),
-				(int)mit->option_data[4].get_index(),
-				(int)mit->option_data[4].get_value(),
-				(int)mit->hire_expire_date,
-				(int)mit->info.is_favorite,
-				(int)mit->info.is_broken,
-				(int)mit->bind_type,
-				(int64_t)mit->unique_id);
-
-			count++;
-		}
+	items.clear();
+	items.reserve(_saved_inventory_items.size());
 
-		if (count)
-			ti.execute();
-	}
-	catch (mysqlx::Error& error) {
-		HLog(error) << "Inventory::save:" << error.what();
-		return false;
-	}
-	catch (std::exception& error) {
-		HLog(error) << "Inventory::save:" << error.what();
-		return false;
-	}
+	for (std::shared_ptr<const item_entry_data> mit : _saved_inventory_items) {
+		inventory_item_save_data data;
 
-	return changes;
-}
+		data.item_id = mit->item_id;
+		data.amount = mit->amount;
+		data.equip_location_mask = mit->current_equip_location_mask;
+		data.is_identified = mit->info.is_identified;
+		data.refine_level = mit->refine_level;
+		data.element_type = mit->ele_type;
+
+		for (int s = 0; s < MAX_ITEM_SLOTS; s++)
+			data.slot_item_id[s] = mit->slot_item_id[s];
 
-int32_t Inventory::load()
-{	
-	try {
-		mysqlx::RowResult rr = sZone->get_db_connection()->sql("SELECT `item_id`, `amount`, `equip_location_mask`, `refine_level`, `slot_item_id_0`,"
-			"`slot_item_id_1`, `slot_item_id_2`, `slot_item_id_3`, `hire_expire_date`, `element_type`, `opt_idx0`, `opt_val0`, `opt_idx1`, `opt_val1`,"
-			"`opt_idx2`, `opt_val2`, `opt_idx3`, `opt_val3`, `opt_idx4`, `opt_val4`, `is_identified`, `is_broken`, `is_favorite`, `bind_type`, `unique_id`"
-			" FROM `character_inventory` WHERE `char_id` = ?")
-			.bind(player()->character()._character_id)
-			.execute();
-
-		std::list<mysqlx::Row> rows = rr.fetchAll();
-
-		if (_inventory_items.size() != 0) {
-			HLog(warning) << "Attempt to synchronize the saved inventory, which should be empty at the time of load or re-load, size: " << _inventory_items.size();
-			return 0;
+		for (int o = 0; o < MAX_ITEM_OPTIONS; o++) {
+			data.option_index[o] = mit->option_data[o].get_index();
+			data.option_value[o] = mit->option_data[o].get_value();
 		}
 
-		int inventory_index = 2;
-		for (std::list<mysqlx::Row>::iterator r = rows.begin(); r != rows.end(); r++) {
-			mysqlx::Row row = *r;
-			item_entry_data i;
+		data.hire_expire_date = mit->hire_expire_date;
+		data.is_favorite = mit->info.is_favorite;
+		data.is_broken = mit->info.is_broken;
+		data.bind_type = mit->bind_type;
+		data.unique_id = mit->unique_id;
 
-			std::shared_ptr<const item_config_data> d = ItemDB->get_item_by_id(row[0].get<int>());
+		items.push_back(data);
+	}
 
-			i.inventory_index = inventory_index++;
-			i.item_id = row[0].get<int>();
-			i.type = d->type;
-			i.amount = row[1].get<int>();
-			i.current_equip_location_mask = row[2].get<int>();
-			i.actual_equip_location_mask = d->equip_location_mask;
-			i.refine_level = row[3].get<int>();
-			i.config = d;
+	return changes;
+}
 
-			i.slot_item_id[0] = row[4].get<int>();
-			i.slot_item_id[1] = row[5].get<int>();
-			i.slot_item_id[2] = row[6].get<int>();
-			i.slot_item_id[3] = row[7].get<int>();
+/**
+ * @brief Builds the inventory from the rows read by the login workers.
+ * @thread Thread that owns the player (MapContainerThread).
+ */
+int32_t Inventory::load(std::vector<inventory_item_save_data> const &items)
+{
+	if (_inventory_items.size() != 0) {
+		HLog(warning) << "Attempt to synchronize the saved inventory, which should be empty at the time of load or re-load, size: " << _inventory_items.size();
+		return 0;
+	}
 
-			i.hire_expire_date = row[8].get<int>();
-			i.sprite_id = d->sprite_id;
+	int inventory_index = 2;
+	for (inventory_item_save_data const &row : items) {
+		item_entry_data i;
 
-			i.ele_type = (element_type)(int)row[9].get<int>();
+		std::shared_ptr<const item_config_data> d = ItemDB->get_item_by_id(row.item_id);
 
-			if (row[10].get<int>()) {
-				i.option_data[0].set_index(row[10].get<int>());
-				i.option_data[0].set_value(row[11].get<int>());
-				i.option_count = 1;
-			}
+		if (d == nullptr) {
+			HLog(warning) << "Inventory::load: skipping unknown item " << row.item_id << " of character " << player()->character()._character_id << ".";
+			continue;
+		}
 
-			if (row[12].get<int>()) {
-				i.option_data[1].set_index(row[12].get<int>());
-				i.option_data[1].set_value(row[13].get<int>());
-				i.option_count = 2;
-			}
+		i.inventory_index = inventory_index++;
+		i.item_id = row.item_id;
+		i.type = d->type;
+		i.amount = row.amount;
+		i.current_equip_location_mask = row.equip_location_mask;
+		i.actual_equip_location_mask = d->equip_location_mask;
+		i.refine_level = row.refine_level;
+		i.config = d;
 
-			if (row[14].get<int>()) {
-				i.option_data[2].set_index(row[14].get<int>());
-				i.option_data[2].set_value(row[15].get<int>());
-				i.option_count = 3;
-			}
+		for (int s = 0; s < 4; s++)
+			i.slot_item_id[s] = row.slot_item_id[s];
 
-			if (row[16].get<int>()) {
-				i.option_data[3].set_index(row[16].get<int>());
-				i.option_data[3].set_value(row[17].get<int>());
-				i.option_count = 4;
-			}
+		i.hire_expire_date = row.hire_expire_date;
+		i.sprite_id = d->sprite_id;
 
-			if (row[18].get<int>()) {
-				i.option_data[4].set_index(row[18].get<int>());
-				i.option_data[4].set_value(row[19].get<int>());
-				i.option_count = 5;
+		i.ele_type = (element_type) row.element_type;
+
+		for (int o = 0; o < 5; o++) {
+			if (row.option_index[o]) {
+				i.option_data[o].set_index(row.option_index[o]);
+				i.option_data[o].set_value(row.option_value[o]);
+				i.option_count = o + 1;
 			}
+		}
 
-			i.info.is_identified = row[20].get<int>();
-			i.info.is_broken = row[21].get<int>();
-			i.info.is_favorite = row[22].get<int>();
+		i.info.is_identified = row.is_identified;
+		i.info.is_broken = row.is_broken;
+		i.info.is_favorite = row.is_favorite;
 
-			i.bind_type = (item_bind_type)(int)row[23].get<int>(); // int16_t
-			i.unique_id = row[24].get<int>();
+		i.bind_type = (item_bind_type) row.bind_type; // int16_t
+		i.unique_id = row.unique_id;
 
-			std::shared_ptr<item_entry_data> item = std::make_shared<item_entry_data>(i);
+		std::shared_ptr<item_entry_data> item = std::make_shared<item_entry_data>(i);
 
-			_saved_inventory_items.push_back(item);
-			_inventory_items.push_back(item);
-		}
-	}
-	catch (mysqlx::Error& error) {
-		HLog(error) << "Inventory::load:" << error.what();
-		return false;
-	}
-	catch (std::exception& error) {
-		HLog(error) << "Inventory::load:" << error.what();
-		return false;
+		_saved_inventory_items.push_back(item);
+		_inventory_items.push_back(item);
 	}
 
 	return _inventory_items.size();
@@ -36,6 +36,7 @@ namespace Horizon
 {
 namespace Zone
 {
+struct inventory_item_save_data;
 namespace Entities
 {
 	class Player;
@@ -92,8 +93,8 @@ public:
 	void notify_drop(uint16_t idx, uint16_t amount);
 	void notify_move_fail(uint16_t idx, bool silent);
 
-	int32_t save();
-	int32_t load();
+	int32_t snapshot(std::vector<inventory_item_save_data> &items);
+	int32_t load(std::vector<inventory_item_save_data> const &items);
 
 	void set_max_storage(uint32_t max_storage) { _max_storage = max_storage; }
 	uint32_t max_storage() { return _max_storage; }
@@ -40,6 +40,8 @@
 #include "Server/Zone/Game/Entities/Traits/AttributesImpl.hpp"
 #include "Server/Zone/Game/Entities/Traits/Status.hpp"
 #include "Server/Zone/Session/ZoneSession.hpp"
+#include "Server/Zone/Persistence/LoginManager.hpp"
+#include "Server/Zone/Persistence/PersistenceManager.hpp"
 #include "Server/Zone/Socket/ZoneSocket.hpp"
 
 #include "Server/Zone/Zone.hpp"
@@ -70,26 +72,22 @@ uint64_t Player::new_unique_id()
 	return (character()._last_unique_id = (char_id << 32));
 }
 
-void Player::create(int char_id, std::string account_gender, int group_id)
-{
-	character()._character_id = char_id;
-	account()._account_gender = account_gender;
-	account()._group_id = group_id;
-
-	load();
-}
-
 bool Player::initialize()
 {
+	if (_login_data == nullptr) {
+		HLog(error) << "Player::initialize: player " << character()._character_id << " was not loaded.";
+		return false;
+	}
+
 	if (Entity::initialize() == false)
 		return false;
 
 	// Inventory.
 	_inventory = std::make_shared<Assets::Inventory>(downcast<Player>(), get_max_inventory_size());
-	_inventory->load();
+	_inventory->load(_login_data->inventory);
 
 	// Initialize Status, after inventory is loaded to compute EquipAtk etc.
-	status()->initialize(shared_from_this()->downcast<Player>());
+	status()->initialize(shared_from_this()->downcast<Player>(), _login_data->status);
 	status()->size()->set_base(ESZ_MEDIUM);
 
 	// Inventory is initialized for the player, notifying weight etc.
@@ -99,9 +97,9 @@ bool Player::initialize()
 	map()->ensure_grid_for_entity(this, map_coords());
 	
 	// Populate skill tree.
-	std::vector<std::shared_ptr<const skill_tree_config>> sktree = SkillDB->get_skill_tree_by_job_id((job_class_type) job_id());
+	std::vector<std::shared_ptr<const skill_tree_config>> const &sktree = SkillDB->get_skill_tree_by_job_id((job_class_type) job_id());
 
-	for (auto s : sktree) {
+	for (auto const &s : sktree) {
 		skill_learnt_info info;
 		info.skill_id = s->skill_id;
 		info.level = 0;
@@ -121,7 +119,7 @@ bool Player::initialize()
 	lua_manager()->initialize_monster_state(lua_state());
 
 	try {
-		sol::load_result fx = lua_state()->load_file("scripts/internal/on_login_event.lua");
+		sol::protected_function fx = lua_manager()->get_script(lua_state(), "scripts/internal/on_login_event.lua");
 		sol::protected_function_result result = fx(shared_from_this()->downcast<Player>(), VER_PRODUCTVERSION_STR);
 		if (!result.valid()) {
 			sol::error err = result;
@@ -142,101 +140,107 @@ void Player::stop_movement()
 	get_session()->clif()->notify_movement_stop(guid(), coords.x(), coords.y());
 }
 
+/**
+ * @brief Captures the player's character, status and inventory data and queues it to be written
+ * by the persistence workers.
+ * @thread Thread that owns the player (MapContainerThread).
+ */
 bool Player::save()
 {
-	try {
-		sZone->get_db_connection()->sql("UPDATE `characters` SET `account_id` = ?, `slot` = ?, `name` = ?, `online` = ?, `gender` = ?, `unban_time` = ?, `rename_count` = ?,"
-			"`last_unique_id` = ?, `hotkey_row_index` = ?, `change_slot_count` = ?, `font` = ?, `show_equip` = ?, `allow_party` = ?, `partner_aid` = ?, `father_aid` = ?, `mother_aid` = ?,"
-			"`child_aid` = ?, `party_id` = ?, `guild_id` = ?, `pet_id` = ?, `homun_id` = ?, `elemental_id` = ?, `current_map` = ?, `current_x` = ?, `current_y` = ?,"
-			"`saved_map` = ?, `saved_x` = ?, `saved_y` = ? "
-			"WHERE `id` = ?")
-			.bind(account()._account_id, character()._slot, name(), character()._online, character()._gender == ENTITY_GENDER_MALE ? "M" : "F", character()._unban_time, character()._rename_count,
-				character()._last_unique_id, character()._hotkey_row_index, character()._change_slot_count, character()._font, character()._show_equip, character()._allow_party,
-				character()._partner_aid, character()._father_aid, character()._mother_aid, character()._child_aid, character()._party_id, character()._guild_id, character()._pet_id,
-				character()._homun_id, character()._elemental_id, map()->get_name(), map_coords().x(), map_coords().y(), character()._saved_map, character()._saved_x, character()._saved_y,
-				character()._character_id
-			)
-			.execute();
-
-		// Status
-		status()->save(shared_from_this()->downcast<Player>());
-
-		// Inventory
-		inventory()->save();
-	}
-	catch (mysqlx::Error& error) {
-		HLog(error) << "Player::save:" << error.what();
-		return false;
-	}
-	catch (std::exception& error) {
-		HLog(error) << "Player::save:" << error.what();
+	std::shared_ptr<player_save_snapshot> snapshot = std::make_shared<player_save_snapshot>();
+	character_save_data &c = snapshot->character;
+
+	c.character_id = character()._character_id;
+	c.account_id = account()._account_id;
+	c.slot = character()._slot;
+	c.name = name();
+	c.online = character()._online;
+	c.gender = character()._gender == ENTITY_GENDER_MALE ? "M" : "F";
+	c.unban_time = character()._unban_time;
+	c.rename_count = character()._rename_count;
+	c.last_unique_id = character()._last_unique_id;
+	c.hotkey_row_index = character()._hotkey_row_index;
+	c.change_slot_count = character()._change_slot_count;
+	c.font = character()._font;
+	c.show_equip = character()._show_equip;
+	c.allow_party = character()._allow_party;
+	c.partner_aid = character()._partner_aid;
+	c.father_aid = character()._father_aid;
+	c.mother_aid = character()._mother_aid;
+	c.child_aid = character()._child_aid;
+	c.party_id = character()._party_id;
+	c.guild_id = character()._guild_id;
+	c.pet_id = character()._pet_id;
+	c.homun_id = character()._homun_id;
+	c.elemental_id = character()._elemental_id;
+	c.current_map = map()->get_name();
+	c.current_x = map_coords().x();
+	c.current_y = map_coords().y();
+	c.saved_map = character()._saved_map;
+	c.saved_x = character()._saved_x;
+	c.saved_y = character()._saved_y;
+
+	// Status
+	status()->snapshot(shared_from_this()->downcast<Player>(), snapshot->status);
+
+	// Inventory
+	inventory()->snapshot(snapshot->inventory);
+
+	return PersistenceMgr->queue(snapshot);
+}
+
+/**
+ * @brief Applies the account and character rows read by the login workers and places the player
+ * on its map. Status and inventory rows are kept until initialize().
+ * @thread Login worker, before the player is handed to its map container.
+ */
+bool Player::load(std::shared_ptr<player_login_data> data)
+{
+	character_save_data const &c = data->character;
+
+	account()._account_gender = data->account_gender;
+	account()._group_id = data->group_id;
+
+	/* Initialize Player Model */
+	character()._character_id = c.character_id;
+	account()._account_id = c.account_id;
+	character()._slot = c.slot;
+	set_name(c.name);
+	set_posture(POSTURE_STANDING);
+	character()._font = c.font;
+
+	character()._gender = strcmp(c.gender.c_str(), "U") == 0
+		? (strcmp(account()._account_gender.c_str(), "M") == 0 ? ENTITY_GENDER_MALE : ENTITY_GENDER_FEMALE)
+		: strcmp(c.gender.c_str(), "M") == 0 ? ENTITY_GENDER_MALE : ENTITY_GENDER_FEMALE;
+
+	character()._online = 1;
+	set_last_unique_id((uint64_t) c.last_unique_id);
+
+	character()._saved_map = c.saved_map;
+	character()._saved_x = c.saved_x;
+	character()._saved_y = c.saved_y;
+
+	/**
+	 * Set map and coordinates for entity.
+	 */
+	std::shared_ptr<Map> map = MapMgr->get_map(c.current_map);
+
+	if (map == nullptr) {
+		HLog(error) << "Error loading player, character with ID " << c.character_id << " is on unknown map '" << c.current_map << "'.";
 		return false;
 	}
-	return true;
-}
-
-bool Player::load()
-{
-	try {
-		mysqlx::RowResult rr = sZone->get_db_connection()->sql("SELECT `id`, `account_id`, `slot`, `name`, `font`, `gender`, `last_unique_id`, `saved_map`, `saved_x`, `saved_y`, "
-			"`current_map`, `current_x`, `current_y` FROM `characters` WHERE id = ?")
-			.bind(character()._character_id)
-			.execute();
-
-		mysqlx::Row r = rr.fetchOne();
-
-		if (r.isNull()) {
-			HLog(error) << "Error loading player, character with ID " << character()._character_id << " does not exist.";
-			return false;
-		}
-
-		/* Initialize Player Model */
-		character()._character_id = r[0].get<int>();
-		account()._account_id = r[1].get<int>();
-		character()._slot = r[2].get<int>();
-		set_name(r[3].get<std::string>());
-		set_posture(POSTURE_STANDING);
-		character()._font = r[4].get<int>();
-
-		std::string char_gender = r[5].get<std::string>();
-
-		character()._gender = strcmp(char_gender.c_str(), "U") == 0
-			? (strcmp(account()._account_gender.c_str(), "M") == 0 ? ENTITY_GENDER_MALE : ENTITY_GENDER_FEMALE)
-			: strcmp(char_gender.c_str(), "M") == 0 ? ENTITY_GENDER_MALE : ENTITY_GENDER_FEMALE;
 
-		character()._online = 1;
-		set_last_unique_id((uint64_t)r[6].get<int64_t>());
+	set_map(map);
+	set_map_coords(MapCoords(c.current_x, c.current_y));
 
-		character()._saved_map = r[7].get<std::string>();;
-		character()._saved_x = r[8].get<int>();
-		character()._saved_y = r[9].get<int>();
-
-		/**
-		 * Set map and coordinates for entity.
-		 */
-		MapCoords mcoords(r[11].get<int>(), r[12].get<int>());
-		std::shared_ptr<Map> map = MapMgr->get_map(r[10].get<std::string>());
-
-		map->container()->add_player(shared_from_this()->downcast<Player>());
-
-		set_map(map);
-		set_map_coords(mcoords);
-	}
-	catch (mysqlx::Error& error) {
-		HLog(error) << "Player::load:" << error.what();
-		return false;
-	}
-	catch (std::exception& error) {
-		HLog(error) << "Player::load:" << error.what();
-		return false;
-	}
+	_login_data = data;
 
 	return true;
 }
 
 void Player::on_pathfinding_failure()
 {
-	HLog(debug) << "Player " << name() << " has failed to find path from (" << map_coords().x() << "," << map_coords().y() << ") to (" << dest_coords().x() << ", " << dest_coords().y() << ").";
+	HLogSys(LOG_GAME, debug) << "Player " << name() << " has failed to find path from (" << map_coords().x() << "," << map_coords().y() << ") to (" << dest_coords().x() << ", " << dest_coords().y() << ").";
 }
 
 void Player::on_movement_begin()
@@ -255,7 +259,7 @@ void Player::on_movement_step()
 
 	map()->ensure_grid_for_entity(this, map_coords());
 
-	update_viewport();
+	update_viewport(previous_step_coords());
 
 	map()->visit_in_range(map_coords(), npc_trigger_performer, MAX_NPC_TRIGGER_RANGE);
 }
@@ -269,6 +273,33 @@ void Player::update_viewport()
 	GridReferenceContainerVisitor<GridViewPortUpdater, GridReferenceContainer<AllEntityTypes>> update_caller(updater);
 
 	map()->visit_in_range(map_coords(), update_caller);
+
+	apply_viewport_changes(updater._left, updater._entered);
+}
+
+void Player::update_viewport(MapCoords const &from)
+{
+	GridViewPortUpdater updater(shared_from_this(), from);
+	GridReferenceContainerVisitor<GridViewPortUpdater, GridReferenceContainer<AllEntityTypes>> update_caller(updater);
+
+	map()->visit_in_range(from, map_coords(), update_caller);
+
+	apply_viewport_changes(updater._left, updater._entered);
+}
+
+void Player::apply_viewport_changes(std::vector<uint32_t> const &left, std::vector<std::shared_ptr<Entity>> const &entered)
+{
+	if (left.empty() && entered.empty())
+		return;
+
+	// The client takes one packet per entity, they are queued as a single send.
+	ZoneSession::TransmitBatch batch(get_session());
+
+	for (uint32_t guid : left)
+		remove_entity_from_viewport(guid, EVP_NOTIFY_OUT_OF_SIGHT);
+
+	for (std::shared_ptr<Entity> const &entity : entered)
+		add_entity_to_viewport(entity);
 }
 
 void Player::add_entity_to_viewport(std::shared_ptr<Entity> entity)
@@ -276,13 +307,11 @@ void Player::add_entity_to_viewport(std::shared_ptr<Entity> entity)
 	if (entity == nullptr)
 		return;
 
-	if (entity_is_in_viewport(entity))
+	if (!_viewport.insert(entity->guid()))
 		return;
 
 	entity_viewport_entry entry = get_session()->clif()->create_viewport_entry(entity);
 	get_session()->clif()->notify_viewport_add_entity(entry);
-	
-	_viewport_entities.push_back(entity);
 
 	if (entity->type() == ENTITY_MONSTER) {
 		if (map()->container()->getScheduler().Count(get_scheduler_task_id(ENTITY_SCHEDULE_AI_ACTIVE)) == 0)
@@ -297,56 +326,22 @@ void Player::add_entity_to_viewport(std::shared_ptr<Entity> entity)
 				});
 	}
 
-	HLog(debug) << "------- VIEWPORT ENTITIES ----------";
-	for (auto it = _viewport_entities.begin(); it != _viewport_entities.end(); it++) {
-		if ((*it).expired())
-			continue;
-		HLog(debug) << "Entity:" << it->lock()->name() << " " << it->lock()->guid();
-	}
-	HLog(debug) << "--------------------";
+	HLogSys(LOG_GAME, debug) << "Entity " << entity->name() << " " << entity->guid() << " entered the viewport of " << name() << " (" << _viewport.size() << " entities).";
 }
 
-void Player::remove_entity_from_viewport(std::shared_ptr<Entity> entity, entity_viewport_notification_type type)
+void Player::remove_entity_from_viewport(uint32_t guid, entity_viewport_notification_type type)
 {
-	if (!entity_is_in_viewport(entity))
+	if (!_viewport.erase(guid))
 		return;
 
-	_viewport_entities.erase(std::remove_if(_viewport_entities.begin(), _viewport_entities.end(),
-		[entity] (std::weak_ptr<Entity> wp_e) {
-			if (wp_e.expired())
-				return false;
-			return wp_e.lock()->guid() == entity->guid();
-		}
-	), _viewport_entities.end());
-
-	get_session()->clif()->notify_viewport_remove_entity(entity, type);
+	get_session()->clif()->notify_viewport_remove_entity(guid, type);
 
-	HLog(debug) << "------- VIEWPORT ENTITIES ----------";
-	for (auto it = _viewport_entities.begin(); it != _viewport_entities.end(); it++) {
-		if ((*it).expired())
-			continue;
-		HLog(debug) << "Entity:" << it->lock()->name() << " " << it->lock()->guid();
-	}
-	HLog(debug) << "--------------------";
+	HLogSys(LOG_GAME, debug) << "Entity " << guid << " left the viewport of " << name() << " (" << _viewport.size() << " entities).";
 }
 
 bool Player::entity_is_in_viewport(std::shared_ptr<Entity> entity)
 {
-	if (entity == nullptr)
-		return false;
-
-	std::vector<std::weak_ptr<Entity>>::iterator it = std::find_if (_viewport_entities.begin(), _viewport_entities.end(), 
-		[entity] (const std::weak_ptr<Entity> &vp_ew) { 
-			std::shared_ptr<Entity> vp_es = vp_ew.lock();
-
-			if (vp_es == nullptr || entity == nullptr)
-				return false;
-
-			return (vp_es->guid() == entity->guid());
-		}
-	);
-	
-	return (it != _viewport_entities.end());
+	return entity != nullptr && _viewport.contains(entity->guid());
 }
 
 void Player::realize_entity_movement(std::shared_ptr<Entity> entity)
@@ -444,7 +439,7 @@ void Player::on_map_enter()
 	inventory()->notify_all();
 
 	// clear viewport
-	get_viewport_entities().clear();
+	viewport().clear();
 
 	update_viewport();
 
@@ -471,7 +466,11 @@ void Player::on_status_effect_change(std::shared_ptr<status_change_entry> sce)
 
 void Player::notify_in_area(ByteBuffer &buf, grid_notifier_type type, uint16_t range)
 {
-	GridPlayerNotifier notifier(buf, static_cast<Entity *>(this)->shared_from_this(), type);
+	if (buf.is_empty() || !ZoneSession::is_valid_packet(buf.get_read_pointer(), buf.active_length()))
+		return;
+
+	BroadcastBuffer broadcast(buf);
+	GridPlayerNotifier notifier(broadcast, static_cast<Entity *>(this)->shared_from_this(), type);
 	GridReferenceContainerVisitor<GridPlayerNotifier, GridReferenceContainer<AllEntityTypes>> container(notifier);
 
 	map()->visit_in_range(map_coords(), container, range);
@@ -480,7 +479,7 @@ void Player::notify_in_area(ByteBuffer &buf, grid_notifier_type type, uint16_t r
 
 bool Player::job_change(int32_t job_id)
 {
-	std::shared_ptr<const job_config_data> job = JobDB->get_job_by_id(job_id);
+	job_config_data const *job = JobDB->find_job_by_id(job_id);
 
 	if (job == nullptr) {
 		HLog(error) << "Player::job_change: Invalid job_id " << job_id << " provided, job was not found or not supported.";
@@ -495,7 +494,7 @@ bool Player::job_change(int32_t job_id)
 
 bool Player::perform_skill(int16_t skill_id, int16_t skill_lv)
 {
-	std::shared_ptr<const skill_config_data> sk_d = SkillDB->get_skill_by_id(skill_id);
+	skill_config_data const *sk_d = SkillDB->find_skill_by_id(skill_id);
 
     if (sk_d == nullptr) {
         HLog(warning) << "Tried to perform skill for non-existent id " << skill_id << ", ignoring...";
@@ -503,7 +502,7 @@ bool Player::perform_skill(int16_t skill_id, int16_t skill_lv)
     }
 
     try {
-        sol::load_result fx = lua_state()->load_file("scripts/skills/" + sk_d->name + ".lua");
+        sol::protected_function fx = lua_manager()->get_script(lua_state(), "scripts/skills/" + sk_d->name + ".lua");
         sol::protected_function_result result = fx(shared_from_this(), skill_id, skill_lv);
         if (!result.valid()) {
             sol::error err = result;
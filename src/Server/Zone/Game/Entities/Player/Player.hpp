@@ -35,6 +35,7 @@
 #include "Server/Zone/Definitions/ClientDefinitions.hpp"
 #include "Server/Zone/Game/Entities/Entity.hpp"
 #include "Server/Zone/Game/Entities/GridObject.hpp"
+#include "Server/Zone/Game/Entities/Player/Viewport.hpp"
 #include "Server/Zone/Game/StaticDB/JobDB.hpp"
 #include "Server/Zone/Definitions/EntityDefinitions.hpp" // entity_gender_types
 #include "Server/Zone/Definitions/ItemDefinitions.hpp"
@@ -50,6 +51,7 @@ namespace Horizon
 namespace Zone
 {
 class ZoneSession;
+struct player_login_data;
 namespace Assets
 {
 	class Inventory;
@@ -92,8 +94,6 @@ public:
 
 	std::shared_ptr<ZoneSession> get_session() { return _session; }
 
-	void create(int char_id, std::string account_gender, int group_id);
-
 	bool initialize();
 
 	/**
@@ -101,6 +101,12 @@ public:
 	 */
 	void update_viewport();
 
+	/**
+	 * @brief Updates the viewport after a walk step from the given coordinates, unlike update_viewport()
+	 * only entities that crossed the view boundary are looked at. Changes are sent in one transmit batch.
+	 */
+	void update_viewport(MapCoords const &from);
+
 	/**
 	 * Movement
 	 */
@@ -108,7 +114,7 @@ public:
 	void realize_entity_movement_entry(std::shared_ptr<Entity> entity);
 
 	void add_entity_to_viewport(std::shared_ptr<Entity> entity);
-	void remove_entity_from_viewport(std::shared_ptr<Entity> entity, entity_viewport_notification_type type);
+	void remove_entity_from_viewport(uint32_t guid, entity_viewport_notification_type type);
 	void spawn_entity_in_viewport(std::shared_ptr<Entity> entity);
 	bool entity_is_in_viewport(std::shared_ptr<Entity> entity);
 
@@ -128,7 +134,13 @@ public:
 	 * DB Synchronizations.
 	 */
 	bool save();
-	bool load();
+	bool load(std::shared_ptr<player_login_data> data);
+
+	/**
+	 * @brief Rows prefetched by the login pipeline, held until the map container initialized the player.
+	 */
+	std::shared_ptr<player_login_data> login_data() { return _login_data; }
+	std::shared_ptr<player_login_data> release_login_data() { return std::move(_login_data); }
 
 	uint64_t new_unique_id();
 
@@ -162,7 +174,7 @@ public:
 	int32_t npc_contact_guid() { return _npc_contact_guid; }
 	void set_npc_contact_guid(int32_t guid) { _npc_contact_guid = guid; }
 
-	std::vector<std::weak_ptr<Entity>> &get_viewport_entities() { return _viewport_entities; }
+	Viewport &viewport() { return _viewport; }
 
 	std::map<uint16_t, std::shared_ptr<skill_learnt_info>> &get_learnt_skills() { return _learnt_skills; }
 	std::shared_ptr<skill_learnt_info> get_learnt_skill(uint16_t skill_id) 
@@ -195,13 +207,16 @@ public:
     bool attack(std::shared_ptr<Entity> e, bool continuous = false) override;
     bool stop_attack();
 private:
+	void apply_viewport_changes(std::vector<uint32_t> const &left, std::vector<std::shared_ptr<Entity>> const &entered);
+
 	std::shared_ptr<ZoneSession> _session;
 	std::shared_ptr<sol::state> _lua_state;
 	std::shared_ptr<Assets::Inventory> _inventory;
+	std::shared_ptr<player_login_data> _login_data;
 	std::atomic<bool> _is_logged_in{false};
 	int32_t _npc_contact_guid{0};
 
-	std::vector<std::weak_ptr<Entity>> _viewport_entities;
+	Viewport _viewport;
 	
 	std::map<uint16_t, std::shared_ptr<skill_learnt_info>> _learnt_skills;
 
@@ -0,0 +1,92 @@
+/***************************************************
+ *       _   _            _                        *
+ *      | | | |          (_)                       *
+ *      | |_| | ___  _ __ _ _______  _ __          *
+ *      |  _  |/ _ \| '__| |_  / _ \| '_  \        *
+ *      | | | | (_) | |  | |/ / (_) | | | |        *
+ *      \_| |_/\___/|_|  |_/___\___/|_| |_|        *
+ ***************************************************
+ * This file is part of Horizon (c).
+ *
+ * Copyright (c) 2019 Sagun K. (sagunxp@gmail.com).
+ * Copyright (c) 2019 Horizon Dev Team.
+ *
+ * Base Author - Sagun K. (sagunxp@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ **************************************************/
+
+#ifndef HORIZON_ZONE_GAME_ENTITIES_PLAYER_VIEWPORT_HPP
+#define HORIZON_ZONE_GAME_ENTITIES_PLAYER_VIEWPORT_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace Horizon
+{
+namespace Zone
+{
+/**
+ * @brief Guids of the entities a player's client has been told about, kept in a sorted array.
+ * Membership is a binary search over contiguous memory. The array stays small (entities within
+ * view range), so the moves on insert and erase are cheaper than the nodes of a tree or hash set.
+ * @thread MapContainerThread of the player.
+ */
+class Viewport
+{
+public:
+	bool contains(uint32_t guid) const { return std::binary_search(_guids.begin(), _guids.end(), guid); }
+
+	/**
+	 * @return false if the guid was in the viewport already.
+	 */
+	bool insert(uint32_t guid)
+	{
+		std::vector<uint32_t>::iterator it = std::lower_bound(_guids.begin(), _guids.end(), guid);
+
+		if (it != _guids.end() && *it == guid)
+			return false;
+
+		_guids.insert(it, guid);
+		return true;
+	}
+
+	/**
+	 * @return false if the guid was not in the viewport.
+	 */
+	bool erase(uint32_t guid)
+	{
+		std::vector<uint32_t>::iterator it = std::lower_bound(_guids.begin(), _guids.end(), guid);
+
+		if (it == _guids.end() || *it != guid)
+			return false;
+
+		_guids.erase(it);
+		return true;
+	}
+
+	void clear() { _guids.clear(); }
+
+	std::size_t size() const { return _guids.size(); }
+
+	std::vector<uint32_t> const &guids() const { return _guids; }
+
+private:
+	std::vector<uint32_t> _guids;
+};
+}
+}
+
+#endif /* HORIZON_ZONE_GAME_ENTITIES_PLAYER_VIEWPORT_HPP */
@@ -185,8 +185,8 @@ void NextBaseExperience::on_observable_changed(BaseLevel *blvl)
 	if (entity() == nullptr || blvl == nullptr)
 		return;
 
-	std::shared_ptr<const job_config_data> job = JobDB->get_job_by_id(entity()->job_id());
-	std::shared_ptr<const exp_group_data> bexpg = ExpDB->get_exp_group(job->base_exp_group, EXP_GROUP_TYPE_BASE);
+	job_config_data const *job = JobDB->find_job_by_id(entity()->job_id());
+	exp_group_data const *bexpg = ExpDB->find_exp_group(job->base_exp_group, EXP_GROUP_TYPE_BASE);
 
 	set_base(bexpg->exp[blvl->get_base() - 1]);
 }
@@ -205,8 +205,8 @@ void NextJobExperience::on_observable_changed(JobLevel *jlvl)
 	if (entity() == nullptr || jlvl == nullptr)
 		return;
 
-	std::shared_ptr<const job_config_data> job = JobDB->get_job_by_id(entity()->job_id());
-	std::shared_ptr<const exp_group_data> jexpg = ExpDB->get_exp_group(job->job_exp_group, EXP_GROUP_TYPE_JOB);
+	job_config_data const *job = JobDB->find_job_by_id(entity()->job_id());
+	exp_group_data const *jexpg = ExpDB->find_exp_group(job->job_exp_group, EXP_GROUP_TYPE_JOB);
 
 	set_base(jexpg->exp[jlvl->get_base() - 1]);
 }
@@ -240,7 +240,7 @@ int32_t MaxWeight::compute(bool notify)
 	if (entity() == nullptr || _str == nullptr)
 		return 0;
 
-	std::shared_ptr<const job_config_data> job = JobDB->get_job_by_id(entity()->job_id());
+	job_config_data const *job = JobDB->find_job_by_id(entity()->job_id());
 
 	set_base(job->max_weight + _str->get_base() * 300);
 
@@ -477,7 +477,7 @@ int32_t AttackSpeed::compute(bool notify)
 		EquipmentListType const &equipments = entity()->downcast<Horizon::Zone::Entities::Player>()->inventory()->equipments();
 		std::shared_ptr<const item_entry_data> rhw = equipments[IT_EQPI_HAND_R].second.lock();
 		std::shared_ptr<const item_entry_data> lhw = equipments[IT_EQPI_HAND_L].second.lock();
-		std::shared_ptr<const job_config_data> job = JobDB->get_job_by_id(entity()->job_id());
+		job_config_data const *job = JobDB->find_job_by_id(entity()->job_id());
 
 		item_weapon_type rhw_type, lhw_type;
 
@@ -42,6 +42,7 @@
 #include "Server/Zone/Game/Entities/Entity.hpp"
 #include "Server/Zone/Packets/TransmittedPackets.hpp"
 #include "Server/Zone/Session/ZoneSession.hpp"
+#include "Server/Zone/Persistence/PersistenceManager.hpp"
 #include "Server/Zone/Zone.hpp"
 
 using namespace Horizon::Zone::Traits;
@@ -56,9 +57,9 @@ Status::~Status()
 {
 }
 
-bool Status::initialize(std::shared_ptr<Horizon::Zone::Entities::Player> player)
+bool Status::initialize(std::shared_ptr<Horizon::Zone::Entities::Player> player, status_save_data const &data)
 {
-	load(player);
+	load(player, data);
 
 	std::shared_ptr<const job_config_data> job = player->job();
 
@@ -355,140 +356,135 @@ bool Status::initialize(std::shared_ptr<Horizon::Zone::Entities::Creature> creat
 	return true;
 }
 
-bool Status::load(std::shared_ptr<Horizon::Zone::Entities::Player> pl)
+/**
+ * @brief Applies the `character_status` row read by the login workers.
+ * @thread Thread that owns the player (MapContainerThread).
+ */
+bool Status::load(std::shared_ptr<Horizon::Zone::Entities::Player> pl, status_save_data const &data)
 {
-	try {
-		mysqlx::RowResult rr = sZone->get_db_connection()->sql("SELECT `job_id`, `strength`, `agility`, `vitality`, `intelligence`, `dexterity`, "
-			"`luck`, `status_points`, `skill_points`, `hp`, `sp`, `maximum_hp`, `maximum_sp`, `base_level`, `job_level`, `base_experience`, `job_experience`, "
-			"`hair_color_id`, `cloth_color_id`, `head_top_view_id`, `head_mid_view_id`, `head_bottom_view_id`, `hair_style_id`, `shield_view_id`, `weapon_view_id`, `robe_view_id`, "
-			"`body_id`, `zeny`, `virtue`, `honor`, `manner` FROM `character_status` WHERE `id` = ?")
-			.bind(pl->character()._character_id)
-			.execute();
-
-		mysqlx::Row r = rr.fetchOne();
-
-		if (r.isNull()) {
-			HLog(error) << "Error loading status, character with ID " << pl->character()._character_id << " does not exist.";
-			return false;
-		}
+	int32_t job_id = data.job_id;
 
-		int32_t job_id = r[0].get<int>();
-
-		std::shared_ptr<const job_config_data> job = JobDB->get_job_by_id(job_id);
-		std::shared_ptr<const exp_group_data> bexpg = ExpDB->get_exp_group(job->base_exp_group, EXP_GROUP_TYPE_BASE);
-		std::shared_ptr<const exp_group_data> jexpg = ExpDB->get_exp_group(job->job_exp_group, EXP_GROUP_TYPE_JOB);
-
-		pl->set_job_id(job_id);
-		pl->set_job(job);
-
-		int32_t str = r[1].get<int>();
-		int32_t agi = r[2].get<int>();
-		int32_t vit = r[3].get<int>();
-		int32_t _int = r[4].get<int>();
-		int32_t dex = r[5].get<int>();
-		int32_t luk = r[6].get<int>();
-
-		/**
-		 * Main Attributes.
-		 */
-		set_strength(std::make_shared<Strength>(_entity, str));
-		set_agility(std::make_shared<Agility>(_entity, agi, 0, 0));
-		set_vitality(std::make_shared<Vitality>(_entity, vit, 0, 0));
-		set_intelligence(std::make_shared<Intelligence>(_entity, _int, 0, 0));
-		set_dexterity(std::make_shared<Dexterity>(_entity, dex, 0, 0));
-		set_luck(std::make_shared<Luck>(_entity, luk, 0, 0));
-
-		set_size(std::make_shared<EntitySize>(_entity, (int)ESZ_MEDIUM));
-
-		set_strength_cost(std::make_shared<StrengthPointCost>(_entity, get_required_statpoints(str, str + 1)));
-		set_agility_cost(std::make_shared<AgilityPointCost>(_entity, get_required_statpoints(agi, agi + 1)));
-		set_vitality_cost(std::make_shared<VitalityPointCost>(_entity, get_required_statpoints(vit, vit + 1)));
-		set_intelligence_cost(std::make_shared<IntelligencePointCost>(_entity, get_required_statpoints(_int, _int + 1)));
-		set_dexterity_cost(std::make_shared<DexterityPointCost>(_entity, get_required_statpoints(dex, dex + 1)));
-		set_luck_cost(std::make_shared<LuckPointCost>(_entity, get_required_statpoints(luk, luk + 1)));
-
-		set_status_point(std::make_shared<StatusPoint>(_entity, uint32_t(r[7].get<int>())));
-		set_skill_point(std::make_shared<SkillPoint>(_entity, uint32_t(r[8].get<int>())));
-
-		set_current_hp(std::make_shared<CurrentHP>(_entity, uint32_t(r[9].get<int>())));
-		set_current_sp(std::make_shared<CurrentSP>(_entity, uint32_t(r[10].get<int>())));
-		set_max_hp(std::make_shared<MaxHP>(_entity, uint32_t(r[11].get<int>())));
-		set_max_sp(std::make_shared<MaxSP>(_entity, uint32_t(r[12].get<int>())));
-
-		uint32_t base_level = uint32_t(r[13].get<int>());
-		uint32_t job_level = uint32_t(r[14].get<int>());
-
-		set_base_level(std::make_shared<BaseLevel>(_entity, base_level));
-		set_job_level(std::make_shared<JobLevel>(_entity, job_level));
-
-		set_base_experience(std::make_shared<BaseExperience>(_entity, uint64_t(r[15].get<int>())));
-		set_job_experience(std::make_shared<JobExperience>(_entity, uint64_t(r[16].get<int>())));
-		set_next_base_experience(std::make_shared<NextBaseExperience>(_entity, bexpg->exp[base_level - 1]));
-		set_next_job_experience(std::make_shared<NextJobExperience>(_entity, bexpg->exp[job_level - 1]));
-		set_movement_speed(std::make_shared<MovementSpeed>(_entity, DEFAULT_MOVEMENT_SPEED));
-
-		set_base_appearance(std::make_shared<BaseAppearance>(_entity, job_id));
-		set_hair_color(std::make_shared<HairColor>(_entity, uint32_t(r[17].get<int>())));
-		set_cloth_color(std::make_shared<ClothColor>(_entity, uint32_t(r[18].get<int>())));
-		set_head_top_sprite(std::make_shared<HeadTopSprite>(_entity, uint32_t(r[19].get<int>())));
-		set_head_mid_sprite(std::make_shared<HeadMidSprite>(_entity, uint32_t(r[20].get<int>())));
-		set_head_bottom_sprite(std::make_shared<HeadBottomSprite>(_entity, uint32_t(r[21].get<int>())));
-		set_hair_style(std::make_shared<HairStyle>(_entity, uint32_t(r[22].get<int>())));
-		set_shield_sprite(std::make_shared<ShieldSprite>(_entity, uint32_t(r[23].get<int>())));
-		set_weapon_sprite(std::make_shared<WeaponSprite>(_entity, uint32_t(r[24].get<int>())));
-		set_robe_sprite(std::make_shared<RobeSprite>(_entity, uint32_t(r[25].get<int>())));
-		set_body_style(std::make_shared<BodyStyle>(_entity, uint32_t(r[26].get<int>())));
-
-		/**
-		 * Misc
-		 */
-		set_zeny(std::make_shared<Zeny>(_entity, int32_t(r[27].get<int>())));
-		set_virtue(std::make_shared<Virtue>(_entity, int32_t(r[28].get<int>())));
-		set_honor(std::make_shared<Honor>(_entity, int32_t(r[29].get<int>())));
-		set_manner(std::make_shared<Manner>(_entity, int32_t(r[30].get<int>())));
-
-		HLog(info) << "Status loaded for character " << pl->name() << "(" << pl->character()._character_id << ").";
-	}
-	catch (mysqlx::Error& error) {
-		HLog(error) << "Status::load:" << error.what();
-		return false;
-	}
-	catch (std::exception& error) {
-		HLog(error) << "Status::load:" << error.what();
+	std::shared_ptr<const job_config_data> job = JobDB->get_job_by_id(job_id);
+
+	if (job == nullptr) {
+		HLog(error) << "Error loading status, character with ID " << pl->character()._character_id << " has unknown job " << job_id << ".";
 		return false;
 	}
+
+	std::shared_ptr<const exp_group_data> bexpg = ExpDB->get_exp_group(job->base_exp_group, EXP_GROUP_TYPE_BASE);
+	std::shared_ptr<const exp_group_data> jexpg = ExpDB->get_exp_group(job->job_exp_group, EXP_GROUP_TYPE_JOB);
+
+	pl->set_job_id(job_id);
+	pl->set_job(job);
+
+	int32_t str = data.strength;
+	int32_t agi = data.agility;
+	int32_t vit = data.vitality;
+	int32_t _int = data.intelligence;
+	int32_t dex = data.dexterity;
+	int32_t luk = data.luck;
+
+	/**
+	 * Main Attributes.
+	 */
+	set_strength(std::make_shared<Strength>(_entity, str));
+	set_agility(std::make_shared<Agility>(_entity, agi, 0, 0));
+	set_vitality(std::make_shared<Vitality>(_entity, vit, 0, 0));
+	set_intelligence(std::make_shared<Intelligence>(_entity, _int, 0, 0));
+	set_dexterity(std::make_shared<Dexterity>(_entity, dex, 0, 0));
+	set_luck(std::make_shared<Luck>(_entity, luk, 0, 0));
+
+	set_size(std::make_shared<EntitySize>(_entity, (int)ESZ_MEDIUM));
+
+	set_strength_cost(std::make_shared<StrengthPointCost>(_entity, get_required_statpoints(str, str + 1)));
+	set_agility_cost(std::make_shared<AgilityPointCost>(_entity, get_required_statpoints(agi, agi + 1)));
+	set_vitality_cost(std::make_shared<VitalityPointCost>(_entity, get_required_statpoints(vit, vit + 1)));
+	set_intelligence_cost(std::make_shared<IntelligencePointCost>(_entity, get_required_statpoints(_int, _int + 1)));
+	set_dexterity_cost(std::make_shared<DexterityPointCost>(_entity, get_required_statpoints(dex, dex + 1)));
+	set_luck_cost(std::make_shared<LuckPointCost>(_entity, get_required_statpoints(luk, luk + 1)));
+
+	set_status_point(std::make_shared<StatusPoint>(_entity, uint32_t(data.status_points)));
+	set_skill_point(std::make_shared<SkillPoint>(_entity, uint32_t(data.skill_points)));
+
+	set_current_hp(std::make_shared<CurrentHP>(_entity, uint32_t(data.hp)));
+	set_current_sp(std::make_shared<CurrentSP>(_entity, uint32_t(data.sp)));
+	set_max_hp(std::make_shared<MaxHP>(_entity, uint32_t(data.maximum_hp)));
+	set_max_sp(std::make_shared<MaxSP>(_entity, uint32_t(data.maximum_sp)));
+
+	uint32_t base_level = uint32_t(data.base_level);
+	uint32_t job_level = uint32_t(data.job_level);
+
+	set_base_level(std::make_shared<BaseLevel>(_entity, base_level));
+	set_job_level(std::make_shared<JobLevel>(_entity, job_level));
+
+	set_base_experience(std::make_shared<BaseExperience>(_entity, uint64_t(data.base_experience)));
+	set_job_experience(std::make_shared<JobExperience>(_entity, uint64_t(data.job_experience)));
+	set_next_base_experience(std::make_shared<NextBaseExperience>(_entity, bexpg->exp[base_level - 1]));
+	set_next_job_experience(std::make_shared<NextJobExperience>(_entity, bexpg->exp[job_level - 1]));
+	set_movement_speed(std::make_shared<MovementSpeed>(_entity, DEFAULT_MOVEMENT_SPEED));
+
+	set_base_appearance(std::make_shared<BaseAppearance>(_entity, job_id));
+	set_hair_color(std::make_shared<HairColor>(_entity, uint32_t(data.hair_color_id)));
+	set_cloth_color(std::make_shared<ClothColor>(_entity, uint32_t(data.cloth_color_id)));
+	set_head_top_sprite(std::make_shared<HeadTopSprite>(_entity, uint32_t(data.head_top_view_id)));
+	set_head_mid_sprite(std::make_shared<HeadMidSprite>(_entity, uint32_t(data.head_mid_view_id)));
+	set_head_bottom_sprite(std::make_shared<HeadBottomSprite>(_entity, uint32_t(data.head_bottom_view_id)));
+	set_hair_style(std::make_shared<HairStyle>(_entity, uint32_t(data.hair_style_id)));
+	set_shield_sprite(std::make_shared<ShieldSprite>(_entity, uint32_t(data.shield_view_id)));
+	set_weapon_sprite(std::make_shared<WeaponSprite>(_entity, uint32_t(data.weapon_view_id)));
+	set_robe_sprite(std::make_shared<RobeSprite>(_entity, uint32_t(data.robe_view_id)));
+	set_body_style(std::make_shared<BodyStyle>(_entity, uint32_t(data.body_id)));
+
+	/**
+	 * Misc
+	 */
+	set_zeny(std::make_shared<Zeny>(_entity, int32_t(data.zeny)));
+	set_virtue(std::make_shared<Virtue>(_entity, int32_t(data.virtue)));
+	set_honor(std::make_shared<Honor>(_entity, int32_t(data.honor)));
+	set_manner(std::make_shared<Manner>(_entity, int32_t(data.manner)));
+
+	HLog(info) << "Status loaded for character " << pl->name() << "(" << pl->character()._character_id << ").";
+
 	return true;
 }
 
-bool Status::save(std::shared_ptr<Horizon::Zone::Entities::Player> pl)
+/**
+ * @brief Copies the persisted status of a player into a save snapshot.
+ * @see Player::save()
+ */
+void Status::snapshot(std::shared_ptr<Horizon::Zone::Entities::Player> pl, status_save_data &data)
 {
-	try {
-		sZone->get_db_connection()->sql("UPDATE `character_status` SET `job_id` = ?, `base_level` = ?, `job_level` = ?, `base_experience` = ?, `job_experience` = ?, "
-			"`zeny` = ?, `strength` = ?, `agility` = ?, `vitality` = ?, `intelligence` = ?, `dexterity` = ?, `luck` = ?, `maximum_hp` = ?, `hp` = ?, `maximum_sp` = ?, `sp` = ?, "
-			"`status_points` = ?, `skill_points` = ?, `body_state` = ?, `virtue` = ?, `honor` = ?, `manner` = ?, `hair_style_id` = ?, `hair_color_id` = ?, `cloth_color_id` = ?, `body_id` = ?, "
-			"`weapon_view_id` = ?, `shield_view_id` = ?, `head_top_view_id` = ?, `head_mid_view_id` = ?, `head_bottom_view_id` = ?, `robe_view_id` = ? "
-			"WHERE id = ?")
-			.bind(pl->job_id(), base_level()->total(), job_level()->total(), base_experience()->total(),
-				job_experience()->total(), zeny()->total(), strength()->total(), agility()->total(), vitality()->total(),
-				intelligence()->total(), dexterity()->total(),
-				luck()->total(), max_hp()->total(), current_hp()->total(), max_sp()->total(), current_sp()->total(), status_point()->total(),
-				skill_point()->total(), 0, virtue()->total(), honor()->total(), manner()->total(), hair_style()->get(),
-				hair_color()->get(), cloth_color()->get(), body_style()->get(), weapon_sprite()->get(), shield_sprite()->get(),
-				head_top_sprite()->get(), head_mid_sprite()->get(), head_bottom_sprite()->get(), robe_sprite()->get(),
-				pl->character()._character_id)
-			.execute();
-
-		HLog(info) << "Status saved for character " << pl->name() << "(" << pl->character()._character_id << ").";
-	}
-	catch (mysqlx::Error& error) {
-		HLog(error) << "Status::save:" << error.what();
-		return false;
-	}
-	catch (std::exception& error) {
-		HLog(error) << "Status::save:" << error.what();
-		return false;
-	}
-	return true;
+	data.job_id = pl->job_id();
+	data.base_level = base_level()->total();
+	data.job_level = job_level()->total();
+	data.base_experience = base_experience()->total();
+	data.job_experience = job_experience()->total();
+	data.zeny = zeny()->total();
+	data.strength = strength()->total();
+	data.agility = agility()->total();
+	data.vitality = vitality()->total();
+	data.intelligence = intelligence()->total();
+	data.dexterity = dexterity()->total();
+	data.luck = luck()->total();
+	data.maximum_hp = max_hp()->total();
+	data.hp = current_hp()->total();
+	data.maximum_sp = max_sp()->total();
+	data.sp = current_sp()->total();
+	data.status_points = status_point()->total();
+	data.skill_points = skill_point()->total();
+	data.virtue = virtue()->total();
+	data.honor = honor()->total();
+	data.manner = manner()->total();
+	data.hair_style_id = hair_style()->get();
+	data.hair_color_id = hair_color()->get();
+	data.cloth_color_id = cloth_color()->get();
+	data.body_id = body_style()->get();
+	data.weapon_view_id = weapon_sprite()->get();
+	data.shield_view_id = shield_sprite()->get();
+	data.head_top_view_id = head_top_sprite()->get();
+	data.head_mid_view_id = head_mid_sprite()->get();
+	data.head_bottom_view_id = head_bottom_sprite()->get();
+	data.robe_view_id = robe_sprite()->get();
 }
 
 void Status::on_equipment_changed(bool equipped, std::shared_ptr<const item_entry_data> item)
@@ -41,6 +41,7 @@ namespace Horizon
 namespace Zone
 {
 struct job_config_data;
+struct status_save_data;
 class Entity;
 namespace Entities
 {
@@ -58,7 +59,7 @@ public:
 	~Status();
 
 	bool initialize(std::shared_ptr<Horizon::Zone::Entities::Creature> creature, std::shared_ptr<const monster_config_data> md);
-	bool initialize(std::shared_ptr<Horizon::Zone::Entities::Player> player);
+	bool initialize(std::shared_ptr<Horizon::Zone::Entities::Player> player, status_save_data const &data);
 	bool initialize(std::shared_ptr<Horizon::Zone::Entities::NPC> npc);
 	bool initialize(std::shared_ptr<Horizon::Zone::Entities::Skill> skill);
 	
@@ -66,8 +67,8 @@ public:
 	uint32_t get_status_base(status_point_type type);
 	bool increase_status_point(status_point_type type, uint16_t amount);
 	
-	bool save(std::shared_ptr<Horizon::Zone::Entities::Player> pl);
-	bool load(std::shared_ptr<Horizon::Zone::Entities::Player> pl);
+	void snapshot(std::shared_ptr<Horizon::Zone::Entities::Player> pl, status_save_data &data);
+	bool load(std::shared_ptr<Horizon::Zone::Entities::Player> pl, status_save_data const &data);
 
 	void on_equipment_changed(bool equipped, std::shared_ptr<const item_entry_data> item);
 
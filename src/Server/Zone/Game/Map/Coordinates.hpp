@@ -83,6 +83,28 @@ public:
 		return abs(x_diff) <= range && abs(y_diff) <= range;
 	}
 
+	/**
+	 * @brief Number of moves in 8 directions between two coordinates (Chebyshev distance).
+	 */
+	template <int16_t BOUNDS>
+	int distance(Coordinates<BOUNDS> const &target) const
+	{
+		return std::max(abs(_x - target.x()), abs(_y - target.y()));
+	}
+
+	/**
+	 * @brief Cost of the shortest unobstructed walk between two coordinates (octile distance),
+	 * in the move costs used by the pathfinder (10 per straight step, 14 per diagonal step).
+	 */
+	template <int16_t BOUNDS>
+	int octile_distance(Coordinates<BOUNDS> const &target) const
+	{
+		int x_diff = abs(_x - target.x());
+		int y_diff = abs(_y - target.y());
+
+		return 10 * std::max(x_diff, y_diff) + 4 * std::min(x_diff, y_diff);
+	}
+
 	template<int16_t BOUNDS>
 	Coordinates<BOUNDS> at_range(int range) const
 	{
@@ -0,0 +1,202 @@
+/***************************************************
+ *       _   _            _                        *
+ *      | | | |          (_)                       *
+ *      | |_| | ___  _ __ _ _______  _ __          *
+ *      |  _  |/ _ \| '__| |_  / _ \| '_  \        *
+ *      | | | | (_) | |  | |/ / (_) | | | |        *
+ *      \_| |_/\___/|_|  |_/___\___/|_| |_|        *
+ ***************************************************
+ * This file is part of Horizon (c).
+ *
+ * Copyright (c) 2019 Sagun K. (sagunxp@gmail.com).
+ * Copyright (c) 2019 Horizon Dev Team.
+ *
+ * Base Author - Sagun K. (sagunxp@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ **************************************************/
+
+#ifndef HORIZON_ZONE_GAME_MAP_ENTITYINDEX_HPP
+#define HORIZON_ZONE_GAME_MAP_ENTITYINDEX_HPP
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Horizon
+{
+namespace Zone
+{
+/**
+ * @brief Index of the entities placed on a map by guid, @see Map::find_entity().
+ * Open addressing with linear probing over a power of two slot array that is kept at most half full.
+ * Erased entries are closed by shifting the following ones back, so lookups never walk tombstones.
+ * Each entry keeps the address of the indexed entity, to erase only that entity if the guid was
+ * taken over meanwhile (e.g. a player that logged in again), and a weak reference to hand it out.
+ * Entities are erased when they leave the map, never from their destructors, which may run on any thread.
+ * Entries of entities destroyed without being erased are not handed out and are dropped once the table fills up.
+ * @thread MapContainerThread of the map.
+ */
+template <class T>
+class EntityIndex
+{
+	struct slot
+	{
+		uint32_t guid{0};
+		T const *entity{nullptr};   ///< nullptr for empty slots.
+		std::weak_ptr<T> ref;
+	};
+
+public:
+	explicit EntityIndex(std::size_t capacity = 64)
+	{
+		std::size_t slots = 16;
+
+		_shift = 60;
+
+		while (slots < capacity * 2) {
+			slots <<= 1;
+			--_shift;
+		}
+
+		_slots.resize(slots);
+	}
+
+	/**
+	 * @brief Indexes entity under guid, replacing any entity indexed under it before.
+	 */
+	void insert(uint32_t guid, std::shared_ptr<T> const &entity)
+	{
+		if ((_size + 1) * 2 > _slots.size())
+			compact_or_grow();
+
+		std::size_t i = find_slot(guid);
+
+		if (_slots[i].entity == nullptr)
+			++_size;
+
+		_slots[i].guid = guid;
+		_slots[i].entity = entity.get();
+		_slots[i].ref = entity;
+	}
+
+	/**
+	 * @brief Removes guid from the index if it is indexed for entity.
+	 * @return true if the entry was removed.
+	 */
+	bool erase(uint32_t guid, T const *entity)
+	{
+		std::size_t const mask = _slots.size() - 1;
+		std::size_t hole = find_slot(guid);
+
+		if (_slots[hole].entity == nullptr || _slots[hole].entity != entity)
+			return false;
+
+		_slots[hole] = slot();
+		--_size;
+
+		// Move back entries that would become unreachable past the new hole.
+		for (std::size_t i = (hole + 1) & mask; _slots[i].entity != nullptr; i = (i + 1) & mask) {
+			std::size_t const home = home_of(_slots[i].guid);
+
+			if (((i - home) & mask) >= ((i - hole) & mask)) {
+				_slots[hole] = std::move(_slots[i]);
+				_slots[i] = slot();
+				hole = i;
+			}
+		}
+
+		return true;
+	}
+
+	/**
+	 * @brief Returns the entity indexed under guid, or nullptr if there is none or it was destroyed.
+	 */
+	std::shared_ptr<T> find(uint32_t guid) const
+	{
+		slot const &s = _slots[find_slot(guid)];
+
+		return s.entity != nullptr ? s.ref.lock() : nullptr;
+	}
+
+	std::size_t size() const { return _size; }
+
+	void clear()
+	{
+		for (slot &s : _slots)
+			s = slot();
+
+		_size = 0;
+	}
+
+private:
+	std::size_t home_of(uint32_t guid) const
+	{
+		// Fibonacci hashing, guids are handed out sequentially and would otherwise fill a single run.
+		return (std::size_t) (((uint64_t) guid * UINT64_C(11400714819323198485)) >> _shift);
+	}
+
+	/**
+	 * @brief Slot holding guid, or the empty slot that ends its probe sequence.
+	 */
+	std::size_t find_slot(uint32_t guid) const
+	{
+		std::size_t const mask = _slots.size() - 1;
+		std::size_t i = home_of(guid);
+
+		while (_slots[i].entity != nullptr && _slots[i].guid != guid)
+			i = (i + 1) & mask;
+
+		return i;
+	}
+
+	/**
+	 * @brief Rebuilds the table without the entries of destroyed entities, doubling it only if it would still be full.
+	 */
+	void compact_or_grow()
+	{
+		std::size_t live = 0;
+
+		for (slot const &s : _slots) {
+			if (s.entity != nullptr && !s.ref.expired())
+				++live;
+		}
+
+		std::vector<slot> previous((live + 1) * 2 > _slots.size() ? _slots.size() * 2 : _slots.size());
+
+		previous.swap(_slots);
+
+		if (_slots.size() > previous.size())
+			--_shift;
+
+		_size = 0;
+
+		for (slot &s : previous) {
+			if (s.entity == nullptr || s.ref.expired())
+				continue;
+
+			std::size_t i = find_slot(s.guid);
+			_slots[i] = std::move(s);
+			++_size;
+		}
+	}
+
+	std::vector<slot> _slots;
+	std::size_t _size{0};
+	uint32_t _shift{60};
+};
+}
+}
+
+#endif /* HORIZON_ZONE_GAME_MAP_ENTITYINDEX_HPP */
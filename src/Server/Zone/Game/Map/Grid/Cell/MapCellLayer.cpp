@@ -0,0 +1,118 @@
+/***************************************************
+ *       _   _            _                        *
+ *      | | | |          (_)                       *
+ *      | |_| | ___  _ __ _ _______  _ __          *
+ *      |  _  |/ _ \| '__| |_  / _ \| '_  \        *
+ *      | | | | (_) | |  | |/ / (_) | | | |        *
+ *      \_| |_/\___/|_|  |_/___\___/|_| |_|        *
+ ***************************************************
+ * This file is part of Horizon (c).
+ *
+ * Copyright (c) 2019 Sagun K. (sagunxp@gmail.com).
+ * Copyright (c) 2019 Horizon Dev Team.
+ *
+ * Base Author - Sagun K. (sagunxp@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ **************************************************/
+
+#include "MapCellLayer.hpp"
+#include "Cell.hpp"
+
+#include <cstdlib>
+#include <utility>
+
+using namespace Horizon::Zone;
+
+MapCellLayer::MapCellLayer(uint16_t width, uint16_t height, std::vector<uint8_t> const &cells)
+: _width(width), _height(height), _words_per_row((width + 63) / 64),
+  _types(width * height), _walkable(_words_per_row * height, 0),
+  _shootable(_words_per_row * height, 0), _water(_words_per_row * height, 0)
+{
+	for (int y = 0; y < height; ++y) {
+		for (int x = 0; x < width; ++x) {
+			Cell c(cells.at(y * width + x));
+			std::size_t word = y * _words_per_row + (x >> 6);
+			uint64_t bit = uint64_t(1) << (x & 63);
+
+			_types[y * width + x] = c.get_type();
+
+			if (c.isWalkable())
+				_walkable[word] |= bit;
+			if (c.isShootable())
+				_shootable[word] |= bit;
+			if (c.isWater())
+				_water[word] |= bit;
+		}
+	}
+}
+
+bool MapCellLayer::test_span(std::vector<uint64_t> const &plane, int16_t y, int16_t x_from, int16_t x_to) const
+{
+	if (x_from > x_to)
+		std::swap(x_from, x_to);
+
+	uint64_t const *row = &plane[y * _words_per_row];
+	int first_word = x_from >> 6, last_word = x_to >> 6;
+
+	for (int w = first_word; w <= last_word; ++w) {
+		uint64_t mask = ~uint64_t(0);
+
+		if (w == first_word)
+			mask &= ~uint64_t(0) << (x_from & 63);
+		if (w == last_word)
+			mask &= ~uint64_t(0) >> (63 - (x_to & 63));
+
+		if ((row[w] & mask) != mask)
+			return false;
+	}
+
+	return true;
+}
+
+bool MapCellLayer::test_line(std::vector<uint64_t> const &plane, int16_t x0, int16_t y0, int16_t x1, int16_t y1) const
+{
+	int dx = std::abs(x1 - x0), dy = -std::abs(y1 - y0);
+	int sx = x0 < x1 ? 1 : -1, sy = y0 < y1 ? 1 : -1;
+	int err = dx + dy;
+	int x = x0, y = y0, run_start = x0;
+
+	while (x != x1 || y != y1) {
+		int e2 = 2 * err;
+		int next_x = x, next_y = y;
+
+		if (e2 >= dy) {
+			err += dy;
+			next_x += sx;
+		}
+
+		if (e2 <= dx) {
+			err += dx;
+			next_y += sy;
+		}
+
+		// Test the run of cells on a row once the line leaves it.
+		if (next_y != y) {
+			if (!test_span(plane, y, run_start, x))
+				return false;
+
+			run_start = next_x;
+		}
+
+		x = next_x;
+		y = next_y;
+	}
+
+	return test_span(plane, y, run_start, x);
+}
@@ -0,0 +1,120 @@
+/***************************************************
+ *       _   _            _                        *
+ *      | | | |          (_)                       *
+ *      | |_| | ___  _ __ _ _______  _ __          *
+ *      |  _  |/ _ \| '__| |_  / _ \| '_  \        *
+ *      | | | | (_) | |  | |/ / (_) | | | |        *
+ *      \_| |_/\___/|_|  |_/___\___/|_| |_|        *
+ ***************************************************
+ * This file is part of Horizon (c).
+ *
+ * Copyright (c) 2019 Sagun K. (sagunxp@gmail.com).
+ * Copyright (c) 2019 Horizon Dev Team.
+ *
+ * Base Author - Sagun K. (sagunxp@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ **************************************************/
+
+#ifndef HORIZON_ZONE_GAME_MAPCELLLAYER_HPP
+#define HORIZON_ZONE_GAME_MAPCELLLAYER_HPP
+
+#include "Server/Zone/Definitions/MapDefinitions.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace Horizon
+{
+namespace Zone
+{
+/**
+ * @brief Immutable cell information of a map, sized to its actual dimensions.
+ * Besides the cell type, walkability, shootability and water are kept in separate
+ * bit-planes of 64 cells per word, stored row by row. Bit (x % 64) of word (x / 64)
+ * of a row holds cell x, and bits beyond the width of the map are always clear, so that
+ * pathfinding and line-of-sight checks can test up to 64 cells with a single operation.
+ * Layers are shared by every instance of the same map (@see MapManager::get_cell_layer).
+ * Coordinates must lie within the map, bounds are checked by the caller.
+ * @thread Immutable after construction, safe to read from any thread.
+ */
+class MapCellLayer
+{
+public:
+	MapCellLayer(uint16_t width, uint16_t height, std::vector<uint8_t> const &cells);
+
+	uint16_t width() const { return _width; }
+	uint16_t height() const { return _height; }
+	uint16_t words_per_row() const { return _words_per_row; }
+
+	map_cell_types get_type(int16_t x, int16_t y) const { return _types[y * _width + x]; }
+
+	bool is_walkable(int16_t x, int16_t y) const { return test(_walkable, x, y); }
+	bool is_shootable(int16_t x, int16_t y) const { return test(_shootable, x, y); }
+	bool is_water(int16_t x, int16_t y) const { return test(_water, x, y); }
+
+	uint64_t const *walkable_row(int16_t y) const { return &_walkable[y * _words_per_row]; }
+	uint64_t const *shootable_row(int16_t y) const { return &_shootable[y * _words_per_row]; }
+	uint64_t const *water_row(int16_t y) const { return &_water[y * _words_per_row]; }
+
+	/**
+	 * @brief Checks if every cell from x_from to x_to (inclusive) on row y is walkable.
+	 */
+	bool is_walkable_span(int16_t y, int16_t x_from, int16_t x_to) const { return test_span(_walkable, y, x_from, x_to); }
+
+	/**
+	 * @brief Checks if every cell from x_from to x_to (inclusive) on row y is shootable.
+	 */
+	bool is_shootable_span(int16_t y, int16_t x_from, int16_t x_to) const { return test_span(_shootable, y, x_from, x_to); }
+
+	/**
+	 * @brief Checks if every cell on the line between two cells is walkable.
+	 * The line is traced as by Bresenham's algorithm and tested one row span at a time.
+	 */
+	bool is_walkable_line(int16_t x0, int16_t y0, int16_t x1, int16_t y1) const { return test_line(_walkable, x0, y0, x1, y1); }
+
+	/**
+	 * @brief Checks if every cell on the line between two cells is shootable.
+	 */
+	bool is_shootable_line(int16_t x0, int16_t y0, int16_t x1, int16_t y1) const { return test_line(_shootable, x0, y0, x1, y1); }
+
+	/**
+	 * @brief Bytes held by this layer.
+	 */
+	std::size_t memory_usage() const
+	{
+		return sizeof(MapCellLayer) + _types.capacity() * sizeof(map_cell_types)
+			+ (_walkable.capacity() + _shootable.capacity() + _water.capacity()) * sizeof(uint64_t);
+	}
+
+private:
+	bool test(std::vector<uint64_t> const &plane, int16_t x, int16_t y) const
+	{
+		return (plane[y * _words_per_row + (x >> 6)] >> (x & 63)) & 1;
+	}
+
+	bool test_span(std::vector<uint64_t> const &plane, int16_t y, int16_t x_from, int16_t x_to) const;
+	bool test_line(std::vector<uint64_t> const &plane, int16_t x0, int16_t y0, int16_t x1, int16_t y1) const;
+
+	uint16_t _width{0}, _height{0};
+	uint16_t _words_per_row{0};
+	std::vector<map_cell_types> _types;
+	std::vector<uint64_t> _walkable;
+	std::vector<uint64_t> _shootable;
+	std::vector<uint64_t> _water;
+};
+}
+}
+
+#endif /* HORIZON_ZONE_GAME_MAPCELLLAYER_HPP */
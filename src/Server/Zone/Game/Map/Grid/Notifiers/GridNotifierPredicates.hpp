@@ -32,20 +32,6 @@
 
 #include "Server/Zone/Game/Entities/Entity.hpp"
 
-class GUIDCheckPredicate
-{
-public:
-	GUIDCheckPredicate(uint32_t guid) : _guid(guid) { }
-
-	bool operator()(std::weak_ptr<Horizon::Zone::Entity> entity)
-	{
-		return !entity.expired() && (entity.lock()->guid() == _guid);
-	}
-
-private:
-	uint32_t _guid;
-};
-
 class RangeCheckPredicate
 {
 public:
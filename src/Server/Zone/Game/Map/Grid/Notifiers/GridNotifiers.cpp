@@ -67,7 +67,7 @@ void GridPlayerNotifier::notify(GridRefManager<Horizon::Zone::Entities::Player>
 			default:
 				break;
 		}
-		iter->source()->get_session()->transmit_buffer(_buf, _buf.active_length());
+		iter->source()->get_session()->transmit_broadcast(_buf);
 	}
 }
 
@@ -89,17 +89,23 @@ void GridViewPortUpdater::update(GridRefManager<T> &m)
         return;
 
     std::shared_ptr<Player> pl = _entity.lock()->template downcast<Player>();
+    MapCoords const &to = pl->map_coords();
 
     for (typename GridRefManager<T>::iterator iter = m.begin(); iter != typename GridRefManager<T>::iterator(nullptr); ++iter) {
         if (iter->source() == nullptr || iter->source()->guid() == pl->guid())
             continue;
 
-        std::shared_ptr<Horizon::Zone::Entity> vp_e = iter->source()->shared_from_this();
+        bool in_range = iter->source()->map_coords().is_within_range(to, MAX_VIEW_RANGE);
 
-        if (pl->is_in_range_of(vp_e, MAX_VIEW_RANGE) && !vp_e->is_walking())
-            pl->add_entity_to_viewport(vp_e);
-        else if (!pl->is_in_range_of(vp_e, MAX_VIEW_RANGE))
-            pl->remove_entity_from_viewport(vp_e, EVP_NOTIFY_OUT_OF_SIGHT);
+        if (_step && in_range == iter->source()->map_coords().is_within_range(_from, MAX_VIEW_RANGE))
+            continue;
+
+        if (in_range) {
+            if (!iter->source()->is_walking() && !pl->viewport().contains(iter->source()->guid()))
+                _entered.push_back(iter->source()->shared_from_this());
+        } else if (pl->viewport().contains(iter->source()->guid())) {
+            _left.push_back(iter->source()->guid());
+        }
     }
 }
 
@@ -112,6 +118,34 @@ void GridViewPortUpdater::Visit(GridRefManager<Pet> &m) { update(m); }
 void GridViewPortUpdater::Visit(GridRefManager<Monster> &m) { update(m); }
 void GridViewPortUpdater::Visit(GridRefManager<Skill> &m) { update(m); }
 
+template <class T>
+void GridViewPortStepNotifier::notify(GridRefManager<T> &m)
+{
+    using namespace Horizon::Zone::Entities;
+
+    if (!m.get_size())
+        return;
+
+    std::shared_ptr<Horizon::Zone::Entity> src_entity = _entity.lock();
+
+    if (src_entity == nullptr)
+        return;
+
+    for (typename GridRefManager<T>::iterator iter = m.begin(); iter != typename GridRefManager<T>::iterator(nullptr); ++iter) {
+        if (iter->source() == nullptr || iter->source()->guid() == src_entity->guid())
+            continue;
+
+        Player *tpl = iter->source();
+
+        if (src_entity->map_coords().is_within_range(tpl->map_coords(), MAX_VIEW_RANGE))
+            tpl->add_entity_to_viewport(src_entity);
+        else
+            tpl->remove_entity_from_viewport(src_entity->guid(), EVP_NOTIFY_OUT_OF_SIGHT);
+    }
+}
+
+void GridViewPortStepNotifier::Visit(GridRefManager<Player> &m) { notify(m); }
+
 template <class T>
 void GridEntityExistenceNotifier::notify(GridRefManager<T> &m)
 {
@@ -143,13 +177,13 @@ void GridEntityExistenceNotifier::notify(GridRefManager<T> &m)
             if (!tpl->entity_is_in_viewport(src_entity))
                 continue;
             
-            tpl->remove_entity_from_viewport(src_entity, EVP_NOTIFY_OUT_OF_SIGHT);
+            tpl->remove_entity_from_viewport(src_entity->guid(), EVP_NOTIFY_OUT_OF_SIGHT);
         }
         else if (_notif_type > EVP_NOTIFY_OUT_OF_SIGHT) {
             if (!tpl->entity_is_in_viewport(src_entity))
                 continue;
 
-            tpl->remove_entity_from_viewport(src_entity, _notif_type);
+            tpl->remove_entity_from_viewport(src_entity->guid(), _notif_type);
         }
     }
 }
@@ -234,37 +268,6 @@ template <> void GridEntityMovementNotifier::Visit<Pet>(GridRefManager<Pet> &m);
 template <> void GridEntityMovementNotifier::Visit<Monster>(GridRefManager<Monster> &m);
 template <> void GridEntityMovementNotifier::Visit<Skill>(GridRefManager<Skill> &m);
 
-template <class T>
-void GridEntitySearcher::search(GridRefManager<T> &m)
-{
-    // Found check.
-    if (!_result.expired())
-        return;
-
-    using namespace Horizon::Zone;
-    for (typename GridRefManager<T>::iterator iter = m.begin(); iter != typename GridRefManager<T>::iterator(nullptr); ++iter) {
-        if (iter->source() == nullptr)
-            continue;
-
-        std::weak_ptr<Entity> entity = iter->source()->shared_from_this();
-        if (!entity.expired() && _predicate(entity)) {
-            _result = entity;
-            return;
-        }
-    }
-}
-
-std::shared_ptr<Horizon::Zone::Entity> GridEntitySearcher::get_result() const { return _result.lock(); }
-
-void GridEntitySearcher::Visit(GridRefManager<Player> &m) { search<Player>(m); }
-void GridEntitySearcher::Visit(GridRefManager<NPC> &m) { search<NPC>(m); }
-void GridEntitySearcher::Visit(GridRefManager<Elemental> &m) { search<Elemental>(m); }
-void GridEntitySearcher::Visit(GridRefManager<Homunculus> &m) { search<Homunculus>(m); }
-void GridEntitySearcher::Visit(GridRefManager<Mercenary> &m) { search<Mercenary>(m); }
-void GridEntitySearcher::Visit(GridRefManager<Pet> &m) { search<Pet>(m); }
-void GridEntitySearcher::Visit(GridRefManager<Monster> &m) { search<Monster>(m); }
-void GridEntitySearcher::Visit(GridRefManager<Skill> &m) { search<Skill>(m); }
-
 template <class T>
 void GridMonsterActiveAIExecutor::perform(GridRefManager<T> &m)
 {
@@ -322,15 +325,12 @@ void GridMonsterAIActiveSearchTarget::search(GridRefManager<T> &m)
         // option reduces position lag in such situation. But doing a complex search for every possible
         // target, might be CPU intensive.
         // Disable this to make monsters not do any path search when looking for a target (old behavior).
-        AStar::CoordinateList wp = m->map()->get_pathfinder().findPath(m->map_coords(), e->map_coords());
-
-        if (wp.size() == 0) 
-            continue; // no walk path available.
-
         //Standing monsters use view range, walking monsters use chase range
-        if ((m->is_walking() == false && wp.size() > m->monster_config()->view_range)
-            || (m->is_walking() == true && wp.size() > m->monster_config()->chase_range))
-            continue;
+        // Ranges count the cells of the walk path including the starting one, i.e. one more than its moves.
+        int range = m->is_walking() ? m->monster_config()->chase_range : m->monster_config()->view_range;
+
+        if (range <= 0 || !m->can_reach(e, range - 1))
+            continue; // no walk path available within range.
 #endif
         m->set_target(e);
 
@@ -364,9 +364,8 @@ void GridMonsterAIChangeChaseTarget::search(GridRefManager<T> &m)
         if (m == nullptr || e == nullptr)
             continue;
 
-        std::shared_ptr<AStar::CoordinateList> wp = m->path_to(e);
-        
-        if (wp->size() > m->monster_config()->attack_range)
+        // As for the target search, the range includes the starting cell of the walk path.
+        if (m->monster_config()->attack_range <= 0 || !m->can_reach(e, m->monster_config()->attack_range - 1))
             continue;
 
         m->set_target(e);
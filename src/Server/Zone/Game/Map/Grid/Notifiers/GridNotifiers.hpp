@@ -30,18 +30,32 @@
 #ifndef HORIZON_ZONE_GAME_MAP_GRIDNOTIFIERS_HPP
 #define HORIZON_ZONE_GAME_MAP_GRIDNOTIFIERS_HPP
 
+#include "Libraries/Networking/Buffer/BroadcastBuffer.hpp"
 #include "Libraries/Networking/Buffer/ByteBuffer.hpp"
 #include "Server/Zone/Definitions/EntityDefinitions.hpp"
 #include "Server/Zone/Definitions/ClientDefinitions.hpp"
 #include "Server/Zone/Game/Map/Grid/Notifiers/GridNotifierPredicates.hpp"
 
 #define entity_ns(class) Horizon::Zone::Entities::class
+/**
+ * @brief Collects the entities that enter and leave a player's viewport, @see Player::update_viewport().
+ * After a walk step only entities that crossed the view boundary are looked at, those in view
+ * of both ends of the step keep their viewport state.
+ */
 struct GridViewPortUpdater
 {
 	std::weak_ptr<Horizon::Zone::Entity> _entity;
+	MapCoords _from;
+	bool _step{false};
+	std::vector<std::shared_ptr<Horizon::Zone::Entity>> _entered;
+	std::vector<uint32_t> _left;
 
 	explicit GridViewPortUpdater(const std::shared_ptr<Horizon::Zone::Entity>& entity) : _entity(entity) { }
 
+	GridViewPortUpdater(const std::shared_ptr<Horizon::Zone::Entity>& entity, MapCoords const &from)
+	: _entity(entity), _from(from), _step(true)
+	{ }
+
 	template <class T>
 	void update(GridRefManager<T> &m);
 
@@ -58,14 +72,15 @@ struct GridViewPortUpdater
 	void Visit(GridRefManager<NOT_INTERESTED> &) { }
 };
 
-struct GridEntityExistenceNotifier
+/**
+ * @brief Adds an entity that took a walk step to the viewports of the players that now see it
+ * and removes it from those that lost sight of it, in a single pass over both ends of the step.
+ */
+struct GridViewPortStepNotifier
 {
 	std::weak_ptr<Horizon::Zone::Entity> _entity;
-	entity_viewport_notification_type _notif_type;
 
-	explicit GridEntityExistenceNotifier(const std::shared_ptr<Horizon::Zone::Entity>& entity, entity_viewport_notification_type notif_type)
-	: _entity(entity), _notif_type(notif_type)
-	{ }
+	explicit GridViewPortStepNotifier(const std::shared_ptr<Horizon::Zone::Entity>& entity) : _entity(entity) { }
 
 	template <class T>
 	void notify(GridRefManager<T> &m);
@@ -76,12 +91,13 @@ struct GridEntityExistenceNotifier
 	void Visit(GridRefManager<NOT_INTERESTED> &) { }
 };
 
-struct GridEntitySpawnNotifier
+struct GridEntityExistenceNotifier
 {
 	std::weak_ptr<Horizon::Zone::Entity> _entity;
+	entity_viewport_notification_type _notif_type;
 
-	explicit GridEntitySpawnNotifier(const std::shared_ptr<Horizon::Zone::Entity>& entity)
-	: _entity(entity)
+	explicit GridEntityExistenceNotifier(const std::shared_ptr<Horizon::Zone::Entity>& entity, entity_viewport_notification_type notif_type)
+	: _entity(entity), _notif_type(notif_type)
 	{ }
 
 	template <class T>
@@ -93,13 +109,12 @@ struct GridEntitySpawnNotifier
 	void Visit(GridRefManager<NOT_INTERESTED> &) { }
 };
 
-struct GridEntityMovementNotifier
+struct GridEntitySpawnNotifier
 {
 	std::weak_ptr<Horizon::Zone::Entity> _entity;
-	bool _new_entry{ false };
 
-	explicit GridEntityMovementNotifier(const std::shared_ptr<Horizon::Zone::Entity>& entity, bool new_entry = false)
-	: _entity(entity), _new_entry(new_entry)
+	explicit GridEntitySpawnNotifier(const std::shared_ptr<Horizon::Zone::Entity>& entity)
+	: _entity(entity)
 	{ }
 
 	template <class T>
@@ -111,28 +126,19 @@ struct GridEntityMovementNotifier
 	void Visit(GridRefManager<NOT_INTERESTED> &) { }
 };
 
-struct GridEntitySearcher
+struct GridEntityMovementNotifier
 {
-	std::weak_ptr<Horizon::Zone::Entity> _result;
-	GUIDCheckPredicate _predicate;
+	std::weak_ptr<Horizon::Zone::Entity> _entity;
+	bool _new_entry{ false };
 
-	explicit GridEntitySearcher(uint32_t guid)
-	: _predicate(guid)
+	explicit GridEntityMovementNotifier(const std::shared_ptr<Horizon::Zone::Entity>& entity, bool new_entry = false)
+	: _entity(entity), _new_entry(new_entry)
 	{ }
 
-	[[nodiscard]] std::shared_ptr<Horizon::Zone::Entity> get_result() const;
-
 	template <class T>
-	void search(GridRefManager<T> &m);
+	void notify(GridRefManager<T> &m);
 
 	void Visit(GridRefManager<entity_ns(Player)> &m);
-	void Visit(GridRefManager<entity_ns(NPC)> &m);
-	void Visit(GridRefManager<entity_ns(Elemental)> &m);
-	void Visit(GridRefManager<entity_ns(Homunculus)> &m);
-	void Visit(GridRefManager<entity_ns(Mercenary)> &m);
-	void Visit(GridRefManager<entity_ns(Pet)> &m);
-	void Visit(GridRefManager<entity_ns(Monster)> &m);
-	void Visit(GridRefManager<entity_ns(Skill)> &m);
 
 	template<class NOT_INTERESTED>
 	void Visit(GridRefManager<NOT_INTERESTED> &) { }
@@ -215,13 +221,17 @@ struct GridNPCTrigger
 	void Visit(GridRefManager<NOT_INTERESTED> &) { }
 };
 
+/**
+ * @brief Sends a packet to the players around an entity.
+ * The packet is encoded and checked once by the caller, every recipient queues a view of the same buffer.
+ */
 struct GridPlayerNotifier
 {
 	std::weak_ptr<Horizon::Zone::Entity> _entity;
-	ByteBuffer _buf;
+	BroadcastBuffer const &_buf;
 	grid_notifier_type _type;
 
-	explicit GridPlayerNotifier(ByteBuffer &buf, const std::shared_ptr<Horizon::Zone::Entity>& entity, grid_notifier_type type = GRID_NOTIFY_AREA)
+	explicit GridPlayerNotifier(BroadcastBuffer const &buf, const std::shared_ptr<Horizon::Zone::Entity>& entity, grid_notifier_type type = GRID_NOTIFY_AREA)
 	: _entity(entity), _buf(buf), _type(type)
 	{ }
 
@@ -37,17 +37,13 @@
 
 using namespace Horizon::Zone;
 
-Map::Map(std::weak_ptr<MapContainerThread> container, std::string const &name, uint16_t width, uint16_t height, std::vector<uint8_t> const &cells)
+Map::Map(std::weak_ptr<MapContainerThread> container, std::string const &name, uint16_t width, uint16_t height, std::shared_ptr<MapCellLayer const> cells)
 : _container(container), _name(name), _width(width), _height(height),
   _max_grids((width / MAX_CELLS_PER_GRID), (height / MAX_CELLS_PER_GRID)),
+  _cells(cells),
   _gridholder(GridCoords(width, height)),
   _pathfinder(AStar::Generator(MapCoords(width, height), std::bind(&Map::has_obstruction_at, this, std::placeholders::_1, std::placeholders::_2), MAX_VIEW_RANGE))
 {
-	for (int y = height - 1; y >= 0; --y) {
-		for (int x = 0; x < width; ++x) {
-			_cells[x][y] = Cell(cells.at(y * width + x));
-		}
-	}
 }
 
 Map::~Map()
@@ -56,15 +52,27 @@ Map::~Map()
 
 bool Map::has_obstruction_at(int16_t x, int16_t y)
 {
-	if (x < 0 || y < 0 || x > _width || y > _height)
+	if (x < 0 || y < 0 || x >= _width || y >= _height)
 		return true;
 
-	Cell c = _cells[x][y];
-	
-	if (!c.isWalkable())
-		return true;
+	return !_cells->is_walkable(x, y);
+}
+
+
 
-	return false;
+bool Map::is_walkable_line(MapCoords const &from, MapCoords const &to)
+{
+	if (has_obstruction_at(from.x(), from.y()) || has_obstruction_at(to.x(), to.y()))
+		return false;
+
+	return _cells->is_walkable_line(from.x(), from.y(), to.x(), to.y());
 }
 
+bool Map::has_line_of_sight(MapCoords const &from, MapCoords const &to)
+{
+	if (from.x() < 0 || from.y() < 0 || from.x() >= _width || from.y() >= _height
+		|| to.x() < 0 || to.y() < 0 || to.x() >= _width || to.y() >= _height)
+		return false;
 
+	return _cells->is_shootable_line(from.x(), from.y(), to.x(), to.y());
+}
@@ -31,10 +31,11 @@
 #define HORIZON_ZONE_GAME_MAP_HPP
 
 #include "Path/AStar.hpp"
+#include "EntityIndex.hpp"
 #include "Core/Logging/Logger.hpp"
 #include "Server/Common/Configuration/Horizon.hpp"
 #include "Server/Zone/Definitions/EntityDefinitions.hpp"
-#include "Server/Zone/Game/Map/Grid/Cell/Cell.hpp"
+#include "Server/Zone/Game/Map/Grid/Cell/MapCellLayer.hpp"
 #include "Server/Zone/Game/Map/Grid/GridDefinitions.hpp"
 #include "Server/Zone/Game/Map/Grid/Container/GridReferenceContainerVisitor.hpp"
 #include "Server/Zone/Game/Map/Grid/GridHolder.hpp"
@@ -43,14 +44,47 @@ namespace Horizon
 {
 namespace Zone
 {
+class Entity;
 class Map
 {
 friend class MapManager;
 public:
-	Map(std::weak_ptr<MapContainerThread>, std::string const &, uint16_t, uint16_t, std::vector<uint8_t> const &);
+	Map(std::weak_ptr<MapContainerThread>, std::string const &, uint16_t, uint16_t, std::shared_ptr<MapCellLayer const>);
 	~Map();
 
-	std::shared_ptr<MapContainerThread> container() { return _container.lock(); }
+	/**
+	 * @brief Container the map is updated by, it changes when the map is migrated to another container.
+	 * @thread any
+	 */
+	std::shared_ptr<MapContainerThread> container()
+	{
+		std::lock_guard<std::mutex> lock(_container_mtx);
+		return _container.lock();
+	}
+
+	void set_container(std::weak_ptr<MapContainerThread> container)
+	{
+		std::lock_guard<std::mutex> lock(_container_mtx);
+		_container = container;
+	}
+
+	/**
+	 * @brief Charges time spent updating the map to its tick cost.
+	 * @thread any
+	 */
+	void add_tick_cost(uint64_t us) { _tick_cost_accumulator.fetch_add(us, std::memory_order_relaxed); }
+
+	/**
+	 * @brief Closes the current tick cost sample, the cost of the last sample is kept for readers.
+	 * @thread MapContainerThread
+	 */
+	void sample_tick_cost() { _tick_cost = _tick_cost_accumulator.exchange(0, std::memory_order_relaxed); }
+
+	/**
+	 * @brief Time spent updating the map during the last sample, in microseconds.
+	 * @thread any
+	 */
+	uint64_t get_tick_cost() { return _tick_cost; }
 
 	std::string const &get_name() { return _name; }
 
@@ -59,13 +93,40 @@ public:
 	uint16_t get_width() { return _width; }
 	uint16_t get_height() { return _height; }
 
-	map_cell_types get_cell_type(MapCoords coords) { return _cells[coords.x()][coords.y()].get_type(); }
+	map_cell_types get_cell_type(MapCoords coords) { return _cells->get_type(coords.x(), coords.y()); }
+
+	MapCellLayer const &get_cell_layer() { return *_cells; }
 
 	GridHolderType &getGridHolder() { return _gridholder; }
 
 	template <class T>
 	bool ensure_grid_for_entity(T *entity, MapCoords coords);
 
+	/**
+	 * @brief Looks an entity placed on the map up by guid, without regard to its position.
+	 * Entities are indexed when placed by ensure_grid_for_entity() and removed with remove_entity_from_index().
+	 * Players warping in from a map of another container are indexed once this map's container takes them over.
+	 * @thread MapContainerThread
+	 */
+	std::shared_ptr<Entity> find_entity(uint32_t guid) const { return _entity_index.find(guid); }
+
+	/**
+	 * @brief Removes an entity that leaves the map or the game from the guid index, along with its grid reference.
+	 * Nothing is removed if the guid was indexed for another entity since. Not to be called from destructors,
+	 * entries of destroyed entities expire by themselves (@see EntityIndex).
+	 * @thread MapContainerThread
+	 */
+	void remove_entity_from_index(uint32_t guid, Entity const *entity) { _entity_index.erase(guid, entity); }
+
+	/**
+	 * @brief Indexes an entity already placed on the map, replacing any entity indexed under its guid.
+	 * @thread MapContainerThread
+	 */
+	template <class T>
+	void add_entity_to_index(std::shared_ptr<T> const &entity) { _entity_index.insert(entity->guid(), entity); }
+
+	std::size_t get_indexed_entity_count() const { return _entity_index.size(); }
+
 	template<class T, class CONTAINER>
 	void visit(GridCoords const &grid, GridReferenceContainerVisitor<T, CONTAINER> &visitor);
 
@@ -75,10 +136,31 @@ public:
 	template<class T, class CONTAINER>
 	void visit_in_range(MapCoords const &map_coords, GridReferenceContainerVisitor<T, CONTAINER> &visitor, uint16_t range = MAX_VIEW_RANGE);
 
+	/**
+	 * @brief Visits the grids in range of either of two coordinates, e.g. both ends of a walk step.
+	 */
+	template<class T, class CONTAINER>
+	void visit_in_range(MapCoords const &from, MapCoords const &to, GridReferenceContainerVisitor<T, CONTAINER> &visitor, uint16_t range = MAX_VIEW_RANGE);
+
 	AStar::Generator &get_pathfinder() { return _pathfinder; }
 
 	bool has_obstruction_at(int16_t x, int16_t y);
 
+	/**
+	 * @brief Checks if every cell on the straight line between two coordinates is walkable.
+	 */
+	bool is_walkable_line(MapCoords const &from, MapCoords const &to);
+
+	/**
+	 * @brief Checks if every cell on the straight line between two coordinates can be shot through.
+	 */
+	bool has_line_of_sight(MapCoords const &from, MapCoords const &to);
+
+	/**
+	 * @brief Checks if to can be walked to from from in at most max_steps moves, without building a path.
+	 */
+	bool can_reach(MapCoords const &from, MapCoords const &to, uint32_t max_steps) { return _pathfinder.isReachable(from, to, max_steps); }
+
 	MapCoords get_random_accessible_coordinates()
 	{
 		int16_t x = 0;
@@ -138,12 +220,16 @@ public:
 	}
 	
 private:
+	std::mutex _container_mtx;
 	std::weak_ptr<MapContainerThread> _container;
+	std::atomic<uint64_t> _tick_cost_accumulator{0};
+	std::atomic<uint64_t> _tick_cost{0};
 	std::string _name{""};
 	uint16_t _width{0}, _height{0};
 	GridCoords _max_grids;
-	Cell _cells[MAX_CELLS_PER_MAP][MAX_CELLS_PER_MAP]{{0}};
+	std::shared_ptr<MapCellLayer const> _cells;
 	GridHolderType _gridholder;
+	EntityIndex<Entity> _entity_index;
 	AStar::Generator _pathfinder;
 };
 }
@@ -152,19 +238,30 @@ private:
 template <class T>
 bool Horizon::Zone::Map::ensure_grid_for_entity(T *entity, MapCoords mcoords)
 {
-	std::string const &new_map_name = entity->map()->get_name();
+	std::shared_ptr<Map> previous_map = entity->map();
 	GridCoords new_gcoords = mcoords.scale<MAX_CELLS_PER_GRID, MAX_GRIDS_PER_MAP>();
 
-	if (new_map_name.compare(get_name()) == 0 && entity->grid_coords() == new_gcoords)
+	if (previous_map->get_name().compare(get_name()) == 0 && entity->grid_coords() == new_gcoords && entity->has_valid_grid_reference())
 		return false;
 
+	bool const changes_map = previous_map.get() != this;
+	// Indexes are only changed by the container of their map. An entity moving to a map of another container
+	// is erased and indexed by either container when it processes the handoff (@see MapContainerThread::update).
+	bool const same_container = !changes_map || previous_map->container() == container();
+
 	if (entity->has_valid_grid_reference())
 		entity->remove_grid_reference();
 
+	if (changes_map && same_container)
+		previous_map->remove_entity_from_index(entity->guid(), entity);
+
 	entity->set_grid_coords(new_gcoords);
 
 	_gridholder.get_grid(new_gcoords).add_object(entity);
 
+	if (same_container)
+		_entity_index.insert(entity->guid(), entity->shared_from_this());
+
 	return true;
 }
 
@@ -183,6 +280,15 @@ inline void Horizon::Zone::Map::visit_in_range(MapCoords const &map_coords, Grid
 	visit(lower_bounds.scale<MAX_CELLS_PER_GRID, MAX_GRIDS_PER_MAP>(), upper_bounds.scale<MAX_CELLS_PER_GRID, MAX_GRIDS_PER_MAP>(), visitor);
 }
 
+template<class T, class CONTAINER>
+inline void Horizon::Zone::Map::visit_in_range(MapCoords const &from, MapCoords const &to, GridReferenceContainerVisitor<T, CONTAINER> &visitor, uint16_t range)
+{
+	MapCoords lower_bounds = MapCoords(std::min(from.x(), to.x()), std::min(from.y(), to.y())).at_range<MAX_CELLS_PER_MAP>(-range);
+	MapCoords upper_bounds = MapCoords(std::max(from.x(), to.x()), std::max(from.y(), to.y())).at_range<MAX_CELLS_PER_MAP>(range);
+
+	visit(lower_bounds.scale<MAX_CELLS_PER_GRID, MAX_GRIDS_PER_MAP>(), upper_bounds.scale<MAX_CELLS_PER_GRID, MAX_GRIDS_PER_MAP>(), visitor);
+}
+
 template<class T, class CONTAINER>
 inline void Horizon::Zone::Map::visit(GridCoords const &lower_bound, GridCoords const &upper_bound, GridReferenceContainerVisitor<T, CONTAINER> &visitor)
 {
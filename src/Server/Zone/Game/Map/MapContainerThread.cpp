@@ -34,10 +34,25 @@
 #include "Server/Zone/Session/ZoneSession.hpp"
 #include "Server/Zone/Zone.hpp"
 #include "Server/Zone/Game/Map/Map.hpp"
+#include "Server/Zone/Game/Map/MapManager.hpp"
+#include "Server/Zone/Persistence/LoginManager.hpp"
 #include "Core/Logging/Logger.hpp"
 
+#include <unordered_set>
+
 using namespace Horizon::Zone;
 
+static uint64_t elapsed_us(std::chrono::steady_clock::time_point const &from, std::chrono::steady_clock::time_point const &to)
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+}
+
+// Moving average over roughly the last 16 ticks, seeded with the first sample.
+static uint64_t moving_average(uint64_t average, uint64_t sample, uint64_t ticks)
+{
+	return ticks <= 1 ? sample : (average * 15 + sample) / 16;
+}
+
 MapContainerThread::MapContainerThread()
 {
 
@@ -88,24 +103,91 @@ void MapContainerThread::remove_player(std::shared_ptr<Entities::Player> p)
 	_player_buffer.push(std::make_pair(false, p));
 }
 
+void MapContainerThread::reset_statistics()
+{
+	_tick_histogram.reset();
+	_overrun_count = 0;
+	_skipped_ticks = 0;
+}
+
+void MapContainerThread::add_managed_player(std::shared_ptr<Entities::Player> player)
+{
+	auto slot = _player_slots.find(player->guid());
+
+	if (slot != _player_slots.end()) {
+		_players[slot->second] = std::move(player);
+		return;
+	}
+
+	_player_slots.emplace(player->guid(), _players.size());
+	_players.push_back(std::move(player));
+	_player_count = _players.size();
+}
+
+void MapContainerThread::remove_player_from_map_indexes(Entities::Player *player)
+{
+	for (auto &m : _managed_maps.get_map())
+		m.second->remove_entity_from_index(player->guid(), player);
+}
+
+bool MapContainerThread::remove_managed_player(int32_t guid)
+{
+	auto slot = _player_slots.find(guid);
+
+	if (slot == _player_slots.end())
+		return false;
+
+	std::size_t idx = slot->second;
+
+	_player_slots.erase(slot);
+
+	if (idx != _players.size() - 1) {
+		_players[idx] = std::move(_players.back());
+		_player_slots[_players[idx]->guid()] = idx;
+	}
+
+	_players.pop_back();
+	_player_count = _players.size();
+
+	return true;
+}
+
+map_container_statistics MapContainerThread::get_statistics()
+{
+	map_container_statistics stats;
+
+	stats.maps = _managed_maps.size();
+	stats.players = _player_count;
+	stats.load_weight = _load_weight;
+	stats.ticks = _tick_count;
+	stats.last_tick_us = _last_tick_us;
+	stats.average_tick_us = _average_tick_us;
+	stats.max_tick_us = _tick_histogram.max();
+	stats.p50_tick_us = _tick_histogram.percentile(50);
+	stats.p99_tick_us = _tick_histogram.percentile(99);
+	stats.tick_period_us = _tick_period_us;
+	stats.overruns = _overrun_count;
+	stats.skipped_ticks = _skipped_ticks;
+	stats.shedding_load = _shedding_load;
+	stats.average_inbox_us = _average_inbox_us;
+	stats.average_session_us = _average_session_us;
+	stats.average_scheduler_us = _average_scheduler_us;
+
+	return stats;
+}
+
 std::shared_ptr<Entities::Player> MapContainerThread::get_player(std::string const &name)
 {
-	std::map<int32_t, std::shared_ptr<Entities::Player>> player_map = _managed_players.get_map();
-	for (auto it = player_map.begin(); it != player_map.end(); it++)
-		if (it->second->name() == name)
-			return it->second;
+	std::shared_ptr<Entities::Player> player = MapMgr->find_player(name);
 
-	return nullptr;
+	return player != nullptr && player->map_container().get() == this ? player : nullptr;
 }
 
 std::shared_ptr<Entities::Player> MapContainerThread::get_player(int guid)
 {
-	std::map<int32_t, std::shared_ptr<Entities::Player>> player_map = _managed_players.get_map();
-	for (auto it = player_map.begin(); it != player_map.end(); it++)
-		if (it->second->guid() == guid)
-			return it->second;
+	std::shared_ptr<Entities::Player> player = MapMgr->find_player(guid);
 
-	return nullptr;
+	return player != nullptr && player->map_container().get() == this ? player : nullptr;
 }
 
 //! @brief Responsible for initialization of the container and is called externally.
@@ -120,19 +202,23 @@ void MapContainerThread::initialize()
 //! This method must not be called from within the thread itself! @see MapManager::finalize()
 void MapContainerThread::finalize()
 {
-	std::map<int32_t, std::shared_ptr<Entities::Player>> pmap = _managed_players.get_map();
-	for (auto pi = pmap.begin(); pi != pmap.end();) {
-		std::shared_ptr<Entities::Player> player = pi->second;
+	// Managed players are owned by the container thread, they are only touched once it has stopped.
+	if (_thread.joinable())
+		_thread.join();
 
-		if (player && player->get_session())
+	for (std::shared_ptr<Entities::Player> &player : _players) {
+		if (player->get_session())
 			player->save();
 
 		// Disconnect player.
 //		player->get_packet_handler()->Send_ZC_ACK_REQ_DISCONNECT(true);
-		_managed_players.erase(player->guid());
-		pi++;
+		MapMgr->deregister_player(player);
 	}
 
+	_players.clear();
+	_player_slots.clear();
+	_player_count = 0;
+
 	// Clear anyone in the player buffer (You never know...)
 	std::shared_ptr<std::pair<bool, std::shared_ptr<Entities::Player>>> pbuf = nullptr;
 
@@ -142,12 +228,23 @@ void MapContainerThread::finalize()
 		if (!player || !player->get_session())
 			continue;
 
+		// Players that were still entering the zone have nothing to save yet.
+		if (!player->is_initialized()) {
+			LoginMgr->finish(player);
+			continue;
+		}
+
 		player->save();
 //		player->get_packet_handler()->Send_ZC_ACK_REQ_DISCONNECT(true);
 	}
 
-	if (_thread.joinable())
-		_thread.join();
+	// Players of maps still being handed over to this container when it stopped.
+	std::shared_ptr<std::shared_ptr<map_migration>> incoming;
+
+	while ((incoming = _incoming_maps.try_pop()))
+		for (auto &player : (*incoming)->players)
+			if (player->get_session())
+				player->save();
 
 	_managed_maps.clear();
 
@@ -172,9 +269,71 @@ void MapContainerThread::start_internal()
 {
 	get_lua_manager()->initialize_for_container();
 
+	std::chrono::microseconds const period(1000000 / std::max(1, sZone->config().map_container_tick_rate()));
+	std::chrono::steady_clock::time_point const epoch = std::chrono::steady_clock::now();
+	std::chrono::steady_clock::time_point deadline = epoch, last_overrun_warning = epoch;
+	uint64_t consecutive_overruns = 0, overruns_since_warning = 0;
+
+	_tick_period_us = period.count();
+
 	while (!sZone->general_conf().is_test_run() && sZone->get_shutdown_stage() == SHUTDOWN_NOT_STARTED) {
-		update(std::time(nullptr));
-		std::this_thread::sleep_for(std::chrono::microseconds(MAX_CORE_UPDATE_INTERVAL));
+		std::chrono::steady_clock::time_point tick_start = std::chrono::steady_clock::now();
+
+		update(std::chrono::duration_cast<std::chrono::milliseconds>(tick_start - epoch).count());
+
+		std::chrono::steady_clock::time_point tick_end = std::chrono::steady_clock::now();
+		uint64_t tick_us = elapsed_us(tick_start, tick_end);
+		uint64_t ticks = ++_tick_count;
+
+		// Only this thread writes the timings, plain stores are enough.
+		_last_tick_us = tick_us;
+		_average_tick_us = moving_average(_average_tick_us, tick_us, ticks);
+		_tick_histogram.record(tick_us);
+
+		if (tick_us > (uint64_t) period.count()) {
+			_overrun_count++;
+			overruns_since_warning++;
+			consecutive_overruns++;
+		} else {
+			consecutive_overruns = 0;
+		}
+
+		// Sessions are limited to a few packets per tick while ticks keep overrunning, the rest waits in their queues.
+		bool shedding = consecutive_overruns >= MAP_CONTAINER_SHED_AFTER_OVERRUNS;
+
+		if (shedding != _shedding_load) {
+			_shedding_load = shedding;
+
+			if (shedding)
+				HLog(warning) << "Map container " << (void *) this << " is overloaded, limiting sessions to " << MAP_CONTAINER_SHED_PACKET_BUDGET << " packets per tick.";
+			else
+				HLog(info) << "Map container " << (void *) this << " has recovered, lifting its limit of packets per tick.";
+		}
+
+		if (overruns_since_warning > 0 && tick_end - last_overrun_warning >= std::chrono::seconds(MAP_CONTAINER_OVERRUN_WARNING_INTERVAL)) {
+			HLog(warning) << "Map container " << (void *) this << " overran its " << period.count() << "us tick budget " << overruns_since_warning
+				<< " times in the last " << std::chrono::duration_cast<std::chrono::seconds>(tick_end - last_overrun_warning).count() << " seconds, last tick took " << tick_us << "us.";
+			overruns_since_warning = 0;
+			last_overrun_warning = tick_end;
+		}
+
+		if (tick_end - _last_tick_cost_sample >= std::chrono::seconds(MAP_TICK_COST_SAMPLE_INTERVAL)) {
+			sample_map_tick_costs();
+			_last_tick_cost_sample = tick_end;
+		}
+
+		deadline += period;
+
+		// Ticks that were missed are dropped rather than run back to back to catch up.
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+		if (now >= deadline) {
+			uint64_t missed = (now - deadline) / period + 1;
+			_skipped_ticks += missed;
+			deadline += period * missed;
+		}
+
+		std::this_thread::sleep_until(deadline);
 	};
 
 	get_lua_manager()->finalize();
@@ -182,46 +341,200 @@ void MapContainerThread::start_internal()
 
 //! @brief World update loop for a MapContainerThread.
 //! Performs world updates for maps managed in the specific thread container.
-//! @param[in] diff current system time.
-void MapContainerThread::update(uint64_t diff)
+//! @param[in] tick monotonic time of the update in milliseconds, since the container started.
+void MapContainerThread::update(uint64_t tick)
 {
 	std::shared_ptr<std::pair<bool, std::shared_ptr<Entities::Player>>> pbuf = nullptr;
+	std::chrono::steady_clock::time_point inbox_start = std::chrono::steady_clock::now();
+
+	adopt_migrated_maps();
 
 	// Add any new players / remove anyone else.
 	while ((pbuf = _player_buffer.try_pop())) {
 		std::shared_ptr<Entities::Player> player = pbuf->second;
 
-		if (player->get_session() == nullptr)
+		if (player->get_session() == nullptr) {
+			LoginMgr->finish(player);
 			continue;
+		}
+
+		// Players queued to this container after their map was migrated away are forwarded to its current container.
+		std::shared_ptr<Map> map = player->map();
+		std::shared_ptr<MapContainerThread> owner = map != nullptr ? map->container() : nullptr;
+
+		if (owner != nullptr && owner.get() != this && (pbuf->first || !is_managed_player(player->guid()))) {
+			if (pbuf->first)
+				owner->add_player(player);
+			else
+				owner->remove_player(player);
+			continue;
+		}
 
 		if (pbuf->first) {
+			// Players that just entered the zone are published to their session before anything is sent to them.
+			LoginMgr->accept(player);
 			if (!player->is_initialized())
 				player->initialize();
-			_managed_players.insert(player->guid(), player);
+			// Players warping in from another container were placed on the map by it, but only indexed here.
+			if (player->map() != nullptr)
+				player->map()->add_entity_to_index(player);
+			// Frees the login slot of players that just entered the zone.
+			LoginMgr->finish(player);
+			add_managed_player(player);
+			MapMgr->register_player(player);
 		} else {
-			_managed_players.erase(player->guid());
+			// Players leaving the game are saved here, on the thread that owns them.
+			if (!player->is_logged_in()) {
+				player->save();
+				MapMgr->deregister_player(player);
+			}
+			// Players logging out or warping to a map of another container, whose container indexes them from then on.
+			remove_player_from_map_indexes(player.get());
+			remove_managed_player(player->guid());
 		}
 	}
 
-	// Update sessions
-	std::map<int32_t, std::shared_ptr<Entities::Player>> pmap = _managed_players.get_map();
-	for (auto pi = pmap.begin(); pi != pmap.end();) {
-		std::shared_ptr<Entities::Player> player = pi->second;
+	std::chrono::steady_clock::time_point sessions_start = std::chrono::steady_clock::now();
 
-		if (!player
-			|| !player->get_session()
+	// Update sessions. Players are removed by swapping the last one into their slot, which is then revisited.
+	for (std::size_t i = 0; i < _players.size();) {
+		Entities::Player *player = _players[i].get();
+
+		if (!player->get_session()
 			|| !player->get_session()->get_socket()
 			|| !player->character()._online
 			) {
-			_managed_players.erase(player->guid());
-			pi++;
+			MapMgr->deregister_player(_players[i]);
+			remove_player_from_map_indexes(player);
+			remove_managed_player(player->guid());
 			continue;
 		}
 		// process packets
-		player->get_session()->update(diff);
-		pi++;
+		std::chrono::steady_clock::time_point update_start = std::chrono::steady_clock::now();
+
+		player->get_session()->set_packet_budget(_shedding_load ? MAP_CONTAINER_SHED_PACKET_BUDGET : 0);
+		player->get_session()->update(tick);
+
+		if (std::shared_ptr<Map> map = player->map())
+			map->add_tick_cost(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - update_start).count());
+
+		i++;
 	}
 
-	// Update Monsters
-	getScheduler().Update();
+	std::chrono::steady_clock::time_point scheduler_start = std::chrono::steady_clock::now();
+
+	// Update Monsters, the scheduler's clock advances by the time elapsed between ticks.
+	getScheduler().Update(std::chrono::milliseconds(tick - _last_tick_ms));
+	_last_tick_ms = tick;
+
+	std::chrono::steady_clock::time_point scheduler_end = std::chrono::steady_clock::now();
+	uint64_t ticks = _tick_count + 1;
+
+	_average_inbox_us = moving_average(_average_inbox_us, elapsed_us(inbox_start, sessions_start), ticks);
+	_average_session_us = moving_average(_average_session_us, elapsed_us(sessions_start, scheduler_start), ticks);
+	_average_scheduler_us = moving_average(_average_scheduler_us, elapsed_us(scheduler_start, scheduler_end), ticks);
+
+	// Maps only change containers between updates.
+	send_migrating_maps();
+}
+
+void MapContainerThread::migrate_map(std::string const &name, std::shared_ptr<MapContainerThread> target)
+{
+	_outgoing_maps.push(std::make_pair(name, std::weak_ptr<MapContainerThread>(target)));
+}
+
+void MapContainerThread::send_migrating_maps()
+{
+	std::shared_ptr<std::pair<std::string, std::weak_ptr<MapContainerThread>>> request;
+
+	while ((request = _outgoing_maps.try_pop())) {
+		std::shared_ptr<Map> map = _managed_maps.at(request->first);
+		std::shared_ptr<MapContainerThread> target = request->second.lock();
+
+		if (map == nullptr || target == nullptr || target.get() == this) {
+			HLog(warning) << "Map '" << request->first << "' can not be migrated from map container " << (void *) this << ", it is not managed by it or the target is invalid.";
+			continue;
+		}
+
+		std::shared_ptr<map_migration> migration = std::make_shared<map_migration>();
+		std::unordered_set<uint32_t> guids;
+
+		migration->map = map;
+		migration->load_weight = MapMgr->get_map_weight(map->get_name());
+
+		for (std::size_t i = 0; i < _players.size();) {
+			if (_players[i]->map() != map) {
+				i++;
+				continue;
+			}
+
+			migration->players.push_back(_players[i]);
+			guids.insert(_players[i]->guid());
+			remove_managed_player(_players[i]->guid());
+		}
+
+		get_lua_manager()->monster()->extract_map(map->get_name(), migration->monster_spawns, migration->monsters);
+		get_lua_manager()->npc()->extract_map(map->get_name(), migration->npcs);
+
+		for (auto &monster : migration->monsters)
+			guids.insert(monster->guid());
+
+		for (auto &nd : migration->npcs)
+			guids.insert(nd.first);
+
+		// Entity task groups carry the guid of their entity in the upper 32 bits.
+		migration->tasks = getScheduler().ExtractGroupsIf([&guids] (uint64_t group) { return guids.count((uint32_t) (group >> 32)) > 0; });
+
+		map->set_container(target);
+
+		// Refresh the container and script manager the entities hold on to.
+		for (auto &player : migration->players)
+			player->set_map(map);
+
+		for (auto &monster : migration->monsters)
+			monster->set_map(map);
+
+		for (auto &nd : migration->npcs)
+			if (nd.second->_npc != nullptr)
+				nd.second->_npc->set_map(map);
+
+		remove_load_weight(migration->load_weight);
+		target->add_load_weight(migration->load_weight);
+
+		HLog(info) << "Migrating map '" << map->get_name() << "' with " << migration->players.size() << " players, " << migration->monsters.size() << " monsters, "
+			<< migration->npcs.size() << " NPCs and " << migration->tasks.size() << " tasks from map container " << (void *) this << " to " << (void *) target.get() << ".";
+
+		// The migration is queued before the map is listed by the target so that players
+		// added to the target for the map are only processed once it holds the map's state.
+		target->receive_map(migration);
+		_managed_maps.erase(map->get_name());
+		target->add_map(std::shared_ptr<Map>(map));
+		MapMgr->update_map_route(map);
+	}
+}
+
+void MapContainerThread::adopt_migrated_maps()
+{
+	std::shared_ptr<std::shared_ptr<map_migration>> incoming;
+
+	while ((incoming = _incoming_maps.try_pop())) {
+		std::shared_ptr<map_migration> migration = *incoming;
+
+		for (auto &player : migration->players)
+			add_managed_player(player);
+
+		get_lua_manager()->monster()->adopt_map(migration->monster_spawns, migration->monsters);
+		get_lua_manager()->npc()->adopt_map(migration->npcs);
+		getScheduler().InsertTasks(std::move(migration->tasks));
+
+		HLog(info) << "Map container " << (void *) this << " has taken over map '" << migration->map->get_name() << "'.";
+	}
+}
+
+void MapContainerThread::sample_map_tick_costs()
+{
+	std::map<std::string, std::shared_ptr<Map>> maps = _managed_maps.get_map();
+
+	for (auto &m : maps)
+		m.second->sample_tick_cost();
 }
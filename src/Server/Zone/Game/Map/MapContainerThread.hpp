@@ -33,6 +33,7 @@
 #include "Core/Multithreading/ThreadSafeQueue.hpp"
 #include "Server/Zone/LUA/LUAManager.hpp"
 #include "Utility/TaskScheduler.hpp"
+#include "Utility/TickHistogram.hpp"
 
 namespace Horizon
 {
@@ -42,6 +43,7 @@ class Map;
 namespace Entities
 {
 	class Player;
+	class Monster;
 }
 // Important step as when the map is not available in a given MapContainerThread, the function invoked from lua will just exit. 
 // Functions are run on all containers and not just one.
@@ -49,6 +51,44 @@ namespace Entities
 	if ((map = container->get_map(map_name)) == nullptr) \
 		return;
 
+/**
+ * @brief Load and tick timing figures of a map container.
+ */
+struct map_container_statistics
+{
+	std::size_t maps{0};              ///< Maps managed by the container.
+	std::size_t players{0};           ///< Players managed by the container.
+	uint64_t load_weight{0};          ///< Sum of the load weights of the managed maps.
+	uint64_t ticks{0};                ///< World updates performed.
+	uint64_t last_tick_us{0};         ///< Duration of the last world update.
+	uint64_t average_tick_us{0};      ///< Moving average of the world update duration.
+	uint64_t max_tick_us{0};          ///< Longest world update.
+	uint64_t p50_tick_us{0};          ///< Median world update duration.
+	uint64_t p99_tick_us{0};          ///< 99th percentile of the world update durations.
+	uint64_t tick_period_us{0};       ///< Tick budget at the configured tick rate.
+	uint64_t overruns{0};             ///< World updates that took longer than the tick budget.
+	uint64_t skipped_ticks{0};        ///< Ticks dropped because the container fell behind its schedule.
+	bool shedding_load{false};        ///< Whether sessions are currently limited in packets per tick.
+	uint64_t average_inbox_us{0};     ///< Moving average of the time taken by migrated maps and queued players.
+	uint64_t average_session_us{0};   ///< Moving average of the time taken by player session updates.
+	uint64_t average_scheduler_us{0}; ///< Moving average of the time taken by scheduled tasks.
+};
+
+/**
+ * @brief A map and everything the container updating it holds for it, handed over
+ * from one container to another when the map is migrated.
+ */
+struct map_migration
+{
+	std::shared_ptr<Map> map;
+	uint64_t load_weight{0};
+	std::vector<std::shared_ptr<Entities::Player>> players;
+	std::vector<std::shared_ptr<Entities::Monster>> monsters;
+	std::vector<std::shared_ptr<monster_spawn_data>> monster_spawns;
+	std::vector<std::pair<uint32_t, std::shared_ptr<npc_db_data>>> npcs;
+	TaskScheduler::TaskList tasks;                                     ///< Scheduled tasks of the entities on the map.
+};
+
 class MapContainerThread : public std::enable_shared_from_this<MapContainerThread>
 {
 public:
@@ -66,6 +106,31 @@ public:
 	//! @param[in] m r-value reference to a shared_ptr of a map object.
 	void add_map(std::shared_ptr<Map> &&map);
 
+	//! @brief Returns a copy of the table of managed maps, by name.
+	std::map<std::string, std::shared_ptr<Map>> get_managed_maps() const { return _managed_maps.get_map(); }
+
+	//! @brief Adds to the load weight of the container, used to distribute maps between containers.
+	void add_load_weight(uint64_t weight) { _load_weight += weight; }
+	void remove_load_weight(uint64_t weight) { _load_weight -= weight; }
+	uint64_t get_load_weight() const { return _load_weight; }
+
+	//! @brief Requests a managed map to be moved to another container. The map is handed over with its
+	//! players, monsters, NPCs, spawn information and scheduled tasks at the end of this container's next update.
+	//! @thread any
+	void migrate_map(std::string const &name, std::shared_ptr<MapContainerThread> target);
+
+	//! @brief Queues a map handed over by another container, it is taken over at the start of the next update.
+	//! @thread any
+	void receive_map(std::shared_ptr<map_migration> migration) { _incoming_maps.push(std::move(migration)); }
+
+	//! @brief Returns the load and tick timing figures of the container.
+	//! @thread any
+	map_container_statistics get_statistics();
+
+	//! @brief Clears the tick duration histogram and the overrun and skipped tick counters.
+	//! @thread any
+	void reset_statistics();
+
 	//! @brief Removes a map from the container in real time. Managed maps are
 	//! saved in thread-safe tables.
 	void remove_map(std::string const &name);
@@ -109,15 +174,57 @@ private:
 	
 	//! @brief World update loop emulator for the MapContainerThread.
 	//! Performs world updates for maps managed in the specific thread container.
-	//! @param[in] diff current system time.
+	//! @param[in] tick monotonic time of the update in milliseconds, since the container started.
 	void update(uint64_t tick);
 
+	//! @brief Adds a player to the dense player table, or replaces the instance of a player already in it.
+	//! @thread MapContainerThread
+	void add_managed_player(std::shared_ptr<Entities::Player> player);
+
+	//! @brief Removes a player from the dense player table by moving the last player into its slot.
+	//! @thread MapContainerThread
+	bool remove_managed_player(int32_t guid);
+
+	bool is_managed_player(int32_t guid) const { return _player_slots.count(guid) > 0; }
+
+	//! @brief Removes a player leaving this container from the guid index of every map it manages.
+	//! Players that warped away already point at their destination map, hence all maps are looked at.
+	//! @thread MapContainerThread
+	void remove_player_from_map_indexes(Entities::Player *player);
+
+	//! @brief Hands maps requested for migration over to their target containers.
+	//! @thread MapContainerThread
+	void send_migrating_maps();
+
+	//! @brief Takes over maps handed over by other containers.
+	//! @thread MapContainerThread
+	void adopt_migrated_maps();
+
+	//! @brief Closes the tick cost sample of every managed map.
+	//! @thread MapContainerThread
+	void sample_map_tick_costs();
+
 	std::thread _thread;
 	LockedLookupTable<std::string, std::shared_ptr<Map>> _managed_maps;                     ///< Thread-safe hash-table of managed maps.
 	ThreadSafeQueue<std::pair<bool, std::shared_ptr<Entities::Player>>> _player_buffer;     ///< Thread-safe queue of players to add to/remove from the container.
-	LockedLookupTable<int32_t, std::shared_ptr<Entities::Player>> _managed_players;         ///< Thread-safe hash table of managed players.
+	// Managed players, only ever touched by the container thread. Players are kept contiguous for the
+	// per-tick session updates, cross-thread additions and removals go through _player_buffer.
+	std::vector<std::shared_ptr<Entities::Player>> _players;
+	std::unordered_map<int32_t, std::size_t> _player_slots;                                 ///< Index of each managed player in _players, by guid.
+	std::atomic<std::size_t> _player_count{0};
 	std::shared_ptr<LUAManager> _lua_mgr;                                                   ///< Non-thread-safe shared pointer and owner of a script manager.
 	TaskScheduler _task_scheduler;
+	ThreadSafeQueue<std::pair<std::string, std::weak_ptr<MapContainerThread>>> _outgoing_maps;  ///< Maps requested for migration and their target.
+	ThreadSafeQueue<std::shared_ptr<map_migration>> _incoming_maps;                         ///< Maps handed over by other containers.
+	std::chrono::steady_clock::time_point _last_tick_cost_sample;
+	std::atomic<uint64_t> _load_weight{0};                                                  ///< Sum of the load weights of the managed maps.
+	std::atomic<uint64_t> _tick_count{0};
+	std::atomic<uint64_t> _last_tick_us{0}, _average_tick_us{0};                           ///< World update durations, in microseconds.
+	TickHistogram _tick_histogram;                                                           ///< Distribution of the world update durations.
+	std::atomic<uint64_t> _tick_period_us{0}, _overrun_count{0}, _skipped_ticks{0};
+	std::atomic<bool> _shedding_load{false};                                                ///< Whether sessions are limited in packets per tick.
+	uint64_t _last_tick_ms{0};                                                               ///< Time of the last update, advances the task scheduler.
+	std::atomic<uint64_t> _average_inbox_us{0}, _average_session_us{0}, _average_scheduler_us{0};
 };
 }
 }
@@ -95,60 +95,319 @@ bool MapManager::LoadMapCache()
 			return false;
 	}
 ;
-	int container_idx = 0, map_counter = 0, total_maps = 0;
+	int container_count = sZone->config().map_container_threads();
 	int mcache_size = m.getMCache()->maps.size();
-	int container_max = std::ceil((double) mcache_size / MAX_MAP_CONTAINER_THREADS);
 
-	HLog(info) << "Initializing " << MAX_MAP_CONTAINER_THREADS << " map containers with " << container_max << " maps per container for a total of " << mcache_size << " maps...";
+	HLog(info) << "Initializing " << container_count << " map containers for a total of " << mcache_size << " maps...";
 
-	for (int i = 0; i < MAX_MAP_CONTAINER_THREADS; i++)
+	for (int i = 0; i < container_count; i++)
 		_map_containers.insert(i, std::make_shared<MapContainerThread>());
 
-	for (auto &i : m.getMCache()->maps) {
-		std::shared_ptr<Map> map = std::make_shared<Map>(_map_containers.at(container_idx), i.second.name(), i.second.width(), i.second.height(), i.second.getCells());
-		(_map_containers.at(container_idx))->add_map(std::move(map));
-		map_counter++;
-		total_maps++;
-
-		if (container_max == map_counter || total_maps == mcache_size) {
-			HLog(info) << "Initializing " << map_counter << " maps in map container " << (void *) _map_containers.at(container_idx).get() << "...";
-			(_map_containers.at(container_idx))->initialize();
-			(_map_containers.at(container_idx))->start();
-			map_counter = 0;
-			container_idx++;
+	std::size_t cell_memory = 0;
+	std::vector<Horizon::Libraries::map_data *> maps;
+	std::vector<std::shared_ptr<MapCellLayer const>> cell_layers(mcache_size);
+
+	for (auto &i : m.getMCache()->maps)
+		maps.push_back(&i.second);
+
+	// Packing the cell layers is the bulk of the loading work and independent per map.
+	sZone->get_worker_pool().parallel_for<int>(0, mcache_size, [&maps, &cell_layers, this] (int idx) {
+		cell_layers[idx] = get_cell_layer(maps[idx]->name(), maps[idx]->width(), maps[idx]->height(), maps[idx]->getCells());
+	});
+
+	// Maps are weighed by their hint in the map list, or by their monster spawns, and handed
+	// out heaviest first to the least loaded container.
+	std::unordered_map<std::string, uint64_t> spawn_weights;
+	std::vector<std::pair<uint64_t, int>> weighted_maps;
+
+	read_spawn_weights(spawn_weights);
+
+	for (int idx = 0; idx < mcache_size; idx++) {
+		uint64_t weight = m.getMapWeight(maps[idx]->name());
+
+		if (weight == 0)
+			weight = MAP_CONTAINER_BASE_MAP_WEIGHT + spawn_weights[maps[idx]->name()];
+
+		weighted_maps.emplace_back(weight, idx);
+	}
+
+	std::stable_sort(weighted_maps.begin(), weighted_maps.end(),
+		[] (std::pair<uint64_t, int> const &a, std::pair<uint64_t, int> const &b) { return a.first > b.first; });
+
+	std::vector<uint64_t> container_loads(container_count, 0);
+
+	for (auto &wm : weighted_maps) {
+		Horizon::Libraries::map_data &md = *maps[wm.second];
+		std::shared_ptr<MapCellLayer const> cells = cell_layers[wm.second];
+		int container_idx = std::min_element(container_loads.begin(), container_loads.end()) - container_loads.begin();
+		std::shared_ptr<MapContainerThread> container = _map_containers.at(container_idx);
+		std::shared_ptr<Map> map = std::make_shared<Map>(container, md.name(), md.width(), md.height(), cells);
+
+		cell_memory += cells->memory_usage();
+		map->get_pathfinder().setSearchStepLimit(sZone->config().path_search_step_limit());
+		container->add_map(std::move(map));
+		container->add_load_weight(wm.first);
+		container_loads[container_idx] += wm.first;
+
+		{
+			std::lock_guard<std::mutex> lock(_map_weight_mtx);
+			_map_weights[md.name()] = wm.first;
 		}
 	}
 
-	HLog(info) << "Done initializing " << total_maps << " maps in " << MAX_MAP_CONTAINER_THREADS << " containers.";
+	// Intern the maps in the routing index before any container starts running scripts that look them up.
+	_map_routes.update([this, container_count] (map_routing_table &table) {
+		for (int i = 0; i < container_count; i++) {
+			std::shared_ptr<MapContainerThread> container = _map_containers.at(i);
+
+			for (auto &m : container->get_managed_maps()) {
+				table.map_ids.emplace(m.first, (uint32_t) table.routes.size());
+				table.routes.push_back(map_route{ m.second, container });
+			}
+		}
+	});
+
+	for (int i = 0; i < container_count; i++) {
+		std::shared_ptr<MapContainerThread> container = _map_containers.at(i);
+		HLog(info) << "Initializing " << container->get_managed_maps().size() << " maps with a load weight of " << container_loads[i] << " in map container " << (void *) container.get() << "...";
+		container->initialize();
+		container->start();
+	}
+
+	HLog(info) << "Done initializing " << mcache_size << " maps in " << container_count << " containers, using " << cell_memory / 1024 << " KB of cell data.";
 
 	return true;
 }
 
-std::shared_ptr<Map> MapManager::add_player_to_map(std::string map_name, std::shared_ptr<Entities::Player> p)
+void MapManager::read_spawn_weights(std::unordered_map<std::string, uint64_t> &spawn_weights)
 {
-	std::map<int32_t, std::shared_ptr<MapContainerThread>> container_map = _map_containers.get_map();
-	for (auto i = container_map.begin(); i != container_map.end(); i++) {
-		std::shared_ptr<Map> map = i->second->get_map(map_name);
-		if (map != nullptr) {
-			i->second->add_player(p);
-			return map;
-		} else {
-			return nullptr;
-		}
+	std::string file_path = "scripts/include.lua";
+	sol::state lua;
+	int count = 0;
+
+	// Scripts are only run for their monster spawns, anything else they call fails and is skipped.
+	lua.open_libraries(sol::lib::base, sol::lib::string, sol::lib::table, sol::lib::math);
+	lua.set_function("Monster",
+		[&spawn_weights, &count] (std::string const &map_name, uint16_t /*x*/, uint16_t /*y*/, uint16_t /*x_area*/, uint16_t /*y_area*/, std::string const &/*name*/, uint16_t /*monster_id*/, uint16_t amount, sol::variadic_args /*va*/)
+		{
+			spawn_weights[map_name] += amount;
+			count++;
+		});
+
+	try {
+		lua.script_file(file_path);
+
+		sol::table scripts = lua["scripts"];
+
+		scripts.for_each([&lua] (sol::object const &/*key*/, sol::object const &value) {
+			sol::load_result fn = lua.load_file(value.as<std::string>());
+
+			if (fn.valid())
+				static_cast<sol::protected_function>(fn)();
+		});
+	} catch (sol::error &e) {
+		HLogSys(LOG_SCRIPT, warning) << "Could not read monster spawns from '" << file_path << "' to weigh maps, reason: " << e.what();
+		return;
 	}
 
-	return nullptr;
+	HLog(info) << "Weighing maps by " << count << " monster spawns on " << spawn_weights.size() << " maps.";
 }
 
-bool MapManager::remove_player_from_map(std::string map_name, std::shared_ptr<Entities::Player> p)
+bool MapManager::migrate_map(std::string const &map_name, int32_t container_idx)
 {
-	std::map<int32_t, std::shared_ptr<MapContainerThread>> container_map = _map_containers.get_map();
-	for (auto i = container_map.begin(); i != container_map.end(); i++) {
-		if (i->second->get_map(map_name) != nullptr) {
-			i->second->remove_player(p);
-			return true;
+	std::shared_ptr<Map> map = get_map(map_name);
+	std::shared_ptr<MapContainerThread> target = _map_containers.at(container_idx);
+
+	if (map == nullptr || target == nullptr)
+		return false;
+
+	std::shared_ptr<MapContainerThread> source = map->container();
+
+	if (source == nullptr || source == target)
+		return false;
+
+	source->migrate_map(map_name, target);
+
+	return true;
+}
+
+void MapManager::rebalance_map_containers()
+{
+	std::map<int32_t, std::shared_ptr<MapContainerThread>> containers = _map_containers.get_map();
+
+	if (containers.size() < 2)
+		return;
+
+	int32_t busiest_idx = -1, idlest_idx = -1;
+	map_container_statistics busiest, idlest;
+
+	for (auto &c : containers) {
+		map_container_statistics stats = c.second->get_statistics();
+
+		if (busiest_idx == -1 || stats.average_tick_us > busiest.average_tick_us) {
+			busiest_idx = c.first;
+			busiest = stats;
+		}
+
+		if (idlest_idx == -1 || stats.average_tick_us < idlest.average_tick_us) {
+			idlest_idx = c.first;
+			idlest = stats;
 		}
 	}
 
-	return false;
+	if (busiest_idx == idlest_idx
+		|| busiest.maps < 2
+		|| busiest.average_tick_us < MAP_REBALANCE_MIN_TICK_US
+		|| busiest.average_tick_us * 100 < idlest.average_tick_us * MAP_REBALANCE_IMBALANCE_PERCENT)
+		return;
+
+	// Move the costliest map that brings both containers closest to even, without overshooting.
+	std::map<std::string, std::shared_ptr<Map>> busiest_maps = containers[busiest_idx]->get_managed_maps();
+	std::map<std::string, std::shared_ptr<Map>> idlest_maps = containers[idlest_idx]->get_managed_maps();
+	uint64_t busiest_cost = 0, idlest_cost = 0;
+	std::time_t now = std::time(nullptr);
+
+	for (auto &m : busiest_maps)
+		busiest_cost += m.second->get_tick_cost();
+
+	for (auto &m : idlest_maps)
+		idlest_cost += m.second->get_tick_cost();
+
+	if (busiest_cost <= idlest_cost)
+		return;
+
+	uint64_t target_cost = (busiest_cost - idlest_cost) / 2;
+	std::shared_ptr<Map> candidate = nullptr;
+
+	for (auto &m : busiest_maps) {
+		uint64_t cost = m.second->get_tick_cost();
+		auto moved = _rebalanced_maps.find(m.first);
+
+		if (cost == 0 || cost > target_cost)
+			continue;
+
+		if (moved != _rebalanced_maps.end() && now - moved->second < MAP_REBALANCE_COOLDOWN)
+			continue;
+
+		if (candidate == nullptr || cost > candidate->get_tick_cost())
+			candidate = m.second;
+	}
+
+	if (candidate == nullptr)
+		return;
+
+	HLog(info) << "Rebalancing map containers, moving map '" << candidate->get_name() << "' (" << candidate->get_tick_cost() << "us per sample) from container "
+		<< busiest_idx << " (" << busiest.average_tick_us << "us per tick) to container " << idlest_idx << " (" << idlest.average_tick_us << "us per tick).";
+
+	_rebalanced_maps[candidate->get_name()] = now;
+	migrate_map(candidate->get_name(), idlest_idx);
+}
+
+uint64_t MapManager::get_map_weight(std::string const &map_name)
+{
+	std::lock_guard<std::mutex> lock(_map_weight_mtx);
+	auto it = _map_weights.find(map_name);
+
+	return it != _map_weights.end() ? it->second : 0;
+}
+
+std::shared_ptr<MapCellLayer const> MapManager::get_cell_layer(std::string const &map_name, uint16_t width, uint16_t height, std::vector<uint8_t> const &cells)
+{
+	{
+		std::lock_guard<std::mutex> lock(_cell_layer_mtx);
+		std::shared_ptr<MapCellLayer const> layer = _cell_layers[map_name].lock();
+
+		if (layer != nullptr)
+			return layer;
+	}
+
+	// Built outside of the lock so that maps can be loaded in parallel.
+	std::shared_ptr<MapCellLayer const> built = std::make_shared<MapCellLayer const>(width, height, cells);
+	std::lock_guard<std::mutex> lock(_cell_layer_mtx);
+	std::shared_ptr<MapCellLayer const> layer = _cell_layers[map_name].lock();
+
+	if (layer == nullptr) {
+		layer = built;
+		_cell_layers[map_name] = layer;
+	}
+
+	return layer;
+}
+
+std::shared_ptr<Map> MapManager::add_player_to_map(std::string map_name, std::shared_ptr<Entities::Player> p)
+{
+	std::shared_ptr<map_routing_table const> table = _map_routes.read();
+	auto it = table->map_ids.find(map_name);
+
+	if (it == table->map_ids.end())
+		return nullptr;
+
+	map_route const &route = table->routes[it->second];
+
+	route.container->add_player(p);
+
+	return route.map;
+}
+
+bool MapManager::remove_player_from_map(std::string map_name, std::shared_ptr<Entities::Player> p)
+{
+	std::shared_ptr<MapContainerThread> container = get_map_container(map_name);
+
+	if (container == nullptr)
+		return false;
+
+	container->remove_player(p);
+
+	return true;
+}
+
+void MapManager::update_map_route(std::shared_ptr<Map> map)
+{
+	std::shared_ptr<MapContainerThread> container = map->container();
+
+	_map_routes.update([&map, &container] (map_routing_table &table) {
+		auto it = table.map_ids.find(map->get_name());
+
+		if (it != table.map_ids.end())
+			table.routes[it->second].container = container;
+	});
+}
+
+void MapManager::register_player(std::shared_ptr<Entities::Player> player)
+{
+	std::shared_ptr<player_index const> index = _player_index.read();
+	auto it = index->by_guid.find(player->guid());
+
+	// Warps re-add players to containers, only publish a new index when something changed.
+	if (it != index->by_guid.end() && it->second.lock() == player)
+		return;
+
+	_player_index.update([&player] (player_index &idx) {
+		idx.by_guid[player->guid()] = player;
+		idx.by_name[player->name()] = player;
+	});
+}
+
+void MapManager::deregister_player(std::shared_ptr<Entities::Player> player)
+{
+	std::shared_ptr<player_index const> index = _player_index.read();
+	auto git = index->by_guid.find(player->guid());
+	auto nit = index->by_name.find(player->name());
+
+	// Players are removed from containers on every warp as well, only copy the index if they are in it.
+	if ((git == index->by_guid.end() || git->second.lock() != player)
+		&& (nit == index->by_name.end() || nit->second.lock() != player))
+		return;
+
+	_player_index.update([&player] (player_index &idx) {
+		auto git = idx.by_guid.find(player->guid());
+
+		if (git != idx.by_guid.end() && git->second.lock() == player)
+			idx.by_guid.erase(git);
+
+		auto nit = idx.by_name.find(player->name());
+
+		if (nit != idx.by_name.end() && nit->second.lock() == player)
+			idx.by_name.erase(nit);
+	});
 }
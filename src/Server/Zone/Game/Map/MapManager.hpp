@@ -30,9 +30,13 @@
 #ifndef HORIZON_ZONE_GAME_MAPMANAGER_HPP
 #define HORIZON_ZONE_GAME_MAPMANAGER_HPP
 
+#include "Core/Multithreading/RCUSnapshot.hpp"
 #include "Utility/TaskScheduler.hpp"
 #include "MapContainerThread.hpp"
 
+#include <mutex>
+#include <unordered_map>
+
 enum mapmgr_task_schedule_group
 {
 	MAPMGR_TASK_MAP_UPDATE = 0
@@ -49,6 +53,34 @@ namespace Entities
 }
 
 class Map;
+class MapCellLayer;
+
+/**
+ * @brief Route of an interned map to the map and the container updating it.
+ */
+struct map_route
+{
+	std::shared_ptr<Map> map;
+	std::shared_ptr<MapContainerThread> container;
+};
+
+/**
+ * @brief Immutable map-name to map and container routing table, see MapManager::_map_routes.
+ */
+struct map_routing_table
+{
+	std::unordered_map<std::string, uint32_t> map_ids;               ///< Interned map ids by map name.
+	std::vector<map_route> routes;                                   ///< Routes by map id.
+};
+
+/**
+ * @brief Immutable index of the players logged in the zone, see MapManager::_player_index.
+ */
+struct player_index
+{
+	std::unordered_map<int32_t, std::weak_ptr<Entities::Player>> by_guid;
+	std::unordered_map<std::string, std::weak_ptr<Entities::Player>> by_name;
+};
 
 class MapManager
 {
@@ -69,37 +101,143 @@ public:
 	std::shared_ptr<Map> add_player_to_map(std::string map_name, std::shared_ptr<Entities::Player> p);
 	bool remove_player_from_map(std::string map_name, std::shared_ptr<Entities::Player> p);
 
-	std::shared_ptr<Map> get_map(std::string map_name)
+	/**
+	 * @brief Looks a map up by name in the routing index.
+	 * @thread any
+	 */
+	std::shared_ptr<Map> get_map(std::string const &map_name) const
+	{
+		std::shared_ptr<map_routing_table const> table = _map_routes.read();
+		auto it = table->map_ids.find(map_name);
+
+		return it != table->map_ids.end() ? table->routes[it->second].map : nullptr;
+	}
+
+	/**
+	 * @brief Looks a map up by its interned id.
+	 * @thread any
+	 */
+	std::shared_ptr<Map> get_map(uint32_t map_id) const
+	{
+		std::shared_ptr<map_routing_table const> table = _map_routes.read();
+
+		return map_id < table->routes.size() ? table->routes[map_id].map : nullptr;
+	}
+
+	/**
+	 * @brief Returns the interned id of a map, or -1 if there is no such map.
+	 * @thread any
+	 */
+	int32_t get_map_id(std::string const &map_name) const
+	{
+		std::shared_ptr<map_routing_table const> table = _map_routes.read();
+		auto it = table->map_ids.find(map_name);
+
+		return it != table->map_ids.end() ? (int32_t) it->second : -1;
+	}
+
+	/**
+	 * @brief Returns the container currently updating a map.
+	 * @thread any
+	 */
+	std::shared_ptr<MapContainerThread> get_map_container(std::string const &map_name) const
 	{
-		std::map<int32_t, std::shared_ptr<MapContainerThread>> container_map = _map_containers.get_map();
-		
-		for (auto it = container_map.begin(); it != container_map.end(); ++it) {
-			std::shared_ptr<MapContainerThread> mapc = it->second;
-			std::shared_ptr<Map> map = mapc->get_map(map_name);
-			if (map) 
-				return map;
-		}
-
-		return nullptr;
+		std::shared_ptr<map_routing_table const> table = _map_routes.read();
+		auto it = table->map_ids.find(map_name);
+
+		return it != table->map_ids.end() ? table->routes[it->second].container : nullptr;
 	}
 
+	/**
+	 * @brief Routes a map to the container it was migrated to.
+	 * @thread any
+	 */
+	void update_map_route(std::shared_ptr<Map> map);
+
 	TaskScheduler &getScheduler() { return _scheduler; }
 
-	std::shared_ptr<Entities::Player> find_player(std::string name)
+	std::map<int32_t, std::shared_ptr<MapContainerThread>> get_map_containers() { return _map_containers.get_map(); }
+
+	/**
+	 * @brief Moves a map to another container, at the end of the current container's next update.
+	 * @param[in] map_name name of the map to move.
+	 * @param[in] container_idx index of the container to move the map to.
+	 * @return false if the map or container doesn't exist or the map is already managed by the container.
+	 * @thread any
+	 */
+	bool migrate_map(std::string const &map_name, int32_t container_idx);
+
+	/**
+	 * @brief Moves a map from the busiest container to the idlest one when their tick times are
+	 * too far apart. At most one map is moved per call.
+	 * @thread main
+	 */
+	void rebalance_map_containers();
+
+	/**
+	 * @brief Retrieves the load weight a map was distributed to its container with.
+	 * @return the weight of the map, 0 if it isn't loaded.
+	 * @thread any
+	 */
+	uint64_t get_map_weight(std::string const &map_name);
+
+	/**
+	 * @brief Retrieves the cell layer of a map, building it from the map cache cells
+	 * if no instance of the map holds it already.
+	 * @thread any
+	 */
+	std::shared_ptr<MapCellLayer const> get_cell_layer(std::string const &map_name, uint16_t width, uint16_t height, std::vector<uint8_t> const &cells);
+
+	/**
+	 * @brief Adds a player to the player index when it enters the zone.
+	 * @thread any
+	 */
+	void register_player(std::shared_ptr<Entities::Player> player);
+
+	/**
+	 * @brief Removes a player from the player index when it leaves the zone.
+	 * @thread any
+	 */
+	void deregister_player(std::shared_ptr<Entities::Player> player);
+
+	/**
+	 * @brief Looks a player logged in the zone up by name or guid.
+	 * @thread any
+	 */
+	std::shared_ptr<Entities::Player> find_player(std::string const &name) const
 	{
-		std::map<int32_t, std::shared_ptr<MapContainerThread>> map_containers = _map_containers.get_map();
-		for (auto it = map_containers.begin(); it != map_containers.end(); it++) {
-			std::shared_ptr<Entities::Player> player = it->second->get_player(name);
-			if (player != nullptr)
-				return player;
-		}
-
-		return nullptr;
+		std::shared_ptr<player_index const> index = _player_index.read();
+		auto it = index->by_name.find(name);
+
+		return it != index->by_name.end() ? it->second.lock() : nullptr;
+	}
+
+	std::shared_ptr<Entities::Player> find_player(int32_t guid) const
+	{
+		std::shared_ptr<player_index const> index = _player_index.read();
+		auto it = index->by_guid.find(guid);
+
+		return it != index->by_guid.end() ? it->second.lock() : nullptr;
 	}
 
 private:
+	/**
+	 * @brief Sums the monsters spawned on each map by the scripts listed in scripts/include.lua,
+	 * without loading the scripts into any map container.
+	 */
+	void read_spawn_weights(std::unordered_map<std::string, uint64_t> &spawn_weights);
+
 	TaskScheduler _scheduler;
 	LockedLookupTable<int32_t, std::shared_ptr<MapContainerThread>> _map_containers;
+	std::mutex _cell_layer_mtx;
+	std::unordered_map<std::string, std::weak_ptr<MapCellLayer const>> _cell_layers; ///< Cell layers shared between instances of a map.
+	std::mutex _map_weight_mtx;
+	std::unordered_map<std::string, uint64_t> _map_weights;                            ///< Load weight each map was distributed with.
+	std::unordered_map<std::string, std::time_t> _rebalanced_maps;                     ///< Time maps were last moved by the rebalancer.
+	// Read on every map and player lookup from any thread, rebuilt only when maps are loaded or
+	// migrated and when players enter or leave the zone.
+	RCUSnapshot<map_routing_table> _map_routes;
+	RCUSnapshot<player_index> _player_index;
 };
 }
 }
@@ -29,6 +29,7 @@
  * License terms - https://github.com/daancode/a-star/blob/master/LICENSE
  **************************************************/
 
+
 #ifndef HORIZON_ZONE_GAME_MAP_PATH_ASTAR_HPP
 #define HORIZON_ZONE_GAME_MAP_PATH_ASTAR_HPP
 
@@ -36,6 +37,11 @@
 #include "Server/Zone/Game/Map/Grid/GridDefinitions.hpp"
 #include "Server/Common/Configuration/Horizon.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <vector>
+
 namespace Horizon
 {
 namespace Zone
@@ -70,42 +76,190 @@ typedef std::function<uint32_t(MapCoords, MapCoords)> HeuristicFunction;
 typedef std::vector<MapCoords> CoordinateList;
 typedef std::function<bool(uint16_t x, uint16_t y)> CollisionDetectionFunction;
 
-struct Node
+/**
+ * @brief Search state of the path searches performed by a thread.
+ * Scores and parents are kept in flat arrays indexed by cell (y * width + x), which are
+ * sized to the largest map searched so far and reused by every search of the thread.
+ * Entries are only valid when their stamp matches the generation of the current search,
+ * so nothing has to be cleared between searches.
+ * The open set is a binary heap of cell indices that tracks the heap position of
+ * every open cell, allowing the score of an open cell to be lowered in place.
+ * Breadth-first searches use a plain queue of cells instead (@see reach()).
+ */
+class SearchSpace
 {
-	uint32_t G, H;
-	MapCoords coordinates;
-	Node * parent;
+public:
+	static constexpr int32_t CLOSED = -1;
 
-	explicit Node(MapCoords coord_, Node * parent_ = nullptr)
+	/**
+	 * @brief Search space of the calling thread.
+	 */
+	static SearchSpace &get_instance()
 	{
-		parent = parent_;
-		coordinates = coord_;
-		G = H = 0;
+		thread_local SearchSpace space;
+		return space;
 	}
 
-	uint32_t getScore() const { return G + H; }
-};
+	/**
+	 * @brief Starts a new search over area cells, invalidating the previous one.
+	 */
+	void begin(std::size_t area)
+	{
+		if (_stamp.size() < area) {
+			_stamp.resize(area, 0);
+			_g.resize(area);
+			_h.resize(area);
+			_parent.resize(area);
+			_heap_index.resize(area);
+		}
+
+		if (++_generation == 0) {
+			std::fill(_stamp.begin(), _stamp.end(), 0);
+			_generation = 1;
+		}
 
-using NodeSet = std::vector<Node *>;
+		_heap.clear();
+		_queue.clear();
+		_queue_front = 0;
+	}
 
-class Generator
-{
-	static Node * findNodeOnList(NodeSet& nodes_, MapCoords coordinates_)
+	bool is_visited(int32_t cell) const { return _stamp[cell] == _generation; }
+	bool is_closed(int32_t cell) const { return is_visited(cell) && _heap_index[cell] == CLOSED; }
+
+	uint32_t g(int32_t cell) const { return _g[cell]; }
+	uint32_t h(int32_t cell) const { return _h[cell]; }
+	int32_t parent(int32_t cell) const { return _parent[cell]; }
+
+	bool empty() const { return _heap.empty(); }
+
+	/**
+	 * @brief Opens an unvisited cell, or lowers the score of an open one.
+	 */
+	void open(int32_t cell, uint32_t g, uint32_t h, int32_t parent)
 	{
-		for (auto node : nodes_) {
-			if (node->coordinates == coordinates_) {
-				return node;
-			}
+		_g[cell] = g;
+		_parent[cell] = parent;
+
+		if (!is_visited(cell)) {
+			_stamp[cell] = _generation;
+			_h[cell] = h;
+			_heap_index[cell] = (int32_t) _heap.size();
+			_heap.push_back(cell);
+		}
+
+		sift_up(_heap_index[cell]);
+	}
+
+	/**
+	 * @brief Removes and closes the open cell with the lowest score.
+	 */
+	int32_t close_top()
+	{
+		int32_t top = _heap.front();
+		int32_t last = _heap.back();
+
+		_heap.pop_back();
+
+		if (!_heap.empty()) {
+			_heap[0] = last;
+			_heap_index[last] = 0;
+			sift_down(0);
+		}
+
+		_heap_index[top] = CLOSED;
+
+		return top;
+	}
+
+	/**
+	 * @brief Marks an unvisited cell as reached after steps moves and queues it.
+	 * @return false if the cell was already reached.
+	 */
+	bool reach(int32_t cell, uint32_t steps)
+	{
+		if (is_visited(cell))
+			return false;
+
+		_stamp[cell] = _generation;
+		_g[cell] = steps;
+		_queue.push_back(cell);
+
+		return true;
+	}
+
+	bool has_queued() const { return _queue_front < _queue.size(); }
+	int32_t next_queued() { return _queue[_queue_front++]; }
+
+private:
+	/**
+	 * Orders cells by score, preferring the cell closest to the target on ties.
+	 */
+	bool precedes(int32_t a, int32_t b) const
+	{
+		uint32_t fa = _g[a] + _h[a], fb = _g[b] + _h[b];
+		return fa < fb || (fa == fb && _h[a] < _h[b]);
+	}
+
+	void place(std::size_t pos, int32_t cell)
+	{
+		_heap[pos] = cell;
+		_heap_index[cell] = (int32_t) pos;
+	}
+
+	void sift_up(std::size_t pos)
+	{
+		int32_t cell = _heap[pos];
+
+		while (pos > 0) {
+			std::size_t parent = (pos - 1) / 2;
+
+			if (!precedes(cell, _heap[parent]))
+				break;
+
+			place(pos, _heap[parent]);
+			pos = parent;
 		}
-		return nullptr;
+
+		place(pos, cell);
 	}
-	static void releaseNodes(NodeSet nodes_)
+
+	void sift_down(std::size_t pos)
 	{
-		for (auto it = nodes_.begin(); it != nodes_.end();) {
-			it = nodes_.erase(it);
+		int32_t cell = _heap[pos];
+		std::size_t const size = _heap.size();
+
+		while (true) {
+			std::size_t child = pos * 2 + 1;
+
+			if (child >= size)
+				break;
+
+			if (child + 1 < size && precedes(_heap[child + 1], _heap[child]))
+				child++;
+
+			if (!precedes(_heap[child], cell))
+				break;
+
+			place(pos, _heap[child]);
+			pos = child;
 		}
+
+		place(pos, cell);
 	}
 
+	uint32_t _generation{0};
+	std::vector<uint32_t> _stamp;
+	std::vector<uint32_t> _g;
+	std::vector<uint32_t> _h;
+	std::vector<int32_t> _parent;
+	std::vector<int32_t> _heap_index;   ///< Position in _heap of an open cell, or CLOSED.
+	std::vector<int32_t> _heap;
+	std::vector<int32_t> _queue;
+	std::size_t _queue_front{0};
+};
+
+class Generator
+{
 public:
 	Generator()
 	{
@@ -127,80 +281,181 @@ public:
 
 	void setDiagonalMovement(bool enable_) { directions = (enable_ ? 8 : 4); }
 
-	void setHeuristic(const HeuristicFunction& heuristic_) { heuristic = [heuristic_](auto && PH1, auto && PH2) { return heuristic_(std::forward<decltype(PH1)>(PH1), std::forward<decltype(PH2)>(PH2)); }; }
-
+	void setHeuristic(const HeuristicFunction& heuristic_) { heuristic = heuristic_; }
+
+	/**
+	 * @brief Limits the number of cells a single search may expand, 0 for no limit.
+	 */
+	void setSearchStepLimit(uint32_t limit) { search_step_limit = limit; }
+	uint32_t getSearchStepLimit() const { return search_step_limit; }
+
+	/**
+	 * @brief Finds a path from source_ to target_.
+	 * @return the coordinates of the path from target_ back to source_ (inclusive), each carrying
+	 * the cost of the step that leads to it. If target_ could not be reached within the search
+	 * step limit, the path leads to the expanded cell closest to target_ instead.
+	 * An empty list is returned if the target (or source) is blocked or outside of the map.
+	 */
 	CoordinateList findPath(MapCoords source_, MapCoords target_)
 	{
 		CoordinateList path;
-		Node * current = nullptr;
-		NodeSet openSet, closedSet;
-		int searchStep = 0;
+		int32_t const width = worldSize.x(), height = worldSize.y();
 
-		openSet.reserve(100);
-		closedSet.reserve(100);
-		openSet.push_back(new Node(source_));
-
-		if (check_collision(target_.x(), target_.y()))
+		if (!is_within_bounds(source_, width, height) || !is_within_bounds(target_, width, height)
+			|| check_collision(target_.x(), target_.y()))
 			return path;
 
-		while (!openSet.empty() && searchStep < MAX_VIEW_RANGE) {
-			auto current_it = openSet.begin();
-			
-			current = *current_it;
-
-			for (auto it = openSet.begin(); it != openSet.end(); it++) {
-				auto node = *it;
-				if (node->getScore() <= current->getScore()) {
-					current = node;
-					current_it = it;
-				}
-			}
+		SearchSpace &space = SearchSpace::get_instance();
+		int32_t const target = target_.y() * width + target_.x();
+		int32_t current = source_.y() * width + source_.x();
+		int32_t closest = current;
+		uint32_t searchStep = 0;
+
+		space.begin((std::size_t) width * height);
+		space.open(current, 0, heuristic(source_, target_), -1);
 
-			if (current->coordinates == target_)
+		while (!space.empty() && (search_step_limit == 0 || searchStep < search_step_limit)) {
+			current = space.close_top();
+
+			if (current == target) {
+				closest = current;
 				break;
+			}
 
-			closedSet.push_back(current);
-			openSet.erase(current_it);
+			if (space.h(current) < space.h(closest))
+				closest = current;
+
+			int16_t const x = current % width, y = current / width;
 
 			for (uint32_t i = 0; i < directions; ++i) {
-				
-				MapCoords newCoordinates(current->coordinates + direction[i]);
+				MapCoords newCoordinates(x + direction[i].x(), y + direction[i].y());
 
-				if (check_collision(newCoordinates.x(), newCoordinates.y()) 
-					|| findNodeOnList(closedSet, newCoordinates)) {
+				if (!is_within_bounds(newCoordinates, width, height))
 					continue;
-				}
-
-				newCoordinates.set_move_cost((i < 4) ? 10 : 14);
-				uint32_t totalCost = current->G + newCoordinates.move_cost();
-
-				Node * successor = findNodeOnList(openSet, newCoordinates);
-				if (successor == nullptr) {
-					successor = new Node(newCoordinates, current);
-					successor->G = totalCost;
-					successor->H = heuristic(successor->coordinates, target_);
-					openSet.push_back(successor);
-				} else if (totalCost < successor->G) {
-					successor->parent = current;
-					successor->G = totalCost;
-				}
+
+				int32_t const cell = newCoordinates.y() * width + newCoordinates.x();
+
+				if (space.is_closed(cell) || check_collision(newCoordinates.x(), newCoordinates.y()))
+					continue;
+
+				uint32_t totalCost = space.g(current) + ((i < 4) ? 10 : 14);
+
+				if (!space.is_visited(cell))
+					space.open(cell, totalCost, heuristic(newCoordinates, target_), current);
+				else if (totalCost < space.g(cell))
+					space.open(cell, totalCost, space.h(cell), current);
 			}
 
 			searchStep++;
 		}
 
-		while (current != nullptr) {
-			path.push_back(current->coordinates);
-			current = current->parent;
-		}
+		for (int32_t cell = closest; cell != -1; cell = space.parent(cell)) {
+			MapCoords coords(cell % width, cell / width);
+			int32_t parent = space.parent(cell);
 
-		releaseNodes(openSet);
-		releaseNodes(closedSet);
+			if (parent != -1)
+				coords.set_move_cost((parent % width != coords.x() && parent / width != coords.y()) ? 14 : 10);
+
+			path.push_back(coords);
+		}
 
 		return path;
 	}
 
+	/**
+	 * @brief Checks if target_ can be walked to from source_ in at most max_steps moves,
+	 * without building the path. Targets in a straight unobstructed line are accepted
+	 * right away, others are searched breadth-first up to max_steps moves from source_.
+	 * The search step limit does not apply, as the search is bounded by max_steps instead.
+	 */
+	bool isReachable(MapCoords source_, MapCoords target_, uint32_t max_steps)
+	{
+		int32_t const width = worldSize.x(), height = worldSize.y();
+
+		if (!is_within_bounds(source_, width, height) || !is_within_bounds(target_, width, height)
+			|| check_collision(target_.x(), target_.y()))
+			return false;
+
+		if (source_ == target_)
+			return true;
+
+		if ((uint32_t) source_.distance(target_) > max_steps)
+			return false;
+
+		if (directions == 8 && isWalkableLine(source_, target_))
+			return true;
+
+		SearchSpace &space = SearchSpace::get_instance();
+		int32_t const target = target_.y() * width + target_.x();
+
+		space.begin((std::size_t) width * height);
+		space.reach(source_.y() * width + source_.x(), 0);
+
+		while (space.has_queued()) {
+			int32_t current = space.next_queued();
+			uint32_t steps = space.g(current) + 1;
+			int16_t const x = current % width, y = current / width;
+
+			if (steps > max_steps)
+				break;
+
+			for (uint32_t i = 0; i < directions; ++i) {
+				MapCoords newCoordinates(x + direction[i].x(), y + direction[i].y());
+
+				if (!is_within_bounds(newCoordinates, width, height))
+					continue;
+
+				int32_t const cell = newCoordinates.y() * width + newCoordinates.x();
+
+				if (space.is_visited(cell) || check_collision(newCoordinates.x(), newCoordinates.y()))
+					continue;
+
+				if (cell == target)
+					return true;
+
+				space.reach(cell, steps);
+			}
+		}
+
+		return false;
+	}
+
 private:
+	/**
+	 * Traces the line between two cells, which is a valid walk path of one move per cell if unobstructed.
+	 */
+	bool isWalkableLine(MapCoords source_, MapCoords target_)
+	{
+		int dx = abs(target_.x() - source_.x()), dy = -abs(target_.y() - source_.y());
+		int sx = source_.x() < target_.x() ? 1 : -1, sy = source_.y() < target_.y() ? 1 : -1;
+		int err = dx + dy;
+		int x = source_.x(), y = source_.y();
+
+		while (x != target_.x() || y != target_.y()) {
+			int e2 = 2 * err;
+
+			if (e2 >= dy) {
+				err += dy;
+				x += sx;
+			}
+
+			if (e2 <= dx) {
+				err += dx;
+				y += sy;
+			}
+
+			if (check_collision(x, y))
+				return false;
+		}
+
+		return true;
+	}
+
+	static bool is_within_bounds(MapCoords const &coords, int32_t width, int32_t height)
+	{
+		return coords.x() >= 0 && coords.y() >= 0 && coords.x() < width && coords.y() < height;
+	}
+
 	HeuristicFunction heuristic;
 	CollisionDetectionFunction check_collision;
 	CoordinateList direction = {
@@ -209,6 +464,7 @@ private:
 	};
 	MapCoords worldSize;
 	uint32_t directions{0};
+	uint32_t search_step_limit{DEFAULT_PATH_SEARCH_STEP_LIMIT};
 };
 }
 }
@@ -48,6 +48,8 @@ bool ExpDatabase::load()
 		sol::table job_exp_tbl = lua["job_exp_group_db"];
 		total_entries[0] = load_group(base_exp_tbl, EXP_GROUP_TYPE_BASE);
 		total_entries[1] = load_group(job_exp_tbl, EXP_GROUP_TYPE_JOB);
+		_base_exp_group_db.freeze();
+		_job_exp_group_db.freeze();
 	} catch(const std::exception &e) {
 		HLog(error) << "ExpDB::error: " << e.what();
 		return false;
@@ -60,7 +62,7 @@ bool ExpDatabase::load()
 
 int ExpDatabase::load_group(sol::table &group_tbl, exp_group_type type)
 {
-	LockedLookupTable<std::string, std::shared_ptr<const exp_group_data>> *group_db = type == EXP_GROUP_TYPE_BASE ? &_base_exp_group_db : &_job_exp_group_db;
+	FrozenLookupTable<std::string, std::shared_ptr<const exp_group_data>> *group_db = type == EXP_GROUP_TYPE_BASE ? &_base_exp_group_db : &_job_exp_group_db;
 	int total_entries = 0;
 
 	group_tbl.for_each([group_db, &total_entries, type](sol::object const &key, sol::object const &value) {
@@ -69,7 +71,7 @@ int ExpDatabase::load_group(sol::table &group_tbl, exp_group_type type)
 		exp_group_data expd;
 
 		std::shared_ptr<const exp_group_data> dup;
-		if ((dup = group_db->at(group_name)) != nullptr) {
+		if ((dup = group_db->staged(group_name)) != nullptr) {
 			HLog(warning) << "ExpDB::load: Found duplicate " << (type == EXP_GROUP_TYPE_BASE ? "base" : "job") << " Exp group for '" << group_name << "', overwriting...";
 			group_db->erase(group_name);
 		}
@@ -121,6 +123,7 @@ bool ExpDatabase::load_status_point_table()
 			_stat_point_db.insert(key.as<uint32_t>(), value.as<uint32_t>());
 			total_entries++;
 		});
+		_stat_point_db.freeze();
 	} catch(const std::exception &e) {
 		HLog(error) << "ExpDatabase::load_status_point_table: " << e.what() << ".";
 		return false;
@@ -77,20 +77,32 @@ public:
 		return type == EXP_GROUP_TYPE_BASE ? _base_exp_group_db.at(name) : _job_exp_group_db.at(name);
 	}
 
-	uint32_t get_status_point(uint32_t level)
+	/**
+	 * @brief Lock-free lookup into the frozen exp group tables, the record lives as long as the database.
+	 * @thread any
+	 */
+	exp_group_data const *find_exp_group(std::string const &name, exp_group_type type) const
 	{
-		if (level <= 0 || level > _stat_point_db.size() || level > MAX_LEVEL)
+		std::shared_ptr<const exp_group_data> const *group = type == EXP_GROUP_TYPE_BASE ? _base_exp_group_db.find(name) : _job_exp_group_db.find(name);
+		return group != nullptr ? group->get() : nullptr;
+	}
+
+	uint32_t get_status_point(uint32_t level) const
+	{
+		if (level <= 0 || level > MAX_LEVEL)
 			return 0;
-		return _stat_point_db.at(level);
+
+		uint32_t const *points = _stat_point_db.find(level);
+		return points != nullptr ? *points : 0;
 	}
 
 	bool load_status_point_table();
 
 protected:
 	int load_group(sol::table &tbl, exp_group_type type);
-	LockedLookupTable<std::string, std::shared_ptr<const exp_group_data>> _base_exp_group_db;
-	LockedLookupTable<std::string, std::shared_ptr<const exp_group_data>> _job_exp_group_db;
-	LockedLookupTable<uint32_t, uint32_t> _stat_point_db;
+	FrozenLookupTable<std::string, std::shared_ptr<const exp_group_data>> _base_exp_group_db;
+	FrozenLookupTable<std::string, std::shared_ptr<const exp_group_data>> _job_exp_group_db;
+	FrozenLookupTable<uint32_t, uint32_t> _stat_point_db;
 };
 
 }
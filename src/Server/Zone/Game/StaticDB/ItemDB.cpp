@@ -92,8 +92,10 @@ bool ItemDatabase::load()
 	    sol::load_result fx = lua->load_file(file_path);
 		sol::table item_tbl = fx();
 		total_entries = load_items(item_tbl, file_path);
+		_item_db.freeze();
+		_item_db_str.freeze();
 		auto stop = std::chrono::high_resolution_clock::now();
-		HLog(info) << "Loaded " << total_entries << " entries from '" << file_path << "' (" << std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count() << "µs, Max Collisions: " << _item_db.max_collisions() << ").";
+		HLog(info) << "Loaded " << total_entries << " entries from '" << file_path << "' (" << std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count() << "µs, Max Probe: " << _item_db_str.max_probe() << ").";
 	} catch (sol::error err) {
 		HLog(error) << err.what();
 	}
@@ -517,7 +519,7 @@ int ItemDatabase::load_items(sol::table const &item_tbl, std::string file_path)
 		_item_db_str.insert(id.key_name, std::make_shared<item_config_data>(id));
 	});
 
-	return _item_db.size();
+	return _item_db.staged_size();
 }
 
 bool ItemDatabase::load_refine_db()
@@ -547,6 +549,7 @@ bool ItemDatabase::load_refine_db()
 			if (load_refine_table(tbl.type, lua.get<sol::table>(tbl.tbl_name), tbl.tbl_name, file_path))
 				total_entries++;
 		}
+		_refine_db.freeze();
 		auto stop = std::chrono::high_resolution_clock::now();
 		HLog(info) << "Loaded " << total_entries << " entries from '" << file_path << "' (" << std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count() << "µs).";
 	} catch(const std::exception &e) {
@@ -599,7 +602,7 @@ bool ItemDatabase::load_refine_table(refine_type type, sol::table const &refine_
 		return false;
 	}
 
-	_refine_db.insert(type, std::make_shared<refine_config>(cfg));
+	_refine_db.insert(type, cfg);
 
 	return true;
 }
@@ -627,19 +630,20 @@ bool ItemDatabase::load_weapon_target_size_modifiers_db()
 		sol::table size_mod_tbl = (*lua)["weapon_target_size_modifiers"];
 
 		for (int i = IT_WT_FIST; i < IT_WT_SINGLE_MAX; i++) {
-			std::shared_ptr<std::array<uint8_t, ESZ_MAX>> arr = std::make_shared<std::array<uint8_t, ESZ_MAX>>();
+			std::array<uint8_t, ESZ_MAX> arr;
 			for (int j = ESZ_SMALL; j < ESZ_MAX; j++) {
 				std::string size = j == ESZ_SMALL ? "Small" : j == ESZ_MEDIUM ? "Medium" : "Large";
 				try {
-					(*arr)[j] = size_mod_tbl[i][size];
+					arr[j] = size_mod_tbl[i][size];
 				} catch (std::exception &err) {
 					HLog(error) << "Weapon target size modifier was not found for weapon type " << get_weapon_type_name((item_weapon_type) i) << " size " << size << ", defaulting to 100%...";
-					(*arr)[j] = 100;
+					arr[j] = 100;
 				}
 			}
 			_weapon_target_size_modifiers_db.insert((item_weapon_type) i, arr);
 			total_entries++;
 		}
+		_weapon_target_size_modifiers_db.freeze();
 		auto stop = std::chrono::high_resolution_clock::now();
 		HLog(info) << "Loaded " << total_entries << " entries from '" << file_path << "' (" << std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count() << "µs.";
 	} catch(const std::exception &e) {
@@ -694,20 +698,21 @@ bool ItemDatabase::load_weapon_attribute_modifiers_db()
 		};
 
 		for (int i = IT_LVL_WEAPON1; i < IT_LVL_MAX; i++) {
-			std::shared_ptr<std::array<std::array<uint8_t, ELE_MAX>, ELE_MAX>> arr = std::make_shared<std::array<std::array<uint8_t, ELE_MAX>, ELE_MAX>>();
+			std::array<std::array<uint8_t, ELE_MAX>, ELE_MAX> arr;
 			for (int j = ELE_NEUTRAL; j < ELE_MAX; j++) {
 				for (int k = ELE_NEUTRAL; k < ELE_MAX; k++) {
 					try {
-						(*arr)[j][k] = attr_mod_tbl[i][j][k + 1];
+						arr[j][k] = attr_mod_tbl[i][j][k + 1];
 					} catch (std::exception &err) {
 						HLog(error) << "Weapon target attribute modifier was not found for weapon type " << get_weapon_type_name((item_weapon_type) i) << " attribute [" << attr_s[j].ele_name << "][" << attr_s[k].ele_name << "], defaulting to 100%...";
-						(*arr)[j][k] = 100;
+						arr[j][k] = 100;
 					}
 					total_entries++;
 				}
 			}
 			_weapon_attribute_modifiers_db.insert((item_level_type) i, arr);
 		}
+		_weapon_attribute_modifiers_db.freeze();
 		auto stop = std::chrono::high_resolution_clock::now();
 		HLog(info) << "Loaded " << total_entries << " entries from '" << file_path << "' (" << std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count() << "µs).";
 	} catch(const std::exception &e) {
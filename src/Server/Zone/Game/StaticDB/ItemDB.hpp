@@ -65,18 +65,25 @@ public:
 	std::shared_ptr<const item_config_data> get_item_by_id(uint32_t item_id) const { return _item_db.at(item_id); }
 	std::shared_ptr<const item_config_data> get_item_by_key_name(std::string key_name) const { return _item_db_str.at(key_name); }
 
-	std::shared_ptr<const refine_config> get_refine_config(refine_type type)
+	/**
+	 * @brief Lock-free lookup into the frozen item table, the record lives as long as the database.
+	 * @thread any
+	 */
+	item_config_data const *find_item_by_id(uint32_t item_id) const
 	{
-		return _refine_db.at(type, std::shared_ptr<refine_config>());
+		std::shared_ptr<const item_config_data> const *item = _item_db.find(item_id);
+		return item != nullptr ? item->get() : nullptr;
 	}
 
-	uint8_t get_weapon_target_size_modifier(item_weapon_type wtype, entity_size_type stype)
+	refine_config const *get_refine_config(refine_type type) const { return _refine_db.find(type); }
+
+	uint8_t get_weapon_target_size_modifier(item_weapon_type wtype, entity_size_type stype) const
 	{
-		std::shared_ptr<std::array<uint8_t, ESZ_MAX>> arr = _weapon_target_size_modifiers_db.at(wtype);
+		std::array<uint8_t, ESZ_MAX> const *arr = _weapon_target_size_modifiers_db.find(wtype);
 		return arr != nullptr ? (*arr)[stype] : 100;
 	}
 
-	int32_t get_weapon_attribute_modifier(int32_t weapon_lv, element_type element, element_type def_ele)
+	int32_t get_weapon_attribute_modifier(int32_t weapon_lv, element_type element, element_type def_ele) const
 	{
 		if (weapon_lv < 1 || weapon_lv > 5) 
 			return 100;
@@ -87,10 +94,12 @@ public:
 		if (def_ele < ELE_NEUTRAL || def_ele >= ELE_MAX)
 			return 100;
 
-		std::shared_ptr<std::array<std::array<uint8_t, ELE_MAX>, ELE_MAX>> lvl_arr = _weapon_attribute_modifiers_db.at(weapon_lv);
-		std::array<uint8_t, ELE_MAX> ele_arr = lvl_arr->at(element);
+		std::array<std::array<uint8_t, ELE_MAX>, ELE_MAX> const *lvl_arr = _weapon_attribute_modifiers_db.find(weapon_lv);
+
+		if (lvl_arr == nullptr)
+			return 100;
 
-		return ele_arr[def_ele];
+		return (*lvl_arr)[element][def_ele];
 	}
 
 	std::string get_weapon_type_name(item_weapon_type type)
@@ -106,11 +115,11 @@ private:
 	int load_items(sol::table const &item_tbl, std::string file_path);
 	bool load_refine_table(refine_type tbl_type, sol::table const &refine_table, std::string table_name, std::string file_path);
 	std::array<std::string, IT_WT_SINGLE_MAX> _weapontype2name_db;
-	LockedLookupTable<int32_t, std::shared_ptr<const item_config_data>> _item_db;
-	LockedLookupTable<std::string, std::shared_ptr<const item_config_data>> _item_db_str;
-	LockedLookupTable<int32_t, std::shared_ptr<const refine_config>> _refine_db;
-	LockedLookupTable<int32_t, std::shared_ptr<std::array<uint8_t, ESZ_MAX>>> _weapon_target_size_modifiers_db;
-	LockedLookupTable<int32_t, std::shared_ptr<std::array<std::array<uint8_t, ELE_MAX>, ELE_MAX>>> _weapon_attribute_modifiers_db;
+	FrozenLookupTable<int32_t, std::shared_ptr<const item_config_data>> _item_db;
+	FrozenLookupTable<std::string, std::shared_ptr<const item_config_data>> _item_db_str;
+	FrozenLookupTable<int32_t, refine_config> _refine_db;
+	FrozenLookupTable<int32_t, std::array<uint8_t, ESZ_MAX>> _weapon_target_size_modifiers_db;
+	FrozenLookupTable<int32_t, std::array<std::array<uint8_t, ELE_MAX>, ELE_MAX>> _weapon_attribute_modifiers_db;
 };
 }
 }
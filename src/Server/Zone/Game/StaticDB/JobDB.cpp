@@ -214,6 +214,8 @@ int JobDatabase::load_job(sol::table &job_tbls, std::string name)
 		}
 	}
 
+	_job_db.freeze();
+
 	return count;
 }
 
@@ -311,7 +313,7 @@ bool JobDatabase::load_job_internal(sol::table &job_tbl, job_config_data &data,
 			return false;
 		}
 
-		auto jobi = _job_db.at(jc);
+		auto jobi = _job_db.staged(jc);
 		if (!jobi) {
 			HLog(warning) << "JobDB::load_job_internal:2: Unable to inherit from non-existent job '" << t_str << "' for '" << job_name << "', make sure the job is read before being inherited. Skipping...";
 			return false;
@@ -344,7 +346,7 @@ bool JobDatabase::load_hp_sp_table(sol::table &job_tbl, job_config_data &data, s
 			HLog(warning) <<"JobDB::load_hp_sp_table:1: Unable to inherit from non-existent job '" << t_str << "' for '" << job_name << "', make sure the job is read before being inherited. Skipping...";
 			return false;
 		}
-		auto jobi = _job_db.at(jc);
+		auto jobi = _job_db.staged(jc);
 		if (!jobi) {
 			HLog(warning) <<"JobDB::load_hp_sp_table:2: Unable to inherit " << table_name << " from non-existent job '" << t_str << "' for '" << job_name << "', make sure the job is read before being inherited. Skipping...";
 			return false;
@@ -67,6 +67,16 @@ public:
 	bool load_hp_sp_table(sol::table &job_tbl, job_config_data &data, std::string &job_name, std::string table_name);
 
 	std::shared_ptr<const job_config_data> get_job_by_id(uint16_t job_id) { return _job_db.at((job_class_type) job_id); }
+
+	/**
+	 * @brief Lock-free lookup into the frozen job table, the record lives as long as the database.
+	 * @thread any
+	 */
+	job_config_data const *find_job_by_id(uint16_t job_id) const
+	{
+		std::shared_ptr<const job_config_data> const *job = _job_db.find((job_class_type) job_id);
+		return job != nullptr ? job->get() : nullptr;
+	}
 	std::string get_job_name_by_id(int32_t id) { 
 		for (auto j = _name2id_list.begin(); j != _name2id_list.end(); j++)
 			if (j->second == id)
@@ -74,7 +84,7 @@ public:
 		return "";
 	}
 private:
-	LockedLookupTable<uint32_t, std::shared_ptr<const job_config_data>> _job_db;
+	FrozenLookupTable<uint32_t, std::shared_ptr<const job_config_data>> _job_db;
 	std::map<std::string, int> _name2id_list;
 };
 }
@@ -37,8 +37,28 @@
 
 #include "Server/Zone/Zone.hpp"
 
+#include "Libraries/DBSnapshot/DBSnapshot.hpp"
+
 using namespace Horizon::Zone;
 
+/**
+ * Layout versions of the records stored in the snapshot. Change the version of a record whenever one of its fields
+ * (or a field of a structure it holds) is added, removed, reordered or retyped, older snapshots are then recompiled.
+ */
+#define MONSTER_DB_SNAPSHOT_LAYOUT 1
+#define MONSTER_SKILL_DB_SNAPSHOT_LAYOUT 1
+#define MONSTER_SKILL_INDEX_SNAPSHOT_LAYOUT 1
+
+/**
+ * Skills of a monster are stored as consecutive records in the snapshot, in the order they were read.
+ */
+struct monster_skill_snapshot_index
+{
+	uint32_t monster_id{0};
+	uint32_t first{0};
+	uint32_t count{0};
+};
+
 MonsterDatabase::MonsterDatabase()
 {
 	//
@@ -51,6 +71,15 @@ MonsterDatabase::~MonsterDatabase()
 
 bool MonsterDatabase::load()
 {
+	std::string snapshot_path = sZone->config().get_static_db_snapshot_path().string();
+
+	if (!snapshot_path.empty()) {
+		snapshot_path += "monster_db.snapshot";
+
+		if (load_snapshot(snapshot_path))
+			return true;
+	}
+
 	std::shared_ptr<sol::state> lua = std::make_shared<sol::state>();
 
 	lua->open_libraries(sol::lib::base);
@@ -79,6 +108,9 @@ bool MonsterDatabase::load()
 		mob_tbl.for_each([this, &total_entries] (sol::object const &key, sol::object const &value) {
 			total_entries += load_internal(key, value);
 		});
+		// Monster skills refer to the monsters read above.
+		_monster_db.freeze();
+		_monster_str_db.freeze();
 		HLog(info) << "Loaded " << total_entries << " entries from '" << file_path << "'.";
 	} catch(const std::exception &e) {
 		HLog(error) << "MonsterDatabase::load: " << e.what();
@@ -94,12 +126,163 @@ bool MonsterDatabase::load()
 		mob_tbl.for_each([this, &total_entries] (sol::object const &key, sol::object const &value) {
 			total_entries += load_skill_internal(key, value);
 		});
+		_monster_skill_db.freeze();
 		HLog(info) << "Loaded " << total_entries << " entries from '" << file_path << "'.";
 	} catch(const std::exception &e) {
 		HLog(error) << "MonsterDatabase::load: " << e.what();
 		return false;
 	}
 
+	if (!snapshot_path.empty())
+		save_snapshot(snapshot_path);
+
+	return true;
+}
+
+std::vector<std::string> MonsterDatabase::snapshot_sources()
+{
+	std::string db_path = sZone->config().get_static_db_path().string();
+
+	// Drops and skills are validated against the item and skill databases while reading.
+	return {
+		db_path + "monster_db.lua",
+		db_path + "monster_skill_db.lua",
+		db_path + "item_db.lua",
+		db_path + "skill_db.lua"
+	};
+}
+
+bool MonsterDatabase::load_snapshot(std::string const &file_path)
+{
+	using namespace Horizon::Libraries;
+
+	DBSnapshot snapshot;
+	std::string stale_source;
+	dbsnapshot_error_type result = snapshot.Open(file_path);
+
+	if (result == DBSNAPSHOT_NONEXISTENT_FILE)
+		return false;
+
+	if (result == DBSNAPSHOT_OK)
+		result = snapshot.CheckSources(&stale_source);
+
+	if (result == DBSNAPSHOT_STALE_SOURCE) {
+		HLog(info) << "Monster database snapshot '" << file_path << "' is older than '" << stale_source << "', it will be recompiled.";
+		return false;
+	} else if (result != DBSNAPSHOT_OK) {
+		HLog(warning) << "Monster database snapshot '" << file_path << "' could not be used (" << DBSnapshot::ErrorString(result) << "), it will be recompiled.";
+		return false;
+	}
+
+	std::vector<std::string> sources = snapshot_sources();
+
+	if (snapshot.getHeader().source_count != sources.size()) {
+		HLog(info) << "Monster database snapshot '" << file_path << "' was compiled from other sources, it will be recompiled.";
+		return false;
+	}
+
+	for (uint32_t i = 0; i < sources.size(); ++i) {
+		if (sources[i].compare(snapshot.getSources()[i].path) != 0) {
+			HLog(info) << "Monster database snapshot '" << file_path << "' was compiled from other sources, it will be recompiled.";
+			return false;
+		}
+	}
+
+	std::size_t monster_count = 0, skill_count = 0, index_count = 0;
+	monster_config_data const *monsters = snapshot.GetRecords<monster_config_data>("monster_db", monster_count, MONSTER_DB_SNAPSHOT_LAYOUT);
+	monster_skill_config_data const *skills = snapshot.GetRecords<monster_skill_config_data>("monster_skill_db", skill_count, MONSTER_SKILL_DB_SNAPSHOT_LAYOUT);
+	monster_skill_snapshot_index const *index = snapshot.GetRecords<monster_skill_snapshot_index>("monster_skill_index", index_count, MONSTER_SKILL_INDEX_SNAPSHOT_LAYOUT);
+
+	if (monsters == nullptr || skills == nullptr || index == nullptr) {
+		HLog(info) << "Monster database snapshot '" << file_path << "' was compiled for another record layout, it will be recompiled.";
+		return false;
+	}
+
+	_monster_db.clear();
+	_monster_str_db.clear();
+	_monster_skill_db.clear();
+
+	for (std::size_t i = 0; i < monster_count; ++i) {
+		std::shared_ptr<const monster_config_data> monster = snapshot.Share(&monsters[i]);
+		_monster_db.insert(monster->monster_id, monster);
+		_monster_str_db.insert(monster->sprite_name, monster);
+	}
+
+	for (std::size_t i = 0; i < index_count; ++i) {
+		if (index[i].first > skill_count || index[i].count > skill_count - index[i].first) {
+			HLog(warning) << "Monster database snapshot '" << file_path << "' has an invalid skill index, it will be recompiled.";
+			_monster_db.clear();
+			_monster_str_db.clear();
+			_monster_skill_db.clear();
+			return false;
+		}
+
+		std::shared_ptr<std::vector<std::shared_ptr<const monster_skill_config_data>>> monster_skills =
+			std::make_shared<std::vector<std::shared_ptr<const monster_skill_config_data>>>();
+
+		monster_skills->reserve(index[i].count);
+
+		for (uint32_t j = index[i].first; j < index[i].first + index[i].count; ++j)
+			monster_skills->push_back(snapshot.Share(&skills[j]));
+
+		_monster_skill_db.insert(index[i].monster_id, monster_skills);
+	}
+
+	_monster_db.freeze();
+	_monster_str_db.freeze();
+	_monster_skill_db.freeze();
+
+	HLog(info) << "Loaded " << monster_count << " monsters and " << skill_count << " monster skills from snapshot '" << file_path << "'.";
+	return true;
+}
+
+bool MonsterDatabase::save_snapshot(std::string const &file_path)
+{
+	using namespace Horizon::Libraries;
+
+	DBSnapshotWriter writer;
+	std::vector<monster_config_data> monsters;
+	std::vector<monster_skill_config_data> skills;
+	std::vector<monster_skill_snapshot_index> index;
+	boost::system::error_code ec;
+
+	for (std::string const &source : snapshot_sources()) {
+		if (!writer.AddSource(source)) {
+			HLog(warning) << "Monster database snapshot was not compiled, source '" << source << "' could not be read.";
+			return false;
+		}
+	}
+
+	monsters.reserve(_monster_db.size());
+	_monster_db.for_each([&monsters] (uint32_t, std::shared_ptr<const monster_config_data> const &monster) {
+		monsters.push_back(*monster);
+	});
+
+	_monster_skill_db.for_each([&skills, &index] (uint32_t monster_id, std::shared_ptr<std::vector<std::shared_ptr<const monster_skill_config_data>>> const &monster_skills) {
+		monster_skill_snapshot_index entry;
+		entry.monster_id = monster_id;
+		entry.first = skills.size();
+		entry.count = monster_skills->size();
+		index.push_back(entry);
+
+		for (std::shared_ptr<const monster_skill_config_data> const &skill : *monster_skills)
+			skills.push_back(*skill);
+	});
+
+	writer.AddSection("monster_db", monsters, MONSTER_DB_SNAPSHOT_LAYOUT);
+	writer.AddSection("monster_skill_db", skills, MONSTER_SKILL_DB_SNAPSHOT_LAYOUT);
+	writer.AddSection("monster_skill_index", index, MONSTER_SKILL_INDEX_SNAPSHOT_LAYOUT);
+
+	boost::filesystem::create_directories(boost::filesystem::path(file_path).parent_path(), ec);
+
+	dbsnapshot_error_type result = writer.Write(file_path);
+
+	if (result != DBSNAPSHOT_OK) {
+		HLog(warning) << "Monster database snapshot '" << file_path << "' could not be written (" << DBSnapshot::ErrorString(result) << ").";
+		return false;
+	}
+
+	HLog(info) << "Compiled " << monsters.size() << " monsters and " << skills.size() << " monster skills into snapshot '" << file_path << "'.";
 	return true;
 }
 
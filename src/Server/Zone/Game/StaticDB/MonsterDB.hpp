@@ -51,7 +51,21 @@ public:
 	
 	bool load();
 
+	/**
+	 * @brief Maps the monster and monster skill tables from a compiled snapshot, records are used in place.
+	 * This is the only static database with a snapshot, item, skill and job records hold strings and vectors
+	 * and are read from Lua until they are flattened into trivially copyable records.
+	 * @return false if the snapshot is missing, invalid or older than any of the Lua databases it was compiled from.
+	 */
+	bool load_snapshot(std::string const &file_path);
+	/**
+	 * @brief Compiles the loaded tables into a snapshot, along with fingerprints of the Lua databases they were read from.
+	 */
+	bool save_snapshot(std::string const &file_path);
+
 protected:
+	std::vector<std::string> snapshot_sources();
+
 	bool load_internal(sol::object const &key, sol::object const &value);
 
 	bool parse_level(sol::table const &table, monster_config_data &data);
@@ -87,11 +101,21 @@ public:
 	std::shared_ptr<const monster_config_data> get_monster_by_id(uint32_t id) { return _monster_db.at(id, nullptr); }
 	std::shared_ptr<const monster_config_data> get_monster_by_name(std::string name) { return _monster_str_db.at(name); }
 
+	/**
+	 * @brief Lock-free lookup into the frozen monster table, the record lives as long as the database.
+	 * @thread any
+	 */
+	monster_config_data const *find_monster_by_id(uint32_t id) const
+	{
+		std::shared_ptr<const monster_config_data> const *monster = _monster_db.find(id);
+		return monster != nullptr ? monster->get() : nullptr;
+	}
+
 	std::shared_ptr<std::vector<std::shared_ptr<const monster_skill_config_data>>> get_monster_skill_by_id(uint32_t monster_id) { return _monster_skill_db.at(monster_id); }
 private:
-	LockedLookupTable<uint32_t, std::shared_ptr<const monster_config_data>> _monster_db;
-	LockedLookupTable<std::string, std::shared_ptr<const monster_config_data>> _monster_str_db;
-	LockedLookupTable<uint32_t, std::shared_ptr<std::vector<std::shared_ptr<const monster_skill_config_data>>>> _monster_skill_db;
+	FrozenLookupTable<uint32_t, std::shared_ptr<const monster_config_data>> _monster_db;
+	FrozenLookupTable<std::string, std::shared_ptr<const monster_config_data>> _monster_str_db;
+	FrozenLookupTable<uint32_t, std::shared_ptr<std::vector<std::shared_ptr<const monster_skill_config_data>>>> _monster_skill_db;
 };
 }
 }
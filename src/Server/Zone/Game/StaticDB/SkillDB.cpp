@@ -89,6 +89,9 @@ bool SkillDatabase::load()
 		status_tbl.for_each([this, &total_entries] (sol::object const &key, sol::object const &value) {
 			total_entries += load_internal_skill_db(key, value) ? 1 : 0;
 		});
+		// The skill tree refers to the skills read above.
+		_skill_db.freeze();
+		_skill_str_db.freeze();
 		HLog(info) << "Loaded " << total_entries << " entries from '" << file_path << "'.";
     } catch (sol::error &e) {
         HLog(error) << "SkillDB::load: " << e.what();
@@ -106,6 +109,7 @@ bool SkillDatabase::load()
 		skill_tree_tbl.for_each([this, &total_entries] (sol::object const &key, sol::object const &value) {
 			total_entries += load_internal_skill_tree(key, value) ? 1 : 0;
 		});
+		_skill_tree_db.freeze();
 		HLog(info) << "Loaded " << total_entries << " entries from '" << file_path << "'.";
 	} catch(const std::exception &e) {
 		HLog(error) << "SkillDB::load: error loading skill_tree_db: " << e.what();
@@ -2129,7 +2133,7 @@ bool SkillDatabase::load_internal_skill_tree(sol::object const &key, sol::object
 				if (v.get_type() == sol::type::string) {
 					std::string job_name = v.as<std::string>();
 					jclass = JobDB->get_job_class_by_name(job_name);
-					c = SkillDB->get_skill_tree_by_job_id(jclass);
+					c = _skill_tree_db.staged(jclass);
 
 					if (c.size() == 0) {
 						HLog(error) << "Non-existent job '" << job_name << "' couldn't be inherited for job '" << job->name << "'.";
@@ -2137,7 +2141,7 @@ bool SkillDatabase::load_internal_skill_tree(sol::object const &key, sol::object
 					}
 				} else if (v.get_type() == sol::type::number) {
 					jclass = (job_class_type) v.as<int>();
-					c = SkillDB->get_skill_tree_by_job_id(jclass);
+					c = _skill_tree_db.staged(jclass);
 
 					if (c.size() == 0) {
 						HLog(error) << "Non-existent job " << (int) jclass << " couldn't be inherited for job '" << job->name << "'.";
@@ -109,25 +109,43 @@ public:
 	std::shared_ptr<const skill_config_data> get_skill_by_id(int32_t id) { return _skill_db.at(id); }
 	std::shared_ptr<const skill_config_data> get_skill_by_name(std::string name) { return _skill_str_db.at(name); }
 
-	std::vector<std::shared_ptr<const skill_tree_config>> get_skill_tree_by_job_id(job_class_type job_id) 
+	/**
+	 * @brief Lock-free lookups into the frozen skill tables, the records live as long as the database.
+	 * @thread any
+	 */
+	skill_config_data const *find_skill_by_id(int32_t id) const
 	{
-		return _skill_tree_db.at(job_id, std::vector<std::shared_ptr<const skill_tree_config>>()); 
+		std::shared_ptr<const skill_config_data> const *skill = _skill_db.find(id);
+		return skill != nullptr ? skill->get() : nullptr;
 	}
 
-	std::shared_ptr<const skill_tree_config> get_skill_tree_skill_id_by_job_id(job_class_type job_id, int16_t skill_id)
+	skill_config_data const *find_skill_by_name(std::string const &name) const
 	{
-		for (auto stc : get_skill_tree_by_job_id(job_id)) {
+		std::shared_ptr<const skill_config_data> const *skill = _skill_str_db.find(name);
+		return skill != nullptr ? skill->get() : nullptr;
+	}
+
+	std::vector<std::shared_ptr<const skill_tree_config>> const &get_skill_tree_by_job_id(job_class_type job_id) const
+	{
+		static std::vector<std::shared_ptr<const skill_tree_config>> const empty_tree;
+		std::vector<std::shared_ptr<const skill_tree_config>> const *tree = _skill_tree_db.find(job_id);
+		return tree != nullptr ? *tree : empty_tree;
+	}
+
+	skill_tree_config const *get_skill_tree_skill_id_by_job_id(job_class_type job_id, int16_t skill_id) const
+	{
+		for (std::shared_ptr<const skill_tree_config> const &stc : get_skill_tree_by_job_id(job_id)) {
 			if (stc->skill_id == skill_id)
-				return stc;
+				return stc.get();
 		}
 
 		return nullptr;
 	}
 
 private:
-	LockedLookupTable<uint32_t, std::shared_ptr<const skill_config_data>> _skill_db;
-	LockedLookupTable<std::string, std::shared_ptr<const skill_config_data>> _skill_str_db;
-	LockedLookupTable<job_class_type, std::vector<std::shared_ptr<const skill_tree_config>>> _skill_tree_db;
+	FrozenLookupTable<uint32_t, std::shared_ptr<const skill_config_data>> _skill_db;
+	FrozenLookupTable<std::string, std::shared_ptr<const skill_config_data>> _skill_str_db;
+	FrozenLookupTable<job_class_type, std::vector<std::shared_ptr<const skill_tree_config>>> _skill_tree_db;
 };
 }
 }
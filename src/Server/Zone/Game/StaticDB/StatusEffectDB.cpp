@@ -68,6 +68,7 @@ bool StatusEffectDatabase::load()
 		status_tbl.for_each([this, &total_entries] (sol::object const &key, sol::object const &value) {
 			total_entries += load_internal(key, value) ? 1 : 0;
 		});
+		_status_effect_db.freeze();
 		HLog(info) << "Loaded " << total_entries << " entries from '" << file_path << "'.";
     } catch (sol::error &e) {
         HLog(error) << "StatusEffectDatabase::load: " << e.what();
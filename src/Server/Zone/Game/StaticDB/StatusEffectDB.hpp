@@ -66,7 +66,7 @@ public:
 	std::shared_ptr<const status_effect_config_data> get_status_effect_by_id(int32_t id) { return _status_effect_db.at(id); }
 
 private:
-	LockedLookupTable<uint32_t, std::shared_ptr<const status_effect_config_data>> _status_effect_db;
+	FrozenLookupTable<uint32_t, std::shared_ptr<const status_effect_config_data>> _status_effect_db;
 };
 }
 }
@@ -37,6 +37,7 @@
 #include "Server/Zone/Game/Map/MapManager.hpp"
 #include "Server/Zone/Game/Map/MapContainerThread.hpp"
 #include "Server/Zone/Game/StaticDB/SkillDB.hpp"
+#include "Server/Zone/Persistence/LoginManager.hpp"
 #include "Server/Zone/Session/ZoneSession.hpp"
 #include "Server/Zone/SocketMgr/ClientSocketMgr.hpp"
 #include "Server/Zone/Zone.hpp"
@@ -53,52 +54,35 @@ ZoneClientInterface::~ZoneClientInterface()
 {
 }
 
+/**
+ * @brief Queues the login, the character is loaded by the login workers.
+ * @see LoginManager
+ */
 bool ZoneClientInterface::login(uint32_t account_id, uint32_t char_id, uint32_t auth_code, uint32_t client_time, uint8_t gender)
-{	
-	mysqlx::RowResult rr = sZone->get_db_connection()->sql("SELECT `current_server` FROM `session_data` WHERE `game_account_id` = ? AND `auth_code` = ?")
-		.bind(account_id, auth_code)
-		.execute();
-	mysqlx::Row r = rr.fetchOne();
-
-	if (r.isNull()) {
-		HLog(error) << "Login error! Session data for game account " << account_id << " and authentication code " << auth_code << " does not exist.";
-		return false;
-	}
-
-	std::string current_server = r[0].get<std::string>();
-	if (current_server.compare("Z") == 0) {
-		ZC_REFUSE_ENTER pkt(get_session());
-		pkt.deliver(ZONE_SERV_ERROR_REJECT);
-		return false;
-	}
-
-	mysqlx::RowResult rr2 = sZone->get_db_connection()->sql("SELECT `gender`, `group_id` FROM `game_accounts` WHERE `id` = ?")
-		.bind(account_id)
-		.execute();
-	mysqlx::Row r2 = rr2.fetchOne();
-	
-	if (r2.isNull()) {
-		HLog(error) << "Login error! Game account with id " << account_id << " does not exist.";
-		return false;
-	}
-	
-	sZone->get_db_connection()->sql("UPDATE `session_data` SET `current_server` = ? WHERE `game_account_id` = ? AND `auth_code` = ?")
-		.bind(current_server, account_id, auth_code)
-		.execute();
-
-	std::shared_ptr<Horizon::Zone::Entities::Player> pl = std::make_shared<Horizon::Zone::Entities::Player>(get_session(), account_id);
+{
+	LoginMgr->queue(get_session(), account_id, char_id, auth_code);
 	
-	pl->create(char_id, r2[0].get<std::string>(), r2[1].get<int>());
+	return true;
+}
 
+/**
+ * @thread MapContainerThread receiving the player, before it initializes it.
+ */
+bool ZoneClientInterface::notify_login_accepted(std::shared_ptr<Horizon::Zone::Entities::Player> pl)
+{
 	ZC_AID zc_aid(get_session());
 	ZC_ACCEPT_ENTER2 zc_ae2(get_session());
 	
 	zc_aid.deliver(pl->guid());
 	zc_ae2.deliver(pl->map_coords().x(), pl->map_coords().y(), DIR_SOUTH, pl->character()._font); // edit third argument to saved font.
 	
-	get_session()->set_player(pl);
-	
-	ClientSocktMgr->set_socket_for_removal(get_session()->get_socket());
+	return true;
+}
+
+bool ZoneClientInterface::notify_login_refused()
+{
+	ZC_REFUSE_ENTER pkt(get_session());
+	pkt.deliver(ZONE_SERV_ERROR_REJECT);
 	
 	return true;
 }
@@ -139,32 +123,15 @@ bool ZoneClientInterface::disconnect(int8_t type)
 
 bool ZoneClientInterface::update_session(int32_t account_id)
 {
-	mysqlx::RowResult rr = sZone->get_db_connection()->sql("SELECT `current_server` FROM `session_data` WHERE `id` = ?")
-		.bind(account_id)
-		.execute();
-	mysqlx::Row r = rr.fetchOne();
-
 	HLog(debug) << "Updating session from I.P. address " << get_session()->get_socket()->remote_ip_address();
 
-	if (r.isNull()) {
+	if (!sZone->session_store().touch(account_id, 'C', std::time(nullptr))) {
 		ZC_ACK_REQ_DISCONNECT pkt(get_session());
 		HLog(warning) << "Invalid connection for account with ID " << account_id << ", session wasn't found.";
 		pkt.deliver(0);
 		return false;
 	}
 
-	std::string current_server = r[0].get<std::string>();
-
-	if (current_server.compare("C") != 0) {
-		ZC_ACK_REQ_DISCONNECT pkt(get_session());
-		HLog(warning) << "Invalid connection for account with ID " << account_id << ", session wasn't found.";
-		pkt.deliver(0);
-		return false;
-	}
-	
-	sZone->get_db_connection()->sql("UPDATE `session_data` SET `last_update` = ? WHERE `game_account_id` = ?")
-		.bind(account_id, std::time(nullptr))
-		.execute();
 	return true;
 }
 
@@ -323,13 +290,10 @@ bool ZoneClientInterface::notify_entity_move(int32_t guid, MapCoords from, MapCo
 	return true;
 }
 
-bool ZoneClientInterface::notify_viewport_remove_entity(std::shared_ptr<Entity> entity, entity_viewport_notification_type type)
+bool ZoneClientInterface::notify_viewport_remove_entity(int32_t guid, entity_viewport_notification_type type)
 {
-	if (entity == nullptr)
-		 return false;
-
 	ZC_NOTIFY_VANISH pkt(get_session());
-	pkt.deliver(entity->guid(), type);
+	pkt.deliver(guid, type);
 	return true;
 }
 
@@ -682,12 +646,12 @@ void ZoneClientInterface::upgrade_skill_level(int16_t skill_id)
 		ls->level += 1;
 	}
 
-	std::shared_ptr<const skill_config_data> skd = SkillDB->get_skill_by_id(ls->skill_id);
+	skill_config_data const *skd = SkillDB->find_skill_by_id(ls->skill_id);
 
 	bool upgradeable = false;
 
 	job_class_type job_id = (job_class_type) get_session()->player()->job_id();
-	std::shared_ptr<const skill_tree_config> stc = SkillDB->get_skill_tree_skill_id_by_job_id(job_id, ls->skill_id);
+	skill_tree_config const *stc = SkillDB->get_skill_tree_skill_id_by_job_id(job_id, ls->skill_id);
 
 	if (stc == nullptr) {
 		HLog(error) << "Skill ID " << ls->skill_id << " not found for Job ID " << (int32_t) job_id << ".";
@@ -716,7 +680,7 @@ bool ZoneClientInterface::notify_learnt_skill_list()
 
 		zc_skill_info_data si;
 
-		std::shared_ptr<const skill_config_data> skd = SkillDB->get_skill_by_id(ls->skill_id);
+		skill_config_data const *skd = SkillDB->find_skill_by_id(ls->skill_id);
 		
 		if (skd == nullptr) {
 			HLog(error) << "Tried to send data for unknown skill with ID " << ls->skill_id;
@@ -739,7 +703,7 @@ bool ZoneClientInterface::notify_learnt_skill_list()
 
 		if (ls->learn_type == SKILL_LEARN_PERMANENT) {
 			job_class_type job_id = (job_class_type) get_session()->player()->job_id();
-			std::shared_ptr<const skill_tree_config> stc = SkillDB->get_skill_tree_skill_id_by_job_id(job_id, ls->skill_id);
+			skill_tree_config const *stc = SkillDB->get_skill_tree_skill_id_by_job_id(job_id, ls->skill_id);
 
 			if (stc == nullptr) {
 				HLog(error) << "Skill ID " << ls->skill_id << " not found for Job ID " << (int32_t) job_id << ".";
@@ -775,7 +739,7 @@ void ZoneClientInterface::action_request(int32_t target_guid, player_action_type
 		case PLAYER_ACT_SIT:
 		case PLAYER_ACT_STAND:
 		{
-			std::shared_ptr<const skill_config_data> sk = SkillDB->get_skill_by_name("NV_BASIC");
+			skill_config_data const *sk = SkillDB->find_skill_by_name("NV_BASIC");
 			get_session()->player()->perform_skill(sk->skill_id, 3);
 			break;
 		}
@@ -66,6 +66,8 @@ public:
 	UI::Friend& friend() { return _friend; }
 
 	bool login(uint32_t account_id, uint32_t char_id, uint32_t auth_code, uint32_t client_time, uint8_t gender);
+	bool notify_login_accepted(std::shared_ptr<Horizon::Zone::Entities::Player> pl);
+	bool notify_login_refused();
 	bool restart(uint8_t type);
 	bool disconnect(int8_t type);
 	bool update_session(int32_t account_id);
@@ -83,7 +85,7 @@ public:
 
 	entity_viewport_entry create_viewport_entry(std::shared_ptr<Entity> entity);
 	bool notify_viewport_add_entity(entity_viewport_entry entry);
-	bool notify_viewport_remove_entity(std::shared_ptr<Entity> entity, entity_viewport_notification_type type);
+	bool notify_viewport_remove_entity(int32_t guid, entity_viewport_notification_type type);
 	bool notify_viewport_moving_entity(entity_viewport_entry entry);
 	bool notify_viewport_spawn_entity(entity_viewport_entry entry);
 	
@@ -222,4 +222,36 @@ void MonsterComponent::deregister_single_spawned_monster(uint32_t guid) {
 			_monster_spawned_map.erase(i);
 			return;
 		}
-}
\ No newline at end of file
+}
+
+void MonsterComponent::extract_map(std::string const &map_name, std::vector<std::shared_ptr<monster_spawn_data>> &spawns, std::vector<std::shared_ptr<Monster>> &monsters)
+{
+	for (auto i = _monster_spawn_db.begin(); i != _monster_spawn_db.end();) {
+		if (i->second->map_name == map_name) {
+			spawns.push_back(i->second);
+			i = _monster_spawn_db.erase(i);
+		} else {
+			i++;
+		}
+	}
+
+	for (auto i = _monster_spawned_map.begin(); i != _monster_spawned_map.end();) {
+		std::shared_ptr<Map> map = i->second->map();
+
+		if (map != nullptr && map->get_name() == map_name) {
+			monsters.push_back(i->second);
+			i = _monster_spawned_map.erase(i);
+		} else {
+			i++;
+		}
+	}
+}
+
+void MonsterComponent::adopt_map(std::vector<std::shared_ptr<monster_spawn_data>> const &spawns, std::vector<std::shared_ptr<Monster>> const &monsters)
+{
+	for (auto &spwd : spawns)
+		register_monster_spawn_info(_last_monster_spawn_id++, spwd);
+
+	for (auto &monster : monsters)
+		register_single_spawned_monster(monster->guid(), monster);
+}
@@ -56,6 +56,17 @@ public:
     std::shared_ptr<Entities::Monster> get_single_spawned_monster(uint32_t guid) { return _monster_spawned_map.at(guid); }
     void deregister_single_spawned_monster(uint32_t guid);
 
+    /**
+     * @brief Removes the spawn information and spawned monsters of a map being migrated to another container.
+     * @thread MapContainerThread (source)
+     */
+    void extract_map(std::string const &map_name, std::vector<std::shared_ptr<monster_spawn_data>> &spawns, std::vector<std::shared_ptr<Entities::Monster>> &monsters);
+    /**
+     * @brief Takes over the spawn information and spawned monsters of a map migrated from another container.
+     * @thread MapContainerThread (target)
+     */
+    void adopt_map(std::vector<std::shared_ptr<monster_spawn_data>> const &spawns, std::vector<std::shared_ptr<Entities::Monster>> const &monsters);
+
 private: 
     std::map<uint32_t, std::shared_ptr<monster_spawn_data>> _monster_spawn_db;
     std::map<uint32_t, std::shared_ptr<Entities::Monster>> _monster_spawned_map;
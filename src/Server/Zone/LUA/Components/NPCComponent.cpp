@@ -166,7 +166,7 @@ void NPCComponent::contact_npc_for_player(std::shared_ptr<Player> player, uint32
 		player->set_npc_contact_guid(npc_guid);
 
 	try {
-		sol::protected_function fx = player->lua_state()->load_file("scripts/internal/script_command_main.lua");
+		sol::protected_function fx = player->lua_manager()->get_script(player->lua_state(), "scripts/internal/script_command_main.lua");
 		sol::protected_function_result result = fx(player, nd->_npc, nd->script, nd->script_is_file);
 		if (!result.valid()) {
 			sol::error err = result;
@@ -191,4 +191,22 @@ void NPCComponent::continue_npc_script_for_player(std::shared_ptr<Entities::Play
 		sol::error err = result;
 		HLog(error) << "LUAManager::continue_npc_script_for_player: " << err.what();
 	}
-}
\ No newline at end of file
+}
+void NPCComponent::extract_map(std::string const &map_name, std::vector<std::pair<uint32_t, std::shared_ptr<npc_db_data>>> &npcs)
+{
+	std::map<uint32_t, std::shared_ptr<npc_db_data>> npc_db = _npc_db.get_map();
+
+	for (auto &nd : npc_db) {
+		if (nd.second->map_name != map_name)
+			continue;
+
+		npcs.push_back(nd);
+		_npc_db.erase(nd.first);
+	}
+}
+
+void NPCComponent::adopt_map(std::vector<std::pair<uint32_t, std::shared_ptr<npc_db_data>>> const &npcs)
+{
+	for (auto &nd : npcs)
+		add_npc_to_db(nd.first, nd.second);
+}
@@ -53,6 +53,17 @@ public:
     void add_npc_to_db(uint32_t guid, std::shared_ptr<npc_db_data> const &data) { _npc_db.insert(guid, data); }
     std::shared_ptr<npc_db_data> get_npc_from_db(uint32_t guid) { return _npc_db.at(guid); }
 
+    /**
+     * @brief Removes the NPCs of a map being migrated to another container.
+     * @thread MapContainerThread (source)
+     */
+    void extract_map(std::string const &map_name, std::vector<std::pair<uint32_t, std::shared_ptr<npc_db_data>>> &npcs);
+    /**
+     * @brief Takes over the NPCs of a map migrated from another container.
+     * @thread MapContainerThread (target)
+     */
+    void adopt_map(std::vector<std::pair<uint32_t, std::shared_ptr<npc_db_data>>> const &npcs);
+
     void contact_npc_for_player(std::shared_ptr<Entities::Player> player, uint32_t npc_guid);
     void continue_npc_script_for_player(std::shared_ptr<Entities::Player> player, uint32_t npc_guid, uint32_t select_idx = 0);
 
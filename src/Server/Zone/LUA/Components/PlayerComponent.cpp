@@ -95,7 +95,7 @@ void PlayerComponent::sync_functions(std::shared_ptr<sol::state> state)
 void PlayerComponent::perform_command_from_player(std::shared_ptr<Horizon::Zone::Entities::Player> player, std::string const &cmd)
 {
     try {
-        sol::load_result fx = player->lua_state()->load_file("scripts/internal/at_command_main.lua");
+        sol::protected_function fx = player->lua_manager()->get_script(player->lua_state(), "scripts/internal/at_command_main.lua");
         sol::protected_function_result result = fx(player, cmd);
         if (!result.valid()) {
             sol::error err = result;
@@ -36,10 +36,15 @@
 #include "Server/Zone/Game/Map/MapManager.hpp"
 #include "Server/Zone/Interface/ZoneClientInterface.hpp"
 #include "Server/Zone/Session/ZoneSession.hpp"
+#include "Server/Zone/Zone.hpp"
+
+#include <boost/filesystem.hpp>
 
 using namespace Horizon::Zone;
 using namespace Horizon::Zone::Entities;
 
+std::atomic<uint32_t> LUAManager::_script_cache_generation{0};
+
 LUAManager::LUAManager(std::shared_ptr<MapContainerThread> container)
 : _container(container), 
 _lua_state(std::make_shared<sol::state>()),
@@ -51,7 +56,8 @@ _item_component(std::make_shared<ItemComponent>()),
 _entity_component(std::make_shared<EntityComponent>()),
 _skill_component(std::make_shared<SkillComponent>()),
 _status_effect_component(std::make_shared<StatusEffectComponent>()),
-_combat_component(std::make_shared<CombatComponent>())
+_combat_component(std::make_shared<CombatComponent>()),
+_script_reload_check_interval(sZone->config().script_reload_check_interval())
 {
 }
 
@@ -118,10 +124,10 @@ void LUAManager::initialize_basic_state(std::shared_ptr<sol::state> state)
 
 			if (!res.valid()) {
 				sol::error error = res;
-				HLog(error) << "LUAManager::initialize_state: " << error.what();
+				HLogSys(LOG_SCRIPT, error) << "LUAManager::initialize_state: " << error.what();
 			}
 		} catch (sol::error &error) {
-			HLog(error) << "LUAManager::initialize_state: " << error.what();
+			HLogSys(LOG_SCRIPT, error) << "LUAManager::initialize_state: " << error.what();
 		}
 	}
 
@@ -206,14 +212,14 @@ void LUAManager::load_scripts()
 			sol::protected_function_result result = fn();
 			if (!result.valid()) {
 				sol::error error = result;
-				HLog(warning) << "Failed to load file '" << script_file << "' from '" << file_path << "', reason: " << error.what();
+				HLogSys(LOG_SCRIPT, warning) << "Failed to load file '" << script_file << "' from '" << file_path << "', reason: " << error.what();
 				return;
 			}
 			count++;
 		});
-		HLog(info) << "Read " << count << " NPC scripts from '" << file_path << "' for map container " << (void *)_container.lock().get() << ".";
+		HLogSys(LOG_SCRIPT, info) << "Read " << count << " NPC scripts from '" << file_path << "' for map container " << (void *)_container.lock().get() << ".";
 	} catch (sol::error &e) {
-		HLog(warning) << "Failed to load included script files from '" << file_path << "', reason: " << e.what();
+		HLogSys(LOG_SCRIPT, warning) << "Failed to load included script files from '" << file_path << "', reason: " << e.what();
 	}
 }
 void LUAManager::load_constants()
@@ -223,8 +229,67 @@ void LUAManager::load_constants()
 	try {
 		_lua_state->script_file(file_path);
 		sol::table const_table = _lua_state->get<sol::table>("constants");
-		HLog(info) << "Read constants from '" << file_path << "' for map container " << (void *)_container.lock().get() << ".";
+		HLogSys(LOG_SCRIPT, info) << "Read constants from '" << file_path << "' for map container " << (void *)_container.lock().get() << ".";
 	} catch (sol::error &e) {
-		HLog(error) << "Failed to read constants from '" << file_path << "', reason: " << e.what();
+		HLogSys(LOG_SCRIPT, error) << "Failed to read constants from '" << file_path << "', reason: " << e.what();
 	}
 }
+
+sol::protected_function LUAManager::get_script(std::shared_ptr<sol::state> state, std::string const &file_path)
+{
+	uint32_t generation = _script_cache_generation.load(std::memory_order_relaxed);
+	std::time_t modification_time = get_script_modification_time(file_path);
+	sol::table registry = state->registry();
+	sol::optional<sol::table> cache = registry[LUA_SCRIPT_CACHE_REGISTRY_KEY];
+
+	if (!cache) {
+		cache = state->create_table();
+		registry[LUA_SCRIPT_CACHE_REGISTRY_KEY] = *cache;
+	}
+
+	// Entries are { chunk, cache generation, modification time of the file }.
+	sol::optional<sol::table> entry = (*cache)[file_path];
+
+	if (entry) {
+		if ((*entry).get<uint32_t>(2) == generation && (*entry).get<int64_t>(3) == (int64_t) modification_time) {
+			_script_cache_stats.hits.fetch_add(1, std::memory_order_relaxed);
+			return (*entry).get<sol::protected_function>(1);
+		}
+
+		_script_cache_stats.reloads.fetch_add(1, std::memory_order_relaxed);
+	} else {
+		_script_cache_stats.misses.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	sol::load_result chunk = state->load_file(file_path);
+
+	if (!chunk.valid()) {
+		sol::error error = chunk;
+		throw error;
+	}
+
+	sol::protected_function fn = chunk;
+
+	(*cache)[file_path] = state->create_table_with(1, fn, 2, generation, 3, (int64_t) modification_time);
+
+	return fn;
+}
+
+std::time_t LUAManager::get_script_modification_time(std::string const &file_path)
+{
+	if (_script_reload_check_interval == 0)
+		return 0;
+
+	std::time_t now = std::time(nullptr);
+	script_file_status &status = _script_file_status[file_path];
+
+	if (now - status.last_checked >= _script_reload_check_interval) {
+		boost::system::error_code error;
+		std::time_t modification_time = boost::filesystem::last_write_time(file_path, error);
+
+		status.modification_time = error ? 0 : modification_time;
+		status.last_checked = now;
+	}
+
+	return status.modification_time;
+}
@@ -43,6 +43,22 @@
 #include "Server/Zone/LUA/Components/NPCComponent.hpp"
 #include "Server/Zone/LUA/Components/PlayerComponent.hpp"
 
+#include <atomic>
+#include <ctime>
+#include <unordered_map>
+
+#define LUA_SCRIPT_CACHE_REGISTRY_KEY "horizon_script_cache" // Registry table of each state holding its compiled scripts.
+
+/**
+ * @brief Counters of the compiled script cache of a LUAManager.
+ */
+struct lua_script_cache_statistics
+{
+	uint64_t hits{0};      ///< Scripts served compiled from a state's cache.
+	uint64_t misses{0};    ///< Scripts loaded and compiled for the first time in a state.
+	uint64_t reloads{0};   ///< Cached scripts recompiled after a reload or a change on disk.
+};
+
 namespace Horizon
 {
 namespace Zone
@@ -79,6 +95,36 @@ public:
 	std::shared_ptr<CombatComponent> combat() { return _combat_component; }
 
 	std::shared_ptr<sol::state> lua_state() { return _lua_state; }
+
+	/**
+	 * @brief Retrieves the compiled chunk of a script file for a Lua state.
+	 * A state compiles each file once and keeps the chunk in its registry, so that later
+	 * calls neither open nor parse the file until it is reloaded (@see reload_scripts),
+	 * or until it is found modified on disk if periodic checks are enabled.
+	 * @throws sol::error if the file could not be loaded or compiled.
+	 * @thread MapContainerThread
+	 */
+	sol::protected_function get_script(std::shared_ptr<sol::state> state, std::string const &file_path);
+
+	/**
+	 * @brief Marks the scripts cached by every state as stale, to be recompiled on their next use.
+	 * @thread any
+	 */
+	static void reload_scripts() { _script_cache_generation.fetch_add(1, std::memory_order_relaxed); }
+
+	/**
+	 * @brief Sets the interval in seconds at which script files are checked for changes on disk, 0 to disable.
+	 */
+	void set_script_reload_check_interval(std::time_t interval) { _script_reload_check_interval = interval; }
+
+	lua_script_cache_statistics get_script_cache_statistics()
+	{
+		lua_script_cache_statistics stats;
+		stats.hits = _script_cache_stats.hits.load(std::memory_order_relaxed);
+		stats.misses = _script_cache_stats.misses.load(std::memory_order_relaxed);
+		stats.reloads = _script_cache_stats.reloads.load(std::memory_order_relaxed);
+		return stats;
+	}
 protected:
 	void initialize_for_container();
 	void finalize();
@@ -88,6 +134,7 @@ private:
 	void load_constants();
 	void load_scripts();
 	void load_scripts_internal();
+	std::time_t get_script_modification_time(std::string const &file_path);
 
 	std::vector<std::string> _script_files;
 	std::shared_ptr<sol::state> _lua_state;
@@ -102,7 +149,19 @@ private:
 	std::shared_ptr<SkillComponent> _skill_component;
 	std::shared_ptr<StatusEffectComponent> _status_effect_component;
 	std::shared_ptr<CombatComponent> _combat_component;
-	
+
+	struct script_file_status {
+		std::time_t modification_time{0};
+		std::time_t last_checked{0};
+	};
+	std::unordered_map<std::string, script_file_status> _script_file_status; ///< Last known modification times of script files.
+	std::time_t _script_reload_check_interval{0};
+	static std::atomic<uint32_t> _script_cache_generation;
+	struct {
+		std::atomic<uint64_t> hits{0};
+		std::atomic<uint64_t> misses{0};
+		std::atomic<uint64_t> reloads{0};
+	} _script_cache_stats;                                                   ///< @see lua_script_cache_statistics
 };
 }
 }
@@ -0,0 +1,561 @@
+/***************************************************
+ *       _   _            _                        *
+ *      | | | |          (_)                       *
+ *      | |_| | ___  _ __ _ _______  _ __          *
+ *      |  _  |/ _ \| '__| |_  / _ \| '_  \        *
+ *      | | | | (_) | |  | |/ / (_) | | | |        *
+ *      \_| |_/\___/|_|  |_/___\___/|_| |_|        *
+ ***************************************************
+ * This file is part of Horizon (c).
+ *
+ * Copyright (c) 2019 Sagun K. (sagunxp@gmail.com).
+ * Copyright (c) 2019 Horizon Dev Team.
+ *
+ * Base Author - Sagun K. (sagunxp@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ **************************************************/
+
+#include "LoginManager.hpp"
+
+#include "Server/Zone/Game/Entities/Player/Player.hpp"
+#include "Server/Zone/Game/Map/Map.hpp"
+#include "Server/Zone/Game/Map/MapContainerThread.hpp"
+#include "Server/Zone/Session/ZoneSession.hpp"
+#include "Server/Zone/Socket/ZoneSocket.hpp"
+#include "Server/Zone/SocketMgr/ClientSocketMgr.hpp"
+#include "Server/Zone/Zone.hpp"
+
+using namespace Horizon::Zone;
+
+bool LoginManager::initialize(int threads, int max_concurrent_logins)
+{
+	std::vector<std::shared_ptr<mysqlx::Session>> connections;
+
+	_max_concurrent_logins = std::max(max_concurrent_logins, 0);
+
+	try {
+		for (int i = 0; i < threads; i++)
+			connections.push_back(connect());
+	}
+	catch (mysqlx::Error &error) {
+		HLogSys(LOG_DATABASE, error) << "LoginManager::initialize: " << error.what() << ", characters will be loaded synchronously.";
+		return false;
+	}
+	catch (std::exception &error) {
+		HLogSys(LOG_DATABASE, error) << "LoginManager::initialize: " << error.what() << ", characters will be loaded synchronously.";
+		return false;
+	}
+
+	_running.exchange(!connections.empty());
+
+	for (auto &connection : connections)
+		_workers.push_back(std::thread([this, connection] () { run(connection); }));
+
+	HLogSys(LOG_DATABASE, info) << "Characters entering the zone will be loaded by " << _workers.size() << " database worker(s), "
+		<< (_max_concurrent_logins > 0 ? std::to_string(_max_concurrent_logins) : std::string("unlimited")) << " at a time.";
+
+	return true;
+}
+
+void LoginManager::finalize()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mtx);
+		_running.exchange(false);
+	}
+	_cv.notify_all();
+
+	for (auto &w : _workers) {
+		if (w.joinable())
+			w.join();
+	}
+
+	_workers.clear();
+
+	std::lock_guard<std::mutex> lock(_mtx);
+
+	if (!_waiting.empty() || !_admitted.empty())
+		HLog(info) << "Dropped " << _waiting.size() + _admitted.size() << " login(s) still waiting at shutdown.";
+
+	_waiting.clear();
+	_admitted.clear();
+}
+
+void LoginManager::queue(std::shared_ptr<ZoneSession> session, uint32_t account_id, uint32_t char_id, uint32_t auth_code)
+{
+	std::shared_ptr<login_request> request = std::make_shared<login_request>();
+
+	request->session = session;
+	request->account_id = account_id;
+	request->char_id = char_id;
+	request->auth_code = auth_code;
+	request->data = std::make_shared<player_login_data>();
+	request->data->queued_at = std::chrono::steady_clock::now();
+
+	// The map container that receives the player takes the session over, the main thread lets go of it.
+	session->set_login_pending(true);
+	ClientSocktMgr->set_socket_for_removal(session->get_socket());
+
+	_queued.push_back(request);
+	_requested.fetch_add(1, std::memory_order_relaxed);
+}
+
+void LoginManager::dispatch()
+{
+	if (!_queued.empty()) {
+		admit(_queued);
+		_queued.clear();
+	}
+
+	if (!_workers.empty())
+		return;
+
+	std::shared_ptr<login_request> request;
+
+	while ((request = next_admitted()) != nullptr)
+		execute(*sZone->get_db_connection(), request);
+}
+
+void LoginManager::accept(std::shared_ptr<Entities::Player> player)
+{
+	std::shared_ptr<ZoneSession> session = player->get_session();
+
+	if (player->login_data() == nullptr || session == nullptr || session->player() == player)
+		return;
+
+	session->set_player(player);
+	session->clif()->notify_login_accepted(player);
+	session->set_login_pending(false);
+}
+
+void LoginManager::finish(std::shared_ptr<Entities::Player> player)
+{
+	std::shared_ptr<player_login_data> data = player->release_login_data();
+
+	if (data == nullptr)
+		return;
+
+	std::chrono::steady_clock::time_point from = data->loaded_at;
+	std::chrono::steady_clock::time_point queued_at = data->queued_at;
+
+	record(LOGIN_STAGE_HANDOFF, from);
+	record(LOGIN_STAGE_TOTAL, queued_at);
+
+	_completed.fetch_add(1, std::memory_order_relaxed);
+
+	release();
+}
+
+login_statistics LoginManager::get_statistics()
+{
+	login_statistics stats;
+
+	stats.requested = _requested.load(std::memory_order_relaxed);
+	stats.completed = _completed.load(std::memory_order_relaxed);
+	stats.refused = _refused.load(std::memory_order_relaxed);
+
+	{
+		std::lock_guard<std::mutex> lock(_mtx);
+		stats.in_flight = _in_flight;
+		stats.waiting = _waiting.size();
+	}
+
+	for (int i = 0; i < LOGIN_STAGE_MAX; i++) {
+		stats.p50_us[i] = _stage_histograms[i].percentile(50);
+		stats.p99_us[i] = _stage_histograms[i].percentile(99);
+		stats.max_us[i] = _stage_histograms[i].max();
+	}
+
+	return stats;
+}
+
+void LoginManager::reset_statistics()
+{
+	for (int i = 0; i < LOGIN_STAGE_MAX; i++)
+		_stage_histograms[i].reset();
+}
+
+const char *LoginManager::get_stage_name(login_stage_type stage)
+{
+	switch (stage)
+	{
+	case LOGIN_STAGE_ADMISSION: return "admission";
+	case LOGIN_STAGE_SESSION: return "session";
+	case LOGIN_STAGE_CHARACTER: return "character";
+	case LOGIN_STAGE_STATUS: return "status";
+	case LOGIN_STAGE_INVENTORY: return "inventory";
+	case LOGIN_STAGE_HANDOFF: return "handoff";
+	case LOGIN_STAGE_TOTAL: return "total";
+	default: break;
+	}
+
+	return "unknown";
+}
+
+std::shared_ptr<mysqlx::Session> LoginManager::connect()
+{
+	std::shared_ptr<mysqlx::Session> connection = std::make_shared<mysqlx::Session>(sZone->general_conf().get_db_host(), sZone->general_conf().get_db_port(),
+		sZone->general_conf().get_db_user(), sZone->general_conf().get_db_pass());
+
+	connection->sql(std::string("USE ").append(sZone->general_conf().get_db_database())).execute();
+
+	return connection;
+}
+
+/**
+ * @brief Worker loop, loads admitted logins until the manager stops.
+ * @thread Login worker.
+ */
+void LoginManager::run(std::shared_ptr<mysqlx::Session> connection)
+{
+	while (true) {
+		std::shared_ptr<login_request> request;
+
+		{
+			std::unique_lock<std::mutex> lock(_mtx);
+
+			_cv.wait(lock, [this] () { return !_admitted.empty() || !_running.load(); });
+
+			if (!_running.load())
+				break;
+
+			request = _admitted.front();
+			_admitted.pop_front();
+		}
+
+		if (execute(*connection, request))
+			continue;
+
+		// The connection may have been lost, the next login gets a fresh one.
+		try {
+			connection = connect();
+		}
+		catch (std::exception &error) {
+			HLogSys(LOG_DATABASE, error) << "LoginManager::run: could not reconnect: " << error.what();
+		}
+	}
+}
+
+/**
+ * @return false if the login failed on a database error.
+ */
+bool LoginManager::execute(mysqlx::Session &connection, std::shared_ptr<login_request> request)
+{
+	try {
+		process(connection, request);
+	}
+	catch (mysqlx::Error &error) {
+		HLogSys(LOG_DATABASE, error) << "LoginManager::execute: failed to load character " << request->char_id << " of account " << request->account_id << ": " << error.what();
+		refuse(*request, true);
+		return false;
+	}
+	catch (std::exception &error) {
+		HLog(error) << "LoginManager::execute: failed to load character " << request->char_id << " of account " << request->account_id << ": " << error.what();
+		refuse(*request, true);
+	}
+
+	return true;
+}
+
+/**
+ * @thread Main thread.
+ */
+void LoginManager::admit(std::vector<std::shared_ptr<login_request>> &requests)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mtx);
+
+		for (auto &request : requests) {
+			if (_max_concurrent_logins == 0 || _in_flight < (uint64_t) _max_concurrent_logins) {
+				_in_flight++;
+				_admitted.push_back(request);
+			} else {
+				_waiting.push_back(request);
+			}
+		}
+	}
+
+	_cv.notify_all();
+}
+
+std::shared_ptr<LoginManager::login_request> LoginManager::next_admitted()
+{
+	std::lock_guard<std::mutex> lock(_mtx);
+
+	if (_admitted.empty())
+		return nullptr;
+
+	std::shared_ptr<login_request> request = _admitted.front();
+	_admitted.pop_front();
+	return request;
+}
+
+/**
+ * @brief Frees a slot and admits the login that waited the longest.
+ * @thread Any.
+ */
+void LoginManager::release()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mtx);
+
+		if (_in_flight > 0)
+			_in_flight--;
+
+		if (_waiting.empty() || (_max_concurrent_logins > 0 && _in_flight >= (uint64_t) _max_concurrent_logins))
+			return;
+
+		_in_flight++;
+		_admitted.push_back(_waiting.front());
+		_waiting.pop_front();
+	}
+
+	_cv.notify_one();
+}
+
+/**
+ * @brief Loads a login stage by stage and queues the player to the map container of its map.
+ * @thread Login worker, or the main thread without workers.
+ */
+void LoginManager::process(mysqlx::Session &connection, std::shared_ptr<login_request> request)
+{
+	std::shared_ptr<player_login_data> data = request->data;
+	std::chrono::steady_clock::time_point stage_start = data->queued_at;
+	bool notify = false;
+
+	record(LOGIN_STAGE_ADMISSION, stage_start);
+
+	if (!load_session(connection, *request, notify)) {
+		refuse(*request, notify);
+		return;
+	}
+
+	record(LOGIN_STAGE_SESSION, stage_start);
+
+	if (!load_character(connection, *request)) {
+		refuse(*request, true);
+		return;
+	}
+
+	record(LOGIN_STAGE_CHARACTER, stage_start);
+
+	if (!load_status(connection, *request)) {
+		refuse(*request, true);
+		return;
+	}
+
+	record(LOGIN_STAGE_STATUS, stage_start);
+
+	load_inventory(connection, *request);
+
+	record(LOGIN_STAGE_INVENTORY, stage_start);
+
+	// No other thread knows of the player yet, it is built here and handed to its map container.
+	std::shared_ptr<Entities::Player> player = std::make_shared<Entities::Player>(request->session, request->account_id);
+
+	if (!player->load(data)) {
+		refuse(*request, true);
+		return;
+	}
+
+	data->loaded_at = std::chrono::steady_clock::now();
+
+	// Published to the session by the map container (@see accept()), the session is not touched from here on.
+	player->map()->container()->add_player(player);
+}
+
+bool LoginManager::load_session(mysqlx::Session &connection, login_request &request, bool &refuse)
+{
+	session_registry_entry session;
+
+	if (!sZone->session_store().find(request.account_id, session) || session.auth_code != request.auth_code) {
+		HLog(error) << "Login error! Session data for game account " << request.account_id << " and authentication code " << request.auth_code << " does not exist.";
+		return false;
+	}
+
+	if (session.current_server == 'Z') {
+		refuse = true;
+		return false;
+	}
+
+	mysqlx::RowResult rr = connection.sql("SELECT `gender`, `group_id` FROM `game_accounts` WHERE `id` = ?")
+		.bind(request.account_id)
+		.execute();
+	mysqlx::Row r = rr.fetchOne();
+
+	if (r.isNull()) {
+		HLog(error) << "Login error! Game account with id " << request.account_id << " does not exist.";
+		return false;
+	}
+
+	request.data->account_gender = r[0].get<std::string>();
+	request.data->group_id = r[1].get<int>();
+
+	return true;
+}
+
+bool LoginManager::load_character(mysqlx::Session &connection, login_request &request)
+{
+	mysqlx::RowResult rr = connection.sql("SELECT `id`, `account_id`, `slot`, `name`, `font`, `gender`, `last_unique_id`, `saved_map`, `saved_x`, `saved_y`, "
+		"`current_map`, `current_x`, `current_y` FROM `characters` WHERE id = ?")
+		.bind(request.char_id)
+		.execute();
+
+	mysqlx::Row r = rr.fetchOne();
+
+	if (r.isNull()) {
+		HLog(error) << "Error loading player, character with ID " << request.char_id << " does not exist.";
+		return false;
+	}
+
+	character_save_data &c = request.data->character;
+
+	c.character_id = r[0].get<int>();
+	c.account_id = r[1].get<int>();
+	c.slot = r[2].get<int>();
+	c.name = r[3].get<std::string>();
+	c.font = r[4].get<int>();
+	c.gender = r[5].get<std::string>();
+	c.last_unique_id = r[6].get<int64_t>();
+	c.saved_map = r[7].get<std::string>();
+	c.saved_x = r[8].get<int>();
+	c.saved_y = r[9].get<int>();
+	c.current_map = r[10].get<std::string>();
+	c.current_x = r[11].get<int>();
+	c.current_y = r[12].get<int>();
+
+	return true;
+}
+
+bool LoginManager::load_status(mysqlx::Session &connection, login_request &request)
+{
+	mysqlx::RowResult rr = connection.sql("SELECT `job_id`, `strength`, `agility`, `vitality`, `intelligence`, `dexterity`, "
+		"`luck`, `status_points`, `skill_points`, `hp`, `sp`, `maximum_hp`, `maximum_sp`, `base_level`, `job_level`, `base_experience`, `job_experience`, "
+		"`hair_color_id`, `cloth_color_id`, `head_top_view_id`, `head_mid_view_id`, `head_bottom_view_id`, `hair_style_id`, `shield_view_id`, `weapon_view_id`, `robe_view_id`, "
+		"`body_id`, `zeny`, `virtue`, `honor`, `manner` FROM `character_status` WHERE `id` = ?")
+		.bind(request.char_id)
+		.execute();
+
+	mysqlx::Row r = rr.fetchOne();
+
+	if (r.isNull()) {
+		HLog(error) << "Error loading status, character with ID " << request.char_id << " does not exist.";
+		return false;
+	}
+
+	status_save_data &s = request.data->status;
+
+	s.job_id = r[0].get<int>();
+	s.strength = r[1].get<int>();
+	s.agility = r[2].get<int>();
+	s.vitality = r[3].get<int>();
+	s.intelligence = r[4].get<int>();
+	s.dexterity = r[5].get<int>();
+	s.luck = r[6].get<int>();
+	s.status_points = r[7].get<int>();
+	s.skill_points = r[8].get<int>();
+	s.hp = r[9].get<int>();
+	s.sp = r[10].get<int>();
+	s.maximum_hp = r[11].get<int>();
+	s.maximum_sp = r[12].get<int>();
+	s.base_level = r[13].get<int>();
+	s.job_level = r[14].get<int>();
+	s.base_experience = r[15].get<int>();
+	s.job_experience = r[16].get<int>();
+	s.hair_color_id = r[17].get<int>();
+	s.cloth_color_id = r[18].get<int>();
+	s.head_top_view_id = r[19].get<int>();
+	s.head_mid_view_id = r[20].get<int>();
+	s.head_bottom_view_id = r[21].get<int>();
+	s.hair_style_id = r[22].get<int>();
+	s.shield_view_id = r[23].get<int>();
+	s.weapon_view_id = r[24].get<int>();
+	s.robe_view_id = r[25].get<int>();
+	s.body_id = r[26].get<int>();
+	s.zeny = r[27].get<int>();
+	s.virtue = r[28].get<int>();
+	s.honor = r[29].get<int>();
+	s.manner = r[30].get<int>();
+
+	return true;
+}
+
+void LoginManager::load_inventory(mysqlx::Session &connection, login_request &request)
+{
+	mysqlx::RowResult rr = connection.sql("SELECT `item_id`, `amount`, `equip_location_mask`, `refine_level`, `slot_item_id_0`,"
+		"`slot_item_id_1`, `slot_item_id_2`, `slot_item_id_3`, `hire_expire_date`, `element_type`, `opt_idx0`, `opt_val0`, `opt_idx1`, `opt_val1`,"
+		"`opt_idx2`, `opt_val2`, `opt_idx3`, `opt_val3`, `opt_idx4`, `opt_val4`, `is_identified`, `is_broken`, `is_favorite`, `bind_type`, `unique_id`"
+		" FROM `character_inventory` WHERE `char_id` = ?")
+		.bind(request.char_id)
+		.execute();
+
+	std::list<mysqlx::Row> rows = rr.fetchAll();
+
+	request.data->inventory.reserve(rows.size());
+
+	for (mysqlx::Row &row : rows) {
+		inventory_item_save_data i;
+
+		i.item_id = row[0].get<int>();
+		i.amount = row[1].get<int>();
+		i.equip_location_mask = row[2].get<int>();
+		i.refine_level = row[3].get<int>();
+
+		for (int s = 0; s < 4; s++)
+			i.slot_item_id[s] = row[4 + s].get<int>();
+
+		i.hire_expire_date = row[8].get<int>();
+		i.element_type = row[9].get<int>();
+
+		for (int o = 0; o < 5; o++) {
+			i.option_index[o] = row[10 + o * 2].get<int>();
+			i.option_value[o] = row[11 + o * 2].get<int>();
+		}
+
+		i.is_identified = row[20].get<int>();
+		i.is_broken = row[21].get<int>();
+		i.is_favorite = row[22].get<int>();
+		i.bind_type = row[23].get<int>();
+		i.unique_id = row[24].get<int64_t>();
+
+		request.data->inventory.push_back(i);
+	}
+}
+
+/**
+ * @brief Ends a login that failed, its session goes back to the main thread.
+ */
+void LoginManager::refuse(login_request &request, bool notify)
+{
+	if (notify)
+		request.session->clif()->notify_login_refused();
+
+	request.session->set_login_pending(false);
+
+	if (request.session->get_socket() != nullptr && request.session->get_socket()->is_open())
+		ClientSocktMgr->set_socket_for_management(request.session->get_socket());
+
+	_refused.fetch_add(1, std::memory_order_relaxed);
+
+	release();
+}
+
+void LoginManager::record(login_stage_type stage, std::chrono::steady_clock::time_point &from)
+{
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+	_stage_histograms[stage].record(std::chrono::duration_cast<std::chrono::microseconds>(now - from).count());
+	from = now;
+}
@@ -0,0 +1,200 @@
+/***************************************************
+ *       _   _            _                        *
+ *      | | | |          (_)                       *
+ *      | |_| | ___  _ __ _ _______  _ __          *
+ *      |  _  |/ _ \| '__| |_  / _ \| '_  \        *
+ *      | | | | (_) | |  | |/ / (_) | | | |        *
+ *      \_| |_/\___/|_|  |_/___\___/|_| |_|        *
+ ***************************************************
+ * This file is part of Horizon (c).
+ *
+ * Copyright (c) 2019 Sagun K. (sagunxp@gmail.com).
+ * Copyright (c) 2019 Horizon Dev Team.
+ *
+ * Base Author - Sagun K. (sagunxp@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ **************************************************/
+
+#ifndef HORIZON_ZONE_PERSISTENCE_LOGINMANAGER_HPP
+#define HORIZON_ZONE_PERSISTENCE_LOGINMANAGER_HPP
+
+#include "Server/Zone/Persistence/PersistenceManager.hpp"
+#include "Utility/TickHistogram.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Horizon
+{
+namespace Zone
+{
+class ZoneSession;
+namespace Entities
+{
+	class Player;
+}
+
+enum login_stage_type
+{
+	LOGIN_STAGE_ADMISSION = 0, ///< Queued until a login slot and a worker were free.
+	LOGIN_STAGE_SESSION,       ///< Session validation against the session registry and `game_accounts`.
+	LOGIN_STAGE_CHARACTER,     ///< `characters` row.
+	LOGIN_STAGE_STATUS,        ///< `character_status` row.
+	LOGIN_STAGE_INVENTORY,     ///< `character_inventory` rows.
+	LOGIN_STAGE_HANDOFF,       ///< From the loaded player being queued to its map container until it was initialized.
+	LOGIN_STAGE_TOTAL,
+	LOGIN_STAGE_MAX
+};
+
+/**
+ * @brief Rows of a character entering the zone, read by the login workers.
+ * The character row is applied by Player::load() on the worker, status and inventory rows
+ * by Player::initialize() on the map container that receives the player.
+ */
+struct player_login_data
+{
+	std::string account_gender{"M"};
+	int32_t group_id{0};
+	character_save_data character;
+	status_save_data status;
+	std::vector<inventory_item_save_data> inventory;
+	std::chrono::steady_clock::time_point queued_at;
+	std::chrono::steady_clock::time_point loaded_at;
+};
+
+struct login_statistics
+{
+	uint64_t requested{0};        ///< Logins queued by sessions.
+	uint64_t completed{0};        ///< Players initialized by their map container.
+	uint64_t refused{0};          ///< Logins refused or failed while loading.
+	uint64_t in_flight{0};        ///< Logins holding a slot, from admission until their player was initialized.
+	uint64_t waiting{0};          ///< Logins waiting for a slot.
+	uint64_t p50_us[LOGIN_STAGE_MAX]{0};
+	uint64_t p99_us[LOGIN_STAGE_MAX]{0};
+	uint64_t max_us[LOGIN_STAGE_MAX]{0};
+};
+
+/**
+ * @brief Loads characters entering the zone on database workers, away from the threads that
+ * run the game. A login runs its stages on one worker and ends with a player that is queued
+ * to the map container of its map, which applies the prefetched rows when it initializes it.
+ * At most max_concurrent_logins logins hold a slot at once, from admission until the map
+ * container has initialized their player, so a storm of logins is spread over several ticks.
+ * Later logins wait for a slot in arrival order.
+ */
+class LoginManager
+{
+	struct login_request
+	{
+		std::shared_ptr<ZoneSession> session;
+		uint32_t account_id{0};
+		uint32_t char_id{0};
+		uint32_t auth_code{0};
+		std::shared_ptr<player_login_data> data;
+	};
+
+public:
+	static LoginManager *getInstance()
+	{
+		static LoginManager login_mgr;
+		return &login_mgr;
+	}
+
+	/**
+	 * @brief Opens a connection per worker and starts them. With no workers, or if connecting
+	 * fails, logins are loaded synchronously on the main thread.
+	 * @param max_concurrent_logins logins that may hold a slot at once, 0 for no limit.
+	 * @thread Main thread.
+	 */
+	bool initialize(int threads, int max_concurrent_logins);
+	/**
+	 * @brief Stops the workers, logins still waiting are dropped.
+	 * @thread Main thread.
+	 */
+	void finalize();
+
+	/**
+	 * @brief Records a login of a session. The session stops handling packets until the login
+	 * has finished, they are handled by its map container afterwards.
+	 * @thread Main thread, from the session's packet handler.
+	 */
+	void queue(std::shared_ptr<ZoneSession> session, uint32_t account_id, uint32_t char_id, uint32_t auth_code);
+	/**
+	 * @brief Hands the logins queued during this update to the workers. Called once the main
+	 * thread has finished updating sessions, so that it no longer touches them.
+	 * @thread Main thread.
+	 */
+	void dispatch();
+	/**
+	 * @brief Publishes a player that came through the login pipeline to its session, notifies the
+	 * client and lets the map container handle its packets. Called before the player is initialized,
+	 * does nothing for other players or once the player was published.
+	 * @thread MapContainerThread that received the player.
+	 */
+	void accept(std::shared_ptr<Entities::Player> player);
+	/**
+	 * @brief Frees the slot of a player that came through the login pipeline and releases its
+	 * prefetched rows. Does nothing for other players.
+	 * @thread MapContainerThread that initialized the player.
+	 */
+	void finish(std::shared_ptr<Entities::Player> player);
+
+	login_statistics get_statistics();
+	void reset_statistics();
+
+	static const char *get_stage_name(login_stage_type stage);
+
+private:
+	std::shared_ptr<mysqlx::Session> connect();
+	void run(std::shared_ptr<mysqlx::Session> connection);
+	bool execute(mysqlx::Session &connection, std::shared_ptr<login_request> request);
+	void admit(std::vector<std::shared_ptr<login_request>> &requests);
+	std::shared_ptr<login_request> next_admitted();
+	void release();
+	void process(mysqlx::Session &connection, std::shared_ptr<login_request> request);
+	bool load_session(mysqlx::Session &connection, login_request &request, bool &refuse);
+	bool load_character(mysqlx::Session &connection, login_request &request);
+	bool load_status(mysqlx::Session &connection, login_request &request);
+	void load_inventory(mysqlx::Session &connection, login_request &request);
+	void refuse(login_request &request, bool notify);
+	void record(login_stage_type stage, std::chrono::steady_clock::time_point &from);
+
+	std::vector<std::thread> _workers;
+	std::atomic<bool> _running{false};
+	int _max_concurrent_logins{0};
+
+	std::vector<std::shared_ptr<login_request>> _queued;   ///< Queued during the current main thread update.
+	std::mutex _mtx;
+	std::condition_variable _cv;
+	std::deque<std::shared_ptr<login_request>> _waiting;  ///< Waiting for a slot.
+	std::deque<std::shared_ptr<login_request>> _admitted; ///< Holding a slot, waiting for a worker.
+	uint64_t _in_flight{0};
+
+	std::atomic<uint64_t> _requested{0}, _completed{0}, _refused{0};
+	TickHistogram _stage_histograms[LOGIN_STAGE_MAX];
+};
+}
+}
+
+#define LoginMgr Horizon::Zone::LoginManager::getInstance()
+
+#endif /* HORIZON_ZONE_PERSISTENCE_LOGINMANAGER_HPP */
@@ -0,0 +1,330 @@
+/***************************************************
+ *       _   _            _                        *
+ *      | | | |          (_)                       *
+ *      | |_| | ___  _ __ _ _______  _ __          *
+ *      |  _  |/ _ \| '__| |_  / _ \| '_  \        *
+ *      | | | | (_) | |  | |/ / (_) | | | |        *
+ *      \_| |_/\___/|_|  |_/___\___/|_| |_|        *
+ ***************************************************
+ * This file is part of Horizon (c).
+ *
+ * Copyright (c) 2019 Sagun K. (sagunxp@gmail.com).
+ * Copyright (c) 2019 Horizon Dev Team.
+ *
+ * Base Author - Sagun K. (sagunxp@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ **************************************************/
+
+#include "PersistenceManager.hpp"
+
+#include "Server/Zone/Zone.hpp"
+
+using namespace Horizon::Zone;
+
+bool PersistenceManager::initialize(int threads, int batch_size)
+{
+	_batch_size = std::max(batch_size, 1);
+
+	try {
+		for (int i = 0; i < threads; i++) {
+			std::unique_ptr<worker> w = std::make_unique<worker>();
+			w->connection = connect();
+			_workers.push_back(std::move(w));
+		}
+	}
+	catch (mysqlx::Error &error) {
+		HLogSys(LOG_DATABASE, error) << "PersistenceManager::initialize: " << error.what() << ", player data will be saved synchronously.";
+		_workers.clear();
+		return false;
+	}
+	catch (std::exception &error) {
+		HLogSys(LOG_DATABASE, error) << "PersistenceManager::initialize: " << error.what() << ", player data will be saved synchronously.";
+		_workers.clear();
+		return false;
+	}
+
+	_running.exchange(!_workers.empty());
+
+	for (auto &w : _workers) {
+		worker *wp = w.get();
+		wp->thread = std::thread([this, wp] () { run(*wp); });
+	}
+
+	HLogSys(LOG_DATABASE, info) << "Player data will be saved by " << _workers.size() << " database worker(s) in batches of up to " << _batch_size << ".";
+
+	return true;
+}
+
+void PersistenceManager::finalize()
+{
+	_running.exchange(false);
+
+	for (auto &w : _workers) {
+		{
+			std::lock_guard<std::mutex> lock(w->mtx);
+		}
+		w->cv.notify_all();
+	}
+
+	for (auto &w : _workers) {
+		if (w->thread.joinable())
+			w->thread.join();
+	}
+
+	_workers.clear();
+
+	persistence_statistics stats = get_statistics();
+
+	HLogSys(LOG_DATABASE, info) << "Persistence has shut down after writing " << stats.written << " snapshot(s) (" << stats.failed << " failed).";
+}
+
+bool PersistenceManager::queue(std::shared_ptr<player_save_snapshot> snapshot)
+{
+	snapshot->queued_at = std::chrono::steady_clock::now();
+	_queued.fetch_add(1, std::memory_order_relaxed);
+
+	if (!_workers.empty()) {
+		worker &w = *_workers[(uint32_t) snapshot->character.character_id % _workers.size()];
+		std::unique_lock<std::mutex> lock(w.mtx);
+
+		// Checked under the worker's lock so nothing is queued after it has drained for shutdown.
+		if (_running.load()) {
+			auto it = w.pending.find(snapshot->character.character_id);
+
+			if (it != w.pending.end()) {
+				// Keep the time the oldest unwritten save was requested.
+				snapshot->queued_at = it->second->queued_at;
+				it->second = snapshot;
+				_coalesced.fetch_add(1, std::memory_order_relaxed);
+				return true;
+			}
+
+			w.pending.emplace(snapshot->character.character_id, snapshot);
+			w.order.push_back(snapshot->character.character_id);
+			_queue_depth.fetch_add(1, std::memory_order_relaxed);
+			lock.unlock();
+			w.cv.notify_one();
+			return true;
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(_sync_mtx);
+
+	try {
+		write(*sZone->get_db_connection(), *snapshot);
+		record_latency(*snapshot);
+	}
+	catch (mysqlx::Error &error) {
+		HLogSys(LOG_DATABASE, error) << "PersistenceManager::queue: failed to save character " << snapshot->character.character_id << ": " << error.what();
+		_failed.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	catch (std::exception &error) {
+		HLogSys(LOG_DATABASE, error) << "PersistenceManager::queue: failed to save character " << snapshot->character.character_id << ": " << error.what();
+		_failed.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	return true;
+}
+
+persistence_statistics PersistenceManager::get_statistics()
+{
+	persistence_statistics stats;
+
+	stats.queued = _queued.load(std::memory_order_relaxed);
+	stats.coalesced = _coalesced.load(std::memory_order_relaxed);
+	stats.written = _written.load(std::memory_order_relaxed);
+	stats.failed = _failed.load(std::memory_order_relaxed);
+	stats.batches = _batches.load(std::memory_order_relaxed);
+	stats.queue_depth = _queue_depth.load(std::memory_order_relaxed);
+	stats.average_latency_us = stats.written ? _total_latency_us.load(std::memory_order_relaxed) / stats.written : 0;
+	stats.maximum_latency_us = _maximum_latency_us.load(std::memory_order_relaxed);
+
+	return stats;
+}
+
+std::shared_ptr<mysqlx::Session> PersistenceManager::connect()
+{
+	std::shared_ptr<mysqlx::Session> connection = std::make_shared<mysqlx::Session>(sZone->general_conf().get_db_host(), sZone->general_conf().get_db_port(),
+		sZone->general_conf().get_db_user(), sZone->general_conf().get_db_pass());
+
+	connection->sql(std::string("USE ").append(sZone->general_conf().get_db_database())).execute();
+
+	return connection;
+}
+
+/**
+ * @brief Worker loop, writes pending snapshots in batches until the manager stops and its queue is empty.
+ * @thread Persistence worker.
+ */
+void PersistenceManager::run(worker &w)
+{
+	std::vector<std::shared_ptr<player_save_snapshot>> batch;
+
+	while (true) {
+		std::unique_lock<std::mutex> lock(w.mtx);
+
+		w.cv.wait(lock, [this, &w] () { return !w.order.empty() || !_running.load(); });
+
+		if (w.order.empty())
+			break;
+
+		while (!w.order.empty() && (int) batch.size() < _batch_size) {
+			int32_t character_id = w.order.front();
+			auto it = w.pending.find(character_id);
+
+			w.order.pop_front();
+			batch.push_back(it->second);
+			w.pending.erase(it);
+		}
+
+		_queue_depth.fetch_sub(batch.size(), std::memory_order_relaxed);
+		lock.unlock();
+
+		write_batch(w, batch);
+		batch.clear();
+	}
+}
+
+/**
+ * @brief Writes a batch in a single transaction. If the transaction fails, each snapshot is retried on its
+ * own over a fresh connection so that one bad row doesn't lose the rest of the batch.
+ * @thread Persistence worker.
+ */
+void PersistenceManager::write_batch(worker &w, std::vector<std::shared_ptr<player_save_snapshot>> &batch)
+{
+	try {
+		w.connection->startTransaction();
+
+		for (auto &snapshot : batch)
+			write(*w.connection, *snapshot);
+
+		w.connection->commit();
+		_batches.fetch_add(1, std::memory_order_relaxed);
+
+		for (auto &snapshot : batch)
+			record_latency(*snapshot);
+
+		return;
+	}
+	catch (mysqlx::Error &error) {
+		HLogSys(LOG_DATABASE, warning) << "PersistenceManager::write_batch: " << error.what() << ", retrying " << batch.size() << " snapshot(s) individually.";
+	}
+	catch (std::exception &error) {
+		HLogSys(LOG_DATABASE, warning) << "PersistenceManager::write_batch: " << error.what() << ", retrying " << batch.size() << " snapshot(s) individually.";
+	}
+
+	try {
+		w.connection->rollback();
+	}
+	catch (std::exception &) {
+	}
+
+	for (auto &snapshot : batch) {
+		try {
+			try {
+				w.connection->startTransaction();
+				write(*w.connection, *snapshot);
+				w.connection->commit();
+			}
+			catch (mysqlx::Error &) {
+				// The connection may have been lost, reconnect and try once more.
+				w.connection = connect();
+				w.connection->startTransaction();
+				write(*w.connection, *snapshot);
+				w.connection->commit();
+			}
+
+			_batches.fetch_add(1, std::memory_order_relaxed);
+			record_latency(*snapshot);
+		}
+		catch (std::exception &error) {
+			HLogSys(LOG_DATABASE, error) << "PersistenceManager::write_batch: failed to save character " << snapshot->character.character_id << ": " << error.what();
+			_failed.fetch_add(1, std::memory_order_relaxed);
+
+			try {
+				w.connection->rollback();
+			}
+			catch (std::exception &) {
+			}
+		}
+	}
+}
+
+void PersistenceManager::write(mysqlx::Session &connection, player_save_snapshot const &snapshot)
+{
+	character_save_data const &c = snapshot.character;
+	status_save_data const &s = snapshot.status;
+
+	connection.sql("UPDATE `characters` SET `account_id` = ?, `slot` = ?, `name` = ?, `online` = ?, `gender` = ?, `unban_time` = ?, `rename_count` = ?,"
+		"`last_unique_id` = ?, `hotkey_row_index` = ?, `change_slot_count` = ?, `font` = ?, `show_equip` = ?, `allow_party` = ?, `partner_aid` = ?, `father_aid` = ?, `mother_aid` = ?,"
+		"`child_aid` = ?, `party_id` = ?, `guild_id` = ?, `pet_id` = ?, `homun_id` = ?, `elemental_id` = ?, `current_map` = ?, `current_x` = ?, `current_y` = ?,"
+		"`saved_map` = ?, `saved_x` = ?, `saved_y` = ? "
+		"WHERE `id` = ?")
+		.bind(c.account_id, c.slot, c.name, c.online, c.gender, c.unban_time, c.rename_count,
+			c.last_unique_id, c.hotkey_row_index, c.change_slot_count, c.font, c.show_equip, c.allow_party,
+			c.partner_aid, c.father_aid, c.mother_aid, c.child_aid, c.party_id, c.guild_id, c.pet_id,
+			c.homun_id, c.elemental_id, c.current_map, c.current_x, c.current_y, c.saved_map, c.saved_x, c.saved_y,
+			c.character_id)
+		.execute();
+
+	connection.sql("UPDATE `character_status` SET `job_id` = ?, `base_level` = ?, `job_level` = ?, `base_experience` = ?, `job_experience` = ?, "
+		"`zeny` = ?, `strength` = ?, `agility` = ?, `vitality` = ?, `intelligence` = ?, `dexterity` = ?, `luck` = ?, `maximum_hp` = ?, `hp` = ?, `maximum_sp` = ?, `sp` = ?, "
+		"`status_points` = ?, `skill_points` = ?, `body_state` = ?, `virtue` = ?, `honor` = ?, `manner` = ?, `hair_style_id` = ?, `hair_color_id` = ?, `cloth_color_id` = ?, `body_id` = ?, "
+		"`weapon_view_id` = ?, `shield_view_id` = ?, `head_top_view_id` = ?, `head_mid_view_id` = ?, `head_bottom_view_id` = ?, `robe_view_id` = ? "
+		"WHERE id = ?")
+		.bind(s.job_id, s.base_level, s.job_level, s.base_experience, s.job_experience, s.zeny,
+			s.strength, s.agility, s.vitality, s.intelligence, s.dexterity, s.luck,
+			s.maximum_hp, s.hp, s.maximum_sp, s.sp, s.status_points, s.skill_points, 0, s.virtue, s.honor, s.manner,
+			s.hair_style_id, s.hair_color_id, s.cloth_color_id, s.body_id, s.weapon_view_id, s.shield_view_id,
+			s.head_top_view_id, s.head_mid_view_id, s.head_bottom_view_id, s.robe_view_id,
+			c.character_id)
+		.execute();
+
+	connection.sql("DELETE FROM `character_inventory` WHERE `char_id` = ?")
+		.bind(c.character_id)
+		.execute();
+
+	if (snapshot.inventory.empty())
+		return;
+
+	mysqlx::Schema schema = connection.getSchema(sZone->general_conf().get_db_database());
+	mysqlx::Table table = schema.getTable("character_inventory");
+	mysqlx::TableInsert ti = table.insert("char_id", "item_id", "amount", "equip_location_mask",
+		"is_identified", "refine_level", "element_type", "slot_item_id_0", "slot_item_id_1", "slot_item_id_2", "slot_item_id_3", "opt_idx0", "opt_val0",
+		"opt_idx1", "opt_val1", "opt_idx2", "opt_val2", "opt_idx3", "opt_val3", "opt_idx4", "opt_val4", "hire_expire_date", "is_favorite", "is_broken", "bind_type", "unique_id");
+
+	for (inventory_item_save_data const &i : snapshot.inventory) {
+		ti.values(c.character_id, i.item_id, i.amount, i.equip_location_mask, i.is_identified, i.refine_level, i.element_type,
+			i.slot_item_id[0], i.slot_item_id[1], i.slot_item_id[2], i.slot_item_id[3],
+			i.option_index[0], i.option_value[0], i.option_index[1], i.option_value[1], i.option_index[2], i.option_value[2],
+			i.option_index[3], i.option_value[3], i.option_index[4], i.option_value[4],
+			i.hire_expire_date, i.is_favorite, i.is_broken, i.bind_type, i.unique_id);
+	}
+
+	ti.execute();
+}
+
+void PersistenceManager::record_latency(player_save_snapshot const &snapshot)
+{
+	uint64_t latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - snapshot.queued_at).count();
+	uint64_t maximum = _maximum_latency_us.load(std::memory_order_relaxed);
+
+	while (latency > maximum && !_maximum_latency_us.compare_exchange_weak(maximum, latency, std::memory_order_relaxed));
+
+	_total_latency_us.fetch_add(latency, std::memory_order_relaxed);
+	_written.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,210 @@
+/***************************************************
+ *       _   _            _                        *
+ *      | | | |          (_)                       *
+ *      | |_| | ___  _ __ _ _______  _ __          *
+ *      |  _  |/ _ \| '__| |_  / _ \| '_  \        *
+ *      | | | | (_) | |  | |/ / (_) | | | |        *
+ *      \_| |_/\___/|_|  |_/___\___/|_| |_|        *
+ ***************************************************
+ * This file is part of Horizon (c).
+ *
+ * Copyright (c) 2019 Sagun K. (sagunxp@gmail.com).
+ * Copyright (c) 2019 Horizon Dev Team.
+ *
+ * Base Author - Sagun K. (sagunxp@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ **************************************************/
+
+#ifndef HORIZON_ZONE_PERSISTENCE_PERSISTENCEMANAGER_HPP
+#define HORIZON_ZONE_PERSISTENCE_PERSISTENCEMANAGER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Horizon
+{
+namespace Zone
+{
+/**
+ * @brief Row of the `characters` table as captured by Player::save().
+ * Also read by the login pipeline and applied by Player::load().
+ */
+struct character_save_data
+{
+	int32_t character_id{0};
+	int32_t account_id{0};
+	int16_t slot{0};
+	std::string name{""};
+	int8_t online{0};
+	std::string gender{"F"};
+	int32_t unban_time{0};
+	int32_t rename_count{0};
+	int64_t last_unique_id{0};
+	int16_t hotkey_row_index{0};
+	int32_t change_slot_count{0};
+	int8_t font{0};
+	int8_t show_equip{0};
+	int8_t allow_party{0};
+	int32_t partner_aid{0}, father_aid{0}, mother_aid{0}, child_aid{0};
+	int32_t party_id{0}, guild_id{0};
+	int32_t pet_id{0}, homun_id{0}, elemental_id{0};
+	std::string current_map{""};
+	int16_t current_x{0}, current_y{0};
+	std::string saved_map{""};
+	int32_t saved_x{0}, saved_y{0};
+};
+
+/**
+ * @brief Row of the `character_status` table as captured by Status::snapshot().
+ * Also read by the login pipeline and applied by Status::load().
+ */
+struct status_save_data
+{
+	int32_t job_id{0};
+	int32_t base_level{0}, job_level{0};
+	int32_t base_experience{0}, job_experience{0};
+	int32_t zeny{0};
+	int32_t strength{0}, agility{0}, vitality{0}, intelligence{0}, dexterity{0}, luck{0};
+	int32_t maximum_hp{0}, hp{0}, maximum_sp{0}, sp{0};
+	int32_t status_points{0}, skill_points{0};
+	int32_t virtue{0}, honor{0}, manner{0};
+	uint32_t hair_style_id{0}, hair_color_id{0}, cloth_color_id{0}, body_id{0};
+	uint32_t weapon_view_id{0}, shield_view_id{0};
+	uint32_t head_top_view_id{0}, head_mid_view_id{0}, head_bottom_view_id{0}, robe_view_id{0};
+};
+
+/**
+ * @brief Row of the `character_inventory` table as captured by Inventory::snapshot().
+ * Also read by the login pipeline and applied by Inventory::load().
+ */
+struct inventory_item_save_data
+{
+	int32_t item_id{0};
+	int32_t amount{0};
+	int32_t equip_location_mask{0};
+	int32_t is_identified{0};
+	int32_t refine_level{0};
+	int32_t element_type{0};
+	int32_t slot_item_id[4]{0};
+	int32_t option_index[5]{0};
+	int32_t option_value[5]{0};
+	int32_t hire_expire_date{0};
+	int32_t is_favorite{0};
+	int32_t is_broken{0};
+	int32_t bind_type{0};
+	int64_t unique_id{0};
+};
+
+/**
+ * @brief Copy of everything Player::save() persists, taken on the thread that owns the player
+ * so that the database workers never touch live game state.
+ */
+struct player_save_snapshot
+{
+	character_save_data character;
+	status_save_data status;
+	std::vector<inventory_item_save_data> inventory;
+	std::chrono::steady_clock::time_point queued_at;
+};
+
+struct persistence_statistics
+{
+	uint64_t queued{0};            ///< Snapshots handed to the manager.
+	uint64_t coalesced{0};         ///< Snapshots that replaced a still pending one of the same character.
+	uint64_t written{0};           ///< Snapshots committed to the database.
+	uint64_t failed{0};            ///< Snapshots that could not be written.
+	uint64_t batches{0};           ///< Transactions committed.
+	uint64_t queue_depth{0};       ///< Characters currently waiting to be written.
+	uint64_t average_latency_us{0};///< Mean time from queueing to commit.
+	uint64_t maximum_latency_us{0};///< Worst time from queueing to commit.
+};
+
+/**
+ * @brief Write-behind persistence of player data.
+ * Game threads queue snapshots which are written by a small pool of database workers, each with
+ * its own connection. A character is always handled by the same worker so its saves are written
+ * in order, and saves queued while an earlier one is still pending replace it.
+ * Pending snapshots are flushed by finalize().
+ */
+class PersistenceManager
+{
+	struct worker
+	{
+		std::thread thread;
+		std::shared_ptr<mysqlx::Session> connection;
+		std::mutex mtx;
+		std::condition_variable cv;
+		std::deque<int32_t> order;
+		std::unordered_map<int32_t, std::shared_ptr<player_save_snapshot>> pending;
+	};
+
+public:
+	static PersistenceManager *getInstance()
+	{
+		static PersistenceManager persistence_mgr;
+		return &persistence_mgr;
+	}
+
+	/**
+	 * @brief Opens a connection per worker and starts them. With no workers, or if connecting
+	 * fails, saves are written synchronously on the server's shared connection.
+	 * @thread Main thread.
+	 */
+	bool initialize(int threads, int batch_size);
+	/**
+	 * @brief Writes every pending snapshot and stops the workers. Saves queued afterwards are
+	 * written synchronously.
+	 * @thread Main thread.
+	 */
+	void finalize();
+
+	/**
+	 * @brief Queues a snapshot for writing, replacing a pending one of the same character.
+	 * @thread Any.
+	 */
+	bool queue(std::shared_ptr<player_save_snapshot> snapshot);
+
+	persistence_statistics get_statistics();
+
+private:
+	std::shared_ptr<mysqlx::Session> connect();
+	void run(worker &w);
+	void write_batch(worker &w, std::vector<std::shared_ptr<player_save_snapshot>> &batch);
+	void write(mysqlx::Session &connection, player_save_snapshot const &snapshot);
+	void record_latency(player_save_snapshot const &snapshot);
+
+	std::vector<std::unique_ptr<worker>> _workers;
+	std::atomic<bool> _running{false};
+	std::mutex _sync_mtx;
+	int _batch_size{1};
+
+	std::atomic<uint64_t> _queued{0}, _coalesced{0}, _written{0}, _failed{0}, _batches{0};
+	std::atomic<uint64_t> _queue_depth{0};
+	std::atomic<uint64_t> _total_latency_us{0}, _maximum_latency_us{0};
+};
+}
+}
+
+#define PersistenceMgr Horizon::Zone::PersistenceManager::getInstance()
+
+#endif /* HORIZON_ZONE_PERSISTENCE_PERSISTENCEMANAGER_HPP */
@@ -54,7 +54,6 @@ ZoneSession::~ZoneSession()
 void ZoneSession::initialize()
 {
 	try {
-		_pkt_tbl = std::make_unique<ClientPacketLengthTable>(shared_from_this());
 		_clif = std::make_unique<ZoneClientInterface>(shared_from_this());
 	}
 	catch (std::exception& error) {
@@ -68,21 +67,11 @@ void ZoneSession::transmit_buffer(ByteBuffer _buffer, std::size_t size)
 		return;
 	
 	if (!_buffer.is_empty()) {
-		uint16_t packet_id = 0x0;
-		int16_t packet_len = 0;
-		
-		memcpy(&packet_id, _buffer.get_read_pointer(), sizeof(int16_t));
-		
-		TPacketTablePairType p = _pkt_tbl->get_tpacket_info(packet_id);
-
-		if (p.first == -1) {
-			memcpy(&packet_len, _buffer.get_read_pointer() + 2, sizeof(int16_t));
-		} else {
-			packet_len = p.first;
-		}
+		if (!is_valid_packet(_buffer.get_read_pointer(), _buffer.active_length()))
+			return;
 
-		if (packet_len != _buffer.active_length()) {
-			HLog(warning) << "Packet 0x" << std::hex << packet_id << " has length " << std::dec << packet_len << " but buffer has " << _buffer.active_length() << " bytes... ignoring.";
+		if (_batch_thread.load(std::memory_order_relaxed) == std::this_thread::get_id()) {
+			_batch_buffer.append(_buffer.get_read_pointer(), _buffer.active_length());
 			return;
 		}
 
@@ -90,38 +79,140 @@ void ZoneSession::transmit_buffer(ByteBuffer _buffer, std::size_t size)
 	}
 }
 
+void ZoneSession::transmit_broadcast(BroadcastBuffer const &buf)
+{
+	if (get_socket() == nullptr || !get_socket()->is_open() || buf.length() == 0)
+		return;
+
+	if (_batch_thread.load(std::memory_order_relaxed) == std::this_thread::get_id()) {
+		_batch_buffer.append(buf.data(), buf.length());
+		return;
+	}
+
+	get_socket()->queue_buffer(buf.view());
+}
+
+void ZoneSession::begin_transmit_batch()
+{
+	if (_batch_depth++ == 0)
+		_batch_thread.store(std::this_thread::get_id(), std::memory_order_relaxed);
+}
+
+void ZoneSession::end_transmit_batch()
+{
+	if (_batch_depth == 0 || --_batch_depth > 0)
+		return;
+
+	_batch_thread.store(std::thread::id(), std::memory_order_relaxed);
+
+	if (_batch_buffer.active_length() == 0)
+		return;
+
+	ByteBuffer batch(std::move(_batch_buffer));
+	_batch_buffer = ByteBuffer();
+
+	if (get_socket() != nullptr && get_socket()->is_open())
+		get_socket()->queue_buffer(std::move(batch));
+}
+
+bool ZoneSession::is_valid_packet(uint8_t const *packet, std::size_t length)
+{
+	uint16_t packet_id = 0x0;
+	int16_t packet_len = 0;
+
+	if (length < sizeof(int16_t))
+		return false;
+
+	memcpy(&packet_id, packet, sizeof(int16_t));
+
+	int16_t table_len = ClientPacketLengthTable::get_instance().get_tpacket_length(packet_id);
+
+	if (table_len == -1) {
+		if (length < 2 * sizeof(int16_t))
+			return false;
+
+		memcpy(&packet_len, packet + 2, sizeof(int16_t));
+	} else {
+		packet_len = table_len;
+	}
+
+	if (packet_len != (int64_t) length) {
+		HLog(warning) << "Packet 0x" << std::hex << packet_id << " has length " << std::dec << packet_len << " but buffer has " << length << " bytes... ignoring.";
+		return false;
+	}
+
+	return true;
+}
+
 /**
  * @brief Update loop for each Zone Session.
  * @thread called from MapContainerThread.
  */
-void ZoneSession::update(uint32_t /*diff*/)
+void ZoneSession::update(uint64_t /*tick*/)
 {
-	std::shared_ptr<ByteBuffer> read_buf;
-	while ((read_buf = get_socket()->_buffer_recv_queue.try_pop())) {
+	ByteBuffer read_buf;
+	uint32_t handled = 0;
+
+	// Sessions being handed to a map container are consumed by that container once it takes them over.
+	if (_login_pending.load())
+		return;
+
+	while ((_packet_budget == 0 || handled++ < _packet_budget) && get_socket()->_buffer_recv_queue.try_pop(read_buf)) {
 		uint16_t packet_id = 0x0;
-		memcpy(&packet_id, read_buf->get_read_pointer(), sizeof(int16_t));
-		HPacketTablePairType p = _pkt_tbl->get_hpacket_info(packet_id);
+		memcpy(&packet_id, read_buf.get_read_pointer(), sizeof(int16_t));
+		HPacketStructPtrType handler = get_packet_handler(packet_id);
 		
-		HLog(debug) << "Handling packet 0x" << std::hex << packet_id << " - len:" << p.first << std::endl;
+		HLogSys(LOG_NETWORK, debug) << "Handling packet 0x" << std::hex << packet_id << std::endl;
 		
-		p.second->handle(std::move(*read_buf));
+		if (handler == nullptr) {
+			HLog(warning) << "Received packet 0x" << std::hex << packet_id << " without a handler, ignoring...";
+			continue;
+		}
+
+		handler->handle(std::move(read_buf));
+
+		// CZ_ENTER hands the session over, the receive queue must not be popped by this thread past that point
+		// as the receiving map container becomes its only consumer.
+		if (_login_pending.load())
+			break;
 	}
 }
 
+/**
+ * @brief Retrieves the handler for a packet, instantiating it on first receipt.
+ * @thread called from MapContainerThread.
+ */
+HPacketStructPtrType ZoneSession::get_packet_handler(uint16_t packet_id)
+{
+	auto it = _packet_handlers.find(packet_id);
+
+	if (it != _packet_handlers.end())
+		return it->second;
+
+	HPacketStructPtrType handler = ClientPacketLengthTable::get_instance().create_handler(packet_id, shared_from_this());
+
+	if (handler != nullptr)
+		_packet_handlers.emplace(packet_id, handler);
+
+	return handler;
+}
+
 /**
  * @brief Performs generic logout of player in cases where the
  * connection was closed abruptly or by instruction.
- * Also marks the player for removal from the MapContainerThread.
+ * Also marks the player for removal from the MapContainerThread, which saves it.
  * @thread Called from the NetworkThread.
  */
 void ZoneSession::perform_cleanup()
 {
-	if (player() != nullptr) {
+	std::shared_ptr<Entities::Player> pl = player();
+
+	if (pl != nullptr) {
 
-		player()->set_logged_in(false);
-		player()->notify_nearby_players_of_existence(EVP_NOTIFY_LOGGED_OUT);
-		player()->remove_grid_reference();
-		player()->save();
-		player()->map_container()->remove_player(player());
+		pl->set_logged_in(false);
+		pl->notify_nearby_players_of_existence(EVP_NOTIFY_LOGGED_OUT);
+		pl->remove_grid_reference();
+		// Saved by the map container once it processes the removal.
+		pl->map_container()->remove_player(pl);
 	}
 }
@@ -30,11 +30,17 @@
 #define HORIZON_ZONE_SESSION_ZONESESSION_HPP
 
 #include "Libraries/Networking/Session.hpp"
+#include "Libraries/Networking/Buffer/BroadcastBuffer.hpp"
 #include "Server/Common/Configuration/Horizon.hpp"
 #include "Server/Common/Configuration/ServerConfiguration.hpp"
 #include "Server/Zone/Interface/ZoneClientInterface.hpp"
 #include "Server/Zone/Game/Entities/Player/Player.hpp"
 
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
 #if CLIENT_TYPE == 'R'
 #include "Server/Zone/Packets/RE/ClientPacketLengthTable.hpp"
 #elif CLIENT_TYPE == 'M'
@@ -60,21 +66,88 @@ public:
 
 	void transmit_buffer(ByteBuffer _buffer, std::size_t size);
 
-	void update(uint32_t diff);
+	/**
+	 * @brief Queues a packet that is shared with other recipients, @see BroadcastBuffer.
+	 * The packet must have been checked with is_valid_packet() by the broadcaster, it is not checked again.
+	 * @thread MapContainerThread
+	 */
+	void transmit_broadcast(BroadcastBuffer const &buf);
+
+	/**
+	 * @brief Checks a serialized packet against the client's packet length table.
+	 */
+	static bool is_valid_packet(uint8_t const *packet, std::size_t length);
+
+	/**
+	 * @brief Packets the calling thread transmits to the session between begin and end are gathered
+	 * into one buffer and queued as a single send when the outermost batch ends.
+	 * Packets transmitted from other threads meanwhile are queued as usual.
+	 * @thread MapContainerThread
+	 */
+	void begin_transmit_batch();
+	void end_transmit_batch();
+
+	/**
+	 * @brief Scoped transmit batch, @see begin_transmit_batch().
+	 */
+	class TransmitBatch
+	{
+	public:
+		explicit TransmitBatch(std::shared_ptr<ZoneSession> session) : _session(session) { _session->begin_transmit_batch(); }
+		~TransmitBatch() { _session->end_transmit_batch(); }
+
+		TransmitBatch(TransmitBatch const &) = delete;
+		TransmitBatch &operator=(TransmitBatch const &) = delete;
+
+	private:
+		std::shared_ptr<ZoneSession> _session;
+	};
+
+	/**
+	 * @brief Handles the packets received since the last update.
+	 * @param[in] tick monotonic time of the current update in milliseconds.
+	 */
+	void update(uint64_t tick);
+
+	/**
+	 * @brief Limits the number of packets handled per update, 0 for no limit.
+	 * Packets over the limit are left queued for the following updates.
+	 * @thread MapContainerThread, to shed load when its ticks overrun.
+	 */
+	void set_packet_budget(uint32_t budget) { _packet_budget = budget; }
+
+	HPacketStructPtrType get_packet_handler(uint16_t packet_id);
 
 	void perform_cleanup();
 
 	void initialize();
 	
 	std::unique_ptr<ZoneClientInterface> &clif() { return _clif; }
-	std::unique_ptr<ClientPacketLengthTable> &pkt_tbl() { return _pkt_tbl; }
-	std::shared_ptr<Entities::Player> player() { return _player.expired() ? nullptr : _player.lock(); }
-	void set_player(std::shared_ptr<Entities::Player> pl) { _player = pl; }
+	/**
+	 * @brief Player of the session, published by the map container that receives it from the login workers.
+	 * @thread any, read by the network thread when the connection closes (@see perform_cleanup()).
+	 */
+	std::shared_ptr<Entities::Player> player() { std::lock_guard<std::mutex> lock(_player_mtx); return _player.lock(); }
+	void set_player(std::shared_ptr<Entities::Player> pl) { std::lock_guard<std::mutex> lock(_player_mtx); _player = pl; }
+
+	/**
+	 * @brief Set while the login workers load the session's character, packets are left queued
+	 * until the map container that receives the player takes the session over.
+	 * @thread Main thread, login workers and the map container receiving the player.
+	 */
+	bool is_login_pending() { return _login_pending.load(); }
+	void set_login_pending(bool pending) { _login_pending.exchange(pending); }
 
 protected:
 	std::unique_ptr<ZoneClientInterface> _clif;
-	std::unique_ptr<ClientPacketLengthTable> _pkt_tbl;
+	std::unordered_map<uint16_t, HPacketStructPtrType> _packet_handlers; ///< Handlers instantiated on first receipt of their packet.
+	std::mutex _player_mtx;                                              ///< Guards _player.
 	std::weak_ptr<Entities::Player> _player;
+	uint32_t _packet_budget{0};
+	std::atomic<bool> _login_pending{false};
+	ByteBuffer _batch_buffer;                                            ///< Packets of the open transmit batch.
+	uint32_t _batch_depth{0};
+	std::atomic<std::thread::id> _batch_thread{std::thread::id()};       ///< Thread that opened the batch, none while closed.
 };
 }
 }
@@ -31,6 +31,10 @@
 
 #include "Server/Zone/SocketMgr/ClientSocketMgr.hpp"
 #include "Server/Zone/Game/Map/MapManager.hpp"
+#include "Server/Zone/Game/Map/MapContainerThread.hpp"
+#include "Server/Zone/LUA/LUAManager.hpp"
+#include "Server/Zone/Persistence/LoginManager.hpp"
+#include "Server/Zone/Persistence/PersistenceManager.hpp"
 #include "Server/Zone/Game/StaticDB/ExpDB.hpp"
 #include "Server/Zone/Game/StaticDB/JobDB.hpp"
 #include "Server/Zone/Game/StaticDB/ItemDB.hpp"
@@ -83,18 +87,62 @@ bool ZoneServer::read_config()
 	config().set_static_db_path(tbl.get_or("static_db_path", std::string("db/")));
 	HLog(info) << "Static database path set to " << config().get_static_db_path() << "";
 
+	config().set_static_db_snapshot_path(tbl.get_or("static_db_snapshot_path", std::string("db/snapshots/")));
+
+	if (config().get_static_db_snapshot_path().empty())
+		HLog(info) << "Static database snapshots are disabled, databases will be read from Lua on every start.";
+	else
+		HLog(info) << "Static database snapshots will be read from and compiled into " << config().get_static_db_snapshot_path() << ".";
+
 	config().set_mapcache_path(tbl.get_or("map_cache_file_path", std::string("db/maps.dat")));
 	HLog(info) << "Mapcache file name is set to " << config().get_mapcache_path() << ", it will be read while initializing maps.";
 
 //	config().set_entity_save_interval(tbl.get_or("entity_save_interval", 180000));
 //	HLog(info) << "Entity data will be saved to the database every " << duration_cast<minutes>(std::chrono::milliseconds(config().get_entity_save_interval())).count() << " minutes and " << duration_cast<seconds>(std::chrono::milliseconds(config().get_entity_save_interval())).count() << " seconds.";
 	
-	HLog(info) << "Maps will be managed by '" << MAX_MAP_CONTAINER_THREADS << "' thread containers.";
+	// Thread counts default to one per hardware thread when unset or 0.
+	int hardware_threads = std::max<int>(1, std::thread::hardware_concurrency());
+	int network_threads = tbl.get_or("network_threads", DEFAULT_ZONE_NETWORK_THREADS);
+	int map_container_threads = tbl.get_or("map_container_threads", DEFAULT_MAP_CONTAINER_THREADS);
+
+	config().set_network_threads(network_threads > 0 ? network_threads : hardware_threads);
+	config().set_map_container_threads(map_container_threads > 0 ? map_container_threads : hardware_threads);
+
+	HLog(info) << "Network I/O will be handled by '" << config().network_threads() << "' thread(s).";
+	HLog(info) << "Maps will be managed by '" << config().map_container_threads() << "' thread containers.";
+
+	config().set_map_container_tick_rate(std::min(1000, std::max(1, tbl.get_or("map_container_tick_rate", DEFAULT_MAP_CONTAINER_TICK_RATE))));
+
+	HLog(info) << "Map containers will tick '" << config().map_container_tick_rate() << "' times per second.";
+
+	config().set_map_rebalance_interval(tbl.get_or("map_rebalance_interval", DEFAULT_MAP_REBALANCE_INTERVAL));
+
+	if (config().map_rebalance_interval() > 0)
+		HLog(info) << "Map containers will be rebalanced every '" << config().map_rebalance_interval() << "' seconds.";
 
 	config().set_session_max_timeout(tbl.get_or("session_max_timeout", 60));
 
 	HLog(info) << "Session maximum timeout set to '" << config().session_max_timeout() << "'.";
 
+	config().set_path_search_step_limit(tbl.get_or("path_search_step_limit", DEFAULT_PATH_SEARCH_STEP_LIMIT));
+
+	HLog(info) << "Path searches will expand at most '" << config().path_search_step_limit() << "' cells (0 for no limit).";
+
+	config().set_script_reload_check_interval(tbl.get_or("script_reload_check_interval", 0));
+
+	if (config().script_reload_check_interval() > 0)
+		HLog(info) << "Cached scripts will be checked for changes every '" << config().script_reload_check_interval() << "' seconds.";
+
+	config().set_persistence_threads(tbl.get_or("persistence_threads", DEFAULT_PERSISTENCE_THREADS));
+	config().set_persistence_batch_size(tbl.get_or("persistence_batch_size", DEFAULT_PERSISTENCE_BATCH_SIZE));
+
+	HLog(info) << "Player data will be saved by '" << config().persistence_threads() << "' database worker(s) in batches of up to '" << config().persistence_batch_size() << "'.";
+
+	config().set_login_threads(tbl.get_or("login_threads", DEFAULT_LOGIN_THREADS));
+	config().set_max_concurrent_logins(tbl.get_or("max_concurrent_logins", DEFAULT_MAX_CONCURRENT_LOGINS));
+
+	HLog(info) << "Characters entering the zone will be loaded by '" << config().login_threads() << "' database worker(s), at most '" << config().max_concurrent_logins() << "' at a time (0 for no limit).";
+
 	/**
 	 * Process Configuration that is common between servers.
 	 */
@@ -108,18 +156,12 @@ bool ZoneServer::read_config()
 
 void ZoneServer::verify_connected_sessions()
 {	
-	sZone->get_db_connection()->sql("DELETE FROM `session_data` WHERE `current_server` = ? AND `last_update` < ?")
-		.bind("Z", std::time(nullptr) - config().session_max_timeout())
-		.execute();
-
-	mysqlx::RowResult rr = sZone->get_db_connection()->sql("SELECT COUNT(`game_account_id`) FROM `session_data` WHERE `current_server` = ?")
-		.bind("Z")
-		.execute();
-	mysqlx::Row r = rr.fetchOne();
+	uint32_t expired = session_store().expire('Z', config().session_max_timeout());
 
-	int32_t count = r[0].get<int>();
+	if (expired > 0)
+		HLog(info) << expired << " session(s) timed out.";
 
-	HLog(info) << count << " connected session(s).";
+	HLog(info) << session_store().count('Z') << " connected session(s).";
 }
 
 void ZoneServer::update(uint64_t time)
@@ -135,6 +177,9 @@ void ZoneServer::update(uint64_t time)
 	 * Process Packets.
 	 */
 	ClientSocktMgr->update_socket_sessions(time);
+
+	// Logins queued by the sessions above are loaded by the login workers.
+	LoginMgr->dispatch();
 	
 	if (get_shutdown_stage() == SHUTDOWN_NOT_STARTED && !general_conf().is_test_run()) {
 		_update_timer.expires_from_now(boost::posix_time::microseconds(MAX_CORE_UPDATE_INTERVAL));
@@ -169,6 +214,10 @@ void ZoneServer::initialize_core()
 #endif
 	signal(SIGTERM, SignalHandler);
 
+	_worker_pool = std::make_unique<WorkerThreadPool>();
+
+	HLog(info) << "Background jobs will be run by " << _worker_pool->size() << " worker thread(s).";
+
 	/**
 	 * Static Databases
 	 */
@@ -183,6 +232,12 @@ void ZoneServer::initialize_core()
 	SkillDB->load();
 	MonsterDB->load();
 
+	/**
+	 * Persistence.
+	 */
+	PersistenceMgr->initialize(config().persistence_threads(), config().persistence_batch_size());
+	LoginMgr->initialize(config().login_threads(), config().max_concurrent_logins());
+
 	/**
 	 * Map Manager.
 	 */
@@ -192,7 +247,7 @@ void ZoneServer::initialize_core()
 	ClientSocktMgr->start(get_io_service(),
 						  general_conf().get_listen_ip(),
 						  general_conf().get_listen_port(),
-						  MAX_NETWORK_THREADS);
+						  config().network_threads());
 
 	Server::initialize_core();
 
@@ -200,6 +255,13 @@ void ZoneServer::initialize_core()
 		verify_connected_sessions();
 		context.Repeat();
 	});
+
+	if (config().map_rebalance_interval() > 0) {
+		_task_scheduler.Schedule(Seconds(config().map_rebalance_interval()), [] (TaskContext context) {
+			MapMgr->rebalance_map_containers();
+			context.Repeat();
+		});
+	}
 	
 	_update_timer.expires_from_now(boost::posix_time::microseconds(MAX_CORE_UPDATE_INTERVAL));
 	_update_timer.async_wait(std::bind(&ZoneServer::update, this, MAX_CORE_UPDATE_INTERVAL));
@@ -208,6 +270,9 @@ void ZoneServer::initialize_core()
 
 	HLog(info) << "Server shutdown initiated ...";
 	
+	// Logins still loading finish handing their players over before the containers stop.
+	LoginMgr->finalize();
+
 	MapMgr->finalize();
 
 	/**
@@ -216,6 +281,12 @@ void ZoneServer::initialize_core()
 	_task_scheduler.CancelAll();
 
 	ClientSocktMgr->stop_network();
+
+	// Flush player saves queued during shutdown.
+	PersistenceMgr->finalize();
+
+	// Runs whatever background jobs are still queued.
+	_worker_pool.reset();
 	
 	Server::finalize_core();
 }
@@ -226,6 +297,150 @@ void ZoneServer::initialize_core()
 void ZoneServer::initialize_cli_commands()
 {
 	Server::initialize_cli_commands();
+
+	add_cli_command_func("reload-scripts", std::bind(&ZoneServer::clicmd_reload_scripts, this, std::placeholders::_1));
+	add_cli_command_func("script-cache-stats", std::bind(&ZoneServer::clicmd_script_cache_stats, this, std::placeholders::_1));
+	add_cli_command_func("persistence-stats", std::bind(&ZoneServer::clicmd_persistence_stats, this, std::placeholders::_1));
+	add_cli_command_func("login-stats", std::bind(&ZoneServer::clicmd_login_stats, this, std::placeholders::_1));
+	add_cli_command_func("worker-pool-stats", std::bind(&ZoneServer::clicmd_worker_pool_stats, this, std::placeholders::_1));
+	add_cli_command_func("map-containers", std::bind(&ZoneServer::clicmd_map_containers, this, std::placeholders::_1));
+	add_cli_command_func("migrate-map", std::bind(&ZoneServer::clicmd_migrate_map, this, std::placeholders::_1));
+}
+
+bool ZoneServer::clicmd_reload_scripts(std::string /*cmd*/)
+{
+	LUAManager::reload_scripts();
+
+	HLog(info) << "Cached scripts will be recompiled on their next use.";
+
+	return true;
+}
+
+bool ZoneServer::clicmd_script_cache_stats(std::string /*cmd*/)
+{
+	std::map<int32_t, std::shared_ptr<MapContainerThread>> containers = MapMgr->get_map_containers();
+
+	for (auto &c : containers) {
+		lua_script_cache_statistics stats = c.second->get_lua_manager()->get_script_cache_statistics();
+
+		HLog(info) << "Script cache of map container " << (void *) c.second.get() << " - hits: " << stats.hits
+			<< ", misses: " << stats.misses << ", reloads: " << stats.reloads << ".";
+	}
+
+	return true;
+}
+
+bool ZoneServer::clicmd_persistence_stats(std::string /*cmd*/)
+{
+	persistence_statistics stats = PersistenceMgr->get_statistics();
+
+	HLog(info) << "Persistence - queued: " << stats.queued << ", coalesced: " << stats.coalesced << ", written: " << stats.written
+		<< ", failed: " << stats.failed << ", transactions: " << stats.batches << ", queue depth: " << stats.queue_depth
+		<< ", latency (avg/max): " << stats.average_latency_us << "/" << stats.maximum_latency_us << " us.";
+
+	return true;
+}
+
+bool ZoneServer::clicmd_login_stats(std::string cmd)
+{
+	std::vector<std::string> args;
+	boost::algorithm::split(args, cmd, boost::algorithm::is_any_of(" "), boost::algorithm::token_compress_on);
+
+	// 'login-stats reset' clears the stage histograms.
+	if (args.size() > 1 && args[1] == "reset") {
+		LoginMgr->reset_statistics();
+
+		HLog(info) << "Login stage statistics have been reset.";
+		return true;
+	}
+
+	login_statistics stats = LoginMgr->get_statistics();
+
+	HLog(info) << "Logins - requested: " << stats.requested << ", completed: " << stats.completed << ", refused: " << stats.refused
+		<< ", in flight: " << stats.in_flight << ", waiting: " << stats.waiting << ".";
+
+	for (int i = 0; i < LOGIN_STAGE_MAX; i++) {
+		HLog(info) << "  " << LoginManager::get_stage_name((login_stage_type) i) << " (p50/p99/max): "
+			<< stats.p50_us[i] << "/" << stats.p99_us[i] << "/" << stats.max_us[i] << " us.";
+	}
+
+	return true;
+}
+
+bool ZoneServer::clicmd_worker_pool_stats(std::string /*cmd*/)
+{
+	worker_thread_pool_statistics stats = get_worker_pool().get_statistics();
+
+	HLog(info) << "Worker pool (" << get_worker_pool().size() << " threads) - submitted: " << stats.submitted << ", executed: " << stats.executed
+		<< ", steals: " << stats.steals << ", parks: " << stats.parks << ", queue depth: " << stats.queue_depth << ".";
+
+	return true;
+}
+
+bool ZoneServer::clicmd_map_containers(std::string cmd)
+{
+	std::vector<std::string> args;
+	boost::algorithm::split(args, cmd, boost::algorithm::is_any_of(" "), boost::algorithm::token_compress_on);
+
+	std::map<int32_t, std::shared_ptr<MapContainerThread>> containers = MapMgr->get_map_containers();
+
+	// 'map-containers reset' clears the tick histograms and counters of every container.
+	if (args.size() > 1 && args[1] == "reset") {
+		for (auto &c : containers)
+			c.second->reset_statistics();
+
+		HLog(info) << "Map container tick statistics have been reset.";
+		return true;
+	}
+
+	// 'map-containers <index>' lists the maps of a single container with their weights.
+	if (args.size() > 1) {
+		int32_t idx = std::atoi(args[1].c_str());
+		auto it = containers.find(idx);
+
+		if (it == containers.end()) {
+			HLog(error) << "No map container with index '" << args[1] << "'.";
+			return false;
+		}
+
+		for (auto &m : it->second->get_managed_maps())
+			HLog(info) << "Map container " << idx << " - " << m.first << " (weight " << MapMgr->get_map_weight(m.first) << ").";
+
+		return true;
+	}
+
+	for (auto &c : containers) {
+		map_container_statistics stats = c.second->get_statistics();
+
+		HLog(info) << "Map container " << c.first << " - maps: " << stats.maps << ", load weight: " << stats.load_weight << ", players: " << stats.players
+			<< ", ticks: " << stats.ticks << ", tick time (us) last: " << stats.last_tick_us << ", average: " << stats.average_tick_us
+			<< ", p50: " << stats.p50_tick_us << ", p99: " << stats.p99_tick_us << ", max: " << stats.max_tick_us
+			<< " (average inbox: " << stats.average_inbox_us << ", sessions: " << stats.average_session_us << ", scheduler: " << stats.average_scheduler_us << ")"
+			<< ", budget: " << stats.tick_period_us << "us, overruns: " << stats.overruns << ", skipped ticks: " << stats.skipped_ticks
+			<< (stats.shedding_load ? ", shedding load." : ".");
+	}
+
+	return true;
+}
+
+bool ZoneServer::clicmd_migrate_map(std::string cmd)
+{
+	std::vector<std::string> args;
+	boost::algorithm::split(args, cmd, boost::algorithm::is_any_of(" "), boost::algorithm::token_compress_on);
+
+	if (args.size() < 3) {
+		HLog(error) << "Usage: migrate-map <map name> <map container index>";
+		return false;
+	}
+
+	if (!MapMgr->migrate_map(args[1], std::atoi(args[2].c_str()))) {
+		HLog(error) << "Map '" << args[1] << "' could not be migrated to map container '" << args[2] << "'.";
+		return false;
+	}
+
+	HLog(info) << "Map '" << args[1] << "' will be migrated to map container '" << args[2] << "' at the end of its current container's next update.";
+
+	return true;
 }
 
 /**
@@ -33,6 +33,7 @@
 #include "Server/pch.hpp"
 
 #include "Core/Logging/Logger.hpp"
+#include "Core/Multithreading/WorkerThreadPool.hpp"
 #include "Server/Common/Server.hpp"
 #include "Server/Zone/Socket/ZoneSocket.hpp"
 
@@ -61,13 +62,57 @@ struct s_zone_server_configuration
 	
 	boost::filesystem::path &get_static_db_path() { return _static_db_path; }
 	void set_static_db_path(boost::filesystem::path p) { _static_db_path = p; }
+
+	boost::filesystem::path &get_static_db_snapshot_path() { return _static_db_snapshot_path; }
+	void set_static_db_snapshot_path(boost::filesystem::path p) { _static_db_snapshot_path = p; }
 	
     std::time_t session_max_timeout() { return _session_max_timeout; }
     void set_session_max_timeout(std::time_t timeout) { _session_max_timeout = timeout; }
+
+	uint32_t path_search_step_limit() { return _path_search_step_limit; }
+	void set_path_search_step_limit(uint32_t limit) { _path_search_step_limit = limit; }
+
+	int network_threads() { return _network_threads; }
+	void set_network_threads(int threads) { _network_threads = threads; }
+
+	int map_container_threads() { return _map_container_threads; }
+	void set_map_container_threads(int threads) { _map_container_threads = threads; }
+
+	int map_container_tick_rate() { return _map_container_tick_rate; }
+	void set_map_container_tick_rate(int rate) { _map_container_tick_rate = rate; }
+
+	int map_rebalance_interval() { return _map_rebalance_interval; }
+	void set_map_rebalance_interval(int interval) { _map_rebalance_interval = interval; }
+
+	int persistence_threads() { return _persistence_threads; }
+	void set_persistence_threads(int threads) { _persistence_threads = threads; }
+
+	int persistence_batch_size() { return _persistence_batch_size; }
+	void set_persistence_batch_size(int size) { _persistence_batch_size = size; }
+
+	int login_threads() { return _login_threads; }
+	void set_login_threads(int threads) { _login_threads = threads; }
+
+	int max_concurrent_logins() { return _max_concurrent_logins; }
+	void set_max_concurrent_logins(int logins) { _max_concurrent_logins = logins; }
+
+	std::time_t script_reload_check_interval() { return _script_reload_check_interval; }
+	void set_script_reload_check_interval(std::time_t interval) { _script_reload_check_interval = interval; }
 	
 	boost::filesystem::path _static_db_path;
+	boost::filesystem::path _static_db_snapshot_path;
 	boost::filesystem::path _mapcache_path;
     std::time_t _session_max_timeout;
+	uint32_t _path_search_step_limit{DEFAULT_PATH_SEARCH_STEP_LIMIT};
+	std::time_t _script_reload_check_interval{0};
+	int _network_threads{1};
+	int _map_container_threads{1};
+	int _map_container_tick_rate{DEFAULT_MAP_CONTAINER_TICK_RATE};
+	int _map_rebalance_interval{DEFAULT_MAP_REBALANCE_INTERVAL};
+	int _persistence_threads{DEFAULT_PERSISTENCE_THREADS};
+	int _persistence_batch_size{DEFAULT_PERSISTENCE_BATCH_SIZE};
+	int _login_threads{DEFAULT_LOGIN_THREADS};
+	int _max_concurrent_logins{DEFAULT_MAX_CONCURRENT_LOGINS};
 };
 
 class ZoneServer : public Server
@@ -85,6 +130,13 @@ public:
 	bool read_config();
 	void initialize_core();
 	void initialize_cli_commands();
+	bool clicmd_reload_scripts(std::string cmd);
+	bool clicmd_script_cache_stats(std::string cmd);
+	bool clicmd_persistence_stats(std::string cmd);
+	bool clicmd_login_stats(std::string cmd);
+	bool clicmd_worker_pool_stats(std::string cmd);
+	bool clicmd_map_containers(std::string cmd);
+	bool clicmd_migrate_map(std::string cmd);
 	void verify_connected_sessions();
 	void update(uint64_t diff);
 
@@ -92,10 +144,17 @@ public:
 
 	TaskScheduler &getScheduler() { return _task_scheduler; }
 
+	/**
+	 * @brief Pool for background jobs (map loading, database batches...).
+	 * Exists between the start and the end of initialize_core().
+	 */
+	WorkerThreadPool &get_worker_pool() { return *_worker_pool; }
+
 private:
 	s_zone_server_configuration _zone_server_config;
 	TaskScheduler _task_scheduler;
 	boost::asio::deadline_timer _update_timer;
+	std::unique_ptr<WorkerThreadPool> _worker_pool;
 };
 }
 }
@@ -55,6 +55,7 @@
 
 #include "Logging/Logger.hpp"
 
+#include "Core/Multithreading/FrozenLookupTable.hpp"
 #include "Core/Multithreading/LockedLookupTable.hpp"
 #include "Core/Multithreading/ThreadSafeQueue.hpp"
 
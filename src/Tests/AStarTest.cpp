@@ -34,6 +34,8 @@
 #include <cstring>
 #include <fstream>
 #include <cstdint>
+#include <chrono>
+#include <random>
 
 #include "Server/Zone/Game/Map/Path/AStar.hpp"
 #include "Server/Zone/Game/Map/Grid/Cell/Cell.hpp"
@@ -150,3 +152,130 @@ BOOST_AUTO_TEST_CASE(AStarTest)
 
 	//BOOST_ASSERT(path->size() > 1);
 }
+
+#define PRONTERA_WIDTH 312
+#define PRONTERA_HEIGHT 392
+
+Cell prontera_cell[PRONTERA_WIDTH][PRONTERA_HEIGHT];
+
+bool check_prontera_collision(int16_t x, int16_t y)
+{
+	if (x < 0 || y < 0 ||
+		x >= PRONTERA_WIDTH || y >= PRONTERA_HEIGHT)
+		return true;
+
+	return prontera_cell[x][y].isWalkable() ? false : true;
+}
+
+BOOST_AUTO_TEST_CASE(AStarPronteraBenchmark)
+{
+	int idx = 0;
+
+	for (int y = PRONTERA_HEIGHT - 1; y >= 0; y--) {
+		for (int x = 0; x < PRONTERA_WIDTH; ++x) {
+			prontera_cell[x][y] = Cell(prontera[idx++]);
+		}
+	}
+
+	std::mt19937 rng(1);
+	std::vector<std::pair<MapCoords, MapCoords>> routes;
+
+	while (routes.size() < 1000) {
+		MapCoords start(rng() % PRONTERA_WIDTH, rng() % PRONTERA_HEIGHT), end(rng() % PRONTERA_WIDTH, rng() % PRONTERA_HEIGHT);
+
+		if (!check_prontera_collision(start.x(), start.y()) && !check_prontera_collision(end.x(), end.y()))
+			routes.push_back({ start, end });
+	}
+
+	for (uint32_t limit : { (uint32_t) DEFAULT_PATH_SEARCH_STEP_LIMIT, (uint32_t) 0 }) {
+		Horizon::Zone::AStar::Generator astar({ PRONTERA_WIDTH, PRONTERA_HEIGHT }, &check_prontera_collision);
+		int found = 0;
+		std::size_t total_length = 0;
+
+		astar.setSearchStepLimit(limit);
+
+		auto start_time = std::chrono::high_resolution_clock::now();
+
+		for (auto &route : routes) {
+			AStar::CoordinateList path = astar.findPath(route.first, route.second);
+
+			BOOST_REQUIRE(!path.empty());
+			BOOST_CHECK(path.back() == route.first);
+
+			if (path.front() == route.second)
+				found++;
+
+			total_length += path.size();
+
+			// Every step is walkable and leads to a neighbouring cell.
+			for (std::size_t i = 0; i + 1 < path.size(); i++) {
+				BOOST_CHECK(!check_prontera_collision(path[i].x(), path[i].y()));
+				BOOST_CHECK(path[i].is_within_range(path[i + 1], 1));
+				BOOST_CHECK(path[i] != path[i + 1]);
+			}
+		}
+
+		auto finish_time = std::chrono::high_resolution_clock::now();
+		std::chrono::duration<double, std::micro> elapsed = finish_time - start_time;
+
+		printf("Prontera (step limit %u): %zu paths in %.2fms, %.2fus per path, %d reached their target, %zu cells walked.\n",
+			limit, routes.size(), elapsed.count() / 1000, elapsed.count() / routes.size(), found, total_length);
+
+		BOOST_CHECK_GT(found, 0);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(AStarReachabilityTest)
+{
+	int idx = 0;
+
+	for (int y = PRONTERA_HEIGHT - 1; y >= 0; y--) {
+		for (int x = 0; x < PRONTERA_WIDTH; ++x) {
+			prontera_cell[x][y] = Cell(prontera[idx++]);
+		}
+	}
+
+	Horizon::Zone::AStar::Generator astar({ PRONTERA_WIDTH, PRONTERA_HEIGHT }, &check_prontera_collision);
+	std::mt19937 rng(2);
+	int reachable = 0, tested = 0;
+	double reach_time = 0, path_time = 0;
+
+	astar.setSearchStepLimit(0);
+
+	while (tested < 1000) {
+		MapCoords start(rng() % PRONTERA_WIDTH, rng() % PRONTERA_HEIGHT);
+		MapCoords end(start.x() + (int) (rng() % 31) - 15, start.y() + (int) (rng() % 31) - 15);
+
+		if (check_prontera_collision(start.x(), start.y()) || check_prontera_collision(end.x(), end.y()))
+			continue;
+
+		tested++;
+
+		auto t0 = std::chrono::high_resolution_clock::now();
+		bool is_reachable = astar.isReachable(start, end, MAX_VIEW_RANGE);
+		auto t1 = std::chrono::high_resolution_clock::now();
+		AStar::CoordinateList path = astar.findPath(start, end);
+		auto t2 = std::chrono::high_resolution_clock::now();
+
+		reach_time += std::chrono::duration<double, std::micro>(t1 - t0).count();
+		path_time += std::chrono::duration<double, std::micro>(t2 - t1).count();
+
+		bool path_found = path.front() == end;
+		int steps = path.size() - 1;
+
+		// A path of n moves implies the target is reachable within n moves,
+		// and a reachable target must be found by an unbounded path search.
+		if (path_found && steps <= MAX_VIEW_RANGE)
+			BOOST_CHECK(is_reachable);
+		if (is_reachable)
+			BOOST_CHECK(path_found);
+
+		BOOST_CHECK(!astar.isReachable(start, end, start.distance(end) - 1) || start == end);
+
+		if (is_reachable)
+			reachable++;
+	}
+
+	printf("Reachability: %d of %d targets within %d moves, %.2fus per query against %.2fus per path search.\n",
+		reachable, tested, MAX_VIEW_RANGE, reach_time / tested, path_time / tested);
+}
@@ -0,0 +1,271 @@
+/***************************************************
+ *       _   _            _                        *
+ *      | | | |          (_)                       *
+ *      | |_| | ___  _ __ _ _______  _ __          *
+ *      |  _  |/ _ \| '__| |_  / _ \| '_  \        *
+ *      | | | | (_) | |  | |/ / (_) | | | |        *
+ *      \_| |_/\___/|_|  |_/___\___/|_| |_|        *
+ ***************************************************
+ * This file is part of Horizon (c).
+ *
+ * Copyright (c) 2019 Sagun K. (sagunxp@gmail.com).
+ * Copyright (c) 2019 Horizon Dev Team.
+ *
+ * Base Author - Sagun Khosla <sagunxp@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ **************************************************/
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "ByteBufferPoolTest"
+
+#include "Libraries/Networking/Buffer/BroadcastBuffer.hpp"
+#include "Libraries/Networking/Buffer/ByteBuffer.hpp"
+#include "Libraries/Networking/Buffer/SharedReadBuffer.hpp"
+#include <boost/test/unit_test.hpp>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+BOOST_AUTO_TEST_CASE(ByteBufferInlineStorageTest)
+{
+	bytebuffer_pool_statistics before = ByteBufferPool::get_statistics();
+
+	{
+		ByteBuffer buf;
+		buf << (uint16_t) 0x0072 << (uint32_t) 2000000 << (uint32_t) 150000;
+		BOOST_CHECK_EQUAL(buf.active_length(), 10);
+
+		ByteBuffer moved(std::move(buf));
+		uint16_t packet_id = 0;
+		uint32_t account_id = 0, char_id = 0;
+		moved >> packet_id >> account_id >> char_id;
+		BOOST_CHECK_EQUAL(packet_id, 0x0072);
+		BOOST_CHECK_EQUAL(account_id, 2000000);
+		BOOST_CHECK_EQUAL(char_id, 150000);
+	}
+
+	bytebuffer_pool_statistics after = ByteBufferPool::get_statistics();
+
+	BOOST_CHECK_EQUAL(after.system_allocations, before.system_allocations);
+	BOOST_CHECK_EQUAL(after.pool_hits, before.pool_hits);
+	BOOST_CHECK_EQUAL(after.inline_buffers, before.inline_buffers + 1);
+}
+
+BOOST_AUTO_TEST_CASE(ByteBufferGrowthTest)
+{
+	std::vector<uint8_t> data(100000);
+
+	for (std::size_t i = 0; i < data.size(); i++)
+		data[i] = i % 251;
+
+	ByteBuffer buf;
+	for (std::size_t i = 0; i < data.size(); i += 1000)
+		buf.append(&data[i], 1000);
+
+	BOOST_CHECK_EQUAL(buf.active_length(), data.size());
+	BOOST_CHECK_EQUAL(std::memcmp(buf.get_read_pointer(), data.data(), data.size()), 0);
+
+	ByteBuffer copy(buf);
+	BOOST_CHECK_EQUAL(std::memcmp(copy.get_read_pointer(), data.data(), data.size()), 0);
+
+	ByteBuffer assigned;
+	assigned = std::move(copy);
+	BOOST_CHECK_EQUAL(assigned.active_length(), data.size());
+	BOOST_CHECK_EQUAL(std::memcmp(assigned.get_read_pointer(), data.data(), data.size()), 0);
+	BOOST_CHECK_EQUAL(copy.is_empty(), true);
+}
+
+BOOST_AUTO_TEST_CASE(ByteBufferEmplaceSizeTest)
+{
+	ByteBuffer buf;
+	buf << (uint16_t) 0x0099;
+	buf.append("hello world", 11);
+	buf.emplace_size();
+
+	uint16_t packet_id = 0, packet_len = 0;
+	char text[12] = { 0 };
+	buf >> packet_id >> packet_len;
+	buf.read(text, 11);
+
+	BOOST_CHECK_EQUAL(packet_id, 0x0099);
+	BOOST_CHECK_EQUAL(packet_len, 15);
+	BOOST_CHECK_EQUAL(std::string(text), "hello world");
+}
+
+BOOST_AUTO_TEST_CASE(ByteBufferPoolReuseTest)
+{
+	uint8_t payload[200] = { 0 };
+
+	// Warm up the free list of this thread.
+	{
+		ByteBuffer buf;
+		buf.append(payload, sizeof(payload));
+	}
+
+	bytebuffer_pool_statistics before = ByteBufferPool::get_statistics();
+
+	for (int i = 0; i < 1000; i++) {
+		ByteBuffer buf;
+		buf.append(payload, sizeof(payload));
+	}
+
+	bytebuffer_pool_statistics after = ByteBufferPool::get_statistics();
+
+	BOOST_CHECK_EQUAL(after.system_allocations, before.system_allocations);
+	BOOST_CHECK_EQUAL(after.pool_hits, before.pool_hits + 1000);
+}
+
+BOOST_AUTO_TEST_CASE(ByteBufferCrossThreadReleaseTest)
+{
+	uint8_t payload[1000] = { 0 };
+	std::vector<ByteBuffer> buffers;
+
+	for (int round = 0; round < 10; round++) {
+		for (int i = 0; i < 1000; i++) {
+			ByteBuffer buf;
+			buf.append(payload, sizeof(payload));
+			buffers.push_back(std::move(buf));
+		}
+
+		// Released by another thread, as the NetworkThread releases buffers built by a MapContainerThread.
+		std::thread releaser([&buffers]() { buffers.clear(); });
+		releaser.join();
+	}
+
+	bytebuffer_pool_statistics stats = ByteBufferPool::get_statistics();
+
+	BOOST_CHECK_GT(stats.depot_refills, 0);
+	BOOST_CHECK_LT(stats.system_allocations, 10000);
+}
+
+BOOST_AUTO_TEST_CASE(SharedReadBufferSliceTest)
+{
+	SharedReadBuffer read_buffer(0x1000);
+
+	uint8_t packets[12] = { 0x72, 0x00, 1, 2, 3, 4, 0x7d, 0x00, 5, 6, 7, 8 };
+	memcpy(read_buffer.get_write_pointer(), packets, sizeof(packets));
+	read_buffer.write_completed(sizeof(packets));
+
+	uint8_t *first_pointer = read_buffer.get_read_pointer();
+	ByteBuffer first = read_buffer.slice(6);
+	ByteBuffer second = read_buffer.slice(6);
+
+	// Slices view the read buffer directly.
+	BOOST_CHECK(first.get_read_pointer() == first_pointer);
+	BOOST_CHECK(second.get_read_pointer() == first_pointer + 6);
+	BOOST_CHECK_EQUAL(read_buffer.active_length(), 0);
+
+	uint16_t packet_id = 0;
+	uint32_t value = 0;
+	second >> packet_id >> value;
+	BOOST_CHECK_EQUAL(packet_id, 0x007d);
+	BOOST_CHECK_EQUAL(value, 0x08070605);
+
+	// A partially received packet stays in place while the chunk is shared...
+	read_buffer.get_write_pointer()[0] = 0x64;
+	read_buffer.write_completed(1);
+	read_buffer.ensure_free_space();
+	BOOST_CHECK(read_buffer.get_read_pointer() == first_pointer + 12);
+
+	// ...and is moved into a new chunk once the shared one runs short of space.
+	read_buffer.write_completed(read_buffer.remaining_space() - 16);
+	read_buffer.read_completed(read_buffer.active_length() - 1);
+	read_buffer.get_read_pointer()[0] = 0x64;
+	read_buffer.ensure_free_space();
+	BOOST_CHECK_EQUAL(read_buffer.active_length(), 1);
+	BOOST_CHECK_EQUAL(read_buffer.get_read_pointer()[0], 0x64);
+	BOOST_CHECK(read_buffer.get_read_pointer() != first_pointer);
+
+	// Slices still hold the bytes of the old chunk, and detach from it when grown.
+	first.append((uint32_t) 0xdeadbeef);
+	BOOST_CHECK(first.get_read_pointer() != first_pointer);
+	BOOST_CHECK_EQUAL(first.active_length(), 10);
+	BOOST_CHECK_EQUAL(first.get_read_pointer()[0], 0x72);
+	BOOST_CHECK_EQUAL(first_pointer[6], 0x7d);
+}
+
+BOOST_AUTO_TEST_CASE(SharedReadBufferCompactionTest)
+{
+	SharedReadBuffer read_buffer(0x1000);
+
+	memset(read_buffer.get_write_pointer(), 0x11, 10);
+	read_buffer.write_completed(10);
+
+	uint8_t *base_pointer = read_buffer.get_read_pointer();
+
+	{
+		ByteBuffer slice = read_buffer.slice(8);
+		BOOST_CHECK_EQUAL(slice.active_length(), 8);
+	}
+
+	// No slice is alive, so the remaining bytes are compacted in place.
+	read_buffer.ensure_free_space();
+	BOOST_CHECK(read_buffer.get_read_pointer() == base_pointer);
+	BOOST_CHECK_EQUAL(read_buffer.active_length(), 2);
+
+	// A packet larger than the block grows the buffer.
+	read_buffer.write_completed(read_buffer.remaining_space());
+	read_buffer.ensure_free_space();
+	BOOST_CHECK_GT(read_buffer.remaining_space(), 0);
+	BOOST_CHECK_EQUAL(read_buffer.active_length(), 0x1000);
+}
+
+BOOST_AUTO_TEST_CASE(BroadcastBufferTest)
+{
+	ByteBuffer packet;
+	packet << (uint16_t) 0x8d << (uint16_t) 200;
+	for (int i = 0; i < 196; i++)
+		packet << (uint8_t) i;
+
+	BroadcastBuffer broadcast(packet);
+	BOOST_CHECK(broadcast.is_shared());
+	BOOST_CHECK_EQUAL(broadcast.length(), 200);
+
+	std::vector<ByteBuffer> queued;
+	queued.reserve(9);
+	for (int i = 0; i < 8; i++)
+		queued.push_back(broadcast.view());
+
+	// Every recipient views the same bytes and consumes them independently.
+	for (ByteBuffer &buf : queued)
+		BOOST_CHECK(buf.get_read_pointer() == broadcast.data());
+
+	queued[0].read_completed(150);
+	BOOST_CHECK_EQUAL(queued[0].active_length(), 50);
+	BOOST_CHECK_EQUAL(queued[1].active_length(), 200);
+	BOOST_CHECK_EQUAL(queued[1].get_read_pointer()[4], 0);
+
+	// Views keep the packet alive after the broadcaster is gone, and may be released on other threads.
+	{
+		BroadcastBuffer scoped(packet);
+		queued.push_back(scoped.view());
+	}
+	std::thread release([&queued] () { queued.clear(); });
+	release.join();
+
+	// Small packets are copied into the inline storage of each view.
+	ByteBuffer small;
+	small << (uint16_t) 0x7f << (uint32_t) 0x12345678;
+
+	BroadcastBuffer small_broadcast(small);
+	ByteBuffer small_view = small_broadcast.view();
+	BOOST_CHECK(!small_broadcast.is_shared());
+	BOOST_CHECK_EQUAL(small_view.active_length(), 6);
+	BOOST_CHECK(memcmp(small_view.get_read_pointer(), small_broadcast.data(), 6) == 0);
+
+	BroadcastBuffer empty((ByteBuffer()));
+	BOOST_CHECK_EQUAL(empty.length(), 0);
+	BOOST_CHECK(empty.data() == nullptr);
+}
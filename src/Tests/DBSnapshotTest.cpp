@@ -0,0 +1,186 @@
+/***************************************************
+ *       _   _            _                        *
+ *      | | | |          (_)                       *
+ *      | |_| | ___  _ __ _ _______  _ __          *
+ *      |  _  |/ _ \| '__| |_  / _ \| '_  \        *
+ *      | | | | (_) | |  | |/ / (_) | | | |        *
+ *      \_| |_/\___/|_|  |_/___\___/|_| |_|        *
+ ***************************************************
+ * This file is part of Horizon (c).
+ *
+ * Copyright (c) 2019 Sagun K. (sagunxp@gmail.com).
+ * Copyright (c) 2019 Horizon Dev Team.
+ *
+ * Base Author - Sagun Khosla <sagunxp@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ **************************************************/
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "DBSnapshotTest"
+
+#include "Libraries/DBSnapshot/DBSnapshot.hpp"
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace Horizon::Libraries;
+
+#define TEST_RECORD_LAYOUT 1
+
+struct test_record
+{
+	uint16_t id{0};
+	char name[32]{0};  ///< Fits "record_" followed by any size_t.
+	int32_t values[5]{0};
+};
+
+struct snapshot_fixture
+{
+	snapshot_fixture()
+	: dir(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("dbsnapshot-%%%%-%%%%"))
+	{
+		boost::filesystem::create_directories(dir);
+		source = dir / "test_db.lua";
+		snapshot = dir / "test_db.snapshot";
+		write_source("return { }\n");
+	}
+
+	~snapshot_fixture() { boost::filesystem::remove_all(dir); }
+
+	void write_source(std::string const &content)
+	{
+		std::ofstream ofs(source.string(), std::ios::out | std::ios::trunc);
+		ofs << content;
+	}
+
+	void write_snapshot(std::size_t count)
+	{
+		DBSnapshotWriter writer;
+		std::vector<test_record> records(count);
+
+		for (std::size_t i = 0; i < count; i++) {
+			records[i].id = i + 1;
+			std::snprintf(records[i].name, sizeof(records[i].name), "record_%zu", i);
+			records[i].values[4] = i * 10;
+		}
+
+		BOOST_CHECK(writer.AddSource(source));
+		writer.AddSection("records", records, TEST_RECORD_LAYOUT);
+		writer.AddSection("empty", std::vector<int32_t>(), 1);
+		BOOST_CHECK_EQUAL(writer.Write(snapshot), DBSNAPSHOT_OK);
+	}
+
+	boost::filesystem::path dir, source, snapshot;
+};
+
+BOOST_FIXTURE_TEST_CASE(DBSnapshotRoundTripTest, snapshot_fixture)
+{
+	write_snapshot(1000);
+
+	DBSnapshot snap;
+	BOOST_CHECK_EQUAL(snap.Open(snapshot), DBSNAPSHOT_OK);
+	BOOST_CHECK_EQUAL(snap.CheckSources(), DBSNAPSHOT_OK);
+	BOOST_CHECK_EQUAL(snap.getHeader().section_count, 2);
+
+	std::size_t count = 0;
+	test_record const *records = snap.GetRecords<test_record>("records", count, TEST_RECORD_LAYOUT);
+
+	BOOST_REQUIRE(records != nullptr);
+	BOOST_CHECK_EQUAL(count, 1000);
+	BOOST_CHECK_EQUAL(reinterpret_cast<uintptr_t>(records) % DBSNAPSHOT_SECTION_ALIGNMENT, 0);
+	BOOST_CHECK_EQUAL(records[999].id, 1000);
+	BOOST_CHECK_EQUAL(std::string(records[999].name), "record_999");
+	BOOST_CHECK_EQUAL(records[999].values[4], 9990);
+
+	BOOST_CHECK(snap.GetRecords<int32_t>("empty", count, 1) != nullptr);
+	BOOST_CHECK_EQUAL(count, 0);
+
+	// Missing sections and records of another layout are refused.
+	BOOST_CHECK(snap.GetRecords<test_record>("missing", count, TEST_RECORD_LAYOUT) == nullptr);
+	BOOST_CHECK(snap.GetRecords<int64_t>("records", count, TEST_RECORD_LAYOUT) == nullptr);
+	// Records of the same size are refused too once their layout version changed.
+	BOOST_CHECK(snap.GetRecords<test_record>("records", count, TEST_RECORD_LAYOUT + 1) == nullptr);
+	BOOST_CHECK_EQUAL(count, 0);
+
+	// Shared records keep the mapping alive after the snapshot is gone.
+	std::shared_ptr<const test_record> shared;
+	{
+		DBSnapshot scoped;
+		BOOST_CHECK_EQUAL(scoped.Open(snapshot), DBSNAPSHOT_OK);
+		shared = scoped.Share(scoped.GetRecords<test_record>("records", count, TEST_RECORD_LAYOUT) + 10);
+	}
+	BOOST_CHECK_EQUAL(shared->id, 11);
+}
+
+BOOST_FIXTURE_TEST_CASE(DBSnapshotStaleSourceTest, snapshot_fixture)
+{
+	write_snapshot(10);
+
+	DBSnapshot snap;
+	std::string stale;
+	BOOST_CHECK_EQUAL(snap.Open(snapshot), DBSNAPSHOT_OK);
+
+	// Touching the source without changing it keeps the snapshot current.
+	boost::filesystem::last_write_time(source, boost::filesystem::last_write_time(source) + 10);
+	BOOST_CHECK_EQUAL(snap.CheckSources(), DBSNAPSHOT_OK);
+
+	// Same size, different content.
+	std::time_t mtime = boost::filesystem::last_write_time(source);
+	write_source("return {}\n ");
+	boost::filesystem::last_write_time(source, mtime + 10);
+	BOOST_CHECK_EQUAL(snap.CheckSources(&stale), DBSNAPSHOT_STALE_SOURCE);
+	BOOST_CHECK_EQUAL(stale, source.string());
+
+	boost::filesystem::remove(source);
+	BOOST_CHECK_EQUAL(snap.CheckSources(), DBSNAPSHOT_STALE_SOURCE);
+}
+
+BOOST_FIXTURE_TEST_CASE(DBSnapshotCorruptionTest, snapshot_fixture)
+{
+	DBSnapshot snap;
+
+	BOOST_CHECK_EQUAL(snap.Open(snapshot), DBSNAPSHOT_NONEXISTENT_FILE);
+
+	write_snapshot(100);
+
+	// Flip a byte inside the records.
+	{
+		std::fstream fs(snapshot.string(), std::ios::in | std::ios::out | std::ios::binary);
+		fs.seekp(-20, std::ios::end);
+		fs.put('x');
+	}
+	BOOST_CHECK_EQUAL(snap.Open(snapshot), DBSNAPSHOT_INVALID_CHECKSUM);
+	BOOST_CHECK(!snap.IsOpen());
+
+	// Truncated file.
+	write_snapshot(100);
+	boost::filesystem::resize_file(snapshot, boost::filesystem::file_size(snapshot) - 1);
+	BOOST_CHECK_EQUAL(snap.Open(snapshot), DBSNAPSHOT_INVALID_FORMAT);
+
+	// Unknown version.
+	write_snapshot(100);
+	{
+		std::fstream fs(snapshot.string(), std::ios::in | std::ios::out | std::ios::binary);
+		uint32_t version = DBSNAPSHOT_VERSION + 1;
+		fs.seekp(offsetof(dbsnapshot_header, version));
+		fs.write((const char *) &version, sizeof(version));
+	}
+	BOOST_CHECK_EQUAL(snap.Open(snapshot), DBSNAPSHOT_INVALID_VERSION);
+
+	write_snapshot(100);
+	BOOST_CHECK_EQUAL(snap.Open(snapshot), DBSNAPSHOT_OK);
+}
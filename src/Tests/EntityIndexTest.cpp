@@ -0,0 +1,219 @@
+/***************************************************
+ *       _   _            _                        *
+ *      | | | |          (_)                       *
+ *      | |_| | ___  _ __ _ _______  _ __          *
+ *      |  _  |/ _ \| '__| |_  / _ \| '_  \        *
+ *      | | | | (_) | |  | |/ / (_) | | | |        *
+ *      \_| |_/\___/|_|  |_/___\___/|_| |_|        *
+ ***************************************************
+ * This file is part of Horizon (c).
+ *
+ * Copyright (c) 2019 Sagun K. (sagunxp@gmail.com).
+ * Copyright (c) 2019 Horizon Dev Team.
+ *
+ * Base Author - Sagun K. (sagunxp@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ **************************************************/
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "EntityIndexTest"
+
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Core/Multithreading/ThreadSafeQueue.hpp"
+#include "Server/Zone/Game/Map/EntityIndex.hpp"
+
+using namespace Horizon::Zone;
+
+struct test_entity
+{
+	explicit test_entity(uint32_t guid) : guid(guid) { }
+	uint32_t guid;
+};
+
+BOOST_AUTO_TEST_CASE(EntityIndexLookupTest)
+{
+	EntityIndex<test_entity> index(4);
+	std::vector<std::shared_ptr<test_entity>> entities;
+
+	// Sequential guids, as handed out to NPCs and monsters, well past the initial capacity.
+	for (uint32_t guid = 110000000; guid < 110001000; ++guid) {
+		entities.push_back(std::make_shared<test_entity>(guid));
+		index.insert(guid, entities.back());
+	}
+
+	BOOST_CHECK_EQUAL(index.size(), 1000);
+
+	for (auto &e : entities)
+		BOOST_CHECK(index.find(e->guid) == e);
+
+	BOOST_CHECK(index.find(1) == nullptr);
+
+	// Destroyed entities are not handed out even if they were never erased.
+	entities[10].reset();
+	BOOST_CHECK(index.find(110000010) == nullptr);
+
+	// A guid taken over by another entity is only erased for that entity.
+	std::shared_ptr<test_entity> relogged = std::make_shared<test_entity>(110000020);
+	test_entity *previous = entities[20].get();
+	index.insert(110000020, relogged);
+	BOOST_CHECK_EQUAL(index.size(), 1000);
+	BOOST_CHECK(!index.erase(110000020, previous));
+	BOOST_CHECK(index.find(110000020) == relogged);
+	BOOST_CHECK(index.erase(110000020, relogged.get()));
+	BOOST_CHECK(index.find(110000020) == nullptr);
+	BOOST_CHECK_EQUAL(index.size(), 999);
+
+	index.clear();
+	BOOST_CHECK_EQUAL(index.size(), 0);
+	BOOST_CHECK(index.find(110000000) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(EntityIndexCompactionTest)
+{
+	EntityIndex<test_entity> index(4);
+	std::vector<std::shared_ptr<test_entity>> entities;
+
+	for (uint32_t guid = 1; guid <= 8; ++guid) {
+		entities.push_back(std::make_shared<test_entity>(guid));
+		index.insert(guid, entities.back());
+	}
+
+	// Entities destroyed without being erased only hold their slots until the table fills up.
+	for (std::size_t i = 0; i < 6; ++i)
+		entities[i].reset();
+
+	BOOST_CHECK_EQUAL(index.size(), 8);
+
+	std::shared_ptr<test_entity> spawned = std::make_shared<test_entity>(9);
+	index.insert(9, spawned);
+
+	BOOST_CHECK_EQUAL(index.size(), 3);
+	BOOST_CHECK(index.find(9) == spawned);
+	BOOST_CHECK(index.find(7) == entities[6]);
+	BOOST_CHECK(index.find(8) == entities[7]);
+	BOOST_CHECK(index.find(1) == nullptr);
+	BOOST_CHECK(index.erase(7, entities[6].get()));
+	BOOST_CHECK_EQUAL(index.size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(EntityIndexChurnTest)
+{
+	EntityIndex<test_entity> index;
+	std::unordered_map<uint32_t, std::shared_ptr<test_entity>> reference;
+	std::mt19937 rng(24);
+
+	// Entities spawning and despawning at random, every lookup must agree with a reference map.
+	for (int i = 0; i < 200000; ++i) {
+		uint32_t guid = 150000 + rng() % 4096;
+		auto it = reference.find(guid);
+
+		if (it == reference.end()) {
+			std::shared_ptr<test_entity> e = std::make_shared<test_entity>(guid);
+			index.insert(guid, e);
+			reference.emplace(guid, e);
+		} else {
+			BOOST_REQUIRE(index.erase(guid, it->second.get()));
+			reference.erase(it);
+		}
+
+		if (i % 1000 == 0) {
+			BOOST_REQUIRE_EQUAL(index.size(), reference.size());
+
+			for (uint32_t g = 150000; g < 150000 + 4096; ++g) {
+				auto r = reference.find(g);
+				BOOST_REQUIRE(index.find(g) == (r != reference.end() ? r->second : nullptr));
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(EntityIndexWarpHandoffTest)
+{
+	// Two map containers, each owning the index of its map and a queue of players handed over to it.
+	struct container
+	{
+		EntityIndex<test_entity> index;
+		ThreadSafeQueue<std::pair<bool, std::shared_ptr<test_entity>>> player_buffer;
+		std::unordered_map<uint32_t, std::shared_ptr<test_entity>> managed;
+	};
+
+	container containers[2];
+	std::atomic<int> warps_left(20000), in_flight(0), misses(0);
+
+	for (uint32_t guid = 150000; guid < 150064; ++guid) {
+		std::shared_ptr<test_entity> player = std::make_shared<test_entity>(guid);
+		container &c = containers[guid % 2];
+		c.index.insert(guid, player);
+		c.managed.emplace(guid, player);
+	}
+
+	auto run = [&] (int id) {
+		container &self = containers[id], &other = containers[1 - id];
+		std::mt19937 rng(id);
+
+		while (warps_left.load() > 0 || in_flight.load() > 0) {
+			while (std::shared_ptr<std::pair<bool, std::shared_ptr<test_entity>>> pbuf = self.player_buffer.try_pop()) {
+				std::shared_ptr<test_entity> player = pbuf->second;
+				if (pbuf->first) {
+					self.index.insert(player->guid, player);
+					self.managed.emplace(player->guid, player);
+				} else {
+					self.index.erase(player->guid, player.get());
+				}
+				in_flight--;
+			}
+
+			// Players taken over by this container are looked up while the other one keeps warping players to it.
+			// Boost.Test assertions are not thread-safe, misses are checked once both have stopped.
+			for (auto &m : self.managed)
+				if (self.index.find(m.first) != m.second)
+					misses++;
+
+			if (self.managed.empty() || warps_left.fetch_sub(1) <= 0)
+				continue;
+
+			// Warping to the other container only queues the handoff, as Player::move_to_map does.
+			auto it = std::next(self.managed.begin(), rng() % self.managed.size());
+			std::shared_ptr<test_entity> player = it->second;
+			self.managed.erase(it);
+			in_flight += 2;
+			self.player_buffer.push(std::make_pair(false, player));
+			other.player_buffer.push(std::make_pair(true, player));
+		}
+	};
+
+	std::thread first(run, 0), second(run, 1);
+	first.join();
+	second.join();
+
+	BOOST_CHECK_EQUAL(misses.load(), 0);
+
+	BOOST_CHECK_EQUAL(containers[0].index.size() + containers[1].index.size(), 64);
+
+	for (container &c : containers) {
+		BOOST_CHECK_EQUAL(c.index.size(), c.managed.size());
+		for (auto &m : c.managed)
+			BOOST_CHECK(c.index.find(m.first) == m.second);
+	}
+}
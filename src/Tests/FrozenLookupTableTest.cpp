@@ -0,0 +1,124 @@
+/***************************************************
+ *       _   _            _                        *
+ *      | | | |          (_)                       *
+ *      | |_| | ___  _ __ _ _______  _ __          *
+ *      |  _  |/ _ \| '__| |_  / _ \| '_  \        *
+ *      | | | | (_) | |  | |/ / (_) | | | |        *
+ *      \_| |_/\___/|_|  |_/___\___/|_| |_|        *
+ ***************************************************
+ * This file is part of Horizon (c).
+ *
+ * Copyright (c) 2019 Sagun K. (sagunxp@gmail.com).
+ * Copyright (c) 2019 Horizon Dev Team.
+ *
+ * Base Author - Sagun Khosla <sagunxp@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ **************************************************/
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "FrozenLookupTableTest"
+
+#include "Core/Multithreading/FrozenLookupTable.hpp"
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+BOOST_AUTO_TEST_CASE(FrozenLookupTableFreezeTest)
+{
+	FrozenLookupTable<int, int> dense;
+	FrozenLookupTable<int, int> sparse;
+	FrozenLookupTable<std::string, int> names;
+
+	for (int i = 0; i < 1000; i++) {
+		dense.insert(500 + i, i);
+		sparse.insert(i * 100000, i);
+		names.insert("item_" + std::to_string(i), i);
+	}
+
+	// Nothing is visible before the freeze.
+	BOOST_CHECK(dense.find(500) == nullptr);
+	BOOST_CHECK_EQUAL(dense.staged(500), 0);
+	BOOST_CHECK_EQUAL(dense.staged_size(), 1000);
+
+	dense.freeze();
+	sparse.freeze();
+	names.freeze();
+
+	BOOST_CHECK_EQUAL(dense.size(), 1000);
+	BOOST_CHECK_EQUAL(dense.max_probe(), 0);
+
+	for (int i = 0; i < 1000; i++) {
+		BOOST_CHECK_EQUAL(*dense.find(500 + i), i);
+		BOOST_CHECK_EQUAL(*sparse.find(i * 100000), i);
+		BOOST_CHECK_EQUAL(*names.find("item_" + std::to_string(i)), i);
+	}
+
+	BOOST_CHECK(dense.find(499) == nullptr);
+	BOOST_CHECK(dense.find(1500) == nullptr);
+	BOOST_CHECK(sparse.find(100001) == nullptr);
+	BOOST_CHECK(names.find("item_1000") == nullptr);
+	BOOST_CHECK_EQUAL(names.at("missing", -1), -1);
+
+	int64_t key_sum = 0, value_sum = 0;
+	sparse.for_each([&] (int key, int value) { key_sum += key; value_sum += value; });
+	BOOST_CHECK_EQUAL(key_sum, int64_t(499500) * 100000);
+	BOOST_CHECK_EQUAL(value_sum, 499500);
+}
+
+BOOST_AUTO_TEST_CASE(FrozenLookupTableReloadTest)
+{
+	FrozenLookupTable<int, std::string> table;
+	std::atomic<bool> done{false}, fail{false};
+
+	for (int i = 0; i < 100; i++)
+		table.insert(i, "v0");
+
+	table.freeze();
+
+	std::string const *held = table.find(1);
+
+	// Readers keep looking up while the table is reloaded, every lookup sees one complete snapshot.
+	std::vector<std::thread> readers;
+	for (int r = 0; r < 2; r++) {
+		readers.emplace_back([&table, &done, &fail] () {
+			while (!done) {
+				for (int i = 0; i < 100; i++) {
+					std::string const *value = table.find(i);
+					if (value == nullptr || value->size() < 2 || (*value)[0] != 'v')
+						fail.exchange(true);
+				}
+			}
+		});
+	}
+
+	for (int reload = 1; reload <= 50; reload++) {
+		table.clear();
+		for (int i = 0; i < 100; i++)
+			table.insert(i, "v" + std::to_string(reload));
+		table.freeze();
+	}
+
+	done.exchange(true);
+
+	for (std::thread &reader : readers)
+		reader.join();
+
+	BOOST_CHECK(!fail);
+	// Values handed out before the reload are retired, not freed.
+	BOOST_CHECK_EQUAL(*held, "v0");
+	BOOST_CHECK_EQUAL(*table.find(1), "v50");
+}
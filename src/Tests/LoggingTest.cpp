@@ -20,6 +20,13 @@
 #include <boost/log/sources/severity_logger.hpp>
 #include <boost/log/sources/record_ostream.hpp>
 
+#include "Core/Logging/Logger.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
 namespace logging = boost::log;
 namespace src = boost::log::sources;
 namespace sinks = boost::log::sinks;
@@ -95,3 +102,120 @@ BOOST_AUTO_TEST_CASE(LoggingTest)
     BOOST_LOG_SEV(lg, error) << "An error severity message";
     BOOST_LOG_SEV(lg, fatal) << "A fatal severity message";
 }
+
+static void wait_for_log_thread(uint64_t records)
+{
+	while (Logger::getInstance()->get_statistics().records < records)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+BOOST_AUTO_TEST_CASE(LoggerRecordTest)
+{
+	Logger::getInstance()->set_console_output(false);
+
+	logger_statistics before = Logger::getInstance()->get_statistics();
+
+	HLog(info) << "A short message, " << std::hex << 255 << " in hex.";
+	// Manipulators of the previous message must not leak into the next one.
+	HLog(info) << "Back to decimal: " << 255 << std::endl;
+	HLog(info) << "A long message: " << std::string(3 * LOG_RECORD_TEXT_SIZE, 'x');
+	HLogSys(LOG_NETWORK, warning) << "A network warning.";
+
+	wait_for_log_thread(before.records + 4);
+
+	logger_statistics after = Logger::getInstance()->get_statistics();
+
+	BOOST_CHECK_EQUAL(after.records - before.records, 4);
+	BOOST_CHECK_EQUAL(after.overflows - before.overflows, 1);
+
+	// Disabled levels never reach the log thread.
+	Logger::getInstance()->set_level(LOG_GAME, boost::log::trivial::warning);
+
+	HLogSys(LOG_GAME, info) << "Filtered out.";
+	HLogSys(LOG_GAME, error) << "Not filtered out.";
+	HLogSys(LOG_NETWORK, info) << "Not filtered out either.";
+
+	wait_for_log_thread(after.records + 2);
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+	BOOST_CHECK_EQUAL(Logger::getInstance()->get_statistics().records - after.records, 2);
+
+	Logger::getInstance()->set_level(LOG_GAME, boost::log::trivial::trace);
+
+	log_subsystem subsystem = LOG_CORE;
+
+	BOOST_CHECK(Logger::parse_subsystem("network", subsystem));
+	BOOST_CHECK_EQUAL(subsystem, LOG_NETWORK);
+	BOOST_CHECK(!Logger::parse_subsystem("nonexistent", subsystem));
+}
+
+BOOST_AUTO_TEST_CASE(LoggerContentionBenchmark)
+{
+	// Fewer calls per thread than a ring holds, so this measures the cost paid by the logging thread.
+	int const calls_per_thread = (int) Logger::getInstance()->get_ring_capacity() / 2;
+
+	Logger::getInstance()->set_console_output(false);
+
+	for (int threads : { 1, 2, 4, 8 }) {
+		std::vector<std::thread> producers;
+		std::vector<double> nanoseconds(threads);
+		logger_statistics before = Logger::getInstance()->get_statistics();
+
+		for (int t = 0; t < threads; t++) {
+			producers.emplace_back([t, &nanoseconds, calls_per_thread] () {
+				auto start_time = std::chrono::high_resolution_clock::now();
+
+				for (int i = 0; i < calls_per_thread; i++)
+					HLog(info) << "Benchmark message " << i << " from thread " << t << ".";
+
+				std::chrono::duration<double, std::nano> elapsed = std::chrono::high_resolution_clock::now() - start_time;
+				nanoseconds[t] = elapsed.count() / calls_per_thread;
+			});
+		}
+
+		for (auto &producer : producers)
+			producer.join();
+
+		wait_for_log_thread(before.records + threads * calls_per_thread);
+
+		double total = 0;
+
+		for (double ns : nanoseconds)
+			total += ns;
+
+		printf("Logging: %d thread(s), %.1fns per call, %llu stall(s).\n", threads, total / threads,
+			(unsigned long long) (Logger::getInstance()->get_statistics().stalls - before.stalls));
+	}
+
+	Logger::getInstance()->set_level(LOG_CORE, boost::log::trivial::info);
+
+	auto start_time = std::chrono::high_resolution_clock::now();
+
+	for (int i = 0; i < calls_per_thread; i++)
+		HLog(debug) << "Filtered benchmark message " << i << ".";
+
+	std::chrono::duration<double, std::nano> elapsed = std::chrono::high_resolution_clock::now() - start_time;
+
+	printf("Logging: %.1fns per call below the runtime level.\n", elapsed.count() / calls_per_thread);
+
+	Logger::getInstance()->set_level(LOG_CORE, boost::log::trivial::trace);
+}
+
+BOOST_AUTO_TEST_CASE(LoggerFinalizeTest)
+{
+	Logger::getInstance()->set_console_output(false);
+
+	logger_statistics before = Logger::getInstance()->get_statistics();
+
+	for (int i = 0; i < 100; i++)
+		HLog(info) << "Queued message " << i << ".";
+
+	// Everything queued is written before the log thread stops, later messages are written directly.
+	Logger::getInstance()->finalize();
+
+	BOOST_CHECK_EQUAL(Logger::getInstance()->get_statistics().records - before.records, 100);
+
+	HLog(info) << "Written synchronously.";
+
+	BOOST_CHECK_EQUAL(Logger::getInstance()->get_statistics().records - before.records, 101);
+}
@@ -0,0 +1,130 @@
+/***************************************************
+ *       _   _            _                        *
+ *      | | | |          (_)                       *
+ *      | |_| | ___  _ __ _ _______  _ __          *
+ *      |  _  |/ _ \| '__| |_  / _ \| '_  \        *
+ *      | | | | (_) | |  | |/ / (_) | | | |        *
+ *      \_| |_/\___/|_|  |_/___\___/|_| |_|        *
+ ***************************************************
+ * This file is part of Horizon (c).
+ *
+ * Copyright (c) 2019 Sagun K. (sagunxp@gmail.com).
+ * Copyright (c) 2019 Horizon Dev Team.
+ *
+ * Base Author - Sagun Khosla <sagunxp@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ **************************************************/
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "MapCellLayerTest"
+
+#include <boost/test/unit_test.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "Server/Zone/Game/Map/Grid/Cell/Cell.hpp"
+#include "Server/Zone/Game/Map/Grid/Cell/MapCellLayer.hpp"
+
+using namespace Horizon::Zone;
+
+#define MAP_WIDTH 268
+#define MAP_HEIGHT 300
+
+#include "prontera.cpp"
+
+BOOST_AUTO_TEST_CASE(MapCellLayerMatchesCellsTest)
+{
+	std::vector<uint8_t> cells(izlude, izlude + MAP_WIDTH * MAP_HEIGHT);
+	MapCellLayer layer(MAP_WIDTH, MAP_HEIGHT, cells);
+
+	BOOST_CHECK_EQUAL(layer.words_per_row(), 5);
+
+	for (int y = 0; y < MAP_HEIGHT; ++y) {
+		for (int x = 0; x < MAP_WIDTH; ++x) {
+			Cell c(izlude[y * MAP_WIDTH + x]);
+			BOOST_CHECK_EQUAL(layer.get_type(x, y), c.get_type());
+			BOOST_CHECK_EQUAL(layer.is_walkable(x, y), c.isWalkable());
+			BOOST_CHECK_EQUAL(layer.is_shootable(x, y), c.isShootable());
+			BOOST_CHECK_EQUAL(layer.is_water(x, y), c.isWater());
+		}
+	}
+
+	// Bits beyond the width of the map are clear.
+	for (int y = 0; y < MAP_HEIGHT; ++y)
+		BOOST_CHECK_EQUAL(layer.walkable_row(y)[layer.words_per_row() - 1] >> (MAP_WIDTH % 64), 0);
+
+	// A map of 268x300 cells needs far less than the 416x416 cells of a fixed grid.
+	BOOST_CHECK_LT(layer.memory_usage(), MAP_WIDTH * MAP_HEIGHT * 2);
+}
+
+BOOST_AUTO_TEST_CASE(MapCellLayerSpanTest)
+{
+	std::vector<uint8_t> cells(MAP_WIDTH * MAP_HEIGHT, CELL_WALKABLE_SHOOTABLE_GROUND_0);
+
+	cells[10 * MAP_WIDTH + 70] = CELL_NONWALKABLE_GROUND;
+	cells[20 * MAP_WIDTH + 130] = CELL_CLIFF_ONLY_SHOOTABLE_5;
+
+	MapCellLayer layer(MAP_WIDTH, MAP_HEIGHT, cells);
+
+	BOOST_CHECK(layer.is_walkable_span(10, 0, 69));
+	BOOST_CHECK(layer.is_walkable_span(10, 71, MAP_WIDTH - 1));
+	BOOST_CHECK(!layer.is_walkable_span(10, 0, MAP_WIDTH - 1));
+	BOOST_CHECK(!layer.is_walkable_span(10, 70, 70));
+	BOOST_CHECK(!layer.is_walkable_span(20, 200, 5));
+	BOOST_CHECK(layer.is_shootable_span(20, 0, MAP_WIDTH - 1));
+	BOOST_CHECK(!layer.is_shootable_span(10, 63, 70));
+}
+
+BOOST_AUTO_TEST_CASE(MapCellLayerLineTest)
+{
+	std::vector<uint8_t> cells(MAP_WIDTH * MAP_HEIGHT, CELL_WALKABLE_SHOOTABLE_GROUND_0);
+
+	// A wall at x = 100 from y = 0 to y = 49, that can be shot through.
+	for (int y = 0; y < 50; ++y)
+		cells[y * MAP_WIDTH + 100] = CELL_CLIFF_ONLY_SHOOTABLE_5;
+
+	MapCellLayer layer(MAP_WIDTH, MAP_HEIGHT, cells);
+
+	BOOST_CHECK(layer.is_walkable_line(10, 10, 99, 10));
+	BOOST_CHECK(!layer.is_walkable_line(10, 10, 150, 10));
+	BOOST_CHECK(!layer.is_walkable_line(150, 40, 10, 10));
+	BOOST_CHECK(layer.is_walkable_line(90, 60, 110, 50));
+	BOOST_CHECK(!layer.is_walkable_line(90, 60, 110, 30));
+	BOOST_CHECK(layer.is_walkable_line(100, 50, 100, 200));
+	BOOST_CHECK(!layer.is_walkable_line(100, 200, 100, 49));
+	BOOST_CHECK(layer.is_shootable_line(10, 10, 150, 10));
+	BOOST_CHECK(layer.is_walkable_line(5, 5, 5, 5));
+
+	// Lines agree with a cell by cell trace on izlude.
+	std::vector<uint8_t> izlude_cells(izlude, izlude + MAP_WIDTH * MAP_HEIGHT);
+	MapCellLayer izlude_layer(MAP_WIDTH, MAP_HEIGHT, izlude_cells);
+
+	for (int i = 0; i < 2000; ++i) {
+		int x0 = (i * 37) % MAP_WIDTH, y0 = (i * 53) % MAP_HEIGHT;
+		int x1 = (i * 91 + 7) % MAP_WIDTH, y1 = (i * 13 + 11) % MAP_HEIGHT;
+		int dx = abs(x1 - x0), dy = -abs(y1 - y0), sx = x0 < x1 ? 1 : -1, sy = y0 < y1 ? 1 : -1, err = dx + dy;
+		int x = x0, y = y0;
+		bool walkable = izlude_layer.is_walkable(x, y);
+
+		while (x != x1 || y != y1) {
+			int e2 = 2 * err;
+			if (e2 >= dy) { err += dy; x += sx; }
+			if (e2 <= dx) { err += dx; y += sy; }
+			walkable = walkable && izlude_layer.is_walkable(x, y);
+		}
+
+		BOOST_CHECK_EQUAL(izlude_layer.is_walkable_line(x0, y0, x1, y1), walkable);
+	}
+}
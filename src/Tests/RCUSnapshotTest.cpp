@@ -0,0 +1,116 @@
+/***************************************************
+ *       _   _            _                        *
+ *      | | | |          (_)                       *
+ *      | |_| | ___  _ __ _ _______  _ __          *
+ *      |  _  |/ _ \| '__| |_  / _ \| '_  \        *
+ *      | | | | (_) | |  | |/ / (_) | | | |        *
+ *      \_| |_/\___/|_|  |_/___\___/|_| |_|        *
+ ***************************************************
+ * This file is part of Horizon (c).
+ *
+ * Copyright (c) 2019 Sagun K. (sagunxp@gmail.com).
+ * Copyright (c) 2019 Horizon Dev Team.
+ *
+ * Base Author - Sagun Khosla <sagunxp@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ **************************************************/
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "RCUSnapshotTest"
+
+#include "Core/Multithreading/RCUSnapshot.hpp"
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+BOOST_AUTO_TEST_CASE(RCUSnapshotUpdateTest)
+{
+	RCUSnapshot<std::unordered_map<std::string, int>> index;
+
+	BOOST_CHECK(index.read()->empty());
+
+	index.update([] (std::unordered_map<std::string, int> &m) { m["prontera"] = 1; });
+
+	std::shared_ptr<std::unordered_map<std::string, int> const> held = index.read();
+
+	index.update([] (std::unordered_map<std::string, int> &m) { m["geffen"] = 2; m.erase("prontera"); });
+
+	// Held snapshots never change, new reads see the update.
+	BOOST_CHECK_EQUAL(held->size(), 1);
+	BOOST_CHECK_EQUAL(held->at("prontera"), 1);
+	BOOST_CHECK_EQUAL(index.read()->size(), 1);
+	BOOST_CHECK_EQUAL(index.read()->at("geffen"), 2);
+}
+
+BOOST_AUTO_TEST_CASE(RCUSnapshotInstancesTest)
+{
+	RCUSnapshot<std::vector<int>> a, b;
+
+	a.update([] (std::vector<int> &v) { v.push_back(1); });
+	b.update([] (std::vector<int> &v) { v.push_back(2); v.push_back(3); });
+
+	// Alternating reads of instances of the same type must not mix up their thread caches.
+	for (int i = 0; i < 4; i++) {
+		BOOST_CHECK_EQUAL(a.read()->size(), 1);
+		BOOST_CHECK_EQUAL(b.read()->size(), 2);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(RCUSnapshotConcurrencyTest)
+{
+	RCUSnapshot<std::vector<int>> snapshot;
+	std::atomic<bool> done{false};
+	std::atomic<int> torn{0};
+	std::vector<std::thread> readers;
+
+	snapshot.update([] (std::vector<int> &v) { v.assign(64, 0); });
+
+	for (int r = 0; r < 4; r++) {
+		readers.emplace_back([&snapshot, &done, &torn] () {
+			int last = 0;
+
+			while (!done) {
+				std::shared_ptr<std::vector<int> const> s = snapshot.read();
+
+				for (int value : *s)
+					if (value != s->front())
+						torn++;
+
+				// A thread never goes back to an older snapshot.
+				if (s->front() < last)
+					torn++;
+
+				last = s->front();
+			}
+		});
+	}
+
+	std::thread writer([&snapshot] () {
+		for (int i = 1; i <= 2000; i++)
+			snapshot.update([i] (std::vector<int> &v) { for (int &value : v) value = i; });
+	});
+
+	writer.join();
+	done = true;
+
+	for (auto &t : readers)
+		t.join();
+
+	BOOST_CHECK_EQUAL(torn, 0);
+	BOOST_CHECK_EQUAL(snapshot.read()->front(), 2000);
+}
@@ -0,0 +1,180 @@
+/***************************************************
+ *       _   _            _                        *
+ *      | | | |          (_)                       *
+ *      | |_| | ___  _ __ _ _______  _ __          *
+ *      |  _  |/ _ \| '__| |_  / _ \| '_  \        *
+ *      | | | | (_) | |  | |/ / (_) | | | |        *
+ *      \_| |_/\___/|_|  |_/___\___/|_| |_|        *
+ ***************************************************
+ * This file is part of Horizon (c).
+ *
+ * Copyright (c) 2019 Sagun K. (sagunxp@gmail.com).
+ * Copyright (c) 2019 Horizon Dev Team.
+ *
+ * Base Author - Sagun Khosla <sagunxp@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ **************************************************/
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "SPSCQueueTest"
+
+#include "Core/Multithreading/SPSCQueue.hpp"
+#include "Core/Multithreading/ThreadSafeQueue.hpp"
+#include "Libraries/Networking/Buffer/ByteBuffer.hpp"
+#include <boost/test/unit_test.hpp>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <atomic>
+
+#define MAX_PUSHES 1000000
+#define BENCHMARK_PACKET_SIZE 32
+
+BOOST_AUTO_TEST_CASE(SPSCQueueCapacityTest)
+{
+	SPSCQueue<int> queue(1000);
+
+	BOOST_CHECK_EQUAL(queue.capacity(), 1024);
+
+	for (int i = 0; i < 1024; i++)
+		BOOST_CHECK_EQUAL(queue.try_push(std::move(i)), true);
+
+	int overflow = 1024;
+	BOOST_CHECK_EQUAL(queue.try_push(std::move(overflow)), false);
+	BOOST_CHECK_EQUAL(queue.rejected_pushes(), 1);
+	BOOST_CHECK_EQUAL(queue.size(), 1024);
+	BOOST_CHECK_EQUAL(queue.high_water_mark(), 1024);
+
+	int value = -1;
+	for (int i = 0; i < 1024; i++) {
+		BOOST_CHECK_EQUAL(queue.try_pop(value), true);
+		BOOST_CHECK_EQUAL(value, i);
+	}
+
+	BOOST_CHECK_EQUAL(queue.try_pop(value), false);
+	BOOST_CHECK_EQUAL(queue.empty(), true);
+	BOOST_CHECK_EQUAL(queue.high_water_mark(), 1024);
+}
+
+BOOST_AUTO_TEST_CASE(SPSCQueueOrderingTest)
+{
+	SPSCQueue<int> queue(256);
+	std::atomic<bool> go(false);
+	bool ordered = true;
+
+	std::thread producer([&queue, &go]() {
+		while (!go);
+		for (int i = 0; i < MAX_PUSHES; i++) {
+			int value = i;
+			while (!queue.try_push(std::move(value)))
+				std::this_thread::yield();
+		}
+	});
+
+	std::thread consumer([&queue, &go, &ordered]() {
+		while (!go);
+		int value = 0;
+		for (int i = 0; i < MAX_PUSHES; i++) {
+			while (!queue.try_pop(value))
+				std::this_thread::yield();
+			if (value != i)
+				ordered = false;
+		}
+	});
+
+	go.exchange(true);
+
+	producer.join();
+	consumer.join();
+
+	BOOST_CHECK_EQUAL(ordered, true);
+	BOOST_CHECK_EQUAL(queue.empty(), true);
+	BOOST_CHECK_LE(queue.high_water_mark(), queue.capacity());
+}
+
+/**
+ * Moves packet-sized ByteBuffers from one thread to another through each queue,
+ * mirroring the NetworkThread -> MapContainerThread receive path.
+ */
+BOOST_AUTO_TEST_CASE(SPSCQueueBenchmark)
+{
+	uint8_t payload[BENCHMARK_PACKET_SIZE] = { 0 };
+
+	std::chrono::nanoseconds tsq_duration, spsc_duration;
+
+	{
+		ThreadSafeQueue<ByteBuffer> queue;
+		std::atomic<bool> go(false);
+
+		std::thread producer([&queue, &go, &payload]() {
+			while (!go);
+			for (int i = 0; i < MAX_PUSHES; i++) {
+				ByteBuffer buf(BENCHMARK_PACKET_SIZE);
+				buf.append(payload, BENCHMARK_PACKET_SIZE);
+				queue.push(std::move(buf));
+			}
+		});
+
+		std::thread consumer([&queue, &go]() {
+			while (!go);
+			for (int i = 0; i < MAX_PUSHES; i++) {
+				while (queue.try_pop() == nullptr)
+					std::this_thread::yield();
+			}
+		});
+
+		auto start = std::chrono::steady_clock::now();
+		go.exchange(true);
+		producer.join();
+		consumer.join();
+		tsq_duration = std::chrono::steady_clock::now() - start;
+	}
+
+	{
+		SPSCQueue<ByteBuffer> queue(1024);
+		std::atomic<bool> go(false);
+
+		std::thread producer([&queue, &go, &payload]() {
+			while (!go);
+			for (int i = 0; i < MAX_PUSHES; i++) {
+				ByteBuffer buf(BENCHMARK_PACKET_SIZE);
+				buf.append(payload, BENCHMARK_PACKET_SIZE);
+				while (!queue.try_push(std::move(buf)))
+					std::this_thread::yield();
+			}
+		});
+
+		std::thread consumer([&queue, &go]() {
+			while (!go);
+			ByteBuffer buf;
+			for (int i = 0; i < MAX_PUSHES; i++) {
+				while (!queue.try_pop(buf))
+					std::this_thread::yield();
+			}
+		});
+
+		auto start = std::chrono::steady_clock::now();
+		go.exchange(true);
+		producer.join();
+		consumer.join();
+		spsc_duration = std::chrono::steady_clock::now() - start;
+
+		std::cout << "SPSCQueue high-water mark: " << queue.high_water_mark() << "/" << queue.capacity() << std::endl;
+	}
+
+	std::cout << "ThreadSafeQueue<ByteBuffer>: " << tsq_duration.count() / MAX_PUSHES << " ns per packet." << std::endl;
+	std::cout << "SPSCQueue<ByteBuffer>: " << spsc_duration.count() / MAX_PUSHES << " ns per packet." << std::endl;
+}
@@ -0,0 +1,310 @@
+/***************************************************
+ *       _   _            _                        *
+ *      | | | |          (_)                       *
+ *      | |_| | ___  _ __ _ _______  _ __          *
+ *      |  _  |/ _ \| '__| |_  / _ \| '_  \        *
+ *      | | | | (_) | |  | |/ / (_) | | | |        *
+ *      \_| |_/\___/|_|  |_/___\___/|_| |_|        *
+ ***************************************************
+ * This file is part of Horizon (c).
+ *
+ * Copyright (c) 2019 Sagun K. (sagunxp@gmail.com).
+ * Copyright (c) 2019 Horizon Dev Team.
+ *
+ * Base Author - Sagun K. (sagunxp@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ **************************************************/
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "SessionRegistryTest"
+
+#include "Libraries/SessionRegistry/SessionRegistry.hpp"
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace Horizon::Libraries;
+
+static session_registry_entry make_entry(uint32_t account_id, char server = 'A', int64_t last_update = 0)
+{
+	session_registry_entry entry;
+	entry.game_account_id = account_id;
+	entry.auth_code = account_id * 7;
+	entry.character_slots = 3;
+	entry.current_server = server;
+	entry.last_update = last_update;
+	return entry;
+}
+
+struct shared_registry_fixture
+{
+	shared_registry_fixture()
+	: name("horizon-session-registry-test-" + std::to_string(getpid()))
+	{
+		SessionRegistry::remove(name);
+	}
+
+	~shared_registry_fixture() { SessionRegistry::remove(name); }
+
+	std::string name;
+};
+
+BOOST_AUTO_TEST_CASE(SessionRegistryLocalTest)
+{
+	SessionRegistry registry;
+	session_registry_entry entry;
+
+	registry.open_local(16);
+
+	BOOST_CHECK(registry.is_open());
+	BOOST_CHECK(!registry.is_shared());
+	BOOST_CHECK(!registry.find(1, entry));
+
+	BOOST_CHECK(registry.insert(make_entry(1)));
+	// A second login of the same account is refused.
+	BOOST_CHECK(!registry.insert(make_entry(1, 'C')));
+	BOOST_CHECK(registry.find(1, entry));
+	BOOST_CHECK_EQUAL(entry.auth_code, 7);
+	BOOST_CHECK_EQUAL(entry.current_server, 'A');
+
+	BOOST_CHECK(registry.set_current_server(1, 'C'));
+	BOOST_CHECK(!registry.touch(1, 'Z', 100));
+	BOOST_CHECK(registry.touch(1, 'C', 100));
+	BOOST_CHECK(registry.find(1, entry));
+	BOOST_CHECK_EQUAL(entry.current_server, 'C');
+	BOOST_CHECK_EQUAL(entry.last_update, 100);
+
+	BOOST_CHECK(registry.upsert(make_entry(1, 'Z')));
+	BOOST_CHECK(registry.find(1, entry));
+	BOOST_CHECK_EQUAL(entry.current_server, 'Z');
+
+	BOOST_CHECK(registry.erase(1));
+	BOOST_CHECK(!registry.erase(1));
+	BOOST_CHECK(!registry.find(1, entry));
+	BOOST_CHECK(!registry.set_current_server(1, 'C'));
+
+	BOOST_CHECK_EQUAL(registry.get_statistics().size, 0);
+}
+
+BOOST_AUTO_TEST_CASE(SessionRegistryCapacityTest)
+{
+	SessionRegistry registry;
+	session_registry_entry entry;
+
+	registry.open_local(100);
+
+	uint32_t capacity = registry.get_statistics().capacity;
+
+	BOOST_CHECK_GE(capacity, 100);
+
+	for (uint32_t i = 1; i <= capacity; i++)
+		BOOST_CHECK(registry.insert(make_entry(i)));
+
+	BOOST_CHECK(!registry.insert(make_entry(capacity + 1)));
+	BOOST_CHECK(!registry.upsert(make_entry(capacity + 1)));
+	// Existing sessions can still be replaced.
+	BOOST_CHECK(registry.upsert(make_entry(capacity, 'C')));
+
+	BOOST_CHECK(registry.erase(5));
+	BOOST_CHECK(registry.insert(make_entry(capacity + 1)));
+
+	for (uint32_t i = 1; i <= capacity + 1; i++)
+		BOOST_CHECK_EQUAL(registry.find(i, entry), i != 5);
+}
+
+BOOST_AUTO_TEST_CASE(SessionRegistryExpiryTest)
+{
+	SessionRegistry registry;
+	session_registry_entry entry;
+
+	registry.open_local(64);
+
+	for (uint32_t i = 1; i <= 40; i++)
+		BOOST_CHECK(registry.insert(make_entry(i, i % 2 ? 'C' : 'Z', i)));
+
+	BOOST_CHECK_EQUAL(registry.count('C'), 20);
+	BOOST_CHECK_EQUAL(registry.count('Z'), 20);
+	BOOST_CHECK_EQUAL(registry.count('A'), 0);
+
+	std::vector<uint32_t> expired = registry.expire('C', 21);
+
+	BOOST_CHECK_EQUAL(expired.size(), 10);
+	for (uint32_t id : expired)
+		BOOST_CHECK(id % 2 == 1 && id < 21);
+
+	BOOST_CHECK_EQUAL(registry.count('C'), 10);
+	BOOST_CHECK_EQUAL(registry.count('Z'), 20);
+
+	for (uint32_t i = 1; i <= 40; i++)
+		BOOST_CHECK_EQUAL(registry.find(i, entry), !(i % 2 == 1 && i < 21));
+
+	BOOST_CHECK_EQUAL(registry.get_statistics().expired, 10);
+}
+
+/**
+ * Removals shift entries back into the freed slots, every remaining entry must still be found.
+ */
+BOOST_AUTO_TEST_CASE(SessionRegistryChurnTest)
+{
+	SessionRegistry registry;
+	session_registry_entry entry;
+	std::map<uint32_t, char> expected;
+	std::mt19937 rng(7);
+
+	registry.open_local(256);
+
+	for (int op = 0; op < 20000; op++) {
+		uint32_t id = rng() % 1024 + 1;
+
+		if (rng() % 3 == 0) {
+			BOOST_CHECK_EQUAL(registry.erase(id), expected.erase(id) == 1);
+		} else if (expected.size() < 256 || expected.count(id)) {
+			char server = "ACZ"[rng() % 3];
+			BOOST_CHECK(registry.upsert(make_entry(id, server)));
+			expected[id] = server;
+		}
+	}
+
+	BOOST_CHECK_EQUAL(registry.get_statistics().size, expected.size());
+
+	for (uint32_t id = 1; id <= 1024; id++) {
+		bool found = registry.find(id, entry);
+
+		BOOST_CHECK_EQUAL(found, expected.count(id) == 1);
+
+		if (found)
+			BOOST_CHECK_EQUAL(entry.current_server, expected[id]);
+	}
+}
+
+BOOST_FIXTURE_TEST_CASE(SessionRegistrySharedTest, shared_registry_fixture)
+{
+	SessionRegistry auth, zone;
+	session_registry_entry entry;
+	bool created = false;
+
+	BOOST_CHECK(auth.open_shared(name, 32, &created));
+	BOOST_CHECK(created);
+	BOOST_CHECK(auth.is_shared());
+
+	// A second server opens the same registry, with the capacity it was created with.
+	BOOST_CHECK(zone.open_shared(name, 1024, &created));
+	BOOST_CHECK(!created);
+	BOOST_CHECK_EQUAL(zone.get_statistics().capacity, auth.get_statistics().capacity);
+
+	BOOST_CHECK(auth.insert(make_entry(42)));
+	BOOST_CHECK(zone.find(42, entry));
+	BOOST_CHECK_EQUAL(entry.auth_code, 42 * 7);
+
+	BOOST_CHECK(zone.set_current_server(42, 'Z'));
+	BOOST_CHECK(auth.find(42, entry));
+	BOOST_CHECK_EQUAL(entry.current_server, 'Z');
+}
+
+BOOST_FIXTURE_TEST_CASE(SessionRegistrySharedConcurrencyTest, shared_registry_fixture)
+{
+	SessionRegistry a, b;
+	session_registry_entry entry;
+
+	BOOST_CHECK(a.open_shared(name, 4096));
+	BOOST_CHECK(b.open_shared(name, 4096));
+
+	std::thread ta([&a] () {
+		for (uint32_t i = 0; i < 2000; i++)
+			a.insert(make_entry(i * 2 + 1));
+	});
+	std::thread tb([&b] () {
+		for (uint32_t i = 0; i < 2000; i++)
+			b.insert(make_entry(i * 2 + 2));
+	});
+
+	ta.join();
+	tb.join();
+
+	BOOST_CHECK_EQUAL(a.get_statistics().size, 4000);
+
+	for (uint32_t i = 1; i <= 4000; i++)
+		BOOST_CHECK(b.find(i, entry));
+}
+
+BOOST_FIXTURE_TEST_CASE(SessionRegistrySharedOpenRaceTest, shared_registry_fixture)
+{
+	// Servers starting together open the registry at once, whoever does not create it must find it sized.
+	for (int round = 0; round < 200; round++) {
+		SessionRegistry registries[2];
+		bool opened[2] = { false, false }, created[2] = { false, false };
+		std::atomic<int> ready{0};
+		std::vector<std::thread> openers;
+
+		SessionRegistry::remove(name);
+
+		for (int i = 0; i < 2; i++) {
+			openers.emplace_back([&, i] () {
+				ready.fetch_add(1);
+				while (ready.load() < 2)
+					;
+				opened[i] = registries[i].open_shared(name, 64, &created[i]);
+				if (opened[i])
+					registries[i].upsert(make_entry(i + 1));
+			});
+		}
+
+		for (std::thread &opener : openers)
+			opener.join();
+
+		BOOST_REQUIRE(opened[0] && opened[1]);
+		BOOST_CHECK(created[0] != created[1]);
+
+		for (int i = 0; i < 2; i++) {
+			session_registry_entry entry;
+			session_registry_statistics stats = registries[i].get_statistics();
+
+			BOOST_CHECK_GE(stats.capacity, 64);
+			BOOST_CHECK_EQUAL(stats.size, 2);
+			BOOST_CHECK(registries[i].find(1, entry) && entry.auth_code == 7);
+			BOOST_CHECK(registries[i].find(2, entry) && entry.auth_code == 14);
+		}
+	}
+}
+
+BOOST_FIXTURE_TEST_CASE(SessionRegistryCrossProcessTest, shared_registry_fixture)
+{
+	SessionRegistry parent;
+	session_registry_entry entry;
+
+	BOOST_CHECK(parent.open_shared(name, 64));
+
+	pid_t pid = fork();
+
+	if (pid == 0) {
+		SessionRegistry child;
+		_exit(child.open_shared(name, 64) && child.insert(make_entry(7, 'C')) ? 0 : 1);
+	}
+
+	int status = 0;
+
+	BOOST_REQUIRE(pid > 0);
+	BOOST_CHECK_EQUAL(waitpid(pid, &status, 0), pid);
+	BOOST_CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+	BOOST_CHECK(parent.find(7, entry));
+	BOOST_CHECK_EQUAL(entry.current_server, 'C');
+}
@@ -58,3 +58,121 @@ BOOST_AUTO_TEST_CASE(TaskSchedulingTest)
 		std::this_thread::sleep_for(std::chrono::milliseconds(diff));
 	}
 }
+
+BOOST_AUTO_TEST_CASE(TaskSchedulerMigrationTest)
+{
+	TaskScheduler source, target;
+	int source_runs = 0, target_runs = 0;
+	uint64_t moved_guid = 7, kept_guid = 8;
+
+	source.Schedule(Milliseconds(10), (moved_guid << 32) + 1, [&target_runs] (TaskContext context) {
+		// The context belongs to whichever scheduler ran the task.
+		context.Repeat(Milliseconds(10));
+		++target_runs;
+	});
+	source.Schedule(Milliseconds(10), (kept_guid << 32) + 1, [&source_runs] (TaskContext context) {
+		++source_runs;
+		context.Repeat(Milliseconds(10));
+	});
+	source.Schedule(Milliseconds(10), [&source_runs] (TaskContext /*context*/) { ++source_runs; });
+
+	TaskScheduler::TaskList tasks = source.ExtractGroupsIf([moved_guid] (uint64_t group) { return (group >> 32) == moved_guid; });
+
+	BOOST_CHECK_EQUAL(tasks.size(), 1);
+	BOOST_CHECK_EQUAL(source.Count((moved_guid << 32) + 1), 0);
+	BOOST_CHECK_EQUAL(source.Count((kept_guid << 32) + 1), 1);
+
+	target.InsertTasks(std::move(tasks));
+
+	BOOST_CHECK_EQUAL(target.Count((moved_guid << 32) + 1), 1);
+
+	for (int i = 0; i < 3; i++) {
+		source.Update(Milliseconds(10));
+		target.Update(Milliseconds(10));
+	}
+
+	BOOST_CHECK_EQUAL(target_runs, 3);
+	BOOST_CHECK_EQUAL(source_runs, 4);
+	BOOST_CHECK_EQUAL(target.Count((moved_guid << 32) + 1), 1);
+	BOOST_CHECK_EQUAL(source.Count((moved_guid << 32) + 1), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TaskSchedulerWheelTest)
+{
+	TaskScheduler scheduler;
+	std::vector<int> order;
+
+	// Delays spread over every wheel level and the overflow bucket.
+	scheduler.Schedule(Hours(24 * 30), 4, [&order] (TaskContext) { order.push_back(4); });
+	scheduler.Schedule(Hours(2), 3, [&order] (TaskContext) { order.push_back(3); });
+	scheduler.Schedule(Seconds(30), 2, [&order] (TaskContext) { order.push_back(2); });
+	scheduler.Schedule(Milliseconds(40), 1, [&order] (TaskContext) { order.push_back(1); });
+	scheduler.Schedule(Microseconds(1500), 1, [&order] (TaskContext context) {
+		order.push_back(0);
+		// Regrouping a repeated task moves it within the group index.
+		context.Repeat(Milliseconds(10));
+		context.SetGroup(5);
+	});
+
+	BOOST_CHECK_EQUAL(scheduler.Count(1), 2);
+
+	scheduler.Update(Microseconds(1000));
+	BOOST_CHECK(order.empty());
+
+	scheduler.Update(Microseconds(500));
+	BOOST_CHECK_EQUAL(order.size(), 1);
+	BOOST_CHECK_EQUAL(scheduler.Count(1), 1);
+	BOOST_CHECK_EQUAL(scheduler.Count(5), 1);
+
+	scheduler.CancelGroup(5);
+	scheduler.DelayGroup(2, Hours(1));
+	scheduler.Update(Minutes(59));
+
+	BOOST_CHECK_EQUAL(order.size(), 2);
+	BOOST_CHECK_EQUAL(order.back(), 1);
+
+	scheduler.Update(Hours(24 * 31));
+
+	BOOST_CHECK((order == std::vector<int>{ 0, 1, 2, 3, 4 }));
+	BOOST_CHECK_EQUAL(scheduler.Count(2), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TaskSchedulerBenchmark)
+{
+	int const task_count = 100000, groups = 1000, ticks = 2000, tick_ms = 5;
+	TaskScheduler scheduler;
+	uint64_t runs = 0, expected_runs = 0;
+
+	// Recurring tasks of 1000 entities with intervals between 10ms and 1s.
+	for (int i = 0; i < task_count; i++) {
+		int interval = 10 + (i % 100) * 10;
+		expected_runs += (ticks * tick_ms) / interval;
+		scheduler.Schedule(Milliseconds(interval), (uint64_t) (i % groups), [&runs, interval] (TaskContext context) {
+			++runs;
+			context.Repeat(Milliseconds(interval));
+		});
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < ticks; i++)
+		scheduler.Update(Milliseconds(tick_ms));
+
+	std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+
+	printf("%d recurring tasks, %d updates: %lld us per update, %llu runs.\n", task_count, ticks,
+		(long long) std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() / ticks, (unsigned long long) runs);
+
+	BOOST_CHECK_EQUAL(runs, expected_runs);
+	BOOST_CHECK_EQUAL(scheduler.Count(0), task_count / groups);
+
+	start = std::chrono::steady_clock::now();
+
+	for (int g = 0; g < groups; g++)
+		scheduler.CancelGroup(g);
+
+	printf("Cancelled %d groups in %lld us.\n", groups,
+		(long long) std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+
+	BOOST_CHECK_EQUAL(scheduler.Count(0), 0);
+}
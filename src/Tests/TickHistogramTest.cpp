@@ -0,0 +1,73 @@
+/***************************************************
+ *       _   _            _                        *
+ *      | | | |          (_)                       *
+ *      | |_| | ___  _ __ _ _______  _ __          *
+ *      |  _  |/ _ \| '__| |_  / _ \| '_  \        *
+ *      | | | | (_) | |  | |/ / (_) | | | |        *
+ *      \_| |_/\___/|_|  |_/___\___/|_| |_|        *
+ ***************************************************
+ * This file is part of Horizon (c).
+ *
+ * Copyright (c) 2019 Sagun K. (sagunxp@gmail.com).
+ * Copyright (c) 2019 Horizon Dev Team.
+ *
+ * Base Author - Sagun Khosla <sagunxp@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ **************************************************/
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "TickHistogramTest"
+
+#include "Utility/TickHistogram.hpp"
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE(TickHistogramPercentileTest)
+{
+	TickHistogram histogram;
+
+	BOOST_CHECK_EQUAL(histogram.percentile(50), 0);
+
+	// 1..1000 microseconds, once each.
+	for (uint64_t us = 1; us <= 1000; us++)
+		histogram.record(us);
+
+	BOOST_CHECK_EQUAL(histogram.count(), 1000);
+	BOOST_CHECK_EQUAL(histogram.max(), 1000);
+
+	// Percentiles are reported as bucket upper bounds, within 12.5% of the exact value.
+	uint64_t p50 = histogram.percentile(50), p99 = histogram.percentile(99);
+
+	BOOST_CHECK(p50 >= 500 && p50 <= 500 * 1.125);
+	BOOST_CHECK(p99 >= 990 && p99 <= 1000);
+	BOOST_CHECK_EQUAL(histogram.percentile(100), 1000);
+
+	histogram.reset();
+
+	BOOST_CHECK_EQUAL(histogram.count(), 0);
+	BOOST_CHECK_EQUAL(histogram.max(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TickHistogramRangeTest)
+{
+	TickHistogram histogram;
+
+	// Small values are exact, huge ones are clamped to the last bucket but still counted in max.
+	histogram.record(3);
+	BOOST_CHECK_EQUAL(histogram.percentile(50), 3);
+
+	histogram.record(uint64_t(1) << 40);
+	BOOST_CHECK_EQUAL(histogram.percentile(100), uint64_t(1) << 40);
+	BOOST_CHECK_EQUAL(histogram.count(), 2);
+}
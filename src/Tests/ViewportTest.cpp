@@ -0,0 +1,82 @@
+/***************************************************
+ *       _   _            _                        *
+ *      | | | |          (_)                       *
+ *      | |_| | ___  _ __ _ _______  _ __          *
+ *      |  _  |/ _ \| '__| |_  / _ \| '_  \        *
+ *      | | | | (_) | |  | |/ / (_) | | | |        *
+ *      \_| |_/\___/|_|  |_/___\___/|_| |_|        *
+ ***************************************************
+ * This file is part of Horizon (c).
+ *
+ * Copyright (c) 2019 Sagun K. (sagunxp@gmail.com).
+ * Copyright (c) 2019 Horizon Dev Team.
+ *
+ * Base Author - Sagun K. (sagunxp@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ **************************************************/
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "ViewportTest"
+
+#include <boost/test/unit_test.hpp>
+#include <cstdint>
+#include <random>
+#include <set>
+
+#include "Server/Zone/Game/Entities/Player/Viewport.hpp"
+
+using namespace Horizon::Zone;
+
+BOOST_AUTO_TEST_CASE(ViewportMembershipTest)
+{
+	Viewport viewport;
+
+	BOOST_CHECK(viewport.insert(110000005));
+	BOOST_CHECK(viewport.insert(150000));
+	BOOST_CHECK(viewport.insert(2000001));
+	BOOST_CHECK(!viewport.insert(150000));
+	BOOST_CHECK_EQUAL(viewport.size(), 3);
+
+	BOOST_CHECK(viewport.contains(2000001));
+	BOOST_CHECK(!viewport.contains(2000002));
+
+	BOOST_CHECK(viewport.erase(150000));
+	BOOST_CHECK(!viewport.erase(150000));
+	BOOST_CHECK(!viewport.contains(150000));
+
+	viewport.clear();
+	BOOST_CHECK_EQUAL(viewport.size(), 0);
+	BOOST_CHECK(!viewport.contains(110000005));
+}
+
+BOOST_AUTO_TEST_CASE(ViewportChurnTest)
+{
+	Viewport viewport;
+	std::set<uint32_t> reference;
+	std::mt19937 rng(25);
+
+	// Entities walking in and out of view, the viewport must stay sorted and agree with a reference set.
+	for (int i = 0; i < 100000; ++i) {
+		uint32_t guid = 150000 + rng() % 512;
+
+		if (rng() % 2)
+			BOOST_REQUIRE_EQUAL(viewport.insert(guid), reference.insert(guid).second);
+		else
+			BOOST_REQUIRE_EQUAL(viewport.erase(guid), reference.erase(guid) == 1);
+	}
+
+	BOOST_CHECK_EQUAL(viewport.size(), reference.size());
+	BOOST_CHECK(std::equal(viewport.guids().begin(), viewport.guids().end(), reference.begin(), reference.end()));
+}
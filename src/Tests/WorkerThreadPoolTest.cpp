@@ -32,10 +32,16 @@
 
 #include "Core/Multithreading/WorkerThreadPool.hpp"
 #include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <chrono>
 #include <cstring>
+#include <ctime>
 #include <thread>
 #include <cstdio>
 #include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
 
 int work_1(int num = 10)
 {
@@ -53,3 +59,187 @@ BOOST_AUTO_TEST_CASE(WorkerThreadPoolTest)
 		func(29);
 	}
 }
+
+BOOST_AUTO_TEST_CASE(WorkStealingDequeTest)
+{
+	WorkStealingDeque<int *> deque(2);
+	std::vector<int> values(1000);
+	int *value = nullptr;
+
+	// Owner pushes past the initial capacity and pops newest first.
+	for (auto &v : values)
+		deque.push(&v);
+
+	BOOST_CHECK_EQUAL(deque.size(), 1000);
+	BOOST_CHECK(deque.pop(value) && value == &values[999]);
+	BOOST_CHECK(deque.steal(value) && value == &values[0]);
+
+	// Thieves and the owner never take the same element twice.
+	std::atomic<int> taken{0};
+	std::vector<std::thread> thieves;
+
+	for (int t = 0; t < 3; t++) {
+		thieves.emplace_back([&deque, &taken] () {
+			int *v = nullptr;
+
+			while (!deque.empty())
+				if (deque.steal(v))
+					(*v)++, taken++;
+		});
+	}
+
+	while (deque.pop(value))
+		(*value)++, taken++;
+
+	for (auto &thief : thieves)
+		thief.join();
+
+	BOOST_CHECK_EQUAL(taken.load(), 998);
+
+	for (int i = 1; i < 999; i++)
+		BOOST_CHECK_EQUAL(values[i], 1);
+}
+
+BOOST_AUTO_TEST_CASE(WorkerThreadPoolSubmitTest)
+{
+	WorkerThreadPool pool(4);
+	std::vector<std::future<int>> results;
+
+	for (int i = 0; i < 1000; i++)
+		results.push_back(pool.submit([i] () { return i * 2; }));
+
+	for (int i = 0; i < 1000; i++)
+		BOOST_CHECK_EQUAL(results[i].get(), i * 2);
+
+	// Tasks submitted from a worker land on its own deque and can be stolen by the others.
+	std::future<int> nested = pool.submit([&pool] () {
+		std::vector<std::future<int>> inner;
+
+		for (int i = 0; i < 100; i++)
+			inner.push_back(pool.submit([i] () { return i; }));
+
+		int sum = 0;
+
+		for (auto &f : inner)
+			sum += f.get();
+
+		return sum;
+	});
+
+	BOOST_CHECK_EQUAL(nested.get(), 4950);
+
+	std::future<void> failing = pool.submit([] () { throw std::runtime_error("failed"); });
+	BOOST_CHECK_THROW(failing.get(), std::runtime_error);
+
+	worker_thread_pool_statistics stats = pool.get_statistics();
+
+	BOOST_CHECK_EQUAL(stats.submitted, 1102);
+	BOOST_CHECK_EQUAL(stats.queue_depth, 0);
+}
+
+BOOST_AUTO_TEST_CASE(WorkerThreadPoolParallelForTest)
+{
+	WorkerThreadPool pool(4);
+	std::vector<int> values(100000, 0);
+
+	pool.parallel_for<std::size_t>(0, values.size(), [&values] (std::size_t i) { values[i] += (int) i % 7; });
+
+	long expected = 0;
+
+	for (std::size_t i = 0; i < values.size(); i++)
+		expected += i % 7;
+
+	BOOST_CHECK_EQUAL(std::accumulate(values.begin(), values.end(), 0L), expected);
+
+	// Every index is visited exactly once whatever the grain.
+	for (int grain : { 1, 3, 1000, 200000 }) {
+		std::vector<std::atomic<int>> visits(10007);
+
+		pool.parallel_for<int>(0, (int) visits.size(), [&visits] (int i) { visits[i]++; }, grain);
+
+		for (auto &v : visits)
+			BOOST_CHECK_EQUAL(v.load(), 1);
+	}
+
+	// Nested in a task, the worker helps instead of blocking.
+	std::future<long> nested = pool.submit([&pool] () {
+		std::atomic<long> sum{0};
+		pool.parallel_for<int>(0, 1000, [&sum] (int i) { sum += i; });
+		return sum.load();
+	});
+
+	BOOST_CHECK_EQUAL(nested.get(), 499500);
+
+	BOOST_CHECK_THROW(pool.parallel_for<int>(0, 1000, [] (int i) { if (i == 500) throw std::runtime_error("failed"); }), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(WorkerThreadPoolThroughputBenchmark)
+{
+	unsigned const threads = std::max(std::thread::hardware_concurrency(), 2u);
+	int const tasks = 200000;
+
+	{
+		WorkerThreadPool pool(threads);
+		std::atomic<int> done{0};
+		std::vector<std::future<void>> results;
+
+		results.reserve(tasks);
+
+		auto start_time = std::chrono::high_resolution_clock::now();
+
+		for (int i = 0; i < tasks; i++)
+			results.push_back(pool.submit([&done] () { done++; }));
+
+		for (auto &r : results)
+			r.wait();
+
+		std::chrono::duration<double, std::micro> elapsed = std::chrono::high_resolution_clock::now() - start_time;
+		worker_thread_pool_statistics stats = pool.get_statistics();
+
+		BOOST_CHECK_EQUAL(done.load(), tasks);
+
+		printf("WorkerThreadPool (%u threads): %d external tasks in %.2fms, %.0f tasks/s, %llu steals, %llu parks.\n",
+			threads, tasks, elapsed.count() / 1000, tasks / (elapsed.count() / 1000000),
+			(unsigned long long) stats.steals, (unsigned long long) stats.parks);
+	}
+
+	{
+		WorkerThreadPool pool(threads);
+		std::atomic<long> sum{0};
+
+		auto start_time = std::chrono::high_resolution_clock::now();
+
+		pool.parallel_for<int>(0, tasks * 50, [&sum] (int i) { if (i % 1000 == 0) sum++; }, 1000);
+
+		std::chrono::duration<double, std::micro> elapsed = std::chrono::high_resolution_clock::now() - start_time;
+		worker_thread_pool_statistics stats = pool.get_statistics();
+
+		BOOST_CHECK_EQUAL(sum.load(), tasks * 50 / 1000);
+
+		printf("WorkerThreadPool (%u threads): parallel_for over %d indices in %.2fms, %llu steals.\n",
+			threads, tasks * 50, elapsed.count() / 1000, (unsigned long long) stats.steals);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(WorkerThreadPoolIdleBenchmark)
+{
+	unsigned const threads = std::max(std::thread::hardware_concurrency(), 2u);
+	WorkerThreadPool pool(threads);
+
+	pool.submit([] () { }).wait();
+
+	// Idle workers park instead of spinning.
+	std::clock_t const cpu_start = std::clock();
+	auto start_time = std::chrono::steady_clock::now();
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+	double const cpu_seconds = (double) (std::clock() - cpu_start) / CLOCKS_PER_SEC;
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+
+	printf("WorkerThreadPool (%u threads): %.1f%% of a core used while idle for %.2fs, %llu parks.\n",
+		threads, 100 * cpu_seconds / elapsed.count(), elapsed.count(), (unsigned long long) pool.get_statistics().parks);
+
+	BOOST_CHECK_LT(cpu_seconds, elapsed.count() * 0.5);
+	BOOST_CHECK_GE(pool.get_statistics().parks, 1);
+}
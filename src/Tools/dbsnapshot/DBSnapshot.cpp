@@ -0,0 +1,167 @@
+/***************************************************
+ *       _   _            _                        *
+ *      | | | |          (_)                       *
+ *      | |_| | ___  _ __ _ _______  _ __          *
+ *      |  _  |/ _ \| '__| |_  / _ \| '_  \        *
+ *      | | | | (_) | |  | |/ / (_) | | | |        *
+ *      \_| |_/\___/|_|  |_/___\___/|_| |_|        *
+ ***************************************************
+ * This file is part of Horizon (c).
+ *
+ * Copyright (c) 2019 Sagun K. (sagunxp@gmail.com).
+ * Copyright (c) 2019 Horizon Dev Team.
+ *
+ * Base Author - Sagun K. (sagunxp@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ **************************************************/
+
+#include "DBSnapshot.hpp"
+#include <signal.h>
+
+#include <boost/algorithm/string.hpp>
+#include <ctime>
+
+Horizon::Tools::DBSnapshot::DBSnapshot()
+{
+
+}
+
+Horizon::Tools::DBSnapshot::~DBSnapshot()
+{
+
+}
+
+void Horizon::Tools::DBSnapshot::parse_exec_args(int argc, const char *argv[])
+{
+	for (int i = 1; i < argc; ++i) {
+		std::string arg(argv[i]);
+		std::vector<std::string> arg_parts;
+		boost::split(arg_parts, arg, boost::is_any_of("="));
+
+		if (arg_parts.at(0).compare("--input") == 0 && arg_parts.size() > 1) {
+			_snapshot_path = arg_parts.at(1);
+		} else if (arg_parts.at(0).compare("--verbose") == 0) {
+			_verbose = true;
+		} else if (arg_parts.at(0).compare("--invalidate") == 0) {
+			_invalidate = true;
+		} else {
+			printf("Unrecognised argument '%s'\n", arg.c_str());
+		}
+	}
+}
+
+void Horizon::Tools::DBSnapshot::PrintHeader()
+{
+	dbsnapshot_header const &header = getLibrary().getHeader();
+
+	printf("Info: Snapshot version %u, %llu bytes, checksum %08x.\n", header.version, (unsigned long long) header.file_size, header.checksum);
+	printf("Info: Snapshot has %u section(s) compiled from %u source file(s).\n", header.section_count, header.source_count);
+}
+
+void Horizon::Tools::DBSnapshot::PrintSections()
+{
+	dbsnapshot_header const &header = getLibrary().getHeader();
+
+	for (uint32_t i = 0; i < header.section_count; ++i) {
+		dbsnapshot_section const &s = getLibrary().getSections()[i];
+		printf("Info: Section '%s': %u record(s) of %u bytes (layout %u) at offset %llu.\n", s.name, s.record_count, s.record_size, s.layout, (unsigned long long) s.offset);
+	}
+}
+
+bool Horizon::Tools::DBSnapshot::PrintSources()
+{
+	dbsnapshot_header const &header = getLibrary().getHeader();
+	bool current = true;
+
+	for (uint32_t i = 0; i < header.source_count; ++i) {
+		dbsnapshot_source const &source = getLibrary().getSources()[i];
+		uint64_t size = 0;
+		uint32_t checksum = 0;
+
+		if (!Horizon::Libraries::DBSnapshotFileChecksum(source.path, size, checksum)) {
+			printf("Error: Source '%s' could not be read.\n", source.path);
+			current = false;
+		} else if (size != source.size || checksum != source.checksum) {
+			printf("Error: Source '%s' changed since the snapshot was compiled (%llu bytes, checksum %08x, was %llu bytes, checksum %08x).\n",
+				   source.path, (unsigned long long) size, checksum, (unsigned long long) source.size, source.checksum);
+			current = false;
+		} else if (isVerbose()) {
+			std::time_t mtime = source.mtime;
+			printf("Info: Source '%s' is current (%llu bytes, checksum %08x, modified %s).\n",
+				   source.path, (unsigned long long) size, checksum, boost::trim_copy(std::string(std::ctime(&mtime))).c_str());
+		}
+	}
+
+	return current;
+}
+
+bool Horizon::Tools::DBSnapshot::Invalidate()
+{
+	boost::system::error_code ec;
+
+	boost::filesystem::remove(getSnapshotPath(), ec);
+
+	if (ec) {
+		printf("Error: Could not remove '%s': %s.\n", getSnapshotPath().c_str(), ec.message().c_str());
+		return false;
+	}
+
+	printf("Info: Removed '%s', the zone server will recompile it from the Lua databases on its next start.\n", getSnapshotPath().c_str());
+	return true;
+}
+
+/**
+ * Main Runtime Method
+ * @param argc
+ * @param argv
+ * @return 0 if the snapshot is valid and current, 1 if it is invalid and 2 if it is stale.
+ */
+int main(int argc, const char * argv[])
+{
+	printf("     _   _            _\n");
+	printf("    | | | |          (_)\n");
+	printf("    | |_| | ___  _ __ _ _______  _ __\n");
+	printf("    |  _  |/ _ \\| '__| |_  / _ \\| '_  \\\n");
+	printf("    | | | | (_) | |  | |/ / (_) | | | |\n");
+	printf("    \\_| |_/\\___/|_|  |_/___\\___/|_| |_|\n\n");
+	printf("     Horizon Static Database Snapshot \n\n");
+
+	Horizon::Tools::DBSnapshot s;
+
+	s.parse_exec_args(argc, argv);
+
+	printf("Info: Snapshot file set to '%s'\n", s.getSnapshotPath().c_str());
+
+	if (s.shouldInvalidate())
+		return s.Invalidate() ? 0 : 1;
+
+	dbsnapshot_error_type result = s.getLibrary().Open(s.getSnapshotPath());
+
+	if (result != DBSNAPSHOT_OK) {
+		printf("Error: Could not open '%s': %s.\n", s.getSnapshotPath().c_str(), Horizon::Libraries::DBSnapshot::ErrorString(result));
+		return 1;
+	}
+
+	s.PrintHeader();
+	s.PrintSections();
+
+	if (!s.PrintSources()) {
+		printf("Info: Snapshot is stale, the zone server will fall back to the Lua databases and recompile it.\n");
+		return 2;
+	}
+
+	printf("Info: Snapshot is valid and current.\n");
+	return 0;
+}
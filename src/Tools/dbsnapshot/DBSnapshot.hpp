@@ -0,0 +1,81 @@
+/***************************************************
+ *       _   _            _                        *
+ *      | | | |          (_)                       *
+ *      | |_| | ___  _ __ _ _______  _ __          *
+ *      |  _  |/ _ \| '__| |_  / _ \| '_  \        *
+ *      | | | | (_) | |  | |/ / (_) | | | |        *
+ *      \_| |_/\___/|_|  |_/___\___/|_| |_|        *
+ ***************************************************
+ * This file is part of Horizon (c).
+ *
+ * Copyright (c) 2019 Sagun K. (sagunxp@gmail.com).
+ * Copyright (c) 2019 Horizon Dev Team.
+ *
+ * Base Author - Sagun K. (sagunxp@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ **************************************************/
+
+#ifndef HORIZON_TOOLS_DBSNAPSHOT_HPP
+#define HORIZON_TOOLS_DBSNAPSHOT_HPP
+
+#include "Libraries/DBSnapshot/DBSnapshot.hpp"
+
+#include <cstdint>
+#include <string>
+
+namespace Horizon
+{
+namespace Tools
+{
+/**
+ * Inspects and verifies the static database snapshots compiled by the zone server.
+ * The zone server compiles them from the Lua databases and recompiles them whenever a source changes.
+ */
+class DBSnapshot
+{
+public:
+	DBSnapshot();
+	~DBSnapshot();
+
+	void parse_exec_args(int argc, const char *argv[]);
+
+	void PrintHeader();
+	void PrintSections();
+	/**
+	 * @brief Prints the state of every source file.
+	 * @return false if any of them changed since the snapshot was compiled.
+	 */
+	bool PrintSources();
+
+	/**
+	 * @brief Removes the snapshot so that the zone recompiles it from the Lua databases on its next start.
+	 */
+	bool Invalidate();
+
+	std::string const &getSnapshotPath() { return _snapshot_path; }
+	bool isVerbose() { return _verbose; }
+	bool shouldInvalidate() { return _invalidate; }
+
+	Horizon::Libraries::DBSnapshot &getLibrary() { return _snapshot; }
+private:
+	Horizon::Libraries::DBSnapshot _snapshot;
+	std::string _snapshot_path{"db/snapshots/monster_db.snapshot"};
+	bool _verbose{false};
+	bool _invalidate{false};
+};
+}
+}
+
+#endif // HORIZON_TOOLS_DBSNAPSHOT_HPP
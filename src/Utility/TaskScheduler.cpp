@@ -16,6 +16,8 @@
 
 #include "TaskScheduler.hpp"
 
+#include <algorithm>
+
 TaskScheduler& TaskScheduler::ClearValidator()
 {
 	_predicate = EmptyValidator;
@@ -50,9 +52,7 @@ TaskScheduler& TaskScheduler::CancelAll()
 
 TaskScheduler& TaskScheduler::CancelGroup(group_t const group)
 {
-	_task_holder.RemoveIf(
-		[group] (TaskContainer const &task) -> bool
-		{ return task->IsInGroup(group); });
+	_task_holder.RemoveGroup(group);
 	return *this;
 }
 
@@ -64,6 +64,24 @@ TaskScheduler& TaskScheduler::CancelGroupsOf(std::vector<group_t> const& groups)
 	return *this;
 }
 
+TaskScheduler::TaskList TaskScheduler::ExtractGroupsIf(std::function<bool(group_t)> const& filter)
+{
+	TaskList extracted;
+
+	_task_holder.ExtractGroupsIf(filter, extracted);
+
+	return extracted;
+}
+
+TaskScheduler& TaskScheduler::InsertTasks(TaskList&& tasks)
+{
+	for (TaskContainer &task : tasks)
+		_task_holder.Push(std::move(task));
+
+	tasks.clear();
+	return *this;
+}
+
 TaskScheduler& TaskScheduler::InsertTask(TaskContainer task)
 {
 	_task_holder.Push(std::move(task));
@@ -92,14 +110,11 @@ void TaskScheduler::Dispatch(success_t const& callback)
 			return;
 	}
 
-	while (!_task_holder.IsEmpty())
+	while (TaskContainer task = _task_holder.PopDue(_now))
 	{
-		if (_task_holder.First()->_end > _now)
-			break;
-
 		// Perfect forward the context to the handler
 		// Use weak references to catch destruction before callbacks.
-		TaskContext context(_task_holder.Pop(), std::weak_ptr<TaskScheduler>(self_reference));
+		TaskContext context(std::move(task), std::weak_ptr<TaskScheduler>(self_reference));
 
 		// Invoke the context
 		context.Invoke();
@@ -113,70 +128,380 @@ void TaskScheduler::Dispatch(success_t const& callback)
 	callback();
 }
 
+TaskScheduler::TaskQueue::TaskQueue(timepoint_t const& now)
+: _current(TickOf(now)), _drained_until(now)
+{
+	_level_count.fill(0);
+}
+
+TaskScheduler::TaskQueue::~TaskQueue()
+{
+	Clear();
+}
+
+uint64_t TaskScheduler::TaskQueue::TickOf(timepoint_t const& time)
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+}
+
 void TaskScheduler::TaskQueue::Push(TaskContainer&& task)
 {
-	container.insert(task);
+	Task *t = task.get();
+
+	// A task can only be queued once.
+	if (t->_queued != nullptr)
+		return;
+
+	t->_queued = std::move(task);
+	++_size;
+
+	if (t->_grouped)
+		LinkGroup(t);
+
+	Place(t);
 }
 
-auto TaskScheduler::TaskQueue::Pop()
+auto TaskScheduler::TaskQueue::PopDue(timepoint_t const& now)
 -> TaskContainer
 {
-	TaskContainer result = *container.begin();
-	container.erase(container.begin());
-	return result;
+	Advance(now);
+
+	Task *task = _buckets[DUE_BUCKET].head;
+
+	if (task == nullptr || task->_end > now)
+		return nullptr;
+
+	return Unlink(task);
 }
 
-auto TaskScheduler::TaskQueue::First() const
--> TaskContainer const&
+void TaskScheduler::TaskQueue::Clear()
 {
-	return *container.begin();
+	// Release the tasks after the queue was reset, destroying a handler must not observe a half-cleared queue.
+	std::vector<TaskContainer> released;
+	released.reserve(_size);
+
+	for (Bucket &bucket : _buckets) {
+		for (Task *task = bucket.head; task != nullptr;) {
+			Task *next = task->_next;
+			task->_prev = task->_next = nullptr;
+			task->_group_prev = task->_group_next = nullptr;
+			released.push_back(std::move(task->_queued));
+			task = next;
+		}
+		bucket = Bucket();
+	}
+
+	_level_count.fill(0);
+	_groups.clear();
+	_empty_groups = 0;
+	_size = 0;
 }
 
-void TaskScheduler::TaskQueue::Clear()
+void TaskScheduler::TaskQueue::RemoveGroup(group_t const group)
 {
-	container.clear();
+	auto it = _groups.find(group);
+
+	if (it == _groups.end())
+		return;
+
+	while (it->second.head != nullptr)
+		Unlink(it->second.head);
 }
 
-std::size_t TaskScheduler::TaskQueue::Count(group_t const &group)
+void TaskScheduler::TaskQueue::ModifyIf(std::function<bool(Task&)> const& modifier)
 {
-	std::size_t count = 0;
+	std::vector<Task*> modified;
+
+	for (Bucket &bucket : _buckets) {
+		for (Task *task = bucket.head; task != nullptr;) {
+			Task *next = task->_next;
+			if (modifier(*task)) {
+				UnlinkBucket(task);
+				modified.push_back(task);
+			}
+			task = next;
+		}
+	}
+
+	for (Task *task : modified)
+		Place(task);
+}
+
+void TaskScheduler::TaskQueue::ModifyGroup(group_t const group, std::function<void(Task&)> const& modifier)
+{
+	auto it = _groups.find(group);
+
+	if (it == _groups.end())
+		return;
 
-	for (std::multiset<TaskContainer, Compare>::iterator it = container.begin();
-		 it != container.end(); it++) {
-		if ((*it)->IsInGroup(group))
-			count++;
+	// Re-bucketing does not touch the group links, the group list can be walked safely.
+	for (Task *task = it->second.head; task != nullptr; task = task->_group_next) {
+		modifier(*task);
+		UnlinkBucket(task);
+		Place(task);
 	}
+}
 
-	return count;
+void TaskScheduler::TaskQueue::ExtractGroupsIf(std::function<bool(group_t)> const& filter, std::vector<TaskContainer>& extracted)
+{
+	for (auto &entry : _groups) {
+		if (entry.second.count == 0 || !filter(entry.first))
+			continue;
+
+		while (entry.second.head != nullptr)
+			extracted.push_back(Unlink(entry.second.head));
+	}
 }
 
-void TaskScheduler::TaskQueue::RemoveIf(std::function<bool(TaskContainer const&)> const& filter)
+void TaskScheduler::TaskQueue::Regroup(Task& task, bool const grouped, group_t const group)
 {
-	for (auto itr = container.begin(); itr != container.end();)
-		if (filter(*itr))
-			itr = container.erase(itr);
-		else
-			++itr;
+	if (task._grouped)
+		UnlinkGroup(&task);
+
+	task._grouped = grouped;
+	task._group = group;
+
+	if (task._grouped)
+		LinkGroup(&task);
 }
 
-void TaskScheduler::TaskQueue::ModifyIf(std::function<bool(TaskContainer const&)> const& filter)
+std::size_t TaskScheduler::TaskQueue::Count(group_t const &group) const
+{
+	auto it = _groups.find(group);
+	return it != _groups.end() ? it->second.count : 0;
+}
+
+bool TaskScheduler::TaskQueue::IsEmpty() const
 {
-	std::vector<TaskContainer> cache;
-	for (auto itr = container.begin(); itr != container.end();)
-		if (filter(*itr))
-		{
-			cache.push_back(*itr);
-			itr = container.erase(itr);
+	return _size == 0;
+}
+
+void TaskScheduler::TaskQueue::Place(Task* task)
+{
+	// Everything in the wheel must be due after _drained_until, which also guarantees its tick is not behind _current.
+	if (task->_end <= _drained_until)
+		PlaceDue(task);
+	else
+		PlaceWheel(task);
+}
+
+void TaskScheduler::TaskQueue::PlaceDue(Task* task)
+{
+	// Keep the due list ordered by end, equal ends keep their insertion order.
+	// Tasks mostly arrive in order so the search from the tail is short.
+	Task *after = _buckets[DUE_BUCKET].tail;
+
+	while (after != nullptr && after->_end > task->_end)
+		after = after->_prev;
+
+	LinkBucket(task, DUE_BUCKET, after);
+}
+
+void TaskScheduler::TaskQueue::PlaceWheel(Task* task)
+{
+	uint64_t const tick = TickOf(task->_end);
+	uint64_t const delta = tick - _current;
+
+	for (std::size_t level = 0; level < WHEEL_LEVELS; ++level) {
+		if (delta < (uint64_t(1) << ((level + 1) * WHEEL_BITS))) {
+			std::size_t const bucket = level * WHEEL_SLOTS + ((tick >> (level * WHEEL_BITS)) & WHEEL_MASK);
+			LinkBucket(task, bucket, _buckets[bucket].tail);
+			return;
 		}
-		else
-			++itr;
+	}
 
-	container.insert(cache.begin(), cache.end());
+	LinkBucket(task, OVERFLOW_BUCKET, _buckets[OVERFLOW_BUCKET].tail);
 }
 
-bool TaskScheduler::TaskQueue::IsEmpty() const
+void TaskScheduler::TaskQueue::LinkBucket(Task* task, std::size_t bucket, Task* after)
 {
-	return container.empty();
+	Bucket &b = _buckets[bucket];
+
+	task->_bucket = bucket;
+	task->_prev = after;
+	task->_next = after != nullptr ? after->_next : b.head;
+
+	if (task->_prev != nullptr)
+		task->_prev->_next = task;
+	else
+		b.head = task;
+
+	if (task->_next != nullptr)
+		task->_next->_prev = task;
+	else
+		b.tail = task;
+
+	if (bucket < DUE_BUCKET)
+		++_level_count[bucket / WHEEL_SLOTS];
+}
+
+void TaskScheduler::TaskQueue::UnlinkBucket(Task* task)
+{
+	Bucket &b = _buckets[task->_bucket];
+
+	if (task->_prev != nullptr)
+		task->_prev->_next = task->_next;
+	else
+		b.head = task->_next;
+
+	if (task->_next != nullptr)
+		task->_next->_prev = task->_prev;
+	else
+		b.tail = task->_prev;
+
+	task->_prev = task->_next = nullptr;
+
+	if (task->_bucket < DUE_BUCKET)
+		--_level_count[task->_bucket / WHEEL_SLOTS];
+}
+
+void TaskScheduler::TaskQueue::LinkGroup(Task* task)
+{
+	auto result = _groups.emplace(task->_group, Group());
+	Group &group = result.first->second;
+
+	if (!result.second && group.count == 0)
+		--_empty_groups;
+
+	task->_group_prev = nullptr;
+	task->_group_next = group.head;
+
+	if (group.head != nullptr)
+		group.head->_group_prev = task;
+
+	group.head = task;
+	++group.count;
+}
+
+void TaskScheduler::TaskQueue::UnlinkGroup(Task* task)
+{
+	Group &group = _groups[task->_group];
+
+	if (task->_group_prev != nullptr)
+		task->_group_prev->_group_next = task->_group_next;
+	else
+		group.head = task->_group_next;
+
+	if (task->_group_next != nullptr)
+		task->_group_next->_group_prev = task->_group_prev;
+
+	task->_group_prev = task->_group_next = nullptr;
+
+	// Emptied entries are kept around for a while, repeating tasks re-enter their group right away.
+	if (--group.count == 0)
+		++_empty_groups;
+}
+
+auto TaskScheduler::TaskQueue::Unlink(Task* task)
+-> TaskContainer
+{
+	UnlinkBucket(task);
+
+	if (task->_grouped)
+		UnlinkGroup(task);
+
+	--_size;
+	return std::move(task->_queued);
+}
+
+void TaskScheduler::TaskQueue::Advance(timepoint_t const& now)
+{
+	if (now <= _drained_until)
+		return;
+
+	uint64_t const target = TickOf(now);
+
+	while (_current < target) {
+		// Every task of the current slot is due, the slot only holds tasks of this very tick.
+		Bucket &slot = _buckets[_current & WHEEL_MASK];
+		while (slot.head != nullptr) {
+			Task *task = slot.head;
+			UnlinkBucket(task);
+			PlaceDue(task);
+		}
+
+		Step(target);
+	}
+
+	// Tasks of the target tick are only due up to the exact time point.
+	for (Task *task = _buckets[_current & WHEEL_MASK].head; task != nullptr;) {
+		Task *next = task->_next;
+		if (task->_end <= now) {
+			UnlinkBucket(task);
+			PlaceDue(task);
+		}
+		task = next;
+	}
+
+	_drained_until = now;
+
+	if (_empty_groups > GROUP_PRUNE_THRESHOLD && _empty_groups > _groups.size() / 2)
+		PruneGroups();
+}
+
+void TaskScheduler::TaskQueue::Step(uint64_t const target)
+{
+	// Find the lowest level holding any task, the overflow bucket is looked at with the last level.
+	std::size_t level = 0;
+
+	while (level < WHEEL_LEVELS && _level_count[level] == 0)
+		++level;
+
+	if (level == WHEEL_LEVELS && _level_count[WHEEL_LEVELS] != 0)
+		level = WHEEL_LEVELS - 1;
+
+	if (level == WHEEL_LEVELS) {
+		// Nothing left in the wheel, it can jump right to the target.
+		_current = target;
+		return;
+	}
+
+	// Lower levels are empty, skip ahead to the next tick where the found level has to cascade.
+	uint64_t const next = level == 0 ? _current + 1 : ((_current >> (level * WHEEL_BITS)) + 1) << (level * WHEEL_BITS);
+
+	_current = std::min(next, target);
+
+	// Pull the overflowing tasks in whenever the last level turns.
+	if ((_current & ((uint64_t(1) << ((WHEEL_LEVELS - 1) * WHEEL_BITS)) - 1)) == 0)
+		Cascade(OVERFLOW_BUCKET);
+
+	// Cascade the higher levels first, their tasks may end up in a lower level slot that cascades next.
+	for (std::size_t l = WHEEL_LEVELS - 1; l > 0; --l) {
+		if ((_current & ((uint64_t(1) << (l * WHEEL_BITS)) - 1)) == 0)
+			Cascade(l * WHEEL_SLOTS + ((_current >> (l * WHEEL_BITS)) & WHEEL_MASK));
+	}
+}
+
+void TaskScheduler::TaskQueue::Cascade(std::size_t const bucket)
+{
+	// Detach the whole bucket first, overflowing tasks may be placed right back into it.
+	Task *task = _buckets[bucket].head;
+	std::size_t count = 0;
+
+	for (Task *t = task; t != nullptr; t = t->_next)
+		++count;
+
+	_buckets[bucket] = Bucket();
+	_level_count[bucket / WHEEL_SLOTS] -= count;
+
+	while (task != nullptr) {
+		Task *next = task->_next;
+		task->_prev = task->_next = nullptr;
+		PlaceWheel(task);
+		task = next;
+	}
+}
+
+void TaskScheduler::TaskQueue::PruneGroups()
+{
+	for (auto it = _groups.begin(); it != _groups.end();) {
+		if (it->second.count == 0)
+			it = _groups.erase(it);
+		else
+			++it;
+	}
+
+	_empty_groups = 0;
 }
 
 TaskContext& TaskContext::Dispatch(std::function<TaskScheduler&(TaskScheduler&)> const& apply)
@@ -199,13 +524,27 @@ bool TaskContext::IsInGroup(TaskScheduler::group_t const group) const
 
 TaskContext& TaskContext::SetGroup(TaskScheduler::group_t const group)
 {
-	_task->_group = TaskScheduler::MakeUnique<TaskScheduler::group_t>(group);
+	// A repeated task is queued already and has to move within the group index.
+	if (_task->_queued != nullptr) {
+		if (auto const owner = _owner.lock())
+			owner->_task_holder.Regroup(*_task, true, group);
+		return *this;
+	}
+
+	_task->_grouped = true;
+	_task->_group = group;
 	return *this;
 }
 
 TaskContext& TaskContext::ClearGroup()
 {
-	_task->_group = nullptr;
+	if (_task->_queued != nullptr) {
+		if (auto const owner = _owner.lock())
+			owner->_task_holder.Regroup(*_task, false, 0);
+		return *this;
+	}
+
+	_task->_grouped = false;
 	return *this;
 }
 
@@ -21,8 +21,10 @@
 #include <cstdint>
 #include <functional>
 #include <memory>
-#include <set>
+#include <array>
 #include <queue>
+#include <unordered_map>
+#include <vector>
 #include <mutex>
 #include <random>
 
@@ -103,6 +105,82 @@ class TaskScheduler
 		return std::unique_ptr<T>(new T(std::forward<Args>(args)...));
 	}
 
+	/// Pooling allocator for tasks, freed task blocks are kept on a per-thread free list
+	/// and handed out again on the next schedule instead of going through the heap.
+	/// Blocks may be released on a different thread than the one which allocated them
+	/// (i.e. when tasks are migrated between schedulers), they simply join that thread's list.
+	template<typename T>
+	struct TaskAllocator
+	{
+		typedef T value_type;
+
+		/// Maximum amount of free blocks kept per thread.
+		static constexpr std::size_t MAX_FREE_BLOCKS = 4096;
+
+		TaskAllocator() = default;
+		template<typename U>
+		TaskAllocator(TaskAllocator<U> const&) { }
+
+		T* allocate(std::size_t n)
+		{
+			static_assert(sizeof(T) >= sizeof(FreeBlock), "Pooled type is too small to hold a free list link.");
+
+			FreeList& list = free_list();
+
+			if (n != 1 || list.head == nullptr)
+				return static_cast<T*>(::operator new(n * sizeof(T)));
+
+			FreeBlock *block = list.head;
+			list.head = block->next;
+			--list.size;
+			return reinterpret_cast<T*>(block);
+		}
+
+		void deallocate(T* p, std::size_t n)
+		{
+			FreeList& list = free_list();
+
+			if (n != 1 || list.size >= MAX_FREE_BLOCKS) {
+				::operator delete(p);
+				return;
+			}
+
+			FreeBlock *block = reinterpret_cast<FreeBlock*>(p);
+			block->next = list.head;
+			list.head = block;
+			++list.size;
+		}
+
+		template<typename U>
+		bool operator== (TaskAllocator<U> const&) const { return true; }
+		template<typename U>
+		bool operator!= (TaskAllocator<U> const&) const { return false; }
+
+	private:
+		struct FreeBlock { FreeBlock *next; };
+
+		struct FreeList
+		{
+			FreeBlock *head{nullptr};
+			std::size_t size{0};
+
+			~FreeList()
+			{
+				while (head != nullptr) {
+					FreeBlock *next = head->next;
+					::operator delete(head);
+					head = next;
+				}
+			}
+		};
+
+		static FreeList& free_list()
+		{
+			static thread_local FreeList list;
+			return list;
+		}
+	};
+
 	class Task
 	{
 		friend class TaskContext;
@@ -110,24 +188,32 @@ class TaskScheduler
 
 		timepoint_t _end;
 		duration_calculator_t _duration_calculator;
-		std::unique_ptr<group_t> _group;
+		group_t _group;
+		bool _grouped;
 		repeated_t _repeated;
 		task_handler_t _task;
 
+		/// Intrusive links used by the task queue, only valid while the task is queued.
+		/// The queue keeps the task alive through _queued until it is removed again.
+		std::shared_ptr<Task> _queued;
+		Task *_prev{nullptr}, *_next{nullptr};
+		Task *_group_prev{nullptr}, *_group_next{nullptr};
+		std::size_t _bucket{0};
+
 	public:
 		// All Argument construct
 		Task(timepoint_t const& end, duration_calculator_t&& duration_calculator,
 			 group_t const group,
 			 repeated_t const repeated, task_handler_t const& task)
 		: _end(end), _duration_calculator(std::move(duration_calculator)),
-		_group(TaskScheduler::MakeUnique<group_t>(group)),
+		_group(group), _grouped(true),
 		_repeated(repeated), _task(task) { }
 
 		// Minimal Argument construct
 		Task(timepoint_t const& end, duration_calculator_t&& duration_calculator,
 			 task_handler_t const& task)
 		: _end(end), _duration_calculator(std::move(duration_calculator)),
-		_group(nullptr), _repeated(0), _task(task) { }
+		_group(0), _grouped(false), _repeated(0), _task(task) { }
 
 		// Copy construct
 		Task(Task const&) = delete;
@@ -158,43 +244,104 @@ class TaskScheduler
 		// Returns true if the task is in the given group
 		inline bool IsInGroup(group_t const group) const
 		{
-			return _group && (*_group == group);
+			return _grouped && (_group == group);
 		}
 	};
 
 	typedef std::shared_ptr<Task> TaskContainer;
 
-	/// Container which provides Task order, insert and reschedule operations.
-	struct Compare
-	{
-		bool operator() (TaskContainer const& left, TaskContainer const& right) const
-		{
-			return (*left.get()) < (*right.get());
-		};
-	};
-
+	/// Hierarchical timing wheel which holds all pending tasks.
+	/// Tasks are bucketed by their due millisecond into WHEEL_LEVELS levels of WHEEL_SLOTS slots,
+	/// each level covering WHEEL_SLOTS times the range of the one below it. Tasks of a higher level
+	/// cascade down as the wheel turns, tasks beyond the range of the last level wait in an overflow bucket.
+	/// Tasks that became due are moved into a sorted due list, preserving the dispatch order by end time.
+	/// Scheduling and cancelling a single task is O(1), grouped tasks are additionally indexed by group
+	/// so that counting, cancelling or migrating a group only touches the tasks of that group.
 	class TaskQueue
 	{
-		std::multiset<TaskContainer, Compare> container;
-
 	public:
+		static constexpr std::size_t WHEEL_BITS = 6;
+		static constexpr std::size_t WHEEL_LEVELS = 5;
+		static constexpr std::size_t WHEEL_SLOTS = 1 << WHEEL_BITS;
+		static constexpr uint64_t WHEEL_MASK = WHEEL_SLOTS - 1;
+		static constexpr std::size_t OVERFLOW_BUCKET = WHEEL_LEVELS * WHEEL_SLOTS;
+		static constexpr std::size_t DUE_BUCKET = OVERFLOW_BUCKET + 1;
+		static constexpr std::size_t BUCKET_COUNT = DUE_BUCKET + 1;
+		/// Amount of emptied group entries tolerated before the group index is pruned.
+		static constexpr std::size_t GROUP_PRUNE_THRESHOLD = 1024;
+
+		explicit TaskQueue(timepoint_t const& now);
+		~TaskQueue();
+
+		TaskQueue(TaskQueue const&) = delete;
+		TaskQueue& operator= (TaskQueue const&) = delete;
+
 		// Pushes the task in the container
 		void Push(TaskContainer&& task);
 
-		/// Pops the task out of the container
-		TaskContainer Pop();
-
-		TaskContainer const& First() const;
+		/// Pops the earliest task which is due at the given time point, returns nullptr if there is none.
+		TaskContainer PopDue(timepoint_t const& now);
 
 		void Clear();
 
-		void RemoveIf(std::function<bool(TaskContainer const&)> const& filter);
+		void RemoveGroup(group_t const group);
+
+		/// Calls the modifier on every task and re-buckets the task if it returns true.
+		void ModifyIf(std::function<bool(Task&)> const& modifier);
+
+		/// Calls the modifier on every task of the group and re-buckets the tasks.
+		void ModifyGroup(group_t const group, std::function<void(Task&)> const& modifier);
 
-		void ModifyIf(std::function<bool(TaskContainer const&)> const& filter);
+		void ExtractGroupsIf(std::function<bool(group_t)> const& filter, std::vector<TaskContainer>& extracted);
 
-		std::size_t Count(group_t const &group);
+		/// Moves a queued task into another group or out of its group.
+		void Regroup(Task& task, bool const grouped, group_t const group);
+
+		std::size_t Count(group_t const &group) const;
 
 		bool IsEmpty() const;
+
+	private:
+		struct Bucket
+		{
+			Task *head{nullptr}, *tail{nullptr};
+		};
+
+		struct Group
+		{
+			Task *head{nullptr};
+			std::size_t count{0};
+		};
+
+		static uint64_t TickOf(timepoint_t const& time);
+
+		/// Places an unbucketed task into the due list or the wheel.
+		void Place(Task* task);
+		void PlaceDue(Task* task);
+		void PlaceWheel(Task* task);
+		void LinkBucket(Task* task, std::size_t bucket, Task* after);
+		void UnlinkBucket(Task* task);
+		void LinkGroup(Task* task);
+		void UnlinkGroup(Task* task);
+		TaskContainer Unlink(Task* task);
+
+		/// Turns the wheel up to the given time point, moving all tasks due until then into the due list.
+		void Advance(timepoint_t const& now);
+		/// Moves the wheel to the next tick worth visiting, never past the target tick.
+		void Step(uint64_t const target);
+		void Cascade(std::size_t const bucket);
+		void PruneGroups();
+
+		std::array<Bucket, BUCKET_COUNT> _buckets;
+		/// Amount of tasks per wheel level, the last entry counts the overflow bucket.
+		std::array<std::size_t, WHEEL_LEVELS + 1> _level_count;
+		std::unordered_map<group_t, Group> _groups;
+		std::size_t _empty_groups{0};
+		std::size_t _size{0};
+		/// Current wheel tick in milliseconds, every task in the wheel is due at or after it.
+		uint64_t _current;
+		/// Every task due until this time point is in the due list.
+		timepoint_t _drained_until;
 	};
 
 	/// Contains a self reference to track if this object was deleted or not.
@@ -226,12 +373,12 @@ class TaskScheduler
 public:
 	TaskScheduler()
 	: self_reference(this, [](TaskScheduler const*) { }),
-	_now(clock_t::now()), _predicate(EmptyValidator) { }
+	_now(clock_t::now()), _task_holder(_now), _predicate(EmptyValidator) { }
 
 	template<typename P>
 	TaskScheduler(P&& predicate)
 	: self_reference(this, [](TaskScheduler const*) { }),
-	_now(clock_t::now()), _predicate(std::forward<P>(predicate)) { }
+	_now(clock_t::now()), _task_holder(_now), _predicate(std::forward<P>(predicate)) { }
 
 	TaskScheduler(TaskScheduler const&) = delete;
 	TaskScheduler(TaskScheduler&&) = delete;
@@ -281,6 +428,7 @@ public:
 		return ScheduleAt(_now, MakeDurationCalculator(time), task);
 	}
 
+	/// Returns the amount of pending tasks in the group.
 	std::size_t Count(group_t const &group);
 
 	/// Schedule an event with a fixed rate.
@@ -323,13 +471,23 @@ public:
 	/// Hint: Use std::initializer_list for this: "{1, 2, 3, 4}"
 	TaskScheduler& CancelGroupsOf(std::vector<group_t> const& groups);
 
+	/// Tasks taken out of a scheduler to be handed over to another one.
+	typedef std::vector<TaskContainer> TaskList;
+
+	/// Removes and returns all tasks of the groups accepted by the filter, ungrouped tasks are kept.
+	/// Never call this from within a task context!
+	TaskList ExtractGroupsIf(std::function<bool(group_t)> const& filter);
+
+	/// Inserts tasks extracted from another scheduler, they keep their due time.
+	TaskScheduler& InsertTasks(TaskList&& tasks);
+
 	/// Delays all tasks with the given duration.
 	template<typename _Rep, typename _Period>
 	TaskScheduler& DelayAll(std::chrono::duration<_Rep, _Period> const& duration)
 	{
-		_task_holder.ModifyIf([&duration](TaskContainer const& task) -> bool
+		_task_holder.ModifyIf([&duration](Task& task) -> bool
 							  {
-								  task->_end += duration;
+								  task._end += duration;
 								  return true;
 							  });
 		return *this;
@@ -347,16 +505,10 @@ public:
 	template<typename _Rep, typename _Period>
 	TaskScheduler& DelayGroup(group_t const group, std::chrono::duration<_Rep, _Period> const& duration)
 	{
-		_task_holder.ModifyIf([&duration, group](TaskContainer const& task) -> bool
-							  {
-								  if (task->IsInGroup(group))
-								  {
-									  task->_end += duration;
-									  return true;
-								  }
-								  else
-									  return false;
-							  });
+		_task_holder.ModifyGroup(group, [&duration](Task& task)
+								 {
+									 task._end += duration;
+								 });
 		return *this;
 	}
 
@@ -388,10 +540,7 @@ public:
 	template<typename _Rep, typename _Period>
 	TaskScheduler& RescheduleGroup(group_t const group, std::chrono::duration<_Rep, _Period> const& duration)
 	{
-		return RescheduleAtWithPredicate(_now + duration, [&](TaskContainer const& task)
-										 {
-											 return task->IsInGroup(group);
-										 });
+		return RescheduleGroupAt(group, _now + duration);
 	}
 
 	/// Reschedule all tasks of a group with a random duration between min and max.
@@ -410,7 +559,7 @@ private:
 	TaskScheduler& ScheduleAt(timepoint_t const& end,
 							  duration_calculator_t&& duration_calculator, task_handler_t const& task)
 	{
-		return InsertTask(TaskContainer(new Task(end + duration_calculator(), std::move(duration_calculator), task)));
+		return InsertTask(std::allocate_shared<Task>(TaskAllocator<Task>(), end + duration_calculator(), std::move(duration_calculator), task));
 	}
 
 	/// Schedule an event with a fixed rate.
@@ -419,34 +568,28 @@ private:
 							  duration_calculator_t&& duration_calculator,
 							  group_t const group, task_handler_t const& task)
 	{
-		// FIXME Reuse std::unique_ptr
 		static repeated_t const DEFAULT_REPEATED = 0;
-		return InsertTask(TaskContainer(new Task(end + duration_calculator(), std::move(duration_calculator), group, DEFAULT_REPEATED, task)));
-	}
-
-	static bool AlwaysTruePredicate(TaskContainer const&)
-	{
-		return true;
+		return InsertTask(std::allocate_shared<Task>(TaskAllocator<Task>(), end + duration_calculator(), std::move(duration_calculator), group, DEFAULT_REPEATED, task));
 	}
 
+	/// Reschedule all tasks to the given time.
 	TaskScheduler& RescheduleAt(timepoint_t const& end)
 	{
-		return RescheduleAtWithPredicate(end, AlwaysTruePredicate);
+		_task_holder.ModifyIf([&end](Task& task) -> bool
+							  {
+								  task._end = end;
+								  return true;
+							  });
+		return *this;
 	}
 
-	/// Reschedule all tasks with a given duration relative to the given time.
-	TaskScheduler& RescheduleAtWithPredicate(timepoint_t const& end, std::function<bool(TaskContainer const&)> const& predicate)
+	/// Reschedule all tasks of a group to the given time.
+	TaskScheduler& RescheduleGroupAt(group_t const group, timepoint_t const& end)
 	{
-		_task_holder.ModifyIf([&](TaskContainer const& task) -> bool
-							  {
-								  if (predicate(task))
-								  {
-									  task->_end = end;
-									  return true;
-								  }
-								  else
-									  return false;
-							  });
+		_task_holder.ModifyGroup(group, [&end](Task& task)
+								 {
+									 task._end = end;
+								 });
 		return *this;
 	}
 
@@ -521,7 +664,8 @@ public:
 
 	// Construct from task and owner
 	explicit TaskContext(TaskScheduler::TaskContainer&& task, std::weak_ptr<TaskScheduler>&& owner)
-	: _task(task), _owner(owner), _consumed(std::make_shared<bool>(false)) { }
+	: _task(std::move(task)), _owner(std::move(owner)),
+	_consumed(std::allocate_shared<bool>(TaskScheduler::TaskAllocator<bool>(), false)) { }
 
 	// Move construct
 	TaskContext(TaskContext&& right)
@@ -574,7 +718,11 @@ public:
 		_task->_end += _task->_duration_calculator();
 		_task->_repeated += 1;
 		(*_consumed) = true;
-		return Dispatch(std::bind(&TaskScheduler::InsertTask, std::placeholders::_1, std::cref(_task)));
+
+		if (auto const owner = _owner.lock())
+			owner->InsertTask(_task);
+
+		return *this;
 	}
 
 	/// Repeats the event and set a new duration that is randomized between min and max.
@@ -710,11 +858,7 @@ public:
 	template<typename _Rep, typename _Period>
 	TaskContext& RescheduleGroup(TaskScheduler::group_t const group, std::chrono::duration<_Rep, _Period> const& duration)
 	{
-		return Dispatch(std::bind(&TaskScheduler::RescheduleAtWithPredicate, std::placeholders::_1, _task->_end + duration,
-								  [&](TaskScheduler::TaskContainer const& task)
-								  {
-									  return task->IsInGroup(group);
-								  }));
+		return Dispatch(std::bind(&TaskScheduler::RescheduleGroupAt, std::placeholders::_1, group, _task->_end + duration));
 	}
 
 	/// Reschedule all tasks of a group with a random duration between min and max.
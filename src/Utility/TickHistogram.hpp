@@ -0,0 +1,138 @@
+/***************************************************
+ *       _   _            _                        *
+ *      | | | |          (_)                       *
+ *      | |_| | ___  _ __ _ _______  _ __          *
+ *      |  _  |/ _ \| '__| |_  / _ \| '_  \        *
+ *      | | | | (_) | |  | |/ / (_) | | | |        *
+ *      \_| |_/\___/|_|  |_/___\___/|_| |_|        *
+ ***************************************************
+ * This file is part of Horizon (c).
+ *
+ * Copyright (c) 2019 Sagun K. (sagunxp@gmail.com).
+ * Copyright (c) 2019 Horizon Dev Team.
+ *
+ * Base Author - Sagun K. (sagunxp@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ **************************************************/
+
+#ifndef HORIZON_UTILITIES_TICKHISTOGRAM_HPP
+#define HORIZON_UTILITIES_TICKHISTOGRAM_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Log-linear histogram of durations in microseconds.
+ * Every power of two is split into 8 buckets, so a percentile is reported with at most
+ * 12.5% error. The range reaches about 16 seconds, longer durations land in the last bucket.
+ * Recording is wait-free. Records from several threads, and reads during recording, are
+ * allowed, but a read is not an atomic snapshot of the whole histogram.
+ */
+class TickHistogram
+{
+	static constexpr int SUB_BUCKET_BITS = 3;
+	static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+	static constexpr int MAX_EXPONENT = 24;
+	static constexpr int BUCKETS = SUB_BUCKETS + (MAX_EXPONENT - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+public:
+	TickHistogram() { reset(); }
+
+	void record(uint64_t us)
+	{
+		_buckets[bucket_of(us)].fetch_add(1, std::memory_order_relaxed);
+		_count.fetch_add(1, std::memory_order_relaxed);
+
+		uint64_t max = _max.load(std::memory_order_relaxed);
+
+		while (us > max && !_max.compare_exchange_weak(max, us, std::memory_order_relaxed))
+			;
+	}
+
+	uint64_t count() const { return _count.load(std::memory_order_relaxed); }
+	uint64_t max() const { return _max.load(std::memory_order_relaxed); }
+
+	/**
+	 * @brief Returns the smallest recorded duration that percent percent of the durations
+	 * do not exceed, as the upper bound of its bucket. Returns 0 when nothing was recorded.
+	 */
+	uint64_t percentile(double percent) const
+	{
+		uint64_t total = count();
+
+		if (total == 0)
+			return 0;
+
+		uint64_t rank = (uint64_t) (percent / 100.0 * total + 0.5), seen = 0;
+
+		if (rank == 0)
+			rank = 1;
+
+		for (int i = 0; i < BUCKETS; i++) {
+			seen += _buckets[i].load(std::memory_order_relaxed);
+
+			if (seen >= rank) {
+				uint64_t upper = bucket_upper_bound(i);
+				return upper < max() && i < BUCKETS - 1 ? upper : max();
+			}
+		}
+
+		return max();
+	}
+
+	void reset()
+	{
+		for (int i = 0; i < BUCKETS; i++)
+			_buckets[i].store(0, std::memory_order_relaxed);
+
+		_count.store(0, std::memory_order_relaxed);
+		_max.store(0, std::memory_order_relaxed);
+	}
+
+private:
+	static int bucket_of(uint64_t us)
+	{
+		if (us < SUB_BUCKETS)
+			return (int) us;
+
+		int exponent = 63 - __builtin_clzll(us);
+
+		if (exponent > MAX_EXPONENT)
+			return BUCKETS - 1;
+
+		int sub_bucket = (int) (us >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+
+		return SUB_BUCKETS + (exponent - SUB_BUCKET_BITS) * SUB_BUCKETS + sub_bucket;
+	}
+
+	static uint64_t bucket_upper_bound(int bucket)
+	{
+		if (bucket < SUB_BUCKETS)
+			return (uint64_t) bucket;
+
+		int exponent = (bucket - SUB_BUCKETS) / SUB_BUCKETS + SUB_BUCKET_BITS;
+		uint64_t sub_bucket = (uint64_t) ((bucket - SUB_BUCKETS) % SUB_BUCKETS);
+		uint64_t width = (uint64_t) 1 << (exponent - SUB_BUCKET_BITS);
+
+		return ((uint64_t) 1 << exponent) + (sub_bucket + 1) * width - 1;
+	}
+
+	std::atomic<uint64_t> _buckets[BUCKETS];
+	std::atomic<uint64_t> _count;
+	std::atomic<uint64_t> _max;
+};
+
+#endif // HORIZON_UTILITIES_TICKHISTOGRAM_HPP